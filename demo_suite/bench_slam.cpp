@@ -0,0 +1,996 @@
+/**
+ * \file bench_slam.cpp
+ *
+ * Micro-benchmarks of the geometry and estimation kernels.
+ *
+ * \author jsola@laas.fr
+ * \date 17/10/2026
+ *
+ *  Times the inner kernels of the filter independently of any sensor or display:
+ *  quaternion and frame tools, pin-hole projection and back-projection, AHP and AHPL conversions,
+ *  innovation inversion, EKF predict, correct, initialize and reparametrize at several map sizes,
+ *  synthetic frames of corrections of a sliding window of landmarks, on the EKF and on the compressed EKF,
+ *  Harris and FAST detection in search regions and in whole frames and ZNCC matching on a synthetic image,
+ *  creation and deletion of landmarks.
+ *
+ *  Each benchmark is repeated on a fixed set of random inputs (fixed seed), the number of iterations
+ *  is calibrated to last at least --min-time seconds, and the median and min over the repetitions are reported.
+ *  The number of calls to the general-purpose allocator per operation is also reported.
+ *  The results are written as JSON, so that runs of different commits can be compared with any script:
+ *
+ *    bench_slam --output bench-`git rev-parse --short HEAD`.json --label `git rev-parse --short HEAD`
+ *
+ *  Options:
+ *    --output file    JSON output file (default: standard output only)
+ *    --label name     label of the run, e.g. the commit (default: "unnamed")
+ *    --min-time s     min duration of each repetition in seconds (default: 0.2)
+ *    --repeats n      number of repetitions (default: 5)
+ *    --filter str     only run the benchmarks whose name contains str
+ *
+ * \ingroup rtslam
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <boost/shared_ptr.hpp>
+
+// jafar debug include
+#include "kernel/jafarDebug.hpp"
+#include "kernel/timingTools.hpp"
+#include "jmath/jblas.hpp"
+#include "jmath/ublasExtra.hpp"
+
+#include "image/Image.hpp"
+#include "image/roi.hpp"
+#include "correl/explorer.hpp"
+
+#include "rtslam/quatTools.hpp"
+#include "rtslam/pinholeTools.hpp"
+#include "rtslam/sensorImageParameters.hpp"
+#include "rtslam/ahpTools.hpp"
+#include "rtslam/ahplTools.hpp"
+#include "rtslam/innovation.hpp"
+#include "rtslam/kalmanFilter.hpp"
+#include "rtslam/compressedFilter.hpp"
+#include "rtslam/blockJacobian.hpp"
+#include "rtslam/quickHarrisDetector.hpp"
+#include "rtslam/fastDetector.hpp"
+#include "rtslam/featurePoint.hpp"
+#include "rtslam/simuImageRenderer.hpp"
+#include "rtslam/mapAbstract.hpp"
+#include "rtslam/robotConstantVelocity.hpp"
+#include "rtslam/sensorPinhole.hpp"
+#include "rtslam/landmarkAnchoredHomogeneousPoint.hpp"
+#include "rtslam/landmarkEuclideanPoint.hpp"
+#include "rtslam/landmarkFactory.hpp"
+#include "rtslam/observationPinHoleAnchoredHomogeneous.hpp"
+#include "rtslam/observationMakers.hpp"
+
+using namespace std;
+using namespace jblas;
+using namespace jafar;
+using namespace jafar::jmath;
+using namespace jafar::rtslam;
+
+
+/** ############################################################################
+ * #############################################################################
+ * harness
+ * ###########################################################################*/
+
+/// number of calls to the general-purpose allocator
+static unsigned long n_allocs = 0;
+
+void * operator new(size_t size)
+{
+	++n_allocs;
+	void * p = std::malloc(size ? size : 1);
+	if (p == NULL) throw std::bad_alloc();
+	return p;
+}
+void * operator new[](size_t size) { return operator new(size); }
+void operator delete(void * p) throw() { std::free(p); }
+void operator delete[](void * p) throw() { std::free(p); }
+
+const size_t N_SAMPLES = 256; ///< number of random inputs of each benchmark, cycled over
+const size_t SAMPLE_MASK = N_SAMPLES - 1;
+
+static double uniform(double a, double b)
+{
+	return a + (b - a) * std::rand() / (double)RAND_MAX;
+}
+
+static vec4 randomQuaternion()
+{
+	vec4 q;
+	for (size_t i = 0; i < 4; ++i) q(i) = uniform(-1., 1.);
+	return q / ublas::norm_2(q);
+}
+
+static vec7 randomFrame()
+{
+	vec7 f;
+	for (size_t i = 0; i < 3; ++i) f(i) = uniform(-5., 5.);
+	ublas::subrange(f, 3, 7) = randomQuaternion();
+	return f;
+}
+
+static sym_mat randomCovariance(size_t n, double var)
+{
+	mat A(n, n);
+	for (size_t i = 0; i < n; ++i)
+		for (size_t j = 0; j < n; ++j)
+			A(i,j) = uniform(-1., 1.);
+	sym_mat P = ublas::prod(A, ublas::trans(A)) / (double)n;
+	P += identity_mat(n);
+	return var * P;
+}
+
+
+/**
+ * One benchmark: the inputs are prepared by the constructor, and run(n) executes n operations.
+ */
+class Bench {
+	public:
+		string name;
+		size_t size; ///< problem size, or 0 when not relevant
+		double sink; ///< accumulates the results, so that the work cannot be optimized away
+		Bench(const string & _name, size_t _size): name(_name), size(_size), sink(0.) {}
+		virtual ~Bench() {}
+		virtual void run(size_t n) = 0;
+};
+
+struct BenchResult {
+	string name;
+	size_t size;
+	size_t iterations;
+	double ns_per_op; ///< median over the repetitions
+	double ns_min;
+	double allocs_per_op; ///< calls to the general-purpose allocator
+};
+
+static double timeRun(Bench & bench, size_t n)
+{
+	double t0 = kernel::Clock::getTime();
+	bench.run(n);
+	return kernel::Clock::getTime() - t0;
+}
+
+static BenchResult measure(Bench & bench, double min_time, int repeats)
+{
+	// calibrate the number of iterations, this also warms the caches up
+	size_t n = 1;
+	double t = timeRun(bench, n);
+	while (t < min_time / 10. && n < ((size_t)1 << 30)) { n *= 2; t = timeRun(bench, n); }
+	if (t < min_time) n = (size_t)(n * min_time / std::max(t, 1e-6)) + 1;
+
+	std::vector<double> ns(repeats);
+	for (int r = 0; r < repeats; ++r)
+		ns[r] = timeRun(bench, n) * 1e9 / n;
+	std::sort(ns.begin(), ns.end());
+
+	size_t n_count = std::min(n, (size_t)1024);
+	unsigned long allocs0 = n_allocs;
+	bench.run(n_count);
+	double allocs = (n_allocs - allocs0) / (double)n_count;
+
+	BenchResult res;
+	res.name = bench.name;
+	res.size = bench.size;
+	res.iterations = n;
+	res.ns_per_op = ns[repeats / 2];
+	res.ns_min = ns[0];
+	res.allocs_per_op = allocs;
+	return res;
+}
+
+static string jsonEscape(const string & s)
+{
+	string res;
+	for (size_t i = 0; i < s.size(); ++i)
+	{
+		if (s[i] == '"' || s[i] == '\\') res += '\\';
+		res += s[i];
+	}
+	return res;
+}
+
+static void writeJson(ostream & os, const string & label, int repeats, double min_time, const std::vector<BenchResult> & results)
+{
+	char date[32];
+	time_t now = time(NULL);
+	strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+	os << "{\n";
+	os << "  \"label\": \"" << jsonEscape(label) << "\",\n";
+	os << "  \"date\": \"" << date << "\",\n";
+	os << "  \"repeats\": " << repeats << ",\n";
+	os << "  \"min_time\": " << min_time << ",\n";
+	os << "  \"benchmarks\": [\n";
+	for (size_t i = 0; i < results.size(); ++i)
+	{
+		const BenchResult & r = results[i];
+		os << "    {\"name\": \"" << jsonEscape(r.name) << "\", \"size\": " << r.size << ", \"iterations\": " << r.iterations
+		   << ", \"ns_per_op\": " << r.ns_per_op << ", \"ns_min\": " << r.ns_min << ", \"allocs_per_op\": " << r.allocs_per_op << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+	}
+	os << "  ]\n";
+	os << "}\n";
+}
+
+
+/** ############################################################################
+ * #############################################################################
+ * quaternion and frame tools
+ * ###########################################################################*/
+
+class BenchQProd: public Bench {
+		std::vector<vec4> q1, q2;
+		vec4 q; mat44 Q_q1, Q_q2;
+	public:
+		BenchQProd(): Bench("quat.qProd_jac", 0), q1(N_SAMPLES), q2(N_SAMPLES) {
+			for (size_t i = 0; i < N_SAMPLES; ++i) { q1[i] = randomQuaternion(); q2[i] = randomQuaternion(); }
+		}
+		void run(size_t n) {
+			for (size_t i = 0; i < n; ++i) {
+				quaternion::qProd(q1[i & SAMPLE_MASK], q2[i & SAMPLE_MASK], q, Q_q1, Q_q2);
+				sink += q(0) + Q_q1(0,0);
+			}
+		}
+};
+
+class BenchRotate: public Bench {
+		std::vector<vec4> q; std::vector<vec3> v;
+		vec3 vo; mat34 VO_q; mat33 VO_v;
+	public:
+		BenchRotate(): Bench("quat.rotate_jac", 0), q(N_SAMPLES), v(N_SAMPLES) {
+			for (size_t i = 0; i < N_SAMPLES; ++i) {
+				q[i] = randomQuaternion();
+				for (size_t j = 0; j < 3; ++j) v[i](j) = uniform(-10., 10.);
+			}
+		}
+		void run(size_t n) {
+			for (size_t i = 0; i < n; ++i) {
+				quaternion::rotate(q[i & SAMPLE_MASK], v[i & SAMPLE_MASK], vo, VO_q, VO_v);
+				sink += vo(0) + VO_q(0,0);
+			}
+		}
+};
+
+class BenchComposeFrames: public Bench {
+		std::vector<vec7> G, L;
+		vec7 C; mat C_g, C_l;
+	public:
+		BenchComposeFrames(): Bench("quat.composeFrames_jac", 0), G(N_SAMPLES), L(N_SAMPLES), C_g(7, 7), C_l(7, 7) {
+			for (size_t i = 0; i < N_SAMPLES; ++i) { G[i] = randomFrame(); L[i] = randomFrame(); }
+		}
+		void run(size_t n) {
+			for (size_t i = 0; i < n; ++i) {
+				quaternion::composeFrames(G[i & SAMPLE_MASK], L[i & SAMPLE_MASK], C, C_g, C_l);
+				sink += C(0) + C_l(0,0);
+			}
+		}
+};
+
+class BenchE2q: public Bench {
+		std::vector<vec3> e;
+		vec4 q; mat43 Q_e;
+	public:
+		BenchE2q(): Bench("quat.e2q_jac", 0), e(N_SAMPLES) {
+			for (size_t i = 0; i < N_SAMPLES; ++i)
+				for (size_t j = 0; j < 3; ++j) e[i](j) = uniform(-3., 3.);
+		}
+		void run(size_t n) {
+			for (size_t i = 0; i < n; ++i) {
+				quaternion::e2q(e[i & SAMPLE_MASK], q, Q_e);
+				sink += q(0) + Q_e(0,0);
+			}
+		}
+};
+
+class BenchV2q: public Bench {
+		std::vector<vec3> v;
+		vec4 q; mat43 Q_v;
+	public:
+		BenchV2q(): Bench("quat.v2q_jac", 0), v(N_SAMPLES) {
+			for (size_t i = 0; i < N_SAMPLES; ++i)
+				for (size_t j = 0; j < 3; ++j) v[i](j) = uniform(-0.1, 0.1);
+		}
+		void run(size_t n) {
+			for (size_t i = 0; i < n; ++i) {
+				quaternion::v2q(v[i & SAMPLE_MASK], q, Q_v);
+				sink += q(0) + Q_v(0,0);
+			}
+		}
+};
+
+
+/** ############################################################################
+ * #############################################################################
+ * pin-hole camera
+ * ###########################################################################*/
+
+const unsigned IMG_WIDTH = 640;
+const unsigned IMG_HEIGHT = 480;
+const double INTRINSIC[4] = { 301.27013, 266.86136, 497.28243, 496.81116 };
+const double DISTORTION[2] = { -0.23193, 0.11306 };
+
+static void setupCamera(SensorImageParameters & params)
+{
+	vec4 k;
+	for (size_t i = 0; i < 4; ++i) k(i) = INTRINSIC[i];
+	vec d(2);
+	for (size_t i = 0; i < 2; ++i) d(i) = DISTORTION[i];
+	params.setImgSize(IMG_WIDTH, IMG_HEIGHT);
+	params.setIntrinsicCalibration(k, d, 3);
+}
+
+static vec2 randomPixel()
+{
+	vec2 pix;
+	pix(0) = uniform(0., IMG_WIDTH - 1);
+	pix(1) = uniform(0., IMG_HEIGHT - 1);
+	return pix;
+}
+
+class BenchProject: public Bench {
+		SensorImageParameters params;
+		std::vector<vec3> v;
+		vec2 u; double dist; mat23 U_v;
+	public:
+		BenchProject(): Bench("pinhole.projectPoint_jac", 0), v(N_SAMPLES) {
+			setupCamera(params);
+			for (size_t i = 0; i < N_SAMPLES; ++i)
+				v[i] = pinhole::backprojectPoint(params.intrinsic, params.correction, randomPixel(), uniform(1., 20.));
+		}
+		void run(size_t n) {
+			for (size_t i = 0; i < n; ++i) {
+				pinhole::projectPoint(params.intrinsic, params.distortion, v[i & SAMPLE_MASK], u, dist, U_v);
+				sink += u(0) + U_v(0,0);
+			}
+		}
+};
+
+/// back-projection with the polynomial correction model, or with the undistortion map of the camera parameters
+class BenchBackProject: public Bench {
+		SensorImageParameters params;
+		bool use_map;
+		std::vector<vec2> u;
+		vec3 p; mat P_u, P_depth;
+	public:
+		BenchBackProject(bool _use_map):
+			Bench(_use_map ? "pinhole.backProjectPoint_map_jac" : "pinhole.backProjectPoint_correction_jac", 0),
+			use_map(_use_map), u(N_SAMPLES), P_u(3, 2), P_depth(3, 1)
+		{
+			setupCamera(params);
+			for (size_t i = 0; i < N_SAMPLES; ++i) u[i] = randomPixel();
+		}
+		void run(size_t n) {
+			for (size_t i = 0; i < n; ++i) {
+				if (use_map)
+					params.backProjectPoint(u[i & SAMPLE_MASK], 1.0, p, P_u, P_depth);
+				else
+					pinhole::backProjectPoint(params.intrinsic, params.correction, u[i & SAMPLE_MASK], 1.0, p, P_u, P_depth);
+				sink += p(0) + P_u(0,0);
+			}
+		}
+};
+
+
+/** ############################################################################
+ * #############################################################################
+ * anchored homogeneous points and lines
+ * ###########################################################################*/
+
+static vec7 randomAhp()
+{
+	vec7 ahp;
+	for (size_t i = 0; i < 6; ++i) ahp(i) = uniform(-1., 1.);
+	ahp(6) = uniform(0.05, 1.);
+	return ahp;
+}
+
+class BenchAhpToBearing: public Bench {
+		std::vector<vec7> s, ahp;
+		vec3 v; double dist; mat V_s, V_ahp;
+	public:
+		BenchAhpToBearing(): Bench("ahp.toBearingOnlyFrame_jac", 0), s(N_SAMPLES), ahp(N_SAMPLES), V_s(3, 7), V_ahp(3, 7) {
+			for (size_t i = 0; i < N_SAMPLES; ++i) { s[i] = randomFrame(); ahp[i] = randomAhp(); }
+		}
+		void run(size_t n) {
+			for (size_t i = 0; i < n; ++i) {
+				lmkAHP::toBearingOnlyFrame(s[i & SAMPLE_MASK], ahp[i & SAMPLE_MASK], v, dist, V_s, V_ahp);
+				sink += v(0) + V_ahp(0,0);
+			}
+		}
+};
+
+class BenchAhpFromBearing: public Bench {
+		std::vector<vec7> s; std::vector<vec3> v;
+		vec7 ahp; mat AHP_s, AHP_v, AHP_rho;
+	public:
+		BenchAhpFromBearing(): Bench("ahp.fromBearingOnlyFrame_jac", 0), s(N_SAMPLES), v(N_SAMPLES), AHP_s(7, 7), AHP_v(7, 3), AHP_rho(7, 1) {
+			for (size_t i = 0; i < N_SAMPLES; ++i) {
+				s[i] = randomFrame();
+				for (size_t j = 0; j < 3; ++j) v[i](j) = uniform(-1., 1.);
+				v[i](2) += 2.;
+			}
+		}
+		void run(size_t n) {
+			for (size_t i = 0; i < n; ++i) {
+				lmkAHP::fromBearingOnlyFrame(s[i & SAMPLE_MASK], v[i & SAMPLE_MASK], 0.5, ahp, AHP_s, AHP_v, AHP_rho);
+				sink += ahp(0) + AHP_s(0,0);
+			}
+		}
+};
+
+class BenchAhplToBearing: public Bench {
+		std::vector<vec7> s; std::vector<vec11> ahpl;
+		vec3 v1, v2; double dist1, dist2; mat V1_s, V1_ahpl, V2_s, V2_ahpl;
+	public:
+		BenchAhplToBearing(): Bench("ahpl.toBearingOnlyFrame_jac", 0), s(N_SAMPLES), ahpl(N_SAMPLES),
+			V1_s(3, 7), V1_ahpl(3, 11), V2_s(3, 7), V2_ahpl(3, 11)
+		{
+			for (size_t i = 0; i < N_SAMPLES; ++i) {
+				s[i] = randomFrame();
+				ublas::subrange(ahpl[i], 0, 7) = randomAhp();
+				for (size_t j = 7; j < 10; ++j) ahpl[i](j) = uniform(-1., 1.);
+				ahpl[i](10) = uniform(0.05, 1.);
+			}
+		}
+		void run(size_t n) {
+			for (size_t i = 0; i < n; ++i) {
+				lmkAHPL::toBearingOnlyFrame(s[i & SAMPLE_MASK], ahpl[i & SAMPLE_MASK], v1, v2, dist1, dist2, V1_s, V1_ahpl, V2_s, V2_ahpl);
+				sink += v1(0) + V2_ahpl(0,0);
+			}
+		}
+};
+
+class BenchAhplFromBearing: public Bench {
+		std::vector<vec7> s; std::vector<vec3> v1, v2;
+		vec ahpl; mat AHPL_s, AHPL_v1, AHPL_v2, AHPL_rho1, AHPL_rho2;
+	public:
+		BenchAhplFromBearing(): Bench("ahpl.fromBearingOnlyFrame_jac", 0), s(N_SAMPLES), v1(N_SAMPLES), v2(N_SAMPLES),
+			ahpl(11), AHPL_s(11, 7), AHPL_v1(11, 3), AHPL_v2(11, 3), AHPL_rho1(11, 1), AHPL_rho2(11, 1)
+		{
+			for (size_t i = 0; i < N_SAMPLES; ++i) {
+				s[i] = randomFrame();
+				for (size_t j = 0; j < 3; ++j) { v1[i](j) = uniform(-1., 1.); v2[i](j) = uniform(-1., 1.); }
+				v1[i](2) += 2.; v2[i](2) += 2.;
+			}
+		}
+		void run(size_t n) {
+			for (size_t i = 0; i < n; ++i) {
+				lmkAHPL::fromBearingOnlyFrame(s[i & SAMPLE_MASK], v1[i & SAMPLE_MASK], v2[i & SAMPLE_MASK], 0.5, 0.3,
+					ahpl, AHPL_s, AHPL_v1, AHPL_v2, AHPL_rho1, AHPL_rho2);
+				sink += ahpl(0) + AHPL_s(0,0);
+			}
+		}
+};
+
+
+/** ############################################################################
+ * #############################################################################
+ * innovation and EKF
+ * ###########################################################################*/
+
+class BenchInvertCov: public Bench {
+		Innovation inn;
+	public:
+		BenchInvertCov(size_t _size): Bench("innovation.invertCov", _size), inn(_size) {
+			inn.P() = randomCovariance(_size, 4.);
+		}
+		void run(size_t n) {
+			for (size_t i = 0; i < n; ++i) {
+				inn.invertCov();
+				sink += inn.iP_(0,0);
+			}
+		}
+};
+
+const size_t ROB_SIZE = 13; ///< constant velocity robot: position, orientation, linear and angular velocities
+const size_t LMK_SIZE = 7; ///< anchored homogeneous point
+
+/**
+ * Filter holding a robot and \a n_lmk AHP landmarks, with a dense random covariance,
+ * in which the operations of the benchmarks cycle over the landmarks.
+ */
+class BenchFilter: public Bench {
+	protected:
+		size_t n_lmk;
+		ExtendedKalmanFilterIndirect filter;
+		ind_array ia_x, ia_rob;
+		std::vector<ind_array> ia_lmk;
+	public:
+		BenchFilter(const string & _name, size_t _n_lmk):
+			Bench(_name, ROB_SIZE + _n_lmk * LMK_SIZE), n_lmk(_n_lmk), filter(ROB_SIZE + _n_lmk * LMK_SIZE),
+			ia_x(ia_set(0, ROB_SIZE + _n_lmk * LMK_SIZE)), ia_rob(ia_set(0, ROB_SIZE)), ia_lmk(_n_lmk)
+		{
+			for (size_t i = 0; i < size; ++i) filter.x()(i) = uniform(-1., 1.);
+			filter.P() = randomCovariance(size, 0.01);
+			for (size_t l = 0; l < n_lmk; ++l)
+				ia_lmk[l] = ia_set(ROB_SIZE + l * LMK_SIZE, ROB_SIZE + (l + 1) * LMK_SIZE);
+		}
+		virtual ~BenchFilter() {}
+};
+
+/// constant velocity Jacobian, dense or block-sparse
+class BenchPredict: public BenchFilter {
+		bool use_blocks;
+		mat F_v;
+		BlockJacobian F_blocks;
+		sym_mat Q;
+	public:
+		BenchPredict(size_t _n_lmk, bool _use_blocks):
+			BenchFilter(_use_blocks ? "ekf.predict_blocks" : "ekf.predict", _n_lmk),
+			use_blocks(_use_blocks), F_v(identity_mat(ROB_SIZE)), F_blocks(ROB_SIZE), Q(ROB_SIZE)
+		{
+			const double dt = 0.01;
+			for (size_t i = 0; i < 3; ++i) F_v(i, 7 + i) = dt;
+			for (size_t i = 3; i < 7; ++i)
+				for (size_t j = 3; j < 7; ++j) F_v(i, j) += uniform(-dt, dt);
+			for (size_t i = 3; i < 7; ++i)
+				for (size_t j = 10; j < 13; ++j) F_v(i, j) = uniform(-dt, dt);
+			F_blocks.addIdentity(0, 3);
+			F_blocks.addBlock(0, 7, 3, 3);
+			F_blocks.addBlock(3, 3, 4, 4);
+			F_blocks.addBlock(3, 10, 4, 3);
+			Q = 1e-6 * identity_mat(ROB_SIZE);
+		}
+		void run(size_t n) {
+			for (size_t i = 0; i < n; ++i) {
+				if (use_blocks)
+					filter.predict(ia_x, F_v, F_blocks, ia_rob, Q);
+				else
+					filter.predict(ia_x, F_v, ia_rob, Q);
+				sink += filter.P()(0,0);
+			}
+		}
+};
+
+/// point observation of one landmark, with a dense Jacobian wrt the robot and the landmark
+class BenchCorrect: public BenchFilter {
+		Innovation inn;
+		mat INN_rsl;
+		sym_mat R;
+	public:
+		BenchCorrect(size_t _n_lmk): BenchFilter("ekf.correct", _n_lmk), inn(2), INN_rsl(2, ROB_SIZE + LMK_SIZE), R(identity_mat(2)) {
+			for (size_t i = 0; i < 2; ++i)
+				for (size_t j = 0; j < ROB_SIZE + LMK_SIZE; ++j) INN_rsl(i, j) = uniform(-0.1, 0.1);
+			inn.x()(0) = 0.1; inn.x()(1) = -0.1;
+			inn.P() = R;
+		}
+		void run(size_t n) {
+			for (size_t i = 0; i < n; ++i) {
+				filter.correct(ia_x, inn, INN_rsl, ia_union(ia_rob, ia_lmk[i % n_lmk]), R);
+				sink += filter.P()(0,0);
+			}
+		}
+};
+
+/// partially observable initialization of an AHP landmark from a pixel and an inverse-distance prior
+class BenchInitialize: public BenchFilter {
+		mat G_rs, G_y, G_n;
+		sym_mat R, N;
+	public:
+		BenchInitialize(size_t _n_lmk): BenchFilter("ekf.initialize", _n_lmk),
+			G_rs(LMK_SIZE, ROB_SIZE), G_y(LMK_SIZE, 2), G_n(LMK_SIZE, 1), R(identity_mat(2)), N(1)
+		{
+			for (size_t i = 0; i < LMK_SIZE; ++i) {
+				for (size_t j = 0; j < ROB_SIZE; ++j) G_rs(i, j) = uniform(-1., 1.);
+				for (size_t j = 0; j < 2; ++j) G_y(i, j) = uniform(-0.01, 0.01);
+			}
+			G_n.clear(); G_n(6, 0) = 1.;
+			N(0,0) = 0.25;
+		}
+		void run(size_t n) {
+			for (size_t i = 0; i < n; ++i) {
+				filter.initialize(ia_x, G_rs, ia_rob, ia_lmk[i % n_lmk], G_y, R, G_n, N);
+				sink += filter.P()(0,0);
+			}
+		}
+};
+
+/// reparametrization of an AHP landmark to a Euclidean point, written over the next landmark
+class BenchReparametrize: public BenchFilter {
+		mat J_l;
+		std::vector<ind_array> ia_new;
+	public:
+		BenchReparametrize(size_t _n_lmk): BenchFilter("ekf.reparametrize", _n_lmk), J_l(3, LMK_SIZE), ia_new(_n_lmk) {
+			for (size_t i = 0; i < 3; ++i)
+				for (size_t j = 0; j < LMK_SIZE; ++j) J_l(i, j) = uniform(-1., 1.);
+			for (size_t l = 0; l < n_lmk; ++l) {
+				size_t next = ROB_SIZE + ((l + 1) % n_lmk) * LMK_SIZE;
+				ia_new[l] = ia_set(next, next + 3);
+			}
+		}
+		void run(size_t n) {
+			for (size_t i = 0; i < n; ++i) {
+				filter.reparametrize(ia_x, J_l, ia_lmk[i % n_lmk], ia_new[i % n_lmk]);
+				sink += filter.P()(0,0);
+			}
+		}
+};
+
+
+/**
+ * One synthetic frame: a prediction, then a stacked correction and single corrections of the landmarks
+ * of a window that moves along the map by one landmark every \a period frames.
+ * The covariances of the observed states are recovered before each correction,
+ * as the observations do when they are projected.
+ * This is not a replay of a recorded sequence: the map is a random covariance and the Jacobians are random.
+ */
+class BenchSlidingWindow: public Bench {
+		size_t n_lmk, period, frame;
+		boost::shared_ptr<ExtendedKalmanFilterIndirect> filter;
+		ind_array ia_x, ia_rob;
+		mat F_v, INN_rsl;
+		sym_mat Q, R;
+		Innovation inn;
+		static const size_t WINDOW = 8;
+	public:
+		BenchSlidingWindow(size_t _n_lmk, bool compressed, size_t _period):
+			Bench(compressed ? "cekf.synthetic_window" : "ekf.synthetic_window", ROB_SIZE + _n_lmk * LMK_SIZE), n_lmk(_n_lmk), period(_period), frame(0),
+			ia_x(ia_set(0, ROB_SIZE + _n_lmk * LMK_SIZE)), ia_rob(ia_set(0, ROB_SIZE)),
+			F_v(identity_mat(ROB_SIZE)), INN_rsl(2, ROB_SIZE + LMK_SIZE), Q(1e-6 * identity_mat(ROB_SIZE)), R(identity_mat(2)), inn(2)
+		{
+			if (compressed) filter.reset(new CompressedKalmanFilterIndirect(size));
+			else filter.reset(new ExtendedKalmanFilterIndirect(size));
+			for (size_t i = 0; i < size; ++i) filter->x()(i) = uniform(-1., 1.);
+			filter->P() = randomCovariance(size, 0.01);
+			for (size_t i = 0; i < 3; ++i) F_v(i, 7 + i) = 0.01;
+			for (size_t i = 0; i < 2; ++i)
+				for (size_t j = 0; j < ROB_SIZE + LMK_SIZE; ++j) INN_rsl(i, j) = uniform(-0.1, 0.1);
+			inn.x()(0) = 0.01; inn.x()(1) = -0.01;
+		}
+		void observe(size_t l, bool stack) {
+			size_t first = ROB_SIZE + l * LMK_SIZE;
+			ind_array ia_rsl = ia_union(ia_rob, ia_set(first, first + LMK_SIZE));
+			filter->recover(ia_rsl);
+			inn.P() = R + ublasExtra::prod_JPJt(filter->marginal(ia_rsl), INN_rsl);
+			if (stack) filter->stackCorrection(inn, INN_rsl, ia_rsl, R);
+			else filter->correct(ia_x, inn, INN_rsl, ia_rsl, R);
+		}
+		void run(size_t n) {
+			for (size_t i = 0; i < n; ++i, ++frame) {
+				size_t start = (frame / period) % (n_lmk - WINDOW);
+				filter->predict(ia_x, F_v, ia_rob, Q);
+				for (size_t l = 0; l < WINDOW / 2; ++l) observe(start + l, true);
+				filter->correctAllStacked(ia_x);
+				for (size_t l = WINDOW / 2; l < WINDOW; ++l) observe(start + l, false);
+				sink += filter->x()(0);
+			}
+		}
+};
+
+
+/** ############################################################################
+ * #############################################################################
+ * image processing
+ * ###########################################################################*/
+
+/**
+ * Synthetic gray image made of random overlapping rectangles on a noisy background,
+ * so that it has corners to detect and texture to match.
+ */
+static void fillSyntheticImage(image::Image & img)
+{
+	int w = img.width(), h = img.height(), step = img.step();
+	unsigned char *data = img.data();
+	for (int y = 0; y < h; ++y)
+		for (int x = 0; x < w; ++x)
+			data[y * step + x] = (unsigned char)(100 + std::rand() % 16);
+	for (int r = 0; r < 300; ++r)
+	{
+		int x0 = std::rand() % w, y0 = std::rand() % h;
+		int x1 = std::min(w, x0 + 5 + std::rand() % 60), y1 = std::min(h, y0 + 5 + std::rand() % 60);
+		unsigned char gray = (unsigned char)(std::rand() % 256);
+		for (int y = y0; y < y1; ++y)
+			for (int x = x0; x < x1; ++x)
+				data[y * step + x] = gray;
+	}
+}
+
+/// detection in a search region of std \a roi_std pixels (3 sigma), at random places of the image
+class BenchHarris: public Bench {
+		QuickHarrisDetector detector;
+		feat_img_pnt_ptr_t featPtr;
+	public:
+		image::Image img;
+		std::vector<vec> center;
+		sym_mat P;
+
+		BenchHarris(size_t roi_std): Bench("harris.detectIn", roi_std),
+			detector(5, 15., 2.), featPtr(new FeatureImagePoint(11, 11, CV_8U)),
+			img(IMG_WIDTH, IMG_HEIGHT, CV_8U, JfrImage_CS_GRAY), center(N_SAMPLES, vec(2)), P((double)(roi_std * roi_std) * identity_mat(2))
+		{
+			fillSyntheticImage(img);
+			double margin = 3. * roi_std + 10;
+			for (size_t i = 0; i < N_SAMPLES; ++i) {
+				center[i](0) = uniform(margin, IMG_WIDTH - margin);
+				center[i](1) = uniform(margin, IMG_HEIGHT - margin);
+			}
+		}
+		void run(size_t n) {
+			for (size_t i = 0; i < n; ++i) {
+				image::ConvexRoi roi(center[i & SAMPLE_MASK], P, 3.);
+				if (detector.detectIn(img, featPtr, &roi))
+					sink += featPtr->measurement.x()(0);
+			}
+		}
+};
+
+/// FAST detection on the same image and search regions as \a harris, scored with the FAST or the Harris score
+class BenchFast: public Bench {
+		const BenchHarris & harris;
+		FastDetector detector;
+		feat_img_pnt_ptr_t featPtr;
+	public:
+		BenchFast(const BenchHarris & _harris, int arc, bool harrisScore):
+			Bench(string(arc == 9 ? "fast9" : "fast12") + (harrisScore ? "_harris" : "") + ".detectIn", _harris.size),
+			harris(_harris), detector(arc, 20, harrisScore, 5, 15., 2.), featPtr(new FeatureImagePoint(11, 11, CV_8U)) {}
+		void run(size_t n) {
+			for (size_t i = 0; i < n; ++i) {
+				image::ConvexRoi roi(harris.center[i & SAMPLE_MASK], harris.P, 3.);
+				if (detector.detectIn(harris.img, featPtr, &roi))
+					sink += featPtr->measurement.x()(0);
+			}
+		}
+};
+
+/// detection of the best point of the whole image of \a harris, or of all the FAST corners
+class BenchDetectFrame: public Bench {
+		const BenchHarris & harris;
+		QuickHarrisDetector harrisDetector;
+		FastDetector fastDetector;
+		int arc;
+		feat_img_pnt_ptr_t featPtr;
+		std::vector<FastDetector::corner_t> corners;
+	public:
+		BenchDetectFrame(const BenchHarris & _harris, int _arc):
+			Bench(_arc == 0 ? "harris.detectIn_frame" : (_arc == 9 ? "fast9.detectAll_frame" : "fast12.detectAll_frame"), IMG_WIDTH),
+			harris(_harris), harrisDetector(5, 15., 2.), fastDetector(_arc == 0 ? 9 : _arc, 20), arc(_arc),
+			featPtr(new FeatureImagePoint(11, 11, CV_8U)) {}
+		void run(size_t n) {
+			for (size_t i = 0; i < n; ++i) {
+				if (arc == 0) {
+					if (harrisDetector.detectIn(harris.img, featPtr)) sink += featPtr->measurement.x()(0);
+				} else {
+					fastDetector.detectAll(harris.img, corners);
+					sink += corners.size();
+				}
+			}
+		}
+};
+
+/// matching of a patch in a search region of std \a roi_std pixels (3 sigma) around its true position
+class BenchZncc: public Bench {
+		image::Image img;
+		correl::FastTranslationMatcherZncc matcher;
+		std::vector<boost::shared_ptr<image::Image> > patch;
+		std::vector<vec> center;
+		sym_mat P;
+	public:
+		BenchZncc(size_t roi_std): Bench("zncc.match", roi_std),
+			img(IMG_WIDTH, IMG_HEIGHT, CV_8U, JfrImage_CS_GRAY), matcher(0.8, 0.5),
+			patch(N_SAMPLES), center(N_SAMPLES, vec(2)), P((double)(roi_std * roi_std) * identity_mat(2))
+		{
+			const int patch_size = 15;
+			fillSyntheticImage(img);
+			double margin = 3. * roi_std + patch_size;
+			for (size_t i = 0; i < N_SAMPLES; ++i) {
+				int x = (int)uniform(margin, IMG_WIDTH - margin), y = (int)uniform(margin, IMG_HEIGHT - margin);
+				patch[i].reset(new image::Image(patch_size, patch_size, CV_8U, JfrImage_CS_GRAY));
+				img.extractPatch(*patch[i], x, y, patch_size, patch_size);
+				// the prediction is off the true position by about one std
+				center[i](0) = x + 0.5 + uniform(-1., 1.) * roi_std;
+				center[i](1) = y + 0.5 + uniform(-1., 1.) * roi_std;
+			}
+		}
+		void run(size_t n) {
+			double x, y, std_x, std_y;
+			for (size_t i = 0; i < n; ++i) {
+				image::ConvexRoi roi(center[i & SAMPLE_MASK], P, 3.);
+				sink += matcher.match(*patch[i & SAMPLE_MASK], img, roi, x, y, std_x, std_y);
+				sink += x;
+			}
+		}
+};
+
+/// rendering of a simulated image of 100 landmarks, at a resolution of \a scale times the reference camera
+class BenchRender: public Bench {
+		boost::shared_ptr<simu::ImageRenderer> renderer;
+		image::Image img;
+		simu::ImageRenderer::PointList points;
+		vec7 pose;
+		unsigned frame;
+	public:
+		BenchRender(size_t scale): Bench("simu.render", scale * IMG_WIDTH),
+			img(scale * IMG_WIDTH, scale * IMG_HEIGHT, CV_8U, JfrImage_CS_GRAY), frame(0)
+		{
+			vec4 k;
+			k(0) = scale * IMG_WIDTH / 2.; k(1) = scale * IMG_HEIGHT / 2.; k(2) = k(3) = scale * 500.;
+			vec d(2); d(0) = -0.23; d(1) = 0.11;
+			renderer.reset(new simu::ImageRenderer(scale * IMG_WIDTH, scale * IMG_HEIGHT, k, d));
+			for (size_t i = 0; i < 100; ++i) {
+				vec3 p;
+				p(2) = uniform(3., 6.);
+				p(0) = p(2) * uniform(-0.55, 0.55);
+				p(1) = p(2) * uniform(-0.4, 0.4);
+				points[i] = p;
+			}
+			pose.clear(); pose(3) = 1.;
+		}
+		void run(size_t n) {
+			for (size_t i = 0; i < n; ++i) {
+				renderer->render(pose, points, frame++, img);
+				sink += renderer->groundTruth().size();
+			}
+		}
+};
+
+
+/** ############################################################################
+ * #############################################################################
+ * landmark churn
+ * ###########################################################################*/
+
+const size_t CHURN_BATCH = 20; ///< number of landmarks created before being deleted together
+
+/**
+ * Creation and deletion of a landmark with its observation and appearances, as done by the map manager:
+ * with the landmark factory and observation maker, that use the pools, or with plain new as before.
+ */
+class BenchChurn: public Bench {
+		map_ptr_t mapPtr;
+		robconstvel_ptr_t robPtr;
+		pinhole_ptr_t senPtr;
+		landmark_factory_ptr_t lmkFactory;
+		observation_maker_ptr_t obsMaker;
+		bool pooled;
+		std::vector<landmark_ptr_t> lmks;
+		std::vector<observation_ptr_t> obss;
+	public:
+		BenchChurn(bool _pooled): Bench(_pooled ? "churn.landmark_pooled" : "churn.landmark_new", CHURN_BATCH),
+			pooled(_pooled), lmks(CHURN_BATCH), obss(CHURN_BATCH)
+		{
+			mapPtr.reset(new MapAbstract(20 + CHURN_BATCH * LandmarkAnchoredHomogeneousPoint::size()));
+			robPtr.reset(new RobotConstantVelocity(mapPtr));
+			robPtr->linkToParentMap(mapPtr);
+			senPtr.reset(new SensorPinhole(robPtr, MapObject::UNFILTERED));
+			senPtr->linkToParentRobot(robPtr);
+			setupCamera(senPtr->params);
+			lmkFactory.reset(new LandmarkFactory<LandmarkAnchoredHomogeneousPoint, LandmarkEuclideanPoint>());
+			obsMaker.reset(new ImagePointObservationMaker<ObservationPinHoleAnchoredHomogeneousPoint, SensorPinhole, LandmarkAnchoredHomogeneousPoint,
+				AppearanceImagePoint, SensorAbstract::PINHOLE, LandmarkAbstract::PNT_AH>(0.5, 13));
+		}
+		void run(size_t n) {
+			for (size_t i = 0; i < n; ) {
+				size_t nb = std::min(CHURN_BATCH, n - i);
+				for (size_t j = 0; j < nb; ++j) {
+					if (pooled) {
+						lmks[j] = lmkFactory->createInit(mapPtr);
+						obss[j] = obsMaker->create(senPtr, lmks[j]);
+					} else {
+						lmks[j].reset(new LandmarkAnchoredHomogeneousPoint(mapPtr));
+						boost::shared_ptr<ObservationPinHoleAnchoredHomogeneousPoint> obsPtr(new ObservationPinHoleAnchoredHomogeneousPoint(senPtr, lmks[j]));
+						obsPtr->predictedAppearance.reset(new AppearanceImagePoint(13, 13, CV_8U));
+						obsPtr->observedAppearance.reset(new AppearanceImagePoint(13, 13, CV_8U));
+						obsPtr->setup(0.5);
+						obss[j] = obsPtr;
+					}
+					sink += lmks[j]->state.ia()(0);
+				}
+				for (size_t j = 0; j < nb; ++j) {
+					mapPtr->liberateStates(lmks[j]->state.ia());
+					obss[j].reset();
+					lmks[j].reset();
+				}
+				i += nb;
+			}
+		}
+};
+
+
+/** ############################################################################
+ * #############################################################################
+ * main
+ * ###########################################################################*/
+
+int main(int argc, char* const* argv)
+{
+	string output, label = "unnamed", filter;
+	double min_time = 0.2;
+	int repeats = 5;
+	for (int i = 1; i < argc; ++i)
+	{
+		string arg = argv[i];
+		if (i + 1 >= argc) { cerr << "missing value for option " << arg << endl; return 1; }
+		if (arg == "--output") output = argv[++i];
+		else if (arg == "--label") label = argv[++i];
+		else if (arg == "--min-time") min_time = atof(argv[++i]);
+		else if (arg == "--repeats") repeats = std::max(1, atoi(argv[++i]));
+		else if (arg == "--filter") filter = argv[++i];
+		else { cerr << "unknown option " << arg << endl; return 1; }
+	}
+
+	std::srand(1);
+	std::vector<boost::shared_ptr<Bench> > benches;
+	benches.push_back(boost::shared_ptr<Bench>(new BenchQProd()));
+	benches.push_back(boost::shared_ptr<Bench>(new BenchRotate()));
+	benches.push_back(boost::shared_ptr<Bench>(new BenchComposeFrames()));
+	benches.push_back(boost::shared_ptr<Bench>(new BenchE2q()));
+	benches.push_back(boost::shared_ptr<Bench>(new BenchV2q()));
+	benches.push_back(boost::shared_ptr<Bench>(new BenchProject()));
+	benches.push_back(boost::shared_ptr<Bench>(new BenchBackProject(false)));
+	benches.push_back(boost::shared_ptr<Bench>(new BenchBackProject(true)));
+	benches.push_back(boost::shared_ptr<Bench>(new BenchAhpToBearing()));
+	benches.push_back(boost::shared_ptr<Bench>(new BenchAhpFromBearing()));
+	benches.push_back(boost::shared_ptr<Bench>(new BenchAhplToBearing()));
+	benches.push_back(boost::shared_ptr<Bench>(new BenchAhplFromBearing()));
+	benches.push_back(boost::shared_ptr<Bench>(new BenchInvertCov(2)));
+	benches.push_back(boost::shared_ptr<Bench>(new BenchInvertCov(4)));
+	const size_t map_sizes[] = { 10, 50, 100, 200 }; // number of landmarks
+	for (size_t m = 0; m < sizeof(map_sizes)/sizeof(size_t); ++m)
+	{
+		benches.push_back(boost::shared_ptr<Bench>(new BenchPredict(map_sizes[m], false)));
+		benches.push_back(boost::shared_ptr<Bench>(new BenchPredict(map_sizes[m], true)));
+		benches.push_back(boost::shared_ptr<Bench>(new BenchCorrect(map_sizes[m])));
+		benches.push_back(boost::shared_ptr<Bench>(new BenchInitialize(map_sizes[m])));
+		benches.push_back(boost::shared_ptr<Bench>(new BenchReparametrize(map_sizes[m])));
+		benches.push_back(boost::shared_ptr<Bench>(new BenchSlidingWindow(map_sizes[m], false, 16)));
+		benches.push_back(boost::shared_ptr<Bench>(new BenchSlidingWindow(map_sizes[m], true, 16)));
+	}
+	const size_t roi_stds[] = { 5, 15 }; // search region std in pixels
+	for (size_t r = 0; r < sizeof(roi_stds)/sizeof(size_t); ++r)
+	{
+		boost::shared_ptr<BenchHarris> harris(new BenchHarris(roi_stds[r]));
+		benches.push_back(harris);
+		benches.push_back(boost::shared_ptr<Bench>(new BenchFast(*harris, 9, false)));
+		benches.push_back(boost::shared_ptr<Bench>(new BenchFast(*harris, 9, true)));
+		benches.push_back(boost::shared_ptr<Bench>(new BenchFast(*harris, 12, false)));
+		benches.push_back(boost::shared_ptr<Bench>(new BenchZncc(roi_stds[r])));
+		if (r == 0)
+		{
+			benches.push_back(boost::shared_ptr<Bench>(new BenchDetectFrame(*harris, 0)));
+			benches.push_back(boost::shared_ptr<Bench>(new BenchDetectFrame(*harris, 9)));
+			benches.push_back(boost::shared_ptr<Bench>(new BenchDetectFrame(*harris, 12)));
+		}
+	}
+	benches.push_back(boost::shared_ptr<Bench>(new BenchRender(1)));
+	benches.push_back(boost::shared_ptr<Bench>(new BenchRender(2)));
+	benches.push_back(boost::shared_ptr<Bench>(new BenchChurn(false)));
+	benches.push_back(boost::shared_ptr<Bench>(new BenchChurn(true)));
+
+	std::vector<BenchResult> results;
+	double sink = 0.;
+	for (size_t b = 0; b < benches.size(); ++b)
+	{
+		Bench & bench = *benches[b];
+		if (!filter.empty() && bench.name.find(filter) == string::npos) continue;
+		BenchResult res = measure(bench, min_time, repeats);
+		results.push_back(res);
+		sink += bench.sink;
+		cout << res.name;
+		if (res.size) cout << " [" << res.size << "]";
+		cout << ": " << res.ns_per_op << " ns (min " << res.ns_min << ", " << res.iterations << " iterations, " << res.allocs_per_op << " allocs)" << endl;
+	}
+
+	writeJson(cout, label, repeats, min_time, results);
+	if (!output.empty())
+	{
+		ofstream file(output.c_str());
+		if (!file) { cerr << "cannot write " << output << endl; return 1; }
+		writeJson(file, label, repeats, min_time, results);
+	}
+	// print the sink so that no benchmark can be optimized away
+	cerr << "checksum " << sink << endl;
+	return 0;
+}
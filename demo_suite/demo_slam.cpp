@@ -108,6 +108,16 @@
 	#endif
 #endif
 
+/*
+ * STATUS: experimental, off by default
+ * The point landmarks initialized from the same sensor at the same filter
+ * estimate share a single anchor state in the map, instead of one anchor each.
+ * This saves 3 states per landmark but the first landmark of the group
+ * initializes the anchor, so it is only useful with several landmarks
+ * initialized per frame.
+ */
+#define SHARED_ANCHOR 0
+
 
 /** ############################################################################
  * #############################################################################
@@ -143,6 +153,7 @@
 #include "rtslam/sensorAbsloc.hpp"
 #include "rtslam/landmarkAnchoredHomogeneousPoint.hpp"
 #include "rtslam/landmarkAnchoredHomogeneousPointsLine.hpp"
+#include "rtslam/landmarkSharedAnchorHomogeneousPoint.hpp"
 //#include "rtslam/landmarkEuclideanPoint.hpp"
 #include "rtslam/observationFactory.hpp"
 #include "rtslam/observationMakers.hpp"
@@ -169,6 +180,9 @@
 #include "rtslam/hardwareSensorAdhocSimulator.hpp"
 #include "rtslam/hardwareEstimatorInertialAdhocSimulator.hpp"
 #include "rtslam/exporterSocket.hpp"
+#include "rtslam/posePredictor.hpp"
+#include "rtslam/informationFilter.hpp"
+#include "rtslam/compressedFilter.hpp"
 
 
 /** ############################################################################
@@ -193,7 +207,8 @@ typedef ImagePointObservationMaker<ObservationPinHoleAnchoredHomogeneousPoint, S
 typedef ImagePointObservationMaker<ObservationPinHoleAnchoredHomogeneousPoint, SensorPinhole, LandmarkAnchoredHomogeneousPoint,
 	simu::AppearanceSimu, SensorAbstract::PINHOLE, LandmarkAbstract::PNT_AH> PinholeAhpSimuObservationMaker;
 
-typedef DataManagerOnePointRansac<RawImage, SensorPinhole, FeatureImagePoint, image::ConvexRoi, ActiveSearchGrid, ImagePointHarrisDetector, ImagePointZnccMatcher> DataManager_ImagePoint_Ransac;
+typedef DataManagerOnePointRansac<RawImage, SensorPinhole, FeatureImagePoint, image::ConvexRoi, ActiveSearchGrid, ImagePointHarrisDetector, ImagePointLkMatcher> DataManager_ImagePoint_Ransac;
+typedef DataManagerOnePointRansac<RawImage, SensorPinhole, FeatureImagePoint, image::ConvexRoi, ActiveSearchGrid, ImagePointFastDetector, ImagePointLkMatcher> DataManager_ImagePoint_Ransac_Fast;
 typedef DataManagerOnePointRansac<simu::RawSimu, SensorPinhole, simu::FeatureSimu, image::ConvexRoi, ActiveSearchGrid, simu::DetectorSimu<image::ConvexRoi>, simu::MatcherSimu<image::ConvexRoi> > DataManager_ImagePoint_Ransac_Simu;
 
 #if SEGMENT_BASED
@@ -215,7 +230,7 @@ time_t rseed;
  * program parameters
  * ###########################################################################*/
 
-enum { iDispQt = 0, iDispGdhe, iRenderAll, iReplay, iDump, iRandSeed, iPause, iVerbose, iMap, iRobot, iCamera, iTrigger, iGps, iSimu, iExport, nIntOpts };
+enum { iDispQt = 0, iDispGdhe, iRenderAll, iReplay, iDump, iRandSeed, iPause, iVerbose, iMap, iRobot, iCamera, iTrigger, iGps, iSimu, iExport, iSimuRender, iPredict, nIntOpts };
 int intOpts[nIntOpts] = {0};
 const int nFirstIntOpt = 0, nLastIntOpt = nIntOpts-1;
 
@@ -251,6 +266,8 @@ struct option long_options[] = {
 	{"gps", 2, 0, 0},
 	{"simu", 2, 0, 0},
 	{"export", 2, 0, 0},
+	{"simu-render", 2, 0, 0},
+	{"predict", 2, 0, 0},
 	// double options
 	{"freq", 2, 0, 0}, // should be in config file
 	{"shutter", 2, 0, 0}, // should be in config file
@@ -326,6 +343,8 @@ class ConfigSetup: public kernel::KeyValueFileSaveLoad
 	
 	double IMU_TIMESTAMP_CORRECTION; /// correction to add to the IMU timestamp for synchronization (s)
 	double GPS_TIMESTAMP_CORRECTION; /// correction to add to the GPS timestamp for synchronization (s)
+	double GPS_MAX_DELAY; /// maximum delay of GPS data applied as out-of-sequence measurements, 0 to wait for them instead (s)
+	double GPS_CLONE_PERIOD; /// minimum time between two clones of the robot pose kept for the delayed GPS data, typically the GPS period (s)
 	
 	/// Odometry noise variance to distance ratios
 	double dxNDR;   /// Odometry noise in position increment (m per sqrt(m))
@@ -363,6 +382,9 @@ class ConfigEstimation: public kernel::KeyValueFileSaveLoad
 
 	/// FILTER
 	unsigned MAP_SIZE; /// map size in # of states, robot + landmarks
+	unsigned FILTER_INFO_ACTIVE; /// 0 for the Kalman filter, or the number of landmarks linked to the robot in the sparse information filter
+	unsigned FILTER_LOCAL_SIZE; /// 0 for the Kalman filter, or the max number of states of the active region of the compressed Kalman filter
+	unsigned FILTER_CONSIDER_PERIOD; /// 0 to estimate the calibration states (biases, gravity, sensor poses) at each frame, or N to only estimate them every N frames and consider them (Schmidt-Kalman) in between
 	double PIX_NOISE;  /// measurement noise of a point
 	double PIX_NOISE_SIMUFACTOR;
 
@@ -382,13 +404,27 @@ class ConfigEstimation: public kernel::KeyValueFileSaveLoad
 	unsigned N_INIT;           /// maximum number of landmarks to try to initialize every frame
 	unsigned N_RECOMP_GAINS;   /// how many times information gain is recomputed to resort observations in active search
 	double RANSAC_LOW_INNOV;   /// ransac low innovation threshold (pixels)
+	unsigned CANDIDATE_FRAMES; /// number of frames new points are tracked before being initialized in the map, 0 to initialize them at detection
+	double CANDIDATE_SEARCH;   /// search radius to track the new points (pixels)
+	unsigned OBS_RECLAIM_FRAMES; /// number of frames an observation is not visible before being deleted until the landmark is visible again, 0 to keep them
+	bool GYRO_AID;             /// with the constant velocity robot, predict the search regions of the points with the gyrometers of the IMU
 
 	unsigned RANSAC_NTRIES;    /// number of base observation used to initialize a ransac set
+	double RANSAC_CONFIDENCE;  /// stop the ransac when the probability to have found an inlier set is above this (0 to always do RANSAC_NTRIES)
+	unsigned RANSAC_STRATA;    /// take the base observations in different cells of a RANSAC_STRATA x RANSAC_STRATA grid of the image
+	unsigned RANSAC_MAX_POINTS; /// max number of base observations of a ransac set, when 1-point sets fail
+	double RANSAC_MIN_RATIO;   /// inlier ratio under which the ransac sets take one more base observation
+
+	double EVICT_UTILITY_TH;   /// with the global map manager, when the map is full delete the landmarks with a utility under this for new ones (0 to never do it)
+	double EVICT_DIST_REF;     /// distance at which the utility of a point is halved (0 to ignore the distance)
 
 	/// RAW PROCESSING
 	unsigned HARRIS_CONV_SIZE;
 	double HARRIS_TH;
 	double HARRIS_EDDGE;
+	unsigned FAST_ARC;         /// 0 to detect the points with the Harris detector, or 9 or 12 to use the FAST-9 or FAST-12 detector
+	unsigned FAST_TH;          /// FAST intensity threshold
+	bool FAST_HARRIS_SCORE;    /// score the FAST corners with the Harris score (HARRIS_* parameters) instead of the FAST score
 
 	unsigned DESC_SIZE;     /// descriptor patch size (odd value)
 	bool MULTIVIEW_DESCRIPTOR; /// whether use or not the multiview descriptor
@@ -402,6 +438,9 @@ class ConfigEstimation: public kernel::KeyValueFileSaveLoad
 	double MATCH_TH;           /// ZNCC score threshold
 	double MIN_SCORE;          /// min ZNCC score under which we don't finish to compute the value of the score
 	double PARTIAL_POSITION;   /// position in the patch where we test if we finish the correlation computation
+	unsigned LK_DIRECT_SIZE;   /// search areas smaller than this # of pixels in both directions are tracked by Lucas-Kanade without correlation
+	unsigned LK_ITER;          /// max number of Lucas-Kanade iterations to refine the matches (0 to disable)
+	unsigned SPIRAL_RINGS;     /// number of rings to search from the expectation to the border, stopping at the first good match (0 to search the whole area)
 	
  public:
 	virtual void loadKeyValueFile(jafar::kernel::KeyValueFile const& keyValueFile);
@@ -419,6 +458,7 @@ world_ptr_t worldPtr;
 boost::scoped_ptr<kernel::DataLogger> dataLogger;
 sensor_manager_ptr_t sensorManager;
 boost::shared_ptr<ExporterAbstract> exporter;
+pose_predictor_ptr_t posePredictor;
 #ifdef HAVE_MODULE_QDISPLAY
 display::ViewerQt *viewerQt = NULL;
 #endif
@@ -428,6 +468,50 @@ display::ViewerGdhe *viewerGdhe = NULL;
 kernel::VariableCondition<int> rawdata_condition(0);
 
 
+/**
+ * Print the matching statistics of a point data manager
+ */
+template<class DataManagerSpec>
+void printMatchStats(const data_manager_ptr_t & dmaPtr)
+{
+	boost::shared_ptr<DataManagerSpec> dmPtr = boost::dynamic_pointer_cast<DataManagerSpec>(dmaPtr);
+	if (!dmPtr || dmPtr->matchStats.nSearch == 0) return;
+	std::cout << "matching: " << dmPtr->matchStats.nSearch << " searches"
+		<< ", match rate " << dmPtr->matchStats.nMatch / (double)dmPtr->matchStats.nSearch
+		<< ", " << dmPtr->matchStats.matchTime * 1e6 / dmPtr->matchStats.nSearch << " us per search"
+		<< ", " << dmPtr->matchStats.nGyroRoi << " regions from the gyrometers" << std::endl;
+	std::cout << "ransac: " << dmPtr->matchStats.nRansacSets << " hypotheses"
+		<< ", " << dmPtr->matchStats.nRansacEscalations << " escalations to more base observations" << std::endl;
+}
+
+template<class DataManagerSpec>
+void printSearchStats(const data_manager_ptr_t & dmaPtr)
+{
+	boost::shared_ptr<DataManagerSpec> dmPtr = boost::dynamic_pointer_cast<DataManagerSpec>(dmaPtr);
+	if (!dmPtr || dmPtr->getMatcher()->searchStats().nSearch == 0) return;
+	const ZnccSpiralSearch::search_stats_t & stats = dmPtr->getMatcher()->searchStats();
+	std::cout << "correlation: " << stats.nSearch << " searches"
+		<< ", " << stats.nPositions / (double)stats.nSearch << " positions per search"
+		<< ", " << stats.nEarly << " stopped early" << std::endl;
+}
+
+/// the data manager of the image points of a camera, with the given detector
+template<class DetectorSpec>
+void createImagePointDataManager(const boost::shared_ptr<DetectorSpec> & detector, const boost::shared_ptr<ImagePointLkMatcher> & matcher,
+	const boost::shared_ptr<ActiveSearchGrid> & asGrid, int ransac_ntries, const pinhole_ptr_t & senPtr, const map_manager_ptr_t & mmPoint,
+	const boost::shared_ptr<ObservationFactory> & obsFact, const hardware::hardware_estimator_ptr_t & gyroEst)
+{
+	typedef DataManagerOnePointRansac<RawImage, SensorPinhole, FeatureImagePoint, image::ConvexRoi, ActiveSearchGrid, DetectorSpec, ImagePointLkMatcher> DataManagerSpec;
+	boost::shared_ptr<DataManagerSpec> dmPt(new DataManagerSpec(detector, matcher, asGrid, configEstimation.N_UPDATES_TOTAL, configEstimation.N_UPDATES_RANSAC, ransac_ntries, configEstimation.N_INIT, configEstimation.N_RECOMP_GAINS));
+
+	dmPt->linkToParentSensorSpec(senPtr);
+	dmPt->linkToParentMapManager(mmPoint);
+	dmPt->setObservationFactory(obsFact);
+	dmPt->setCandidateTracking(configEstimation.CANDIDATE_FRAMES, configEstimation.CANDIDATE_SEARCH);
+	dmPt->setAdaptiveRansac(configEstimation.RANSAC_CONFIDENCE, configEstimation.RANSAC_STRATA, configEstimation.RANSAC_MAX_POINTS, configEstimation.RANSAC_MIN_RATIO);
+	if (gyroEst) dmPt->setGyroAid(gyroEst, 4, configSetup.GYRO_NOISE, configSetup.UNCERT_WBIAS*configSetup.GYRO_FULLSCALE);
+}
+
 void demo_slam_init()
 { try {
 	// preprocess options
@@ -441,7 +525,7 @@ void demo_slam_init()
 		else
 			strOpts[sConfigSetup] = "data/setup.cfg";
 	}
-	if (intOpts[iReplay] & 1) intOpts[iExport] = 0;
+	if (intOpts[iReplay] & 1) { intOpts[iExport] = 0; intOpts[iPredict] = 0; }
 	if (strOpts[sConfigSetup][0] == '@' && strOpts[sConfigSetup][1] == '/')
 		strOpts[sConfigSetup] = strOpts[sDataPath] + strOpts[sConfigSetup].substr(1);
 	if (strOpts[sConfigEstimation][0] == '@' && strOpts[sConfigEstimation][1] == '/')
@@ -566,7 +650,7 @@ void demo_slam_init()
 	// pin-hole parameters in BOOST format
 	boost::shared_ptr<ObservationFactory> obsFact(new ObservationFactory());
 #if SEGMENT_BASED
-	if (intOpts[iSimu] != 0)
+	if (intOpts[iSimu] != 0 && !intOpts[iSimuRender])
 	{
 		obsFact->addMaker(boost::shared_ptr<ObservationMakerAbstract>(new PinholeAhplSimuObservationMaker(
 			configEstimation.REPARAM_TH, configEstimation.KILL_SEARCH_SIZE, 30, 0.5, 0.5, configEstimation.D_MIN, configEstimation.PATCH_SIZE)));
@@ -577,7 +661,7 @@ void demo_slam_init()
 	}
 #endif
 #if SEGMENT_BASED != 1
-	if (intOpts[iSimu] != 0)
+	if (intOpts[iSimu] != 0 && !intOpts[iSimuRender])
 	{
 		obsFact->addMaker(boost::shared_ptr<ObservationMakerAbstract>(new PinholeEucpSimuObservationMaker(
 		  configEstimation.D_MIN, configEstimation.PATCH_SIZE)));
@@ -598,7 +682,13 @@ void demo_slam_init()
 	// INIT : 1 map and map-manager, 2 robs, 3 sens and data-manager.
 
 	// 1. Create maps.
-	map_ptr_t mapPtr(new MapAbstract(configEstimation.MAP_SIZE));
+	map_ptr_t mapPtr;
+	if (configEstimation.FILTER_INFO_ACTIVE > 0)
+		mapPtr.reset(new MapAbstract(ekfInd_ptr_t(new SparseInformationFilterIndirect(configEstimation.MAP_SIZE, configEstimation.FILTER_INFO_ACTIVE))));
+	else if (configEstimation.FILTER_LOCAL_SIZE > 0)
+		mapPtr.reset(new MapAbstract(ekfInd_ptr_t(new CompressedKalmanFilterIndirect(configEstimation.MAP_SIZE, configEstimation.FILTER_LOCAL_SIZE))));
+	else
+		mapPtr.reset(new MapAbstract(configEstimation.MAP_SIZE));
 	mapPtr->linkToParentWorld(worldPtr);
 	
    // 1b. Create map manager.
@@ -608,7 +698,11 @@ void demo_slam_init()
    segLmkFactory.reset(new LandmarkFactory<LandmarkAnchoredHomogeneousPointsLine, LandmarkAnchoredHomogeneousPointsLine>());
 #endif
 #if SEGMENT_BASED != 1
+#if SHARED_ANCHOR
+   pointLmkFactory.reset(new LandmarkFactorySharedAnchor<LandmarkEuclideanPoint>());
+#else
    pointLmkFactory.reset(new LandmarkFactory<LandmarkAnchoredHomogeneousPoint, LandmarkEuclideanPoint>());
+#endif
 #endif
 	map_manager_ptr_t mmPoint;
 	map_manager_ptr_t mmSeg;
@@ -623,9 +717,17 @@ void demo_slam_init()
 		}
 		case 1: { // global
 			if(pointLmkFactory != NULL)
-				mmPoint.reset(new MapManagerGlobal(pointLmkFactory, configEstimation.REPARAM_TH, configEstimation.KILL_SEARCH_SIZE, 30, 0.5, 0.5));
+			{
+				boost::shared_ptr<MapManagerGlobal> mmGlobal(new MapManagerGlobal(pointLmkFactory, configEstimation.REPARAM_TH, configEstimation.KILL_SEARCH_SIZE, 30, 0.5, 0.5));
+				mmGlobal->setEviction(configEstimation.EVICT_UTILITY_TH, configEstimation.EVICT_DIST_REF);
+				mmPoint = mmGlobal;
+			}
 			if(segLmkFactory != NULL)
-				mmSeg.reset(new MapManagerGlobal(segLmkFactory, configEstimation.REPARAM_TH, configEstimation.KILL_SEARCH_SIZE, 30, 0.5, 0.5));
+			{
+				boost::shared_ptr<MapManagerGlobal> mmGlobal(new MapManagerGlobal(segLmkFactory, configEstimation.REPARAM_TH, configEstimation.KILL_SEARCH_SIZE, 30, 0.5, 0.5));
+				mmGlobal->setEviction(configEstimation.EVICT_UTILITY_TH, 0.);
+				mmSeg = mmGlobal;
+			}
 			break;
 		}
 		case 2: { // local/multimap
@@ -637,9 +739,15 @@ void demo_slam_init()
 		}
 	}
 	if(mmPoint != NULL)
+	{
 		mmPoint->linkToParentMap(mapPtr);
+		mmPoint->setObservationReclaim(configEstimation.OBS_RECLAIM_FRAMES);
+	}
 	if(mmSeg != NULL)
+	{
 		mmSeg->linkToParentMap(mapPtr);
+		mmSeg->setObservationReclaim(configEstimation.OBS_RECLAIM_FRAMES);
+	}
 
 	// simulation environment
 	boost::shared_ptr<simu::AdhocSimulator> simulator;
@@ -752,6 +860,7 @@ void demo_slam_init()
 
 	// 2. Create robots.
 	robot_ptr_t robPtr1;
+	hardware::hardware_estimator_ptr_t gyroEst; // gyrometers to predict the search regions, with the constant velocity robot
 	if (intOpts[iRobot] == 0) // constant velocity
 	{
 		robconstvel_ptr_t robPtr1_(new RobotConstantVelocity(mapPtr));
@@ -767,6 +876,24 @@ void demo_slam_init()
 
 		robPtr1 = robPtr1_;
 		
+		if (configEstimation.GYRO_AID)
+		{
+			if (intOpts[iSimu] != 0)
+			{
+				boost::shared_ptr<hardware::HardwareEstimatorInertialAdhocSimulator> gyroEst_(
+					new hardware::HardwareEstimatorInertialAdhocSimulator(configSetup.SIMU_IMU_FREQ, 50, simulator, robPtr1_->id()));
+				gyroEst_->setSyncConfig(configSetup.SIMU_IMU_TIMESTAMP_CORRECTION);
+				gyroEst = gyroEst_;
+			} else
+			{
+				boost::shared_ptr<hardware::HardwareEstimatorMti> gyroEst_(new hardware::HardwareEstimatorMti(
+					configSetup.MTI_DEVICE, intOpts[iTrigger], floatOpts[fFreq], floatOpts[fShutter], 1024, mode, strOpts[sDataPath]));
+				if (intOpts[iTrigger] != 0) floatOpts[fFreq] = gyroEst_->getFreq();
+				gyroEst_->setSyncConfig(configSetup.IMU_TIMESTAMP_CORRECTION);
+				gyroEst = gyroEst_;
+			}
+			gyroEst->start();
+		} else
 		if (intOpts[iTrigger] != 0)
 		{
 			// just to initialize the MTI as an external trigger controlling shutter time
@@ -1005,7 +1132,7 @@ void demo_slam_init()
 		int ransac_ntries = 0;
 		 #endif
 
-		if (intOpts[iSimu] != 0)
+		if (intOpts[iSimu] != 0 && !intOpts[iSimuRender])
 		{
 			#if SEGMENT_BASED
 				boost::shared_ptr<simu::DetectorSimu<image::ConvexRoi> > detector(new simu::DetectorSimu<image::ConvexRoi>(LandmarkAbstract::LINE, 4, configEstimation.PATCH_SIZE, configEstimation.PIX_NOISE, configEstimation.PIX_NOISE*configEstimation.PIX_NOISE_SIMUFACTOR));
@@ -1028,6 +1155,9 @@ void demo_slam_init()
 				dmPt11->linkToParentSensorSpec(senPtr11);
 				dmPt11->linkToParentMapManager(mmPoint);
 				dmPt11->setObservationFactory(obsFact);
+				dmPt11->setCandidateTracking(configEstimation.CANDIDATE_FRAMES, configEstimation.CANDIDATE_SEARCH);
+				dmPt11->setAdaptiveRansac(configEstimation.RANSAC_CONFIDENCE, configEstimation.RANSAC_STRATA, configEstimation.RANSAC_MAX_POINTS, configEstimation.RANSAC_MIN_RATIO);
+				if (gyroEst) dmPt11->setGyroAid(gyroEst, 4, configSetup.GYRO_NOISE, configSetup.UNCERT_WBIAS*configSetup.GYRO_FULLSCALE);
 
 				hardware::hardware_sensorext_ptr_t hardSen11(new hardware::HardwareSensorAdhocSimulator(rawdata_condition, floatOpts[fFreq], simulator, robPtr1->id(), senPtr11->id()));
 				senPtr11->setHardwareSensor(hardSen11);
@@ -1057,17 +1187,26 @@ void demo_slam_init()
 					 else
 							pointDescFactory.reset(new DescriptorImagePointFirstViewFactory(configEstimation.DESC_SIZE));
 
-					 boost::shared_ptr<ImagePointHarrisDetector> harrisDetector(new ImagePointHarrisDetector(configEstimation.HARRIS_CONV_SIZE, configEstimation.HARRIS_TH, configEstimation.HARRIS_EDDGE, configEstimation.PATCH_SIZE, configEstimation.PIX_NOISE, pointDescFactory));
-					 boost::shared_ptr<ImagePointZnccMatcher> znccMatcher(new ImagePointZnccMatcher(configEstimation.MIN_SCORE, configEstimation.PARTIAL_POSITION, configEstimation.PATCH_SIZE, configEstimation.MAX_SEARCH_SIZE, configEstimation.RANSAC_LOW_INNOV, configEstimation.MATCH_TH, configEstimation.MAHALANOBIS_TH, configEstimation.RELEVANCE_TH, configEstimation.PIX_NOISE));
-
-					 boost::shared_ptr<DataManager_ImagePoint_Ransac> dmPt11(new DataManager_ImagePoint_Ransac(harrisDetector, znccMatcher, asGrid, configEstimation.N_UPDATES_TOTAL, configEstimation.N_UPDATES_RANSAC, ransac_ntries, configEstimation.N_INIT, configEstimation.N_RECOMP_GAINS));
-
-					 dmPt11->linkToParentSensorSpec(senPtr11);
-					 dmPt11->linkToParentMapManager(mmPoint);
-					 dmPt11->setObservationFactory(obsFact);
+					 boost::shared_ptr<ImagePointLkMatcher> znccMatcher(new ImagePointLkMatcher(configEstimation.MIN_SCORE, configEstimation.PARTIAL_POSITION, configEstimation.PATCH_SIZE, configEstimation.MAX_SEARCH_SIZE, configEstimation.RANSAC_LOW_INNOV, configEstimation.MATCH_TH, configEstimation.MAHALANOBIS_TH, configEstimation.RELEVANCE_TH, configEstimation.PIX_NOISE, configEstimation.LK_DIRECT_SIZE, configEstimation.LK_ITER, configEstimation.SPIRAL_RINGS));
+
+					 if (configEstimation.FAST_ARC > 0)
+					 {
+						 boost::shared_ptr<ImagePointFastDetector> fastDetector(new ImagePointFastDetector(configEstimation.FAST_ARC, configEstimation.FAST_TH, configEstimation.FAST_HARRIS_SCORE, configEstimation.HARRIS_CONV_SIZE, configEstimation.HARRIS_TH, configEstimation.HARRIS_EDDGE, configEstimation.PATCH_SIZE, configEstimation.PIX_NOISE, pointDescFactory));
+						 createImagePointDataManager(fastDetector, znccMatcher, asGrid, ransac_ntries, senPtr11, mmPoint, obsFact, gyroEst);
+					 } else
+					 {
+						 boost::shared_ptr<ImagePointHarrisDetector> harrisDetector(new ImagePointHarrisDetector(configEstimation.HARRIS_CONV_SIZE, configEstimation.HARRIS_TH, configEstimation.HARRIS_EDDGE, configEstimation.PATCH_SIZE, configEstimation.PIX_NOISE, pointDescFactory));
+						 createImagePointDataManager(harrisDetector, znccMatcher, asGrid, ransac_ntries, senPtr11, mmPoint, obsFact, gyroEst);
+					 }
 				#endif
 
-			if (configSetup.CAMERA_TYPE == 0 || configSetup.CAMERA_TYPE == 1)
+			if (intOpts[iSimu] != 0)
+			{ // simulation with rendered images
+				boost::shared_ptr<simu::ImageRenderer> renderer(new simu::ImageRenderer(img_width, img_height, intrinsic, distortion));
+				boost::shared_ptr<hardware::HardwareSensorAdhocSimulator> hardSen11(new hardware::HardwareSensorAdhocSimulator(rawdata_condition, floatOpts[fFreq], simulator, robPtr1->id(), senPtr11->id()));
+				hardSen11->setImageRenderer(renderer);
+				senPtr11->setHardwareSensor(hardSen11);
+			} else if (configSetup.CAMERA_TYPE == 0 || configSetup.CAMERA_TYPE == 1)
 			{ // VIAM
 				#ifdef HAVE_VIAM
 				viam_hwcrop_t crop;
@@ -1111,7 +1250,7 @@ void demo_slam_init()
 
 			senPtr11->setIntegrationPolicy(false);
 			senPtr11->setUseForInit(false);
-			senPtr11->setNeedInit(true); // for auto exposure
+			senPtr11->setNeedInit(intOpts[iSimu] == 0); // for auto exposure
 
 		}
 	} // if (intOpts[iCamera])
@@ -1142,9 +1281,17 @@ void demo_slam_init()
 		senPtr13->setNeedInit(init);
 		senPtr13->setPose(configSetup.GPS_POSE[0], configSetup.GPS_POSE[1], configSetup.GPS_POSE[2],
 											configSetup.GPS_POSE[3], configSetup.GPS_POSE[4], configSetup.GPS_POSE[5]); // x,y,z,roll,pitch,yaw
+		if (intOpts[iReplay] != 1) senPtr13->setMaxDelay(configSetup.GPS_MAX_DELAY, configSetup.GPS_CLONE_PERIOD);
 		//hardGps->start();
 	}
 	
+	if (configEstimation.FILTER_CONSIDER_PERIOD > 0)
+	{
+		mapPtr->filterPtr->setConsider(robPtr1->calibrationStates());
+		for (RobotAbstract::SensorList::iterator senIter = robPtr1->sensorList().begin(); senIter != robPtr1->sensorList().end(); ++senIter)
+			mapPtr->filterPtr->setConsider((*senIter)->calibrationStates());
+	}
+
 	if (intOpts[iReplay] == 1)
 		sensorManager.reset(new SensorManagerReplay(mapPtr));
 	else
@@ -1186,6 +1333,12 @@ void demo_slam_init()
 		case 2: exporter.reset(new ExporterPoster(robPtr1)); break;
 	}
 
+	if (intOpts[iPredict] && robPtr1->hardwareEstimatorPtr)
+	{
+		posePredictor.reset(new PosePredictor(robPtr1));
+		if (exporter) posePredictor->setListener(boost::bind(&ExporterAbstract::exportState, exporter.get(), _1, _2, _3));
+	}
+
 } catch (kernel::Exception &e) { std::cout << e.what(); throw e; } } // demo_slam_init
 
 
@@ -1297,13 +1450,19 @@ int n_innovation = 0;
 				
 				robot_ptr_t robPtr = pinfo.sen->robotPtr();
 //std::cout << "Frame " << (*world)->t << " using sen " << pinfo.sen->id() << " at time " << std::setprecision(16) << newt << std::endl;
-				if (intOpts[iRobot] == 2) robPtr->move(robPtr->control, newt);
-				else robPtr->move(newt);
+				// out-of-sequence data is applied to the past state, without moving the robot back
+				if (!pinfo.sen->handlesDelayedData() || newt >= robPtr->self_time)
+				{
+					if (intOpts[iRobot] == 2) robPtr->move(robPtr->control, newt);
+					else robPtr->move(newt);
+				}
 				
 				JFR_DEBUG("Robot " << robPtr->id() << " state after move " << robPtr->state.x() << " ; euler " << quaternion::q2e(ublas::subrange(robPtr->state.x(), 3, 7)));
 				JFR_DEBUG("Robot state stdev after move " << stdevFromCov(robPtr->state.P()));
 				robot_prediction = robPtr->state.x();
 				
+				if (configEstimation.FILTER_CONSIDER_PERIOD > 0)
+					robPtr->mapPtr()->filterPtr->estimateConsidered((*world)->t % configEstimation.FILTER_CONSIDER_PERIOD == 0);
 				pinfo.sen->process(pinfo.id);
 				
 				JFR_DEBUG("Robot state after corrections of sensor " << pinfo.sen->id() << " : " << robPtr->state.x() << " ; euler " << quaternion::q2e(ublas::subrange(robPtr->state.x(), 3, 7)));
@@ -1311,7 +1470,10 @@ int n_innovation = 0;
 				average_robot_innovation += ublas::norm_2(robPtr->state.x() - robot_prediction);
 				n_innovation++;
 				
-				if (exporter) exporter->exportCurrentState();
+				// robot marginals for the exporters, after the last correction of the frame
+				if (posePredictor || exporter) robPtr->mapPtr()->marginals.update(*robPtr->mapPtr(), false);
+				if (posePredictor) posePredictor->correct(); // exports the filtered state, and the next predicted ones
+				else if (exporter) exporter->exportCurrentState();
 #ifdef GENOM // export genom
 				jblas::vec euler_x(3);
 				jblas::sym_mat euler_P(3,3);
@@ -1360,6 +1522,10 @@ int n_innovation = 0;
 			boost::unique_lock<boost::mutex> display_lock((*world)->display_mutex);
 			if ((*world)->display_rendered)
 			{
+				// all the marginals for the viewers, at the display rate
+				if (intOpts[iDispQt] || intOpts[iDispGdhe])
+					for(WorldAbstract::MapList::iterator mapIter = (*world)->mapList().begin(); mapIter != (*world)->mapList().end(); ++mapIter)
+						(*mapIter)->marginals.update(**mapIter);
 				#ifdef HAVE_MODULE_QDISPLAY
 				display::ViewerQt *viewerQt = NULL;
 				if (intOpts[iDispQt]) viewerQt = PTR_CAST<display::ViewerQt*> ((*world)->getDisplayViewer(display::ViewerQt::id()));
@@ -1425,7 +1591,17 @@ int n_innovation = 0;
 
 	average_robot_innovation /= n_innovation;
 	std::cout << "average_robot_innovation " << average_robot_innovation << std::endl;
+	for (MapAbstract::MapManagerList::iterator mmIter = mapPtr->mapManagerList().begin(); mmIter != mapPtr->mapManagerList().end(); ++mmIter)
+		for (MapManagerAbstract::DataManagerList::iterator dmIter = (*mmIter)->dataManagerList().begin(); dmIter != (*mmIter)->dataManagerList().end(); ++dmIter)
+		{
+			printMatchStats<DataManager_ImagePoint_Ransac>(*dmIter);
+			printSearchStats<DataManager_ImagePoint_Ransac>(*dmIter);
+			printMatchStats<DataManager_ImagePoint_Ransac_Fast>(*dmIter);
+			printSearchStats<DataManager_ImagePoint_Ransac_Fast>(*dmIter);
+			printMatchStats<DataManager_ImagePoint_Ransac_Simu>(*dmIter);
+		}
 
+	posePredictor.reset();
 	if (exporter) exporter->stop();
 	(*world)->slam_blocked(true);
 //	std::cout << "\nFINISHED ! Press a key to terminate." << std::endl;
@@ -1641,6 +1817,8 @@ void demo_slam_run() {
 	* --map 0=odometry, 1=global, 2=local/multimap
 	* --trigger 0=internal, 1=external mode 1, 2=external mode 0, 3=external mode 14 (PointGrey (Flea) only)
 	* --simu 0 or <environment id>*10+<trajectory id> (
+	* --simu-render=0/1 -> in simulation, process rendered images with the real detector and matcher instead of simulated observations
+	* --predict=0/1 -> export the pose predicted with each reading of the IMU / odometry, between the corrections (needs --export and --robot 1/2)
 	* --camera=0/1/2/3 -> Disable / Mono / Stereo / Bicam
 	* --freq camera frequency in double Hz (with trigger==0/1)
 	* --shutter shutter time in double seconds (0=auto); for trigger modes 0,2,3 the value is relative between 0 and 1
@@ -1773,6 +1951,8 @@ void ConfigSetup::loadKeyValueFile(jafar::kernel::KeyValueFile const& keyValueFi
 	
 	KeyValueFile_getItem(IMU_TIMESTAMP_CORRECTION);
 	KeyValueFile_getItem(GPS_TIMESTAMP_CORRECTION);
+	KeyValueFile_getItem(GPS_MAX_DELAY);
+	KeyValueFile_getItem(GPS_CLONE_PERIOD);
 	
 	KeyValueFile_getItem(dxNDR);
 	KeyValueFile_getItem(dvNDR);
@@ -1836,6 +2016,8 @@ void ConfigSetup::saveKeyValueFile(jafar::kernel::KeyValueFile& keyValueFile)
 	
 	KeyValueFile_setItem(IMU_TIMESTAMP_CORRECTION);
 	KeyValueFile_setItem(GPS_TIMESTAMP_CORRECTION);
+	KeyValueFile_setItem(GPS_MAX_DELAY);
+	KeyValueFile_setItem(GPS_CLONE_PERIOD);
 	
 	KeyValueFile_setItem(dxNDR);
 	KeyValueFile_setItem(dvNDR);
@@ -1861,6 +2043,9 @@ void ConfigEstimation::loadKeyValueFile(jafar::kernel::KeyValueFile const& keyVa
 	KeyValueFile_getItem(CORRECTION_SIZE);
 	
 	KeyValueFile_getItem(MAP_SIZE);
+	KeyValueFile_getItem(FILTER_INFO_ACTIVE);
+	KeyValueFile_getItem(FILTER_LOCAL_SIZE);
+	KeyValueFile_getItem(FILTER_CONSIDER_PERIOD);
 	KeyValueFile_getItem(PIX_NOISE);
 	KeyValueFile_getItem(PIX_NOISE_SIMUFACTOR);
 	
@@ -1879,12 +2064,25 @@ void ConfigEstimation::loadKeyValueFile(jafar::kernel::KeyValueFile const& keyVa
 	KeyValueFile_getItem(N_INIT);
 	KeyValueFile_getItem(N_RECOMP_GAINS);
 	KeyValueFile_getItem(RANSAC_LOW_INNOV);
+	KeyValueFile_getItem(CANDIDATE_FRAMES);
+	KeyValueFile_getItem(CANDIDATE_SEARCH);
+	KeyValueFile_getItem(OBS_RECLAIM_FRAMES);
+	KeyValueFile_getItem(GYRO_AID);
 	
 	KeyValueFile_getItem(RANSAC_NTRIES);
+	KeyValueFile_getItem(RANSAC_CONFIDENCE);
+	KeyValueFile_getItem(RANSAC_STRATA);
+	KeyValueFile_getItem(RANSAC_MAX_POINTS);
+	KeyValueFile_getItem(RANSAC_MIN_RATIO);
+	KeyValueFile_getItem(EVICT_UTILITY_TH);
+	KeyValueFile_getItem(EVICT_DIST_REF);
 	
 	KeyValueFile_getItem(HARRIS_CONV_SIZE);
 	KeyValueFile_getItem(HARRIS_TH);
 	KeyValueFile_getItem(HARRIS_EDDGE);
+	KeyValueFile_getItem(FAST_ARC);
+	KeyValueFile_getItem(FAST_TH);
+	KeyValueFile_getItem(FAST_HARRIS_SCORE);
 	
 	KeyValueFile_getItem(DESC_SIZE);
 	KeyValueFile_getItem(MULTIVIEW_DESCRIPTOR);
@@ -1898,6 +2096,9 @@ void ConfigEstimation::loadKeyValueFile(jafar::kernel::KeyValueFile const& keyVa
 	KeyValueFile_getItem(MATCH_TH);
 	KeyValueFile_getItem(MIN_SCORE);
 	KeyValueFile_getItem(PARTIAL_POSITION);
+	KeyValueFile_getItem(LK_DIRECT_SIZE);
+	KeyValueFile_getItem(LK_ITER);
+	KeyValueFile_getItem(SPIRAL_RINGS);
 }
 
 void ConfigEstimation::saveKeyValueFile(jafar::kernel::KeyValueFile& keyValueFile)
@@ -1905,6 +2106,9 @@ void ConfigEstimation::saveKeyValueFile(jafar::kernel::KeyValueFile& keyValueFil
 	KeyValueFile_setItem(CORRECTION_SIZE);
 	
 	KeyValueFile_setItem(MAP_SIZE);
+	KeyValueFile_setItem(FILTER_INFO_ACTIVE);
+	KeyValueFile_setItem(FILTER_LOCAL_SIZE);
+	KeyValueFile_setItem(FILTER_CONSIDER_PERIOD);
 	KeyValueFile_setItem(PIX_NOISE);
 	KeyValueFile_setItem(PIX_NOISE_SIMUFACTOR);
 	
@@ -1923,12 +2127,25 @@ void ConfigEstimation::saveKeyValueFile(jafar::kernel::KeyValueFile& keyValueFil
 	KeyValueFile_setItem(N_INIT);
 	KeyValueFile_setItem(N_RECOMP_GAINS);
 	KeyValueFile_setItem(RANSAC_LOW_INNOV);
+	KeyValueFile_setItem(CANDIDATE_FRAMES);
+	KeyValueFile_setItem(CANDIDATE_SEARCH);
+	KeyValueFile_setItem(OBS_RECLAIM_FRAMES);
+	KeyValueFile_setItem(GYRO_AID);
 	
 	KeyValueFile_setItem(RANSAC_NTRIES);
+	KeyValueFile_setItem(RANSAC_CONFIDENCE);
+	KeyValueFile_setItem(RANSAC_STRATA);
+	KeyValueFile_setItem(RANSAC_MAX_POINTS);
+	KeyValueFile_setItem(RANSAC_MIN_RATIO);
+	KeyValueFile_setItem(EVICT_UTILITY_TH);
+	KeyValueFile_setItem(EVICT_DIST_REF);
 	
 	KeyValueFile_setItem(HARRIS_CONV_SIZE);
 	KeyValueFile_setItem(HARRIS_TH);
 	KeyValueFile_setItem(HARRIS_EDDGE);
+	KeyValueFile_setItem(FAST_ARC);
+	KeyValueFile_setItem(FAST_TH);
+	KeyValueFile_setItem(FAST_HARRIS_SCORE);
 	
 	KeyValueFile_setItem(DESC_SIZE);
 	KeyValueFile_setItem(MULTIVIEW_DESCRIPTOR);
@@ -1942,4 +2159,7 @@ void ConfigEstimation::saveKeyValueFile(jafar::kernel::KeyValueFile& keyValueFil
 	KeyValueFile_setItem(MATCH_TH);
 	KeyValueFile_setItem(MIN_SCORE);
 	KeyValueFile_setItem(PARTIAL_POSITION);
+	KeyValueFile_setItem(LK_DIRECT_SIZE);
+	KeyValueFile_setItem(LK_ITER);
+	KeyValueFile_setItem(SPIRAL_RINGS);
 }
@@ -12,6 +12,7 @@
 
 #include "jmath/misc.hpp"
 #include "rtslam/quatTools.hpp"
+#include "rtslam/quatKernels.hpp"
 
 #ifndef LANDMARKAHP_HPP_
 #define LANDMARKAHP_HPP_
@@ -61,45 +62,36 @@ namespace jafar {
 
 			template<class VF, class Vlf>
 			vec fromFrame(const VF & F, const Vlf & ahpf) {
-
-
-				// split non-trivial chunks of landmark state
-				vec3 p0f(subrange(ahpf, 0, 3));
-				vec3 mf(subrange(ahpf, 3, 6));
-
+				double f[7], l[7], res[6];
+				fixed::load(F, 0, 7, f);
+				fixed::load(ahpf, 0, 6, l);
+				fixed::eucFromFrame(f, l, res); //     anchor
+				fixed::vecFromFrame(f, l + 3, res + 3); // director vector
 
 				// transformed landmark in global frame
 				vec ahp(7);
-
-				subrange(ahp, 0, 3) = eucFromFrame(F, p0f);
-				subrange(ahp, 3, 6) = vecFromFrame(F, mf);
+				fixed::store(res, 6, ahp, 0);
 				ahp(6) = ahpf(6);
-
 				return ahp;
 			}
 
 			template<class VF, class Vahpf, class Vahp, class MAHP_f, class MAHP_ahpf>
 			void fromFrame(const VF & F, const Vahpf & ahpf, Vahp & ahp, MAHP_f & AHP_f, MAHP_ahpf & AHP_ahpf) {
-				// split non-trivial chunks of landmark state
-				vec3 p0f(subrange(ahpf, 0, 3));
-				vec3 mf(subrange(ahpf, 3, 6));
-				// destination chunks
-				vec3 p0;
-				vec3 m;
-				mat JAC_33(3, 3), JAC_37(3, 7);
+				double f[7], l[7], res[6], JAC_37[21], JAC_33[9];
+				fixed::load(F, 0, 7, f);
+				fixed::load(ahpf, 0, 6, l);
 				// Jacobians
 				AHP_f.clear();
 				AHP_ahpf.clear();
 				// transform p0
-				eucFromFrame(F, p0f, p0, JAC_37, JAC_33);
-				subrange(ahp, 0, 3) = p0;
-				subrange(AHP_f, 0, 3, 0, 7) = JAC_37;
-				subrange(AHP_ahpf, 0, 3, 0, 3) = JAC_33;
+				fixed::eucFromFrame(f, l, res, JAC_37, JAC_33);
+				fixed::storeJac(JAC_37, 3, 7, AHP_f, 0, 0);
+				fixed::storeJac(JAC_33, 3, 3, AHP_ahpf, 0, 0);
 				// transform m
-				vecFromFrame(F, mf, m, JAC_37, JAC_33);
-				subrange(ahp, 3, 6) = m;
-				subrange(AHP_f, 3, 6, 0, 7) = JAC_37;
-				subrange(AHP_ahpf, 3, 6, 3, 6) = JAC_33;
+				fixed::vecFromFrame(f, l + 3, res + 3, JAC_37, JAC_33);
+				fixed::storeJac(JAC_37, 3, 7, AHP_f, 3, 0);
+				fixed::storeJac(JAC_33, 3, 3, AHP_ahpf, 3, 3);
+				fixed::store(res, 6, ahp, 0);
 				// transform rho
 				ahp(6) = ahpf(6);
 				AHP_ahpf(6, 6) = 1;
@@ -107,40 +99,36 @@ namespace jafar {
 
 			template<class VF, class Vahp>
 			vec toFrame(const VF & F, const Vahp & ahp) {
-				// split non-trivial chunks of landmark state
-				vec3 p0(subrange(ahp, 0, 3));
-				vec3 m(subrange(ahp, 3, 6));
+				double f[7], l[7], res[6];
+				fixed::load(F, 0, 7, f);
+				fixed::load(ahp, 0, 6, l);
+				fixed::eucToFrame(f, l, res); //     anchor
+				fixed::vecToFrame(f, l + 3, res + 3); // director vector
+
 				// transformed landmark in frame F
 				vec ahpf(7);
-				subrange(ahpf, 0, 3) = eucToFrame(F, p0);
-				subrange(ahpf, 3, 6) = vecToFrame(F, m);
+				fixed::store(res, 6, ahpf, 0);
 				ahpf(6) = ahp(6);
-
 				return ahpf;
 			}
 
 			template<class VF, class Vahp, class Vahpf, class MAHPF_f, class MAHPF_ahp>
 			void toFrame(const VF & F, const Vahp & ahp, Vahpf & ahpf, MAHPF_f & AHPF_f, MAHPF_ahp & AHPF_ahp) {
-				// split non-trivial chunks of landmark state
-				vec3 p0(subrange(ahp, 0, 3));
-				vec3 m(subrange(ahp, 3, 6));
-				// destination chunks
-				vec3 p0f;
-				vec3 mf;
-				mat JAC_33(3, 3), JAC_37(3, 7);
+				double f[7], l[7], res[6], JAC_37[21], JAC_33[9];
+				fixed::load(F, 0, 7, f);
+				fixed::load(ahp, 0, 6, l);
 				// Jacobians
 				AHPF_f.clear();
 				AHPF_ahp.clear();
 				// transform p0
-				eucToFrame(F, p0, p0f, JAC_37, JAC_33);
-				subrange(ahpf, 0, 3) = p0f;
-				subrange(AHPF_f, 0, 3, 0, 7) = JAC_37;
-				subrange(AHPF_ahp, 0, 3, 0, 3) = JAC_33;
+				fixed::eucToFrame(f, l, res, JAC_37, JAC_33);
+				fixed::storeJac(JAC_37, 3, 7, AHPF_f, 0, 0);
+				fixed::storeJac(JAC_33, 3, 3, AHPF_ahp, 0, 0);
 				// transform m
-				vecToFrame(F, m, mf, JAC_37, JAC_33);
-				subrange(ahpf, 3, 6) = mf;
-				subrange(AHPF_f, 3, 6, 0, 7) = JAC_37;
-				subrange(AHPF_ahp, 3, 6, 3, 6) = JAC_33;
+				fixed::vecToFrame(f, l + 3, res + 3, JAC_37, JAC_33);
+				fixed::storeJac(JAC_37, 3, 7, AHPF_f, 3, 0);
+				fixed::storeJac(JAC_33, 3, 3, AHPF_ahp, 3, 3);
+				fixed::store(res, 6, ahpf, 0);
 				// transform rho
 				ahpf(6) = ahp(6);
 				AHPF_ahp(6, 6) = 1;
@@ -195,13 +183,15 @@ namespace jafar {
 			 */
 			template<class VS, class VA>
 			vec3 toBearingOnlyFrame(const VS & s, const VA & ahp) {
-				vec3 p0, m;
-				double rho;
-				split(ahp, p0, m, rho);
-				vec3 t = subrange(s, 0, 3);
-				vec4 q = subrange(s, 3, 7);
-				vec3 d = m - (t - p0) * rho;
-				return rotateInv(q, d); // OK JS April 1 2010
+				double as[7], d[3], v[3];
+				fixed::load(s, 0, 7, as);
+				double rho = ahp(6);
+				for (size_t i = 0; i < 3; ++i)
+					d[i] = ahp(3 + i) - (as[i] - ahp(i)) * rho; // d = m - (t - p0) * rho
+				fixed::rotateInv(as + 3, d, v); // OK JS April 1 2010
+				vec3 res;
+				fixed::store(v, 3, res, 0);
+				return res;
 			}
 
 
@@ -226,14 +216,14 @@ namespace jafar {
 			 */
 			template<class VS, class VA, class VV>
 			void toBearingOnlyFrame(const VS & s, const VA & ahp, VV & v, double & dist) {
-				vec3 p0, m;
-				double rho;
-				split(ahp, p0, m, rho);
-				vec3 t = subrange(s, 0, 3);
-				vec4 q = subrange(s, 3, 7);
-				vec3 d = m - (t - p0) * rho;
-				v = rotateInv(q, d); // OK JS April 1 2010
-				dist = norm_2(v) / rho;
+				double as[7], d[3], av[3];
+				fixed::load(s, 0, 7, as);
+				double rho = ahp(6);
+				for (size_t i = 0; i < 3; ++i)
+					d[i] = ahp(3 + i) - (as[i] - ahp(i)) * rho; // d = m - (t - p0) * rho
+				fixed::rotateInv(as + 3, d, av); // OK JS April 1 2010
+				fixed::store(av, 3, v, 0);
+				dist = sqrt(av[0] * av[0] + av[1] * av[1] + av[2] * av[2]) / rho;
 			}
 
 
@@ -260,31 +250,35 @@ namespace jafar {
 			 */
 			template<class VS, class VA, class VV, class MV_s, class MV_a>
 			void toBearingOnlyFrame(const VS & s, const VA & ahp, VV & v, double & dist, MV_s & V_s, MV_a & V_ahp) {
-				vec3 p0, m;
-				double rho;
-				mat34 V_q;
-				mat33 V_d;
+				double as[7], d[3], av[3], V_q[12], V_d[9];
 				// value
-				split(ahp, p0, m, rho);
-				vec3 t = subrange(s, 0, 3);
-				vec4 q = subrange(s, 3, 7);
-				vec3 d = m - (t - p0) * rho; //    before rotation
-				rotateInv(q, d, v, V_q, V_d); //   obtain v
-				dist = norm_2(v) / rho; //     		 obtain non-observable distance
+				fixed::load(s, 0, 7, as);
+				double rho = ahp(6);
+				for (size_t i = 0; i < 3; ++i)
+					d[i] = ahp(3 + i) - (as[i] - ahp(i)) * rho; // d = m - (t - p0) * rho, before rotation
+				fixed::rotateInv(as + 3, d, av, V_q, V_d); //   obtain v
+				fixed::store(av, 3, v, 0);
+				dist = sqrt(av[0] * av[0] + av[1] * av[1] + av[2] * av[2]) / rho; // obtain non-observable distance
 				// Jacobians
-				mat33 V_p0;
-				V_p0 = V_d * rho;
-				//				mat V_rho(3,1); // This comments only for Jacobian reference...
+				//				V_p0 = V_d * rho; // This comments only for Jacobian reference...
 				//				V_m = V_d;
 				//				V_rho = prod(V_d, (p0 - t));
 				//				V_t = - V_d * rho;
 				V_s.clear();
 				V_ahp.clear();
-				subrange(V_s, 0, 3, 0, 3) = -V_p0; //       dv / dt
-				subrange(V_s, 0, 3, 3, 7) = V_q; //         dv / dq
-				subrange(V_ahp, 0, 3, 0, 3) = V_p0; //      dv / dp0
-				subrange(V_ahp, 0, 3, 3, 6) = V_d; //       dv / dm
-				column(V_ahp, 6) = prod(V_d, (p0 - t)); //  dv / drho   // OK JS April 1 2010
+				for (size_t i = 0; i < 3; ++i) {
+					double v_rho = 0.;
+					for (size_t j = 0; j < 3; ++j) {
+						double V_p0 = V_d[3 * i + j] * rho;
+						V_s(i, j) = -V_p0; //                   dv / dt
+						V_ahp(i, j) = V_p0; //                  dv / dp0
+						V_ahp(i, 3 + j) = V_d[3 * i + j]; //    dv / dm
+						v_rho += V_d[3 * i + j] * (ahp(j) - as[j]);
+					}
+					for (size_t j = 0; j < 4; ++j)
+						V_s(i, 3 + j) = V_q[4 * i + j]; //      dv / dq
+					V_ahp(i, 6) = v_rho; //                   dv / drho   // OK JS April 1 2010
+				}
 			}
 
 
@@ -303,13 +297,14 @@ namespace jafar {
 			 */
 			template<class VS, class VLS>
 			vec7 fromBearingOnlyFrame(const VS & s, const VLS & v, const double _rho) {
-				vec3 t = subrange(s, 0, 3);
-				vec4 q = subrange(s, 3, 7);
+				double as[7], av[3], m[3];
+				fixed::load(s, 0, 7, as);
+				fixed::load(v, 0, 3, av);
+				fixed::rotate(as + 3, av, m);
 				vec7 ahp;
-
-				subrange(ahp, 0, 3) = t;
-				subrange(ahp, 3, 6) = rotate(q, v);
-				ahp(6) = _rho * norm_2(v);
+				fixed::store(as, 3, ahp, 0);
+				fixed::store(m, 3, ahp, 3);
+				ahp(6) = _rho * sqrt(av[0] * av[0] + av[1] * av[1] + av[2] * av[2]);
 				return ahp; // OK JS April 1 2010
 			}
 
@@ -333,30 +328,26 @@ namespace jafar {
 			template<class VS, class VLS, class VA, class MA_s, class MA_v, class MA_rho>
 			void fromBearingOnlyFrame(const VS & s, const VLS & v, const double _rho, VA & ahp, MA_s & AHP_s, MA_v & AHP_v,
 			    MA_rho & AHP_rho) {
-				vec3 t = subrange(s, 0, 3);
-				vec4 q = subrange(s, 3, 7);
-				vec3 m;
-				mat34 M_q;
-				mat33 M_v;
-				mat NV_v(1, 3);
-
-				rotate(q, v, m, M_q, M_v);
-				double nv = norm_2(v);
-
-				subrange(ahp, 0, 3) = t; // p0  = t
-				subrange(ahp, 3, 6) = m; // m   = R(q) * v
+				double as[7], av[3], m[3], M_q[12], M_v[9];
+				fixed::load(s, 0, 7, as);
+				fixed::load(v, 0, 3, av);
+
+				fixed::rotate(as + 3, av, m, M_q, M_v);
+				double nv = sqrt(av[0] * av[0] + av[1] * av[1] + av[2] * av[2]);
+
+				fixed::store(as, 3, ahp, 0); // p0  = t
+				fixed::store(m, 3, ahp, 3); //  m   = R(q) * v
 				ahp(6) = _rho * nv; //              rho = ||v|| * _rho
-				ublasExtra::norm_2Jac<3>(v, NV_v); // drho / dv = d||v||/dv * _rho
 
 				// Jacobians
-				identity_mat I(3);
 				AHP_s.clear();
 				AHP_v.clear();
 				AHP_rho.clear();
-				subrange(AHP_s, 0, 3, 0, 3) = I; //             dp0 / dt
-				subrange(AHP_s, 3, 6, 3, 7) = M_q; //            dm / dq
-				subrange(AHP_v, 3, 6, 0, 3) = M_v; //            dm / dv
-				subrange(AHP_v, 6, 7, 0, 3) = _rho * NV_v; //  drho / dv
+				for (size_t i = 0; i < 3; ++i) AHP_s(i, i) = 1.0; //  dp0 / dt
+				fixed::storeJac(M_q, 3, 4, AHP_s, 3, 3); //            dm / dq
+				fixed::storeJac(M_v, 3, 3, AHP_v, 3, 0); //            dm / dv
+				for (size_t j = 0; j < 3; ++j)
+					AHP_v(6, j) = _rho * av[j] / nv; //                drho / dv = d||v||/dv * _rho
 				AHP_rho(6, 0) = nv; //                         drho / drho
 			} // OK JS April 1 2010
 
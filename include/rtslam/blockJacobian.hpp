@@ -0,0 +1,119 @@
+/**
+ * \file blockJacobian.hpp
+ *
+ * Block-sparse structure of a transition Jacobian.
+ *
+ * \date 17/10/2026
+ * \author jsola
+ *
+ * \ingroup rtslam
+ */
+
+#ifndef BLOCKJACOBIAN_HPP_
+#define BLOCKJACOBIAN_HPP_
+
+#include <vector>
+#include "kernel/jafarDebug.hpp"
+#include "jmath/jblas.hpp"
+
+namespace jafar {
+	namespace rtslam {
+
+		/**
+		 * Block-sparse structure of a square transition Jacobian F.
+		 *
+		 * The structure does not hold the values of F, which stay in the dense matrix filled by the motion model.
+		 * It only lists the blocks of F that are non-zero, so that the filter can skip all the rest.
+		 * - Rows of F that are not covered by any block are identity rows: the corresponding states are not changed by the motion.
+		 * - Rows of F covered by some block are the sum of their blocks. All other entries in these rows are zero.
+		 * - Blocks flagged as identity are known to be the identity matrix, and are applied as a copy instead of a product.
+		 *
+		 * Blocks must not overlap. The structure only depends on the motion model, so it is normally declared once at construction.
+		 *
+		 * \ingroup rtslam
+		 */
+		class BlockJacobian {
+			public:
+				struct Block {
+					size_t row, col, nrows, ncols;
+					bool identity;
+					Block(size_t _row, size_t _col, size_t _nrows, size_t _ncols, bool _identity):
+						row(_row), col(_col), nrows(_nrows), ncols(_ncols), identity(_identity) {}
+				};
+				typedef std::vector<Block> BlockList;
+
+			private:
+				size_t size_;
+				BlockList blocks_;
+				std::vector<bool> active_; ///< rows covered by some block
+
+			public:
+				BlockJacobian(size_t _size = 0): size_(_size), active_(_size, false) {}
+
+				void resize(size_t _size) { size_ = _size; clear(); }
+				void clear() { blocks_.clear(); active_.assign(size_, false); }
+				bool empty() const { return blocks_.empty(); }
+				size_t size() const { return size_; }
+				const BlockList & blocks() const { return blocks_; }
+
+				/**
+				 * Declare a non-zero block of F.
+				 * \param row, col the position of the block in F
+				 * \param nrows, ncols the size of the block
+				 */
+				void addBlock(size_t row, size_t col, size_t nrows, size_t ncols) {
+					JFR_ASSERT(row + nrows <= size_ && col + ncols <= size_, "BlockJacobian::addBlock: block out of bounds");
+					blocks_.push_back(Block(row, col, nrows, ncols, false));
+					for (size_t i = row; i < row + nrows; ++i) active_[i] = true;
+				}
+
+				/**
+				 * Declare an identity block of F, on the diagonal.
+				 * \param pos the position of the block in F
+				 * \param n the size of the block
+				 */
+				void addIdentity(size_t pos, size_t n) {
+					JFR_ASSERT(pos + n <= size_, "BlockJacobian::addIdentity: block out of bounds");
+					blocks_.push_back(Block(pos, pos, n, n, true));
+					for (size_t i = pos; i < pos + n; ++i) active_[i] = true;
+				}
+
+				/**
+				 * Rows of F that differ from identity.
+				 * \param ia_v the indices of the states of F in the map, or none for local indices.
+				 */
+				jblas::ind_array activeRows(const jblas::ind_array & ia_v) const {
+					jblas::ind_array res(nActiveRows());
+					for (size_t i = 0, j = 0; i < size_; ++i)
+						if (active_[i]) res(j++) = ia_v(i);
+					return res;
+				}
+				jblas::ind_array activeRows() const {
+					jblas::ind_array res(nActiveRows());
+					for (size_t i = 0, j = 0; i < size_; ++i)
+						if (active_[i]) res(j++) = i;
+					return res;
+				}
+				size_t nActiveRows() const {
+					size_t n = 0;
+					for (size_t i = 0; i < size_; ++i)
+						if (active_[i]) ++n;
+					return n;
+				}
+
+				/**
+				 * Number of multiply-adds per map column of the product F*Pvm.
+				 * This is to be compared with size()*size() for the dense product.
+				 */
+				size_t cost() const {
+					size_t n = 0;
+					for (BlockList::const_iterator it = blocks_.begin(); it != blocks_.end(); ++it)
+						n += (it->identity ? it->nrows : it->nrows * it->ncols);
+					return n;
+				}
+		};
+
+	}
+}
+
+#endif /* BLOCKJACOBIAN_HPP_ */
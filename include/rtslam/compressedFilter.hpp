@@ -0,0 +1,120 @@
+/**
+ * \file compressedFilter.hpp
+ *
+ * Compressed extended Kalman filter, with lazy updates of the map
+ *
+ * \date 17/10/2026
+ * \author jsola
+ *
+ * \ingroup rtslam
+ */
+
+#ifndef COMPRESSEDFILTER_HPP_
+#define COMPRESSEDFILTER_HPP_
+
+#include <vector>
+#include <list>
+
+#include "rtslam/kalmanFilter.hpp"
+
+namespace jafar {
+	namespace rtslam {
+		using namespace jblas;
+
+
+		/**
+		 * Compressed extended Kalman filter (CEKF, Guivant and Nebot, 2001).
+		 * \ingroup rtslam
+		 *
+		 * The states are split between the active region A, that is the robot, the sensors and the landmarks
+		 * recently used, and the rest of the map B. The predictions and corrections only update x and P_AA,
+		 * and the effect of the corrections on the covariances of the rest of the map is accumulated
+		 * in small matrices, with P_AB and P_BB the values at the last global update:
+		 * - P_AB <-- phi * P_AB
+		 * - P_BB <-- P_BB - P_BA * psi * P_AB
+		 *
+		 * The means of the whole map are updated at each correction, which is linear in the map size.
+		 * The covariances are globally updated only when a state out of A is needed:
+		 * a correction or a prediction involving it, or recover() for the map objects that read P(),
+		 * and the state is then added to A. When A becomes larger than \a maxActive, it is reduced to the states
+		 * used since it was last reduced. New landmarks and reparametrizations of active landmarks
+		 * are added to A without a global update. The consider states (see setConsider()) are always kept in A.
+		 *
+		 * A global update costs |B|^2 times the smaller of the size of A and the total size of the innovations
+		 * since the previous one, so it is never more expensive than the EKF corrections it replaces.
+		 *
+		 * The results are the same as the ones of the EKF, up to rounding errors.
+		 */
+		class CompressedKalmanFilterIndirect: public ExtendedKalmanFilterIndirect {
+			private:
+				ind_array ia_active_; ///< active states A, rows of phi
+				ind_array ia_base_; ///< active states at the last global update, columns of phi and psi
+				ind_array ia_x_; ///< used states at the last operation
+				std::vector<int> pos_; ///< position of the states in A, -1 if not active
+				std::vector<bool> touched_; ///< the state was used since the region was last reduced
+				mat phi_;
+				sym_mat psi_;
+				bool pending_; ///< the covariances of B are not up to date
+
+				/// the terms of psi, to update P_BB with their smaller rank when there are few of them
+				struct LazyCorrection {
+					LazyCorrection(const mat & Y, const sym_mat & iZ): Y(Y), iZ(iZ) {}
+					mat Y; ///< phi_rsl' * INN_rsl'
+					sym_mat iZ; ///< inverse of the innovation covariances
+				};
+				std::list<LazyCorrection> lazyCorrections_;
+				size_t lazySize_; ///< total size of the lazy innovations
+
+				size_t maxActive_;
+				size_t nGlobalUpdates_;
+
+				void setRegion(const ind_array & ia);
+				void activate(const ind_array & ia);
+				void addActive(const ind_array & ia, const mat & phi_rows);
+				void touch(const ind_array & ia);
+				ind_array touchedStates();
+				ind_array activePos(const ind_array & ia);
+				bool isActive(const ind_array & ia);
+				mat phiRows(const ind_array & ia);
+				/// update of the means of B and of the compressed matrices, after the update of A with K
+				void correctLazy(const mat & Y, const sym_mat & iZ, const vec & z);
+				/// apply the compressed matrices to P_AB and P_BB
+				void globalUpdate();
+
+			public:
+				/**
+				 * \param _size the state size
+				 * \param maxActive the maximum number of states in the active region
+				 */
+				CompressedKalmanFilterIndirect(size_t _size, size_t maxActive = 300);
+
+				virtual void grow(size_t _size);
+
+				virtual void predict(const ind_array & iax, const mat & F_v, const ind_array & iav, const mat & F_u, const sym_mat & U);
+				virtual void predict(const ind_array & iax, const mat & F_v, const ind_array & iav, const sym_mat & Q);
+				virtual void predict(const ind_array & iax, const mat & F_v, const BlockJacobian & F_blocks, const ind_array & iav, const sym_mat & Q);
+
+				virtual void initialize(const ind_array & iax, const mat & G_rs, const ind_array & ia_rs, const ind_array & ia_l, const mat & G_y, const sym_mat & R);
+				virtual void initialize(const ind_array & iax, const mat & G_v, const ind_array & ia_rs, const ind_array & ia_l, const mat & G_y, const sym_mat & R, const mat & G_n, const sym_mat & N);
+
+				virtual void reparametrize(const ind_array & iax, const mat & J_l, const ind_array & ia_old, const ind_array & ia_new);
+				virtual void reparametrizeAllStacked(const ind_array & iax);
+
+				virtual void correct(const ind_array & iax, Innovation & inn, const mat & INN_rsl, const ind_array & ia_rsl, const sym_mat & R);
+				virtual void correctAllStacked(const ind_array & iax);
+
+				virtual void liberate(const ind_array & ia);
+				virtual void recover(const ind_array & ia);
+				/// the marginals of states out of A are computed from psi, without a global update
+				virtual sym_mat marginal(const ind_array & ia);
+
+				/// number of states in the active region
+				size_t activeSize() { return ia_active_.size(); }
+				/// number of global updates of the covariances
+				size_t globalUpdates() { return nGlobalUpdates_; }
+		};
+
+	}
+}
+
+#endif /* COMPRESSEDFILTER_HPP_ */
@@ -9,6 +9,8 @@
 #ifndef DATAMANAGERABSTRACT_HPP_
 #define DATAMANAGERABSTRACT_HPP_
 
+#include <map>
+
 #include "rtslam/parents.hpp"
 #include "rtslam/sensorAbstract.hpp"
 #include "rtslam/mapManager.hpp"
@@ -41,10 +43,18 @@ namespace jafar {
 
     protected:
       boost::shared_ptr<ObservationFactory> obsFactory;
+      /// observations of each landmark type used to predict the visibility of the landmarks, never registered
+      std::map<int, observation_ptr_t> visibilityProbes;
     public:
-      void setObservationFactory( boost::shared_ptr<ObservationFactory> of ) { obsFactory=of; }
+      void setObservationFactory( boost::shared_ptr<ObservationFactory> of ) { obsFactory=of; visibilityProbes.clear(); }
       boost::shared_ptr<ObservationFactory> observationFactory( void ) { return obsFactory; }
 
+      /**
+       * Predict if a landmark that has no observation for this data manager is visible by its sensor,
+       * from its mean only, without creating its observation.
+       */
+      bool predictVisibility(const landmark_ptr_t & lmkPtr);
+
     public:
       virtual ~DataManagerAbstract(void) {}
 
@@ -24,6 +24,7 @@ namespace jafar {
 			int numObs = 0;
 			asGrid->renew();
 			obsListSorted.clear();
+			mapManagerPtr()->manageObservations(shared_from_this());
 
 			// loop all observations
 			for (ObservationList::iterator obsIter = observationList().begin(); obsIter
@@ -267,8 +268,12 @@ namespace jafar {
 						                    (app_src->patch.height()-app_dst->patch.height())/2, 0, 0,
 						                    app_dst->patch.width(), app_dst->patch.height());
 
-						// 2c. compute and fill stochastic data for the landmark
-						obsPtr->backProject();
+						// 2c. compute and fill stochastic data for the landmark, drop the features that cannot be undistorted
+						if (!obsPtr->backProject())
+						{
+							obsPtr->landmarkPtr()->mapManagerPtr()->unregisterLandmark(obsPtr->landmarkPtr());
+							return;
+						}
 
 						// 2d. Create lmk descriptor
 						vec7 globalSensorPose = sensorPtr()->globalPose();
@@ -11,10 +11,12 @@
 
 #include <vector>
 #include <list>
+#include <algorithm>
 #include "boost/shared_ptr.hpp"
 
 #include "rtslam/dataManagerAbstract.hpp"
 #include "rtslam/quatTools.hpp"
+#include "rtslam/hardwareEstimatorAbstract.hpp"
 
 namespace jafar {
 	namespace rtslam {
@@ -22,6 +24,7 @@ namespace jafar {
 		typedef std::vector<observation_ptr_t> ObsList;
 		struct RansacSet {
 				observation_ptr_t obsBasePtr;
+				size_t nBase; ///< number of base obs, that are the first inliers
 				ObsList inlierObs;
 				ObsList pendingObs;
 				size_t size() {
@@ -32,9 +35,9 @@ namespace jafar {
 		typedef std::list<ransac_set_ptr_t> RansacSetList;
 
 
-		// TODO extend to n-point ransac ?
 		/**
-		This class implements the one-point-Ransac ActiveSearch strategy
+		This class implements the one-point-Ransac ActiveSearch strategy,
+		that can be extended to 2 or 3-point hypotheses, see setAdaptiveRansac()
 		
 		@ingroup rtslam
 		*/
@@ -56,6 +59,15 @@ namespace jafar {
 					algorithmParams.n_tries = n_tries;
 					algorithmParams.n_init = n_init;
 					algorithmParams.n_recomp_gains = n_recomp_gains;
+					algorithmParams.n_candidate_frames = 0;
+					algorithmParams.candidate_search = 0.;
+					algorithmParams.candidate_parallax_prior = false;
+					setAdaptiveRansac(0., 1, 1, 0.);
+					clearMatchStats();
+					gyroAid.prevTime = -1.;
+					gyroAid.valid = false;
+					gyroAid.prevQCov.resize(4,4);
+					gyroAid.senPoseCov.resize(7,7);
 				}
 				virtual ~DataManagerOnePointRansac() {
 				}
@@ -72,10 +84,52 @@ namespace jafar {
 				ObservationListSorted obsListSorted;
 				// the list of visible observations to handle
 				ObsList obsVisibleList;
+				jblas::ind_array ia_visible; ///< states of the visible observations, the only ones updated by the hypotheses
+				jblas::sym_mat P_visible; ///< their covariances, read once from the filter for all the hypotheses
 				unsigned remainingObsCount;
 				ObsList obsBaseList;
 				ObsList obsFailedList;
 				RansacSetList ransacSetList;
+				std::vector<bool> baseCells; ///< cells of the image where a base obs was taken
+
+				/**
+				 * A new feature tracked in the image before it is initialized in the map
+				 */
+				struct CandidateTrack {
+						boost::shared_ptr<FeatureSpec> featPtr; ///< the feature, with its last measurement and appearance
+						appearance_ptr_t refAppearance; ///< the appearance at detection, that is tracked
+						jblas::vec7 senPose; ///< the global sensor pose at detection
+						jblas::vec meas;     ///< the measurement at detection
+						unsigned nFrames;    ///< number of frames the feature was tracked in
+				};
+				typedef std::list<CandidateTrack> CandidateTrackList;
+				CandidateTrackList candidateList;
+
+				/**
+				 * Prediction of the sensor orientation from gyrometer readings, instead of the motion model
+				 */
+				struct GyroAid {
+						hardware::hardware_estimator_ptr_t estimatorPtr; ///< the estimator giving the gyrometer readings, null if not used
+						size_t column;      ///< column of the x gyrometer in the readings
+						double noise;       ///< gyrometer noise density (rad/s/sqrt(Hz))
+						double biasStd;     ///< standard deviation of the gyrometer bias (rad/s)
+						double prevTime;    ///< time of the previous frame, negative if none
+						jblas::vec4 prevQ;  ///< robot orientation estimated at the previous frame
+						jblas::sym_mat prevQCov; ///< its covariance
+						bool valid;         ///< the sensor pose is predicted for the current frame
+						boost::shared_ptr<jblas::vec7> senPosePtr; ///< the predicted global sensor pose
+						jblas::sym_mat senPoseCov; ///< its covariance
+				} gyroAid;
+
+			public: // statistics
+				struct MatchStats {
+						unsigned nSearch;   ///< number of searches with the expected innovation
+						unsigned nMatch;    ///< number of them that matched
+						double matchTime;   ///< time spent matching them (s)
+						unsigned nGyroRoi;  ///< number of searches in the region predicted with the gyrometers
+						unsigned nRansacSets; ///< number of RANSAC hypotheses
+						unsigned nRansacEscalations; ///< number of times the hypotheses took one more base obs
+				} matchStats;
 
 			protected: // parameters
 				struct alg_params_t {
@@ -84,9 +138,67 @@ namespace jafar {
 						unsigned n_tries;   ///< number of RANSAC consensus tries
 						unsigned n_init;    ///< number of feature initialization
 						unsigned n_recomp_gains; ///< number of update after which infoGains are completely recomputed
+						unsigned n_candidate_frames; ///< number of frames new features are tracked before initialization, 0 to initialize them at detection
+						double candidate_search; ///< search radius to track the new features (pixels)
+						bool candidate_parallax_prior; ///< initialize the distance prior from the parallax of the track
+						double ransac_confidence; ///< probability to have drawn an inlier hypothesis before stopping RANSAC, 0 to always do n_tries
+						unsigned ransac_strata; ///< the base obs are taken in different cells of a ransac_strata x ransac_strata grid
+						unsigned ransac_max_points; ///< max number of base obs of the hypotheses
+						double ransac_min_ratio; ///< inlier ratio under which the hypotheses take one more base obs
 				} algorithmParams;
 
 			public: // getters ans setters
+				/**
+				 * Track the new features in 2D during a few frames before initializing them in the map.
+				 * Only the features that were matched in all these frames are initialized, so that those
+				 * that are lost soon do not cost a landmark initialization and deletion in the filter.
+				 * \param n_frames number of frames to track the new features, 0 to initialize them at detection
+				 * \param search_radius search radius around the last position (pixels)
+				 * \param parallax_prior initialize the distance prior from the parallax of the track, when it is significant,
+				 * and reject the tracks that are not consistent with a static point
+				 */
+				void setCandidateTracking(unsigned n_frames, double search_radius, bool parallax_prior = true) {
+					algorithmParams.n_candidate_frames = n_frames;
+					algorithmParams.candidate_search = search_radius;
+					algorithmParams.candidate_parallax_prior = parallax_prior;
+					if (n_frames == 0) candidateList.clear();
+				}
+				/**
+				 * Predict the sensor orientation from the gyrometer readings between the frames, rather than from
+				 * the motion model, to search the points in smaller regions and predict their patches with the
+				 * right rotation during fast rotations. The gyrometers are assumed aligned with the robot frame.
+				 * The region of a point is the smallest of the regions predicted by the filter and by the gyrometers,
+				 * and the matches must still be compatible with the filter.
+				 * \param estimatorPtr the estimator giving the gyrometer readings, null to disable
+				 * \param column column of the x gyrometer in the readings (the first column is the time)
+				 * \param noise gyrometer noise density (rad/s/sqrt(Hz))
+				 * \param bias_std standard deviation of the gyrometer bias (rad/s)
+				 */
+				void setGyroAid(hardware::hardware_estimator_ptr_t estimatorPtr, size_t column, double noise, double bias_std) {
+					gyroAid.estimatorPtr = estimatorPtr;
+					gyroAid.column = column;
+					gyroAid.noise = noise;
+					gyroAid.biasStd = bias_std;
+					gyroAid.prevTime = -1.;
+					gyroAid.valid = false;
+				}
+				/**
+				 * Adapt the RANSAC to the frame, instead of always drawing n_tries hypotheses from one random base obs.
+				 * n_tries remains the max number of hypotheses.
+				 * \param confidence stop when the probability to have drawn a hypothesis of inliers only is above this,
+				 * given the best inlier ratio so far, 0 to always draw n_tries hypotheses
+				 * \param strata take the base obs in different cells of a strata x strata grid of the image, 1 to take them anywhere
+				 * \param max_points max number of base obs of the hypotheses, 1 for 1-point RANSAC only
+				 * \param min_ratio when the best inlier ratio is under this after a share of the hypotheses, take one more base obs
+				 */
+				void setAdaptiveRansac(double confidence, unsigned strata, unsigned max_points, double min_ratio) {
+					algorithmParams.ransac_confidence = confidence;
+					algorithmParams.ransac_strata = std::max(strata, 1u);
+					algorithmParams.ransac_max_points = std::max(max_points, 1u);
+					algorithmParams.ransac_min_ratio = min_ratio;
+				}
+				void clearMatchStats() { matchStats.nSearch = matchStats.nMatch = matchStats.nGyroRoi = matchStats.nRansacSets = matchStats.nRansacEscalations = 0; matchStats.matchTime = 0.; }
+				boost::shared_ptr<MatcherSpec> getMatcher() { return matcher; }
 /*				boost::shared_ptr<FeatureManagerSpec> featureManager(void) {
 					return featMan;
 				}*/
@@ -104,12 +216,22 @@ namespace jafar {
 				void getOneMatchedBaseObs(observation_ptr_t & obsBasePtr, boost::shared_ptr<RawSpec> rawData);
 				observation_ptr_t selectOneRandomObs();
 				vec updateMean(const observation_ptr_t & obsPtr);
+				vec updateMean(const ObsList & obsList);
+				/// positions of the states \a ia in ia_visible
+				jblas::ind_array visiblePos(const jblas::ind_array & ia);
+				size_t baseCell(const observation_ptr_t & obsPtr);
 				void projectFromMean(vec & exp, const observation_ptr_t & obsPtr, const vec & x);
 				bool isLowInnovationInlier(const observation_ptr_t & obsPtr, const vec & exp, double lowInnTh);
 				bool isExpectedInnovationInlier( observation_ptr_t & obsPtr, double highInnTh);
 // 				bool match(const boost::shared_ptr<RawImage> & rawPtr, const appearance_ptr_t & targetApp, image::ConvexRoi &roi, Measurement & measure, const appearance_ptr_t & app);
 				bool matchWithLowInnovation(const observation_ptr_t obsPtr, double lowInnTh);
 				bool matchWithExpectedInnovation(boost::shared_ptr<RawSpec> rawData,  observation_ptr_t obsPtr);
+				RoiSpec expectedPointRoi(const observation_ptr_t & obsPtr);
+				void predictGyroPose(double time);
+				void saveGyroPose(double time);
+				bool initNewLandmark(const boost::shared_ptr<FeatureSpec> & featPtr, boost::shared_ptr<RawSpec> rawData, const CandidateTrack * track = NULL);
+				void trackCandidates(boost::shared_ptr<RawSpec> rawData);
+				void promoteCandidates(boost::shared_ptr<RawSpec> rawData);
 
 		};
 
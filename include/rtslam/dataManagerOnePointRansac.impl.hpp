@@ -5,7 +5,11 @@
  * \author jsola
  * \ingroup rtslam
  */
+#include <algorithm>
+#include <cmath>
+
 #include "kernel/misc.hpp"
+#include "kernel/timingTools.hpp"
 
 #include "jmath/randomIntTmplt.hpp"
 #include "jmath/misc.hpp"
@@ -49,6 +53,7 @@ namespace jafar {
 			map_ptr_t mapPtr = sensorPtr()->robotPtr()->mapPtr();
 			unsigned numObs = 0;
 
+			predictGyroPose(rawData->timestamp);
 			projectAndCollectVisibleObs();
 
 			unsigned n_tries = algorithmParams.n_tries;
@@ -59,28 +64,41 @@ namespace jafar {
 			//### Create the different Ransac sets
 			//### 
 			unsigned current_try = 0;
+			unsigned n_points = 1; // number of base obs of the hypotheses
+			unsigned level_tries = 0; // number of hypotheses with n_points base obs
+			size_t best_size = 0;
+			baseCells.assign(algorithmParams.ransac_strata * algorithmParams.ransac_strata, false);
 			if (n_tries >= 2)
 			while (current_try < n_tries)
 			{
-				// select random obs and match it
-				observation_ptr_t obsBasePtr;
-				getOneMatchedBaseObs(obsBasePtr, rawData);
-				if (!obsBasePtr) break; // no more available matched obs
+				// select random obs and match them
+				ObsList obsBaseSet;
+				for (unsigned k = 0; k < n_points; ++k)
+				{
+					observation_ptr_t obsBasePtr;
+					getOneMatchedBaseObs(obsBasePtr, rawData);
+					if (!obsBasePtr) break; // no more available matched obs
+					obsBaseSet.push_back(obsBasePtr);
+				}
+				if (obsBaseSet.size() < n_points) break;
 
-				// 1b. base obs is now matched
+				// 1b. base obs are now matched
 				ransac_set_ptr_t ransacSetPtr(new RansacSet);
 				ransacSetList.push_back(ransacSetPtr);
-				ransacSetPtr->obsBasePtr = obsBasePtr;
-				ransacSetPtr->inlierObs.push_back(obsBasePtr);
+				ransacSetPtr->obsBasePtr = obsBaseSet.front();
+				ransacSetPtr->nBase = n_points;
+				ransacSetPtr->inlierObs = obsBaseSet;
 
 				current_try ++;
-				vec x_copy = updateMean(obsBasePtr);
+				level_tries ++;
+				matchStats.nRansacSets++;
+				vec x_copy = (n_points == 1 ? updateMean(obsBaseSet.front()) : updateMean(obsBaseSet));
 
 				// for each other obs
 				for(ObsList::iterator obsIter = obsVisibleList.begin(); obsIter != obsVisibleList.end(); obsIter++)
 				{
 					observation_ptr_t obsCurrentPtr = *obsIter;
-					if (obsCurrentPtr == obsBasePtr) continue; // ignore the tested observation
+					if (std::find(obsBaseSet.begin(), obsBaseSet.end(), obsCurrentPtr) != obsBaseSet.end()) continue; // ignore the tested observations
 
 					// get obs things
 					jblas::vec lmk = obsCurrentPtr->landmarkPtr()->state.x();
@@ -153,6 +171,26 @@ namespace jafar {
 						ransacSetPtr->pendingObs.push_back(obsCurrentPtr);
 					}
 				} // for each other obs
+
+				if (ransacSetPtr->size() > best_size) best_size = ransacSetPtr->size();
+				double inlier_ratio = best_size / (double)obsVisibleList.size();
+
+				// stop when a better consensus is unlikely, given the best inlier ratio so far
+				if (algorithmParams.ransac_confidence > 0.)
+				{
+					if (inlier_ratio >= 1.0) break;
+					double needed_tries = log(1.0 - algorithmParams.ransac_confidence) / log(1.0 - pow(inlier_ratio, (double)n_points));
+					if (level_tries >= needed_tries) break;
+				}
+
+				// the hypotheses with n_points base obs failed, try with one more base obs
+				if (n_points < algorithmParams.ransac_max_points && inlier_ratio < algorithmParams.ransac_min_ratio &&
+				    level_tries >= std::max(n_tries / algorithmParams.ransac_max_points, 1u))
+				{
+					n_points++;
+					level_tries = 0;
+					matchStats.nRansacEscalations++;
+				}
 			} // for i = 0:n_tries
 
 			// TODO we should also store the measurement when building the sets,
@@ -171,9 +209,9 @@ namespace jafar {
 
 				// if there are too many updates to do bufferized, randomly move out some of them
 				// to pending, they may be processed in active search if really necessary
-				while (best_set->size() > 1 && best_set->size() > algorithmParams.n_updates_ransac)
+				while (best_set->size() > best_set->nBase && best_set->size() > algorithmParams.n_updates_ransac)
 				{
-					int n = (rtslam::rand() % (best_set->size() - 1)) + 1; // keep the first one which is the base obs
+					int n = (rtslam::rand() % (best_set->size() - best_set->nBase)) + best_set->nBase; // keep the first ones which are the base obs
 					best_set->pendingObs.push_back(best_set->inlierObs[n]);
 					kernel::fastErase(best_set->inlierObs, n);
 				}
@@ -191,7 +229,7 @@ namespace jafar {
 						
 						// 2a. add obs to buffer for EKF update
 						#if BUFFERED_UPDATE
-						mapPtr->filterPtr->stackCorrection(obsPtr->innovation, obsPtr->INN_rsl, obsPtr->ia_rsl);
+						mapPtr->filterPtr->stackCorrection(obsPtr->innovation, obsPtr->INN_rsl, obsPtr->ia_rsl, obsPtr->measurement.P());
 						#if RELEVANCE_TEST
 						innovation_relevance += obsPtr->computeRelevance();
 						#endif
@@ -313,9 +351,7 @@ namespace jafar {
                         RoiSpec roi;
                         if(obsPtr->expectation.P().size1() == 2) // basically DsegMatcher handles it's own roi and (due to the size4 expectation) the following roi computation fails. - TODO clean up all this, is should not mess with One point ransac
                         {
-                           roi = RoiSpec(obsPtr->expectation.x(), obsPtr->expectation.P() + matcher->params.measVar*identity_mat(2), matcher->params.mahalanobisTh);
-                           obsPtr->searchSize = roi.count();
-                           if (obsPtr->searchSize > matcher->params.maxSearchSize) roi.scale(sqrt(matcher->params.maxSearchSize/(double)obsPtr->searchSize));
+                           roi = expectedPointRoi(obsPtr);
                         }
 								else // Segment
 								{
@@ -339,12 +375,14 @@ namespace jafar {
 									roi = RoiSpec(rect);
 								}
 								// 1d. match predicted feature in search area
-								//						kernel::Chrono match_chrono;
+								kernel::Chrono match_chrono;
 								matcher->match(rawData, obsPtr->predictedAppearance, roi, obsPtr->measurement, obsPtr->observedAppearance);
-								//						total_match_time += match_chrono.elapsedMicrosecond();
+								matchStats.matchTime += match_chrono.elapsedMicrosecond() * 1e-6;
+								matchStats.nSearch++;
 
 								// 1e. if feature is found
 								if (obsPtr->getMatchScore() > matcher->params.threshold) {
+									matchStats.nMatch++;
 									obsPtr->events.matched = true;
 									obsPtr->computeInnovation();
 
@@ -415,6 +453,8 @@ namespace jafar {
 			ransacSetList.clear();
 			obsBaseList.clear();
 			obsFailedList.clear();
+
+			saveGyroPose(rawData->timestamp);
 		}
 
 
@@ -425,9 +465,18 @@ namespace jafar {
 			boost::shared_ptr<RawSpec> rawData = SPTR_CAST<RawSpec>(data);			
 			updateVisibleObs();
 			obsVisibleList.clear();
+
+			// 1. Follow the features detected in the previous frames, and initialize those that were tracked long enough
+			if (algorithmParams.n_candidate_frames > 0)
+			{
+				trackCandidates(rawData);
+				promoteCandidates(rawData);
+			}
 			
+			// when the map is full, the map manager may delete its least useful landmarks for the new ones,
+			// that are detected in the empty cells of the grid
 			for(unsigned i = 0; i < algorithmParams.n_init; )
-			if (mapManagerPtr()->mapSpaceForInit()) {
+			if (mapManagerPtr()->mapSpaceForInit(sensorPtr()) || mapManagerPtr()->canMakeSpace()) {
 				//boost::shared_ptr<RawImage> rawDataSpec = SPTR_CAST<RawImage>(rawData);
 				RoiSpec roi;
 				if (featMan->getRoi(roi)) {
@@ -437,56 +486,26 @@ namespace jafar {
 					boost::shared_ptr<FeatureSpec> featPtr;
 					if (detector->detect(rawData, roi, featPtr))
 					{
-						// 2a. Create the lmk and associated obs object.
-						observation_ptr_t obsPtr =
-								mapManagerPtr()->createNewLandmark(shared_from_this());
-
-						// 2b. fill data for this obs
-						obsPtr->counters.nSearch = 1;
-						obsPtr->counters.nMatch = 1;
-						obsPtr->counters.nInlier = 1;
-						obsPtr->events.visible = true;
-						obsPtr->events.predicted = false;
-						obsPtr->events.measured = true;
-						obsPtr->events.matched = false;
-						obsPtr->events.updated = true;
-                  obsPtr->measurement = featPtr->measurement;
-
-						// 2c. compute and fill stochastic data for the landmark
-						obsPtr->backProject();
-
-						// 2d. Create lmk descriptor
-						detector->fillDataObs(featPtr, obsPtr);
-
-						// FIXME maybe adjust roi to prevent from detecting points too close to edge compared to descriptor size
-						// it would be better if we could check that the descriptor cannot be build before adding the landmark to the map...
-						if (obsPtr->updateDescriptor())
+						if (algorithmParams.n_candidate_frames > 0 && featPtr->measurement.size() == 2)
 						{
-							#if VISIBILITY_MAP
-							obsPtr->updateVisibilityMap();
-							#endif
-							featMan->addObs(obsPtr->measurement.x());
-							
-//#ifndef JFR_NDEBUG
-#if 0
-							// check that point is correlated very close from the source (because of interpolation, and to check bugs)
-							obsPtr->project();
-							if (obsPtr->predictAppearance())
-							{
-								jblas::sym_mat P = jblas::identity_mat(obsPtr->expectation.size())*jmath::sqr(4.0);
-								RoiSpec roi(obsPtr->expectation.x(), P, 1.0);
-								obsPtr->searchSize = roi.count();
-								matcher->match(rawData, obsPtr->predictedAppearance, roi, obsPtr->measurement, obsPtr->observedAppearance);
-								JFR_ASSERT(ublas::norm_2(obsPtr->measurement.x()-obsPtr->expectation.x()) <= 0.01);
-							}
-#endif
-							
+							// 2. Track the feature before creating the landmark
+							CandidateTrack track;
+							track.featPtr = featPtr;
+							track.refAppearance.reset(featPtr->appearancePtr->clone());
+							track.senPose = sensorPtr()->globalPose();
+							track.meas = featPtr->measurement.x();
+							track.nFrames = 0;
+							candidateList.push_back(track);
+							featMan->addObs(featPtr->measurement.x());
 							++i;
 						} else
-						{
-							obsPtr->landmarkPtr()->mapManagerPtr()->unregisterLandmark(obsPtr->landmarkPtr());
+						if (!mapManagerPtr()->makeSpaceForInit(sensorPtr()))
+							break;
+						else
+						if (initNewLandmark(featPtr, rawData))
+							++i;
+						else
 							featMan->setFailed(roi);
-						}
 					} else // create&init
 					{
 						featMan->setFailed(roi);
@@ -495,6 +514,115 @@ namespace jafar {
 			} else break; // if space in map
 		} // detect()
 
+
+		template<class RawSpec,class SensorSpec, class FeatureSpec, class RoiSpec, class FeatureManagerSpec, class DetectorSpec, class MatcherSpec>
+		bool DataManagerOnePointRansac<RawSpec,SensorSpec,FeatureSpec,RoiSpec,FeatureManagerSpec,DetectorSpec,MatcherSpec>::
+		initNewLandmark(const boost::shared_ptr<FeatureSpec> & featPtr, boost::shared_ptr<RawSpec> rawData, const CandidateTrack * track)
+		{
+			// 2a. Create the lmk and associated obs object.
+			observation_ptr_t obsPtr =
+					mapManagerPtr()->createNewLandmark(shared_from_this());
+
+			// 2b. fill data for this obs
+			obsPtr->counters.nSearch = 1;
+			obsPtr->counters.nMatch = 1;
+			obsPtr->counters.nInlier = 1;
+			obsPtr->events.visible = true;
+			obsPtr->events.predicted = false;
+			obsPtr->events.measured = true;
+			obsPtr->events.matched = false;
+			obsPtr->events.updated = true;
+			obsPtr->measurement = featPtr->measurement;
+
+			// 2c. get the distance prior from the parallax of the track, if any, and reject the tracks that are not a static point
+			if (track && algorithmParams.candidate_parallax_prior)
+			{
+				double error;
+				obsPtr->triangulatePrior(track->senPose, track->meas, error);
+				if (error > matcher->params.mahalanobisTh * sqrt(2.0) * matcher->params.measStd)
+				{
+					obsPtr->landmarkPtr()->mapManagerPtr()->unregisterLandmark(obsPtr->landmarkPtr());
+					return false;
+				}
+			}
+
+			// 2d. compute and fill stochastic data for the landmark, drop the features that cannot be undistorted
+			if (!obsPtr->backProject())
+			{
+				obsPtr->landmarkPtr()->mapManagerPtr()->unregisterLandmark(obsPtr->landmarkPtr());
+				return false;
+			}
+
+			// 2e. Create lmk descriptor
+			detector->fillDataObs(featPtr, obsPtr);
+
+			// FIXME maybe adjust roi to prevent from detecting points too close to edge compared to descriptor size
+			// it would be better if we could check that the descriptor cannot be build before adding the landmark to the map...
+			if (obsPtr->updateDescriptor())
+			{
+				#if VISIBILITY_MAP
+				obsPtr->updateVisibilityMap();
+				#endif
+				if (!track) featMan->addObs(obsPtr->measurement.x()); // a track was added to the grid when it was matched in this frame
+				
+//#ifndef JFR_NDEBUG
+#if 0
+				// check that point is correlated very close from the source (because of interpolation, and to check bugs)
+				obsPtr->project();
+				if (obsPtr->predictAppearance())
+				{
+					jblas::sym_mat P = jblas::identity_mat(obsPtr->expectation.size())*jmath::sqr(4.0);
+					RoiSpec roi(obsPtr->expectation.x(), P, 1.0);
+					obsPtr->searchSize = roi.count();
+					matcher->match(rawData, obsPtr->predictedAppearance, roi, obsPtr->measurement, obsPtr->observedAppearance);
+					JFR_ASSERT(ublas::norm_2(obsPtr->measurement.x()-obsPtr->expectation.x()) <= 0.01);
+				}
+#endif
+				
+				return true;
+			} else
+			{
+				obsPtr->landmarkPtr()->mapManagerPtr()->unregisterLandmark(obsPtr->landmarkPtr());
+				return false;
+			}
+		}
+
+
+		template<class RawSpec,class SensorSpec, class FeatureSpec, class RoiSpec, class FeatureManagerSpec, class DetectorSpec, class MatcherSpec>
+		void DataManagerOnePointRansac<RawSpec,SensorSpec,FeatureSpec,RoiSpec,FeatureManagerSpec,DetectorSpec,MatcherSpec>::
+		trackCandidates(boost::shared_ptr<RawSpec> rawData)
+		{
+			jblas::sym_mat P = jblas::identity_mat(2) * jmath::sqr(algorithmParams.candidate_search);
+			for(typename CandidateTrackList::iterator it = candidateList.begin(); it != candidateList.end(); )
+			{
+				// match the appearance at detection around the last position, the new measurement and appearance replace the last ones
+				boost::shared_ptr<FeatureSpec> featPtr = it->featPtr;
+				RoiSpec roi(featPtr->measurement.x(), P, 1.0);
+				matcher->match(rawData, it->refAppearance, roi, featPtr->measurement, featPtr->appearancePtr);
+				if (featPtr->measurement.matchScore > matcher->params.threshold && roi.isIn(featPtr->measurement.x()))
+				{
+					it->nFrames++;
+					featMan->addObs(featPtr->measurement.x());
+					++it;
+				} else
+					it = candidateList.erase(it); // lost, it would not have been a good landmark
+			}
+		}
+
+
+		template<class RawSpec,class SensorSpec, class FeatureSpec, class RoiSpec, class FeatureManagerSpec, class DetectorSpec, class MatcherSpec>
+		void DataManagerOnePointRansac<RawSpec,SensorSpec,FeatureSpec,RoiSpec,FeatureManagerSpec,DetectorSpec,MatcherSpec>::
+		promoteCandidates(boost::shared_ptr<RawSpec> rawData)
+		{
+			for(typename CandidateTrackList::iterator it = candidateList.begin(); it != candidateList.end(); )
+			{
+				if (it->nFrames < algorithmParams.n_candidate_frames) { ++it; continue; }
+				if (!mapManagerPtr()->makeSpaceForInit(sensorPtr())) break;
+				initNewLandmark(it->featPtr, rawData, &(*it));
+				it = candidateList.erase(it);
+			}
+		}
+
 #if 0
 		template<class RawSpec,class SensorSpec, class FeatureSpec, class RoiSpec, class FeatureManagerSpec, class DetectorSpec, class MatcherSpec>
 		void DataManagerOnePointRansac<RawSpec,SensorSpec,FeatureSpec,RoiSpec,FeatureManagerSpec,DetectorSpec,MatcherSpec>::
@@ -513,6 +641,7 @@ namespace jafar {
 		projectAndCollectVisibleObs()
 		{
 			obsVisibleList.clear();
+			mapManagerPtr()->manageObservations(shared_from_this());
 
 			for(ObservationList::iterator obsIter = observationList().begin(); obsIter != observationList().end();obsIter++)
 			{
@@ -521,6 +650,8 @@ namespace jafar {
 				obsPtr->clearFlags();
 				obsPtr->counters.nFrameSinceLastVisible++;
 				obsPtr->measurement.matchScore = 0;
+				if (gyroAid.valid) obsPtr->appearancePosePtr = gyroAid.senPosePtr;
+				              else obsPtr->appearancePosePtr.reset();
 
 				#if PROJECT_MEAN_VISIBILITY
 				obsPtr->projectMean();
@@ -552,6 +683,13 @@ namespace jafar {
 				} // visible obs
 			} // for each obs
 			remainingObsCount = obsVisibleList.size();
+
+			// the states read by the hypotheses, their covariances must be up to date
+			ia_visible = jblas::ind_array(0);
+			for(ObsList::iterator obsIter = obsVisibleList.begin(); obsIter != obsVisibleList.end(); obsIter++)
+				ia_visible = jmath::ublasExtra::ia_union(ia_visible, (*obsIter)->ia_rsl);
+			mapManagerPtr()->mapPtr()->filterPtr->recover(ia_visible);
+			P_visible = mapManagerPtr()->mapPtr()->filterPtr->marginal(ia_visible);
 		}
 
 		template<class RawSpec,class SensorSpec, class FeatureSpec, class RoiSpec, class FeatureManagerSpec, class DetectorSpec, class MatcherSpec>
@@ -585,6 +723,15 @@ namespace jafar {
 //				obsBasePtr = selectOneRandomObs();
 				if (remainingObsCount <= 0) { obsBasePtr.reset(); return; }
 				int n = rtslam::rand()%remainingObsCount;
+				if (baseCells.size() > 1)
+				{
+					// prefer a cell of the image where there is no base obs yet, and start again when they all have one
+					unsigned k;
+					for (k = 0; k < remainingObsCount; ++k)
+						if (!baseCells[baseCell(obsVisibleList[(n + k) % remainingObsCount])]) break;
+					if (k < remainingObsCount) n = (n + k) % remainingObsCount;
+					                      else baseCells.assign(baseCells.size(), false);
+				}
 				obsBasePtr = obsVisibleList[n];
 
 // JFR_DEBUG("getOneMatchedBaseObs: trying obs " << obsBasePtr->id() << " already matched " << obsBasePtr->events.matched);
@@ -603,6 +750,7 @@ namespace jafar {
 				if (obsBasePtr->events.matched)
 				{
 					obsBaseList.push_back(obsBasePtr);
+					if (baseCells.size() > 1) baseCells[baseCell(obsBasePtr)] = true;
 					matchedBase = true;
 				}
 				
@@ -619,12 +767,11 @@ namespace jafar {
 		{
 			// get map things
 			vec x_copy = mapManagerPtr()->mapPtr()->x();
-			ind_array ia_x = mapManagerPtr()->mapPtr()->ia_used_states();
-			sym_mat &P = mapManagerPtr()->mapPtr()->P();
+			const ind_array & ia_x = ia_visible; // only the visible observations are projected with the copy
 
 			// compute Kalman gain
 			mat K(ia_x.size(), obsPtr->innovation.size());
-			kalman::computeKalmanGain(P, ia_x, obsPtr->innovation, obsPtr->INN_rsl, obsPtr->ia_rsl, K);
+			kalman::computeKalmanGain(P_visible, jmath::ublasExtra::ia_set(0, ia_x.size()), obsPtr->innovation, obsPtr->INN_rsl, visiblePos(obsPtr->ia_rsl), K);
 
 			// perform state update to the mean, get temporary copy
 			ublas::project(x_copy, ia_x) += ublas::prod(K, obsPtr->innovation.x());
@@ -633,6 +780,84 @@ namespace jafar {
 		}
 
 
+		/*
+		 * Same as updateMean(obsPtr) with the stacked innovations of several observations.
+		 */
+		template<class RawSpec,class SensorSpec, class FeatureSpec, class RoiSpec, class FeatureManagerSpec, class DetectorSpec, class MatcherSpec>
+		vec DataManagerOnePointRansac<RawSpec,SensorSpec,FeatureSpec,RoiSpec,FeatureManagerSpec,DetectorSpec,MatcherSpec>::
+		updateMean(const ObsList & obsList)
+		{
+			// get map things
+			vec x_copy = mapManagerPtr()->mapPtr()->x();
+			const ind_array & ia_x = ia_visible; // only the visible observations are projected with the copy
+			const sym_mat & P = P_visible;
+			const ind_array pos_x = jmath::ublasExtra::ia_set(0, ia_x.size());
+			std::vector<ind_array> pos_rsl(obsList.size());
+			for (size_t i = 0; i < obsList.size(); ++i) pos_rsl[i] = visiblePos(obsList[i]->ia_rsl);
+
+			// stacked innovation, its covariance, and P * INN_x' (cross covariance)
+			size_t size = 0;
+			for (size_t i = 0; i < obsList.size(); ++i) size += obsList[i]->innovation.size();
+			vec z(size);
+			mat S(size, size);
+			mat PINNt(ia_x.size(), size);
+			for (size_t i = 0, oi = 0; i < obsList.size(); oi += obsList[i]->innovation.size(), ++i)
+			{
+				const observation_ptr_t & obsI = obsList[i];
+				size_t si = obsI->innovation.size();
+				ublas::subrange(z, oi, oi+si) = obsI->innovation.x();
+				ublas::subrange(PINNt, 0, ia_x.size(), oi, oi+si) = ublas::prod(ublas::project(P, pos_x, pos_rsl[i]), ublas::trans(obsI->INN_rsl));
+				ublas::subrange(S, oi, oi+si, oi, oi+si) = obsI->innovation.P();
+				for (size_t j = 0, oj = 0; j < i; oj += obsList[j]->innovation.size(), ++j)
+				{
+					const observation_ptr_t & obsJ = obsList[j];
+					size_t sj = obsJ->innovation.size();
+					mat Sij = ublas::prod(obsI->INN_rsl, ublas::prod<mat>(ublas::project(P, pos_rsl[i], pos_rsl[j]), ublas::trans(obsJ->INN_rsl)));
+					ublas::subrange(S, oi, oi+si, oj, oj+sj) = Sij;
+					ublas::subrange(S, oj, oj+sj, oi, oi+si) = ublas::trans(Sij);
+				}
+			}
+			mat iS(size, size);
+			jmath::ublasExtra::lu_inv(S, iS);
+
+			// perform state update to the mean, get temporary copy
+			ublas::project(x_copy, ia_x) -= ublas::prod(PINNt, ublas::prod(iS, z));
+
+			return x_copy;
+		}
+
+
+		template<class RawSpec,class SensorSpec, class FeatureSpec, class RoiSpec, class FeatureManagerSpec, class DetectorSpec, class MatcherSpec>
+		jblas::ind_array DataManagerOnePointRansac<RawSpec,SensorSpec,FeatureSpec,RoiSpec,FeatureManagerSpec,DetectorSpec,MatcherSpec>::
+		visiblePos(const jblas::ind_array & ia)
+		{
+			jblas::ind_array res(ia.size());
+			for (size_t i = 0; i < ia.size(); ++i)
+			{
+				size_t j = 0;
+				while (j < ia_visible.size() && ia_visible(j) != ia(i)) ++j;
+				JFR_ASSERT(j < ia_visible.size(), "DataManagerOnePointRansac::visiblePos: state not visible");
+				res(i) = j;
+			}
+			return res;
+		}
+
+
+		template<class RawSpec,class SensorSpec, class FeatureSpec, class RoiSpec, class FeatureManagerSpec, class DetectorSpec, class MatcherSpec>
+		size_t DataManagerOnePointRansac<RawSpec,SensorSpec,FeatureSpec,RoiSpec,FeatureManagerSpec,DetectorSpec,MatcherSpec>::
+		baseCell(const observation_ptr_t & obsPtr)
+		{
+			unsigned strata = algorithmParams.ransac_strata;
+			double width = sensorSpecPtr()->params.width, height = sensorSpecPtr()->params.height;
+			if (width <= 0 || height <= 0) return 0;
+			int i = (int)(obsPtr->expectation.x()(0) * strata / width);
+			int j = (int)(obsPtr->expectation.x()(1) * strata / height);
+			i = std::min(std::max(i, 0), (int)strata-1);
+			j = std::min(std::max(j, 0), (int)strata-1);
+			return j * strata + i;
+		}
+
+
 		template<class RawSpec,class SensorSpec, class FeatureSpec, class RoiSpec, class FeatureManagerSpec, class DetectorSpec, class MatcherSpec>
 		void DataManagerOnePointRansac<RawSpec,SensorSpec,FeatureSpec,RoiSpec,FeatureManagerSpec,DetectorSpec,MatcherSpec>::
 		projectFromMean(vec & exp, const observation_ptr_t & obsPtr, const vec & x)
@@ -688,9 +913,7 @@ namespace jafar {
             RoiSpec roi;
             if(obsPtr->expectation.P().size1() == 2) // basically DsegMatcher handles it's own roi and having a size4 expectation the following roi computation fails, hence the test  - TODO clean up all this, is should not mess with One point ransac
             {
-               roi = RoiSpec(obsPtr->expectation.x(), obsPtr->expectation.P() + matcher->params.measVar*identity_mat(2), matcher->params.mahalanobisTh);
-               obsPtr->searchSize = roi.count();
-               if (obsPtr->searchSize > matcher->params.maxSearchSize) roi.scale(sqrt(matcher->params.maxSearchSize/(double)obsPtr->searchSize));
+               roi = expectedPointRoi(obsPtr);
 				}
 				else // Segment
 				{
@@ -713,15 +936,126 @@ namespace jafar {
 					);
 					roi = RoiSpec(rect);
 				}
+				kernel::Chrono match_chrono;
 				matcher->match(rawData, obsPtr->predictedAppearance, roi, obsPtr->measurement, obsPtr->observedAppearance);
+				matchStats.matchTime += match_chrono.elapsedMicrosecond() * 1e-6;
+				matchStats.nSearch++;
 // JFR_DEBUG("obs " << obsPtr->id() << " expected at " << obsPtr->expectation.x() << " measured with innovation " << obsPtr->measurement.x()-obsPtr->expectation.x());
 
-				return (obsPtr->getMatchScore() > matcher->params.threshold && isExpectedInnovationInlier(obsPtr, matcher->params.mahalanobisTh));
+				bool matched = (obsPtr->getMatchScore() > matcher->params.threshold && isExpectedInnovationInlier(obsPtr, matcher->params.mahalanobisTh));
+				if (matched) matchStats.nMatch++;
+				return matched;
 			} else
 				return false;
 		}
 
 
+		template<class RawSpec,class SensorSpec, class FeatureSpec, class RoiSpec, class FeatureManagerSpec, class DetectorSpec, class MatcherSpec>
+		RoiSpec DataManagerOnePointRansac<RawSpec,SensorSpec,FeatureSpec,RoiSpec,FeatureManagerSpec,DetectorSpec,MatcherSpec>::
+		expectedPointRoi(const observation_ptr_t & obsPtr)
+		{
+			RoiSpec roi(obsPtr->expectation.x(), obsPtr->expectation.P() + matcher->params.measVar*identity_mat(2), matcher->params.mahalanobisTh);
+			obsPtr->searchSize = roi.count();
+
+			if (gyroAid.valid)
+			{
+				// project from the sensor pose predicted with the gyrometers, with the uncertainties of this pose and of the landmark
+				vec lmk = obsPtr->landmarkPtr()->state.x();
+				vec exp, nobs;
+				mat EXP_sg(2, 7), EXP_l(2, lmk.size());
+				obsPtr->model->project_func(*gyroAid.senPosePtr, lmk, exp, nobs, EXP_sg, EXP_l);
+				if (obsPtr->model->predictVisibility_func(exp, nobs))
+				{
+					sym_mat P = jmath::ublasExtra::prod_JPJt(gyroAid.senPoseCov, EXP_sg)
+					          + jmath::ublasExtra::prod_JPJt(obsPtr->landmarkPtr()->state.P(), EXP_l)
+					          + matcher->params.measVar*identity_mat(2);
+					RoiSpec gyroRoi(exp, P, matcher->params.mahalanobisTh);
+					if (gyroRoi.count() < obsPtr->searchSize)
+					{
+						roi = gyroRoi;
+						obsPtr->searchSize = roi.count();
+						matchStats.nGyroRoi++;
+					}
+				}
+			}
+
+			if (obsPtr->searchSize > matcher->params.maxSearchSize) roi.scale(sqrt(matcher->params.maxSearchSize/(double)obsPtr->searchSize));
+			return roi;
+		}
+
+
+		/*
+		 * The robot orientation is the one estimated at the previous frame rotated by the integrated gyrometers,
+		 * and its position is the one predicted by the motion model. The uncertainty of the orientation
+		 * is the one of the previous estimate plus the gyrometer noise and bias over the interval.
+		 */
+		template<class RawSpec,class SensorSpec, class FeatureSpec, class RoiSpec, class FeatureManagerSpec, class DetectorSpec, class MatcherSpec>
+		void DataManagerOnePointRansac<RawSpec,SensorSpec,FeatureSpec,RoiSpec,FeatureManagerSpec,DetectorSpec,MatcherSpec>::
+		predictGyroPose(double time)
+		{
+			gyroAid.valid = false;
+			if (!gyroAid.estimatorPtr || gyroAid.prevTime < 0. || time <= gyroAid.prevTime) return;
+
+			// integrate the gyrometers between the frames
+			jblas::mat_indirect readings = gyroAid.estimatorPtr->acquireReadings(gyroAid.prevTime, time);
+			size_t n = readings.size1();
+			vec4 dq = quaternion::identQ();
+			double t = gyroAid.prevTime;
+			for (size_t i = 0; i < n; ++i)
+			{
+				double t_next = (i+1 < n ? std::min(readings(i+1, 0), time) : time);
+				if (t_next <= t) continue;
+				vec3 v;
+				for (size_t j = 0; j < 3; ++j) v(j) = readings(i, gyroAid.column + j) * (t_next - t);
+				dq = quaternion::qProd(dq, quaternion::v2q(v));
+				t = t_next;
+			}
+			gyroAid.estimatorPtr->releaseReadings();
+			if (n == 0) return;
+			double dt = time - gyroAid.prevTime;
+
+			// robot pose
+			robot_ptr_t robPtr = sensorPtr()->robotPtr();
+			vec7 robPose = robPtr->pose.x();
+			vec4 q;
+			mat Q_qprev(4, 4), Q_dq(4, 4);
+			quaternion::qProd(gyroAid.prevQ, dq, q, Q_qprev, Q_dq);
+			ublas::subrange(robPose, 3, 7) = q;
+
+			// its covariance, with a small rotation error e applied to the increment: dq' = dq * v2q(e)
+			mat DQ_dq(4, 4), Q_e(4, 3);
+			quaternion::qProd_by_dq2(dq, DQ_dq);
+			Q_e = 0.5 * ublas::prod(Q_dq, ublas::subrange(DQ_dq, 0, 4, 1, 4));
+			double varAngle = jmath::sqr(gyroAid.noise) * dt + jmath::sqr(gyroAid.biasStd * dt);
+			sym_mat robPoseCov(7, 7);
+			robPoseCov.clear();
+			ublas::subrange(robPoseCov, 0, 3, 0, 3) = ublas::subrange(robPtr->pose.P(), 0, 3, 0, 3);
+			ublas::subrange(robPoseCov, 3, 7, 3, 7) = jmath::ublasExtra::prod_JPJt(gyroAid.prevQCov, Q_qprev)
+			                                        + varAngle * ublas::prod(Q_e, ublas::trans(Q_e));
+
+			// global sensor pose
+			vec7 senPose;
+			mat SG_r(7, 7), SG_s(7, 7);
+			quaternion::composeFrames(robPose, sensorPtr()->pose.x(), senPose, SG_r, SG_s);
+			if (!gyroAid.senPosePtr) gyroAid.senPosePtr.reset(new vec7());
+			*gyroAid.senPosePtr = senPose;
+			gyroAid.senPoseCov = jmath::ublasExtra::prod_JPJt(robPoseCov, SG_r);
+			gyroAid.valid = true;
+		}
+
+
+		template<class RawSpec,class SensorSpec, class FeatureSpec, class RoiSpec, class FeatureManagerSpec, class DetectorSpec, class MatcherSpec>
+		void DataManagerOnePointRansac<RawSpec,SensorSpec,FeatureSpec,RoiSpec,FeatureManagerSpec,DetectorSpec,MatcherSpec>::
+		saveGyroPose(double time)
+		{
+			if (!gyroAid.estimatorPtr) return;
+			robot_ptr_t robPtr = sensorPtr()->robotPtr();
+			gyroAid.prevQ = ublas::subrange(robPtr->pose.x(), 3, 7);
+			gyroAid.prevQCov = ublas::subrange(robPtr->pose.P(), 3, 7, 3, 7);
+			gyroAid.prevTime = time;
+		}
+
+
 	} // namespace ::rtslam
 } // namespace jafar::
 
@@ -24,7 +24,24 @@ namespace rtslam {
 			robot_ptr_t robPtr;
 		public:
 			ExporterAbstract(robot_ptr_t robPtr): robPtr(robPtr) {}
-			virtual void exportCurrentState() = 0;
+			/**
+			Export the filtered state of the robot, from the marginals of the map if they are up to date.
+			*/
+			virtual void exportCurrentState()
+			{
+				jblas::vec x;
+				jblas::sym_mat P;
+				if (!robPtr->mapPtr()->marginals.get(robPtr->state.ia(), x, P))
+				{
+					x = robPtr->state.x();
+					P = robPtr->state.P();
+				}
+				exportState(robPtr->self_time, x, P);
+			}
+			/**
+			Export a state of the robot, eg predicted by a PosePredictor. It can be called from another thread.
+			*/
+			virtual void exportState(double time, const jblas::vec & x, const jblas::sym_mat & P) = 0;
 			virtual void stop() {}
 	};
 	
@@ -38,7 +55,7 @@ namespace rtslam {
 			{
 			
 			}
-			virtual void exportCurrentState()
+			virtual void exportState(double time, const jblas::vec & x, const jblas::sym_mat & P)
 			{
 				
 				
@@ -91,7 +91,7 @@ namespace rtslam {
 				boost::thread thread_send(boost::bind(&ExporterSocket::sendTask, this));
 			}
 			
-			virtual void exportCurrentState()
+			virtual void exportState(double time, const jblas::vec & state, const jblas::sym_mat & stateCov)
 			{
 				if (mutex_data.try_lock())
 				{
@@ -104,9 +104,7 @@ namespace rtslam {
 					
 					robot : p q v ab wb g
 					*/
-					jblas::vec &state = robPtr->mapPtr()->filterPtr->x();
-					jblas::sym_mat &stateCov = robPtr->mapPtr()->filterPtr->P();
-					message[0] = robPtr->self_time;
+					message[0] = time;
 					for(int i = 0; i < 3; ++i) message[i+1] = state(i)+robPtr->origin_sensors(i)-robPtr->origin_export(i);
 					for(int i = 3; i < 7; ++i) message[i+1] = state(i);
 					jblas::vec3 euler = quaternion::q2e(ublas::subrange(state,3,7));
@@ -0,0 +1,101 @@
+/**
+ * \file fastDetector.hpp
+ *
+ * \date 17/10/2026
+ * \author jsola
+ *
+ *  \ingroup rtslam
+ */
+
+#ifndef FASTDETECTOR_HPP_
+#define FASTDETECTOR_HPP_
+
+#include <vector>
+
+#include "image/Image.hpp"
+#include "image/roi.hpp"
+
+#include "rtslam/featurePoint.hpp"
+
+
+namespace jafar{
+	namespace rtslam{
+
+		/**
+		 * FAST corner detector class (Rosten and Drummond, 2006).
+		 * \ingroup rtslam
+		 * \author jsola
+		 *
+		 * A pixel is a corner if at least \a arc contiguous pixels of the circle of radius 3 around it
+		 * (16 pixels) are all brighter than the center plus the threshold, or all darker than the center
+		 * minus the threshold. The usual arcs are 9 (FAST-9) and 12 (FAST-12).
+		 *
+		 * The segment test is only a few comparisons per pixel, and it is done on 16 pixels at once with SSE2
+		 * when available. The pixels are first tested on the 4 compass points of the circle,
+		 * that reject most of them before the full test.
+		 *
+		 * The candidates are scored either with the FAST score, the sum of the absolute differences
+		 * above the threshold over the brighter or darker pixels, or with the same Harris score as
+		 * QuickHarrisDetector, which is then only computed at the candidates and is thresholded
+		 * and tested for edges as QuickHarrisDetector does.
+		 *
+		 * As QuickHarrisDetector, detectIn() extracts the best point inside a region of interest,
+		 * which does not need non-maximum suppression. detectAll() extracts all the corners of a region,
+		 * for instance the whole image, with a 3x3 non-maximum suppression.
+		 */
+		class FastDetector {
+			public:
+				struct corner_t {
+					int x, y; ///< pixel coordinates
+					float score;
+				};
+
+				/**
+				 * \param arc the min number of contiguous pixels of the circle, from 9 to 16
+				 * \param threshold the intensity difference with the center
+				 * \param harrisScore score the candidates with the Harris score instead of the FAST score
+				 * \param convolutionBoxSize, harrisThreshold, edge the parameters of the Harris score, see QuickHarrisDetector
+				 */
+				FastDetector(int arc = 9, int threshold = 20, bool harrisScore = false,
+					int convolutionBoxSize = 5, float harrisThreshold = 15.0, float edge = 2.0);
+
+				bool detectIn(image::Image const& image, feat_img_pnt_ptr_t featPtr, const image::ConvexRoi * roiPtr = 0);
+				/// all the corners of the region with non-maximum suppression, the whole image if \a roiPtr is 0
+				void detectAll(image::Image const& image, std::vector<corner_t> & corners, const image::ConvexRoi * roiPtr = 0);
+
+				/// number of pixels of the region that passed the segment test in the last detection
+				unsigned nCandidates() const { return m_nCandidates; }
+
+			private:
+				bool clip(const image::Image & image, const image::ConvexRoi * roiPtr, int & x0, int & y0, int & x1, int & y1);
+				/// the center of the pixel is in the region, or there is no region
+				bool inRoi(const image::ConvexRoi * roiPtr, int x, int y);
+				void setOffsets(int step);
+				/// segment test of the pixels x0 to x1 (excluded) of row y, hits[x-x0] is 1 for the corners
+				void segmentTest(const image::Image & image, int y, int x0, int x1, unsigned char * hits);
+				bool segmentTest(const uchar * pix);
+				float score(const image::Image & image, int x, int y);
+				float fastScore(const uchar * pix);
+				float harrisScore(const image::Image & image, int x, int y);
+
+			private:
+				int m_arc;
+				int m_threshold;
+				bool m_harrisScore;
+				int m_convolutionSize;
+				float m_harrisThreshold;
+				float m_edge;
+				double normCoeff;
+				int m_border; ///< pixels around the corners used by the segment test and the score
+
+				int m_step; ///< row step of the image the offsets were computed for
+				int m_offsets[16]; ///< offsets of the pixels of the circle
+				std::vector<unsigned char> m_hits;
+				std::vector<float> m_scores;
+				unsigned m_nCandidates;
+		};
+	}
+}
+
+
+#endif /* FASTDETECTOR_HPP_ */
@@ -263,6 +263,8 @@ namespace jafar {
 				 *
 				 * In case the input Gaussian is REMOTE, a composition of indirect arrays is performed,
 				 * and the resulting Gaussian points to the Gaussian where the remote Gaussian points to.
+				 * The covariances are composed with the indices of \a G in its own covariances matrix,
+				 * which are not those of the mean if \a G has a covariances block (see the constructor from a block below).
 				 *
 				 * The local storage \a x_local and \a P_local in the constructed Gaussian are kept at null size for economy.
 				 * \param G a Gaussian.
@@ -277,7 +279,7 @@ namespace jafar {
 					//     # check storage   ?                   # is local                   :             # is remote
 					ia_(G.storage_ == LOCAL  ?  _ia                                           : G.ia_.compose(_ia)),
 					x_ (G.storage_ == LOCAL  ?  jblas::vec_indirect     (G.x_local, ia_)      : jblas::vec_indirect     (G.x_.data(), ia_, 1)     ),
-					P_ (G.storage_ == LOCAL  ?  jblas::sym_mat_indirect (G.P_local, ia_, ia_) : jblas::sym_mat_indirect (G.P_.data(), ia_, ia_, 1))
+					P_ (G.storage_ == LOCAL  ?  jblas::sym_mat_indirect (G.P_local, ia_, ia_) : jblas::sym_mat_indirect (G.P_.data(), G.P_.indirect1().compose(_ia), G.P_.indirect2().compose(_ia), 1))
 				{
 				}
 
@@ -306,6 +308,30 @@ namespace jafar {
 				}
 
 
+				/**
+				 * Remote constructor from a mean vector and a covariances block.
+				 * The mean points to a part of the remote vector \a _x, as in the constructor above,
+				 * but the covariances are the whole matrix \a _P, which only holds the covariances of these states.
+				 * This is for the filters that do not keep the covariances of all the states in one matrix.
+				 * The result is such that the new Gaussian Gnew has <i> x_ = _x(_ia) </i> and <i> P_ = _P.</i>
+				 * \param _x the remote mean vector.
+				 * \param _ia the indirect array of the mean.
+				 * \param _P the remote covariances matrix, of the size of \a _ia.
+				 */
+				inline Gaussian(jblas::vec & _x, const jblas::ind_array& _ia, jblas::sym_mat & _P) :
+					hasNullCov_ (false),
+					size_       (_ia.size()),
+					storage_    (REMOTE),
+					x_local     (0),
+					P_local     (0),
+					ia_         (_ia),
+					x_          (_x, ia_),
+					P_          (_P, jafar::jmath::ublasExtra::ia_set(0, size_), jafar::jmath::ublasExtra::ia_set(0, size_))
+				{
+					JFR_ASSERT(_P.size1() == size_, "gaussian::Gaussian():: ia and P sizes do not match.");
+				}
+
+
 				// Getters
 				inline bool                      hasNullCov() const    { return hasNullCov_; }
 				inline storage_t                 storage() const       { return storage_;    }
@@ -12,6 +12,11 @@
 #ifndef HARDWARE_ESTIMATOR_ABSTRACT_HPP_
 #define HARDWARE_ESTIMATOR_ABSTRACT_HPP_
 
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "jmath/jblas.hpp"
+
 namespace jafar {
 namespace rtslam {
 namespace hardware {
@@ -22,8 +27,19 @@ namespace hardware {
 
 	class HardwareEstimatorAbstract
 	{
+		public:
+			typedef boost::function<void(const jblas::vec &)> reading_callback_t;
 		protected:
 			bool started;
+			boost::mutex mutex_callback; ///< held while the callback is called or changed
+			reading_callback_t readingCallback;
+			/**
+			To be called by the acquisition thread for each new reading, after it is available to acquireReadings.
+			*/
+			void newReading(const jblas::vec & reading) {
+				boost::unique_lock<boost::mutex> l(mutex_callback);
+				if (readingCallback) readingCallback(reading);
+			}
 		public:
 			HardwareEstimatorAbstract(): started(false) {}
 			/**
@@ -48,6 +64,16 @@ namespace hardware {
 			virtual jblas::ind_array incrementValues() = 0;
 		
 			virtual void start() {}
+			/**
+			Set a function called in the acquisition thread for each new reading, with the same layout as
+			the lines of acquireReadings. It must return quickly to not delay the acquisition.
+			It waits for the end of the current call, if any, so that the previous function is not called
+			anymore when it returns and the object it refers to can be destroyed.
+			*/
+			void setReadingCallback(reading_callback_t callback) {
+				boost::unique_lock<boost::mutex> l(mutex_callback);
+				readingCallback = callback;
+			}
 	};
 
 }}}
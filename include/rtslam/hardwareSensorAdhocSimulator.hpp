@@ -13,6 +13,8 @@
 #define HARDWARESENSORADHOCSIMULATOR_HPP_
 
 #include "rtslam/simulator.hpp"
+#include "rtslam/simuImageRenderer.hpp"
+#include "rtslam/rawImage.hpp"
 #include "rtslam/hardwareSensorAbstract.hpp"
 
 namespace jafar {
@@ -26,6 +28,7 @@ namespace hardware {
 			size_t n;
 			boost::shared_ptr<simu::AdhocSimulator> simulator;
 			size_t robId, senId;
+			boost::shared_ptr<simu::ImageRenderer> renderer;
 		protected:
 			virtual void getTimingInfos(double &data_period, double &arrival_delay) { data_period=dt; arrival_delay=0.; }
 		public:
@@ -34,6 +37,12 @@ namespace hardware {
 				dt(1./freq), n(0), simulator(simulator), robId(robId), senId(senId) {}
 			virtual void start() {}
 			
+			/**
+			 * Produce rendered images (RawImage) instead of the simulated observations (RawSimu),
+			 * in order to use the real image processing. The renderer keeps the ground truth of the last image.
+			 */
+			void setImageRenderer(boost::shared_ptr<simu::ImageRenderer> renderer_) { renderer = renderer_; }
+			
 			int getRawInfo(size_t m, RawInfo &info)
 			{
 				info.timestamp = m*dt;
@@ -66,7 +75,18 @@ namespace hardware {
 			virtual void getRaw(unsigned id, raw_ptr_t& raw)
 			{
 				double t = id*dt;
-				raw = simulator->getRaw(robId, senId, t);
+				if (renderer)
+				{
+					jblas::vec7 senGlobPose;
+					rawimage_ptr_t rawImg(new RawImage());
+					rawImg->setJafarImage(jafarImage_ptr_t(new image::Image(renderer->width(), renderer->height(), CV_8U, JfrImage_CS_GRAY)));
+					rawImg->timestamp = t;
+					rawImg->arrival = t;
+					if (simulator->getSensorGlobalPose(robId, senId, t, senGlobPose))
+						renderer->render(senGlobPose, simulator->getPointLandmarks(t), id, *(rawImg->img));
+					raw = rawImg;
+				} else
+					raw = simulator->getRaw(robId, senId, t);
 				n = id+1;
 				return;
 			}
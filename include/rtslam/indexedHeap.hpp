@@ -0,0 +1,96 @@
+/**
+ * \file indexedHeap.hpp
+ *
+ * \date 17/10/2026
+ * \author jsola
+ *
+ *  \ingroup rtslam
+ */
+
+#ifndef INDEXEDHEAP_HPP_
+#define INDEXEDHEAP_HPP_
+
+#include <vector>
+#include <map>
+#include <utility>
+#include <cstddef>
+
+namespace jafar {
+	namespace rtslam {
+
+		/**
+		 * Binary min-heap of scores with an index of the keys.
+		 *
+		 * The score of a key can be changed or removed in O(log n), without searching the key in the heap,
+		 * so that the scores of the landmarks can be maintained at each frame and the lowest one found in O(1).
+		 * \ingroup rtslam
+		 */
+		template<class Key>
+		class IndexedMinHeap {
+			private:
+				typedef std::pair<double, Key> entry_t;
+				std::vector<entry_t> heap;
+				std::map<Key, size_t> index; ///< position of each key in the heap
+
+				void place(size_t i) { index[heap[i].second] = i; }
+				void swapEntries(size_t i, size_t j) { std::swap(heap[i], heap[j]); place(i); place(j); }
+				void up(size_t i) {
+					while (i > 0 && heap[i].first < heap[(i-1)/2].first) { swapEntries(i, (i-1)/2); i = (i-1)/2; }
+				}
+				void down(size_t i) {
+					while (true)
+					{
+						size_t m = i, l = 2*i+1, r = 2*i+2;
+						if (l < heap.size() && heap[l].first < heap[m].first) m = l;
+						if (r < heap.size() && heap[r].first < heap[m].first) m = r;
+						if (m == i) return;
+						swapEntries(i, m); i = m;
+					}
+				}
+
+			public:
+				size_t size() const { return heap.size(); }
+				bool empty() const { return heap.empty(); }
+				bool contains(const Key & key) const { return index.find(key) != index.end(); }
+				void clear() { heap.clear(); index.clear(); }
+
+				/// insert the key, or change its score
+				void update(const Key & key, double score) {
+					typename std::map<Key, size_t>::iterator it = index.find(key);
+					if (it == index.end())
+					{
+						heap.push_back(entry_t(score, key));
+						place(heap.size()-1);
+						up(heap.size()-1);
+					} else
+					{
+						size_t i = it->second;
+						double old = heap[i].first;
+						heap[i].first = score;
+						if (score < old) up(i); else down(i);
+					}
+				}
+
+				void remove(const Key & key) {
+					typename std::map<Key, size_t>::iterator it = index.find(key);
+					if (it == index.end()) return;
+					size_t i = it->second;
+					index.erase(it);
+					if (i == heap.size()-1) { heap.pop_back(); return; }
+					heap[i] = heap.back();
+					heap.pop_back();
+					place(i);
+					Key moved = heap[i].second;
+					up(i); down(index[moved]);
+				}
+
+				/// the key with the lowest score, the heap must not be empty
+				const Key & topKey() const { return heap.front().second; }
+				double topScore() const { return heap.front().first; }
+				void pop() { Key key = heap.front().second; remove(key); }
+		};
+
+	}
+}
+
+#endif /* INDEXEDHEAP_HPP_ */
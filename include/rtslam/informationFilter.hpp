@@ -0,0 +1,156 @@
+/**
+ * \file informationFilter.hpp
+ *
+ * Sparse extended information filter, for large maps
+ *
+ * \date 17/10/2026
+ * \author jsola
+ *
+ * \ingroup rtslam
+ */
+
+#ifndef INFORMATIONFILTER_HPP_
+#define INFORMATIONFILTER_HPP_
+
+#include <vector>
+#include <map>
+#include <list>
+
+#include "rtslam/kalmanFilter.hpp"
+
+namespace jafar {
+	namespace rtslam {
+		using namespace jblas;
+
+
+		/**
+		 * Sparse extended information filter (SEIF).
+		 * \ingroup rtslam
+		 *
+		 * The state is represented by the information matrix L = inv(P) and the information vector eta = L*x.
+		 * L is sparse, two states are linked only if they were involved in a same correction or motion,
+		 * and it is stored as a list of non-zero elements for each state. All the operations only touch the states
+		 * that they involve and their neighbours in L, so that their cost does not depend on the size of the map:
+		 * - the motion links the robot to its active landmarks, and these landmarks together,
+		 * - the corrections add information to the observed states,
+		 * - the robot is kept linked to at most \a maxActive landmarks: the links to the weakest ones
+		 *   are removed by sparsification, which keeps the filter consistent,
+		 * - the deleted landmarks and the states replaced by a reparametrization are marginalized out.
+		 *
+		 * The mean x() is recovered incrementally: after each correction it is solved exactly on the corrected states
+		 * and their neighbours, the other states being fixed, and \a relaxSize other states are refined by
+		 * Gauss-Seidel relaxation, cycling over the map.
+		 *
+		 * There is no dense covariances matrix, P() is empty: each map object has its own covariances block,
+		 * given by objectState(), so that the memory grows with the number of states and not with its square.
+		 * The covariances are computed by recover(): the robot after each prediction and correction, and the states
+		 * of the observations when they are projected. They are approximated by inverting L on the states and
+		 * their neighbours only, ie conditioned on the other states, so they are somewhat optimistic.
+		 * The covariances of the states recovered together last, with their cross-variances, are kept until L changes
+		 * and given by marginal(), so that recovering any subset of them, as the observations do one by one after
+		 * the data manager recovered all the visible ones, costs nothing. They are also copied to the blocks
+		 * of the map objects, the blocks of the objects that were not recovered are not up to date.
+		 *
+		 * The states that are not already in L when they are first used (the robot, the sensors) get their prior
+		 * from the blocks of their map objects.
+		 * The landmark initializations and the reparametrizations are exact functions of other states,
+		 * they are given a noise of \a noiseFloor to be represented in information form.
+		 */
+		class SparseInformationFilterIndirect: public ExtendedKalmanFilterIndirect {
+			private:
+				typedef std::map<size_t, double> InfoRow;
+				std::vector<InfoRow> L_; ///< non-zero elements of the information matrix, by row
+				vec eta_; ///< information vector
+				std::vector<bool> known_; ///< the state has information in L
+				std::vector<size_t> element_; ///< first state of the landmark the state belongs to, or -1 for the other states
+				ind_array ia_robot_; ///< the states moved by the last prediction
+				std::vector<int> pos_; ///< position of the states in the current local problem, -1 if not in it
+				std::vector<int> recoveredPos_; ///< position of the states in ia_recovered_, -1 if not in it
+				ind_array ia_recovered_; ///< the states recovered together last
+				sym_mat P_recovered_; ///< their covariances
+
+				/// covariances block of a map object
+				struct CovarianceBlock
+				{
+					ind_array ia; ///< the states of the object
+					sym_mat P; ///< their covariances
+				};
+				std::list<CovarianceBlock> blocks_; ///< never shrunk, since the Gaussians of the map objects point to the blocks
+				std::vector<CovarianceBlock*> freeBlocks_; ///< the blocks of the liberated objects, reused by the new ones
+				std::vector<std::vector<CovarianceBlock*> > blocksOf_; ///< the blocks of the objects that each state belongs to
+
+				size_t maxActive_;
+				double noiseFloor_;
+				size_t relaxSize_;
+				size_t relaxNext_;
+
+				mat gather(const ind_array & ia);
+				void scatter(const ind_array & ia, const mat & Lloc);
+				void clearRows(const ind_array & ia);
+				ind_array neighbors(const ind_array & ia);
+				void setLocal(const ind_array & ia, bool in);
+				void invalidateRecovered();
+				/// the recovered covariances, completed by the blocks of the map objects
+				sym_mat covariance(const ind_array & ia);
+				void releaseBlocks(const ind_array & ia);
+				/// eta - L*x on the states ia, only taking into account the states that are not in ia
+				vec externalInfo(const ind_array & ia);
+
+				void addPrior(const ind_array & ia);
+				void addCorrection(Innovation & inn, const mat & INN_rsl, const ind_array & ia_rsl, const sym_mat & R);
+				void finishCorrection(const ind_array & ia_inn);
+				void initializeWithNoise(const mat & G_rs, const ind_array & ia_rs, const ind_array & ia_l, const sym_mat & S);
+				void refreshInfoVector(const ind_array & ia);
+				void solveLocal(const ind_array & ia);
+				void eliminate(const ind_array & ia);
+				void sparsify();
+				void relax();
+
+			public:
+				/**
+				 * \param _size the state size
+				 * \param maxActive the maximum number of landmarks linked to the robot
+				 * \param noiseFloor the variance given to the exact functions of other states
+				 * \param relaxSize the number of states refined by relaxation at each correction
+				 */
+				SparseInformationFilterIndirect(size_t _size, size_t maxActive = 10, double noiseFloor = 1e-6, size_t relaxSize = 100);
+
+				virtual void grow(size_t _size);
+
+				/**
+				 * State of a new map object: a view on x(), and a covariances block of its own.
+				 * The block is released when the states are liberated, and reused by a later object of the same size.
+				 */
+				virtual Gaussian objectState(const ind_array & ia);
+
+				virtual void predict(const ind_array & iax, const mat & F_v, const ind_array & iav, const mat & F_u, const sym_mat & U);
+				virtual void predict(const ind_array & iax, const mat & F_v, const ind_array & iav, const sym_mat & Q);
+				virtual void predict(const ind_array & iax, const mat & F_v, const BlockJacobian & F_blocks, const ind_array & iav, const sym_mat & Q);
+
+				virtual void initialize(const ind_array & iax, const mat & G_rs, const ind_array & ia_rs, const ind_array & ia_l, const mat & G_y, const sym_mat & R);
+				virtual void initialize(const ind_array & iax, const mat & G_v, const ind_array & ia_rs, const ind_array & ia_l, const mat & G_y, const sym_mat & R, const mat & G_n, const sym_mat & N);
+
+				virtual void reparametrize(const ind_array & iax, const mat & J_l, const ind_array & ia_old, const ind_array & ia_new);
+				virtual void reparametrizeAllStacked(const ind_array & iax);
+
+				/**
+				 * Information filter correction.
+				 * The information of the measurement is added with its noise \a R, inn.P() is not used.
+				 */
+				virtual void correct(const ind_array & iax, Innovation & inn, const mat & INN_rsl, const ind_array & ia_rsl, const sym_mat & R);
+				virtual void correctAllStacked(const ind_array & iax);
+
+				virtual void liberate(const ind_array & ia);
+				virtual void recover(const ind_array & ia);
+				virtual sym_mat marginal(const ind_array & ia);
+
+				/// number of landmarks linked to the robot
+				size_t activeCount();
+				/// number of non-zero elements of the information matrix
+				size_t nonZeros() const;
+		};
+
+	}
+}
+
+#endif /* INFORMATIONFILTER_HPP_ */
@@ -12,9 +12,13 @@
 #ifndef KALMANFILTER_HPP_
 #define KALMANFILTER_HPP_
 
+#include <vector>
+
 #include "jmath/ixaxpy.hpp"
 #include "jmath/ublasExtra.hpp"
+#include "rtslam/gaussian.hpp"
 #include "rtslam/innovation.hpp"
+#include "rtslam/blockJacobian.hpp"
 
 namespace jafar {
 	namespace rtslam {
@@ -23,27 +27,57 @@ namespace jafar {
 
 		/**
 		 * Base class for Kalman filters
+		 *
+		 * The operations used by the map objects are virtual, so that other filters can be used behind
+		 * the same interface, eg SparseInformationFilterIndirect. They keep the mean in x(),
+		 * and the covariances needed by the map objects in the storage given by objectState(),
+		 * which is P() for the Kalman filters.
 		 * \ingroup rtslam
 		 */
 		class ExtendedKalmanFilterIndirect {
 			private:
 				size_t size_; // state size
+				std::vector<bool> consider_; // the state is a consider state
+				size_t nConsider_; // number of consider states
+				bool estimateConsidered_; // the consider states are updated as the other ones
+				bool denseP_; // P_ holds the covariances of all the states
 //				size_t measurementSize;
 //				size_t expectationSize;
 //				size_t innovationSize;
-			private:
+			protected:
 				vec x_;
 				sym_mat P_;
+				unsigned long version_; // number of predictions and corrections
 			public:
 				//				boost::posix_time::time_duration curTime;
 				mat K;
 				mat PJt_tmp;
 
 				ExtendedKalmanFilterIndirect(size_t _size);
+				virtual ~ExtendedKalmanFilterIndirect() {}
+
+			protected:
+				/**
+				 * Constructor for the filters that keep their covariances in another form.
+				 * \param _size the state size
+				 * \param _denseP false not to allocate P(), which then stays empty.
+				 */
+				ExtendedKalmanFilterIndirect(size_t _size, bool _denseP);
+
+			public:
 
 				size_t size(){
 					return size_;
 				}
+
+				/**
+				 * Grow the filter storage.
+				 * The existing x and P are preserved and the new states are cleared.
+				 * P is not allocated if the filter does not keep a dense P.
+				 * The storage objects are not replaced, so that remote Gaussians referring to them remain valid.
+				 * \param _size the new state size, larger than the current one.
+				 */
+				virtual void grow(size_t _size);
 				jblas::vec & x() {
 					return x_;
 				}
@@ -57,6 +91,25 @@ namespace jafar {
 					return P_(i, j);
 				}
 
+				/**
+				 * State of a new map object, on the states \a ia.
+				 * The mean is a view on x(). With the Kalman filters the covariances are a view on P(),
+				 * other filters may give each map object its own covariances block instead.
+				 * Only the covariances of the object are then stored, its cross-variances
+				 * with the other objects are obtained with marginal().
+				 * \param ia the states of the object.
+				 */
+				virtual Gaussian objectState(const ind_array & ia);
+
+				/**
+				 * Version of the estimate, incremented at each prediction and correction.
+				 * Initializations and reparametrizations do not change it, because they do not modify
+				 * the estimate of the states that were already in the filter.
+				 */
+				unsigned long version() const {
+					return version_;
+				}
+
 
 				/**
 				 * Predict covariances matrix.
@@ -75,7 +128,7 @@ namespace jafar {
 				 * \param F_u the Jacobian of the process model wrt the perturbation.
 				 * \param U the covariances matrix of the perturbation in control-space.
 				 */
-				void predict(const ind_array & iax, const mat & F_v, const ind_array & iav, const mat & F_u, const sym_mat & U);
+				virtual void predict(const ind_array & iax, const mat & F_v, const ind_array & iav, const mat & F_u, const sym_mat & U);
 
 				/**
 				 * Predict covariances matrix.
@@ -92,7 +145,24 @@ namespace jafar {
 				 * \param iav the ind_array of the process model states.
 				 * \param Q the covariances matrix of the perturbation in state-space.
 				 */
-				void predict(const ind_array & iax, const mat & F_v, const ind_array & iav, const sym_mat & Q);
+				virtual void predict(const ind_array & iax, const mat & F_v, const ind_array & iav, const sym_mat & Q);
+
+				/**
+				 * Predict covariances matrix, with a block-sparse Jacobian.
+				 *
+				 * This is the same as predict(iax, F_v, iav, Q), but F_v is only applied where it differs from identity,
+				 * as described by \a F_blocks.
+				 * The cross-variances Pvm are only recomputed for the rows of F_v that are not identity rows,
+				 * and only with the non-zero blocks of these rows.
+				 * The small robot block Pvv is still computed with the dense F_v.
+				 *
+				 * \param iax the ind_array of all used states in the map.
+				 * \param F_v the Jacobian of the process model.
+				 * \param F_blocks the block structure of F_v.
+				 * \param iav the ind_array of the process model states.
+				 * \param Q the covariances matrix of the perturbation in state-space.
+				 */
+				virtual void predict(const ind_array & iax, const mat & F_v, const BlockJacobian & F_blocks, const ind_array & iav, const sym_mat & Q);
 
 				/**
 				 * EKF initialization from fully observable info.
@@ -104,7 +174,7 @@ namespace jafar {
 				 * \param G_y Jacobian of back-projection wrt the measurement
 				 * \param R measurement noise covariances matrix
 				 */
-				void initialize(const ind_array & iax, const mat & G_rs, const ind_array & ia_rs, const ind_array & ia_l, const mat & G_y, const sym_mat & R);
+				virtual void initialize(const ind_array & iax, const mat & G_rs, const ind_array & ia_rs, const ind_array & ia_l, const mat & G_y, const sym_mat & R);
 
 				/**
 				 * EKF initialization from partially observable info.
@@ -118,7 +188,7 @@ namespace jafar {
 				 * \param G_n Jacobian of back-projection wrt the non-measured prior
 				 * \param N non-measured prior covariances matrix
 				 */
-				void initialize(const ind_array & iax, const mat & G_v, const ind_array & ia_rs, const ind_array & ia_l, const mat & G_y, const sym_mat & R, const mat & G_n, const sym_mat & N);
+				virtual void initialize(const ind_array & iax, const mat & G_v, const ind_array & ia_rs, const ind_array & ia_l, const mat & G_y, const sym_mat & R, const mat & G_n, const sym_mat & N);
 
 				/**
 				 * EKF reparametrization.
@@ -128,7 +198,7 @@ namespace jafar {
 				 * \param ia_old indices to old landmark parameters
 				 * \param ia_new indices to new landmark parameters
 				 */
-				void reparametrize(const ind_array & iax, const mat & J_l, const ind_array & ia_old, const ind_array & ia_new);
+				virtual void reparametrize(const ind_array & iax, const mat & J_l, const ind_array & ia_old, const ind_array & ia_new);
 
 				/**
 				 * Compute Kalman gain.
@@ -160,11 +230,70 @@ namespace jafar {
 				 * \param inn the Innovation.
 				 * \param INN_rsl: the Jacobian wrt the states that contributed to the innovation
 				 * \param ia_rsl: the indices to these states
+				 * \param R the measurement noise covariances, that is included in inn.P().
+				 * The EKF only uses inn.P(), the filters that do not work with the innovation covariance use R.
 				 */
-				void correct(const ind_array & iax, Innovation & inn, const mat & INN_rsl, const ind_array & ia_rsl);
+				virtual void correct(const ind_array & iax, Innovation & inn, const mat & INN_rsl, const ind_array & ia_rsl, const sym_mat & R);
+
+				/**
+				 * The states are not used anymore, eg the landmark was deleted.
+				 * The EKF has nothing to do, its covariances with the other states are simply ignored.
+				 * \param ia the indices of the states.
+				 */
+				virtual void liberate(const ind_array & ia) {}
+
+				/**
+				 * Make sure that the covariances of the states \a ia, and their cross-variances, are up to date,
+				 * in P() or in the storage of the map objects. It is always the case with the EKF.
+				 * \param ia the indices of the states.
+				 */
+				virtual void recover(const ind_array & ia) {}
+
+				/**
+				 * Marginal covariances of the states \a ia, with their cross-variances,
+				 * eg for the innovation of an observation or for the display.
+				 * The default is to recover() them and read them in P().
+				 * \param ia the indices of the states.
+				 */
+				virtual sym_mat marginal(const ind_array & ia);
+
+				/**
+				 * Mark the states as consider states (Schmidt-Kalman filter), eg calibration parameters.
+				 * Their uncertainty is taken into account in the gains of the other states, but the corrections
+				 * do not change their means and covariances, only their cross-variances with the other states.
+				 * This keeps the filter consistent while these states are not estimated.
+				 * The information filter ignores it and estimates them as the other states.
+				 * \param ia the indices of the states.
+				 * \param consider true to stop estimating the states, false to estimate them again.
+				 */
+				void setConsider(const ind_array & ia, bool consider = true);
+				/// true if the state is a consider state
+				bool isConsider(size_t i) const { return consider_[i]; }
+				/// the consider states
+				ind_array consideredStates() const;
+				/**
+				 * Temporarily estimate the consider states as the other ones, eg one frame from time to time.
+				 * \param estimate true to estimate them, false to go back to the Schmidt-Kalman corrections.
+				 */
+				void estimateConsidered(bool estimate) { estimateConsidered_ = estimate; }
 
-				
 			protected:
+
+				/**
+				 * Schmidt-Kalman update of x and P from K and PJt_tmp, if some of the states are consider states.
+				 * The rows of K of the consider states are set to zero, and only the rows of the estimated states
+				 * of x and P are updated.
+				 * \param ia_x the indirect array of used indices in the map.
+				 * \param z the innovation.
+				 * \return false if the update has to be done normally.
+				 */
+				bool considerUpdate(const ind_array & ia_x, const vec & z);
+
+				/**
+				 * Covariance update P += K*PJt', from K and PJt_tmp.
+				 * \param ia_x the indirect array of used indices in the map.
+				 */
+				void updateCovariance(const ind_array & ia_x);
 				
 				vec stackedInnovation_x;
 				sym_mat stackedInnovation_P;
@@ -172,14 +301,15 @@ namespace jafar {
 
 				struct StackedCorrection
 				{
-					StackedCorrection(Innovation & inn, const mat & INN_rsl, const ind_array & ia_rsl):
-						inn(inn), INN_rsl(INN_rsl), ia_rsl(ia_rsl)
+					StackedCorrection(Innovation & inn, const mat & INN_rsl, const ind_array & ia_rsl, const sym_mat & R):
+						inn(inn), INN_rsl(INN_rsl), ia_rsl(ia_rsl), R(R)
 					{
 // JFR_DEBUG("StackedCorrection " << this->INN_rsl << " " << INN_rsl);
 					}
 					Innovation inn;
 					mat INN_rsl;
 					ind_array ia_rsl;
+					sym_mat R;
 				};
 
 				typedef std::list<StackedCorrection> CorrectionList;
@@ -193,12 +323,42 @@ namespace jafar {
 					void clear() { inn_size = 0; stack.clear(); }
 				};
 				CorrectionStack corrStack;
+
+				struct StackedReparametrization
+				{
+					StackedReparametrization(const mat & J_l, const ind_array & ia_old, const ind_array & ia_new):
+						J_l(J_l), ia_old(ia_old), ia_new(ia_new) {}
+					mat J_l;
+					ind_array ia_old;
+					ind_array ia_new;
+				};
+				typedef std::list<StackedReparametrization> ReparametrizationList;
+				ReparametrizationList reparStack;
 				
 			public:
-				void stackCorrection(Innovation & inn, const mat & INN_rsl, const ind_array & ia_rsl);
-				void correctAllStacked(const ind_array & iax);
+				/**
+				 * Stack a correction, to be applied later with correctAllStacked().
+				 * The arguments are the same as in correct().
+				 */
+				void stackCorrection(Innovation & inn, const mat & INN_rsl, const ind_array & ia_rsl, const sym_mat & R);
+				virtual void correctAllStacked(const ind_array & iax);
 				void clearStack();
 
+				/**
+				 * Stack a reparametrization, to be applied later with reparametrizeAllStacked().
+				 * The arguments are the same as in reparametrize().
+				 */
+				void stackReparametrization(const mat & J_l, const ind_array & ia_old, const ind_array & ia_new);
+				/**
+				 * Apply all the stacked reparametrizations in one pass over the covariances matrix.
+				 * The rows of all old elements are read once, then the rows of all new elements are written once,
+				 * so new elements may use (part of) the space of the old ones.
+				 * Old elements may share states, e.g. a common anchor: the cross-variances of the new elements
+				 * with the old states that they do not reuse are also computed.
+				 * \param iax indirect array of indices to used states, including all old elements.
+				 */
+				virtual void reparametrizeAllStacked(const ind_array & iax);
+
 		};
 
 	}
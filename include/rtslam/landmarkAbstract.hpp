@@ -22,6 +22,7 @@
 #include "rtslam/parents.hpp"
 
 #include <boost/smart_ptr.hpp>
+#include <map>
 
 namespace jafar {
 	namespace rtslam {
@@ -31,6 +32,18 @@ namespace jafar {
 		class ObservationAbstract;
 //		class MapManagerAbstract;
 
+		/**
+		 * Counters of an observation, see ObservationAbstract::counters.
+		 * They are defined here to be kept by the landmark when the observation is reclaimed.
+		 */
+		struct ObservationCounters {
+				int nSearch; ///< Number of searches
+				int nMatch;  ///< Number of matches
+				int nInlier; ///< Number of times declared inlier
+				int nSearchSinceLastInlier; ///< Number of frames the landmark was searched since last time it was inlier
+				int nFrameSinceLastVisible; ///< Number of frames since last time it was visible
+		};
+
 
 		/** Base class for all landmarks defined in the module
 		 * rtslam.
@@ -59,6 +72,10 @@ namespace jafar {
 				 */
 			LandmarkAbstract(const map_ptr_t & _mapPtr, const size_t _size);
 			LandmarkAbstract(const simulation_t dummy, const map_ptr_t & _mapPtr, const size_t _size);
+				/**
+				 * Constructor on states already reserved in the filter, possibly shared with other landmarks.
+				 */
+			LandmarkAbstract(const map_ptr_t & _mapPtr, const jblas::ind_array & _ia);
 		                /**
 				 * Constructor by replacement: occupied the same filter state as a specified previous lmk. _icomp is the complementary memory, to be relaxed by the user.
 				 */
@@ -99,6 +116,8 @@ namespace jafar {
 
 				descriptor_ptr_t descriptorPtr; ///< Landmark descriptor
 				VisibilityMap visibilityMap;
+				/// counters of the observations reclaimed after a long absence, by sensor id, given back to the new ones
+				std::map<size_t, ObservationCounters> reclaimedCounters;
 
 				jblas::mat LNEW_lmk; ///<Jacobian comming from reparametrisation of old lmk wrt. new lmk
 
@@ -119,6 +138,25 @@ namespace jafar {
 				 */
 				virtual size_t reparamSize() = 0;
 
+				/**
+				 * The filter states that belong to this landmark only, that is all of state.ia() but
+				 * the states shared with other landmarks. They can be reused by the reparametrized landmark.
+				 */
+				virtual jblas::ind_array ownStates() const { return state.ia(); }
+
+				/**
+				 * Positions in the landmark state of the states to initialize in the filter at back-projection,
+				 * that is all of them but the shared states that are already initialized.
+				 */
+				virtual jblas::ind_array initStates() const { return jmath::ublasExtra::ia_set(0, state.size()); }
+
+				/**
+				 * Give back states of the landmark to the map, when it is removed or reparametrized.
+				 * \param _mapPtr the map.
+				 * \param _ia the own states to liberate. The shared states are liberated when they are not used anymore.
+				 */
+				virtual void liberateStates(const map_ptr_t & _mapPtr, const jblas::ind_array & _ia);
+
 				// Create a landmark descriptor
 				virtual void setDescriptor(const descriptor_ptr_t & descPtr)
 				{
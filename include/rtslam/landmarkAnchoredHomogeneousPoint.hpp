@@ -41,6 +41,10 @@ namespace jafar {
 				 */
 				LandmarkAnchoredHomogeneousPoint(const map_ptr_t & mapPtr);
 				LandmarkAnchoredHomogeneousPoint(const simulation_t dummy, const map_ptr_t & mapPtr);
+				/**
+				 * Constructor on states already reserved in the map, see LandmarkSharedAnchorHomogeneousPoint.
+				 */
+				LandmarkAnchoredHomogeneousPoint(const map_ptr_t & mapPtr, const jblas::ind_array & _ia);
 
 				virtual ~LandmarkAnchoredHomogeneousPoint() {
 //					cout << "Deleted landmark: " << id() << ": " << typeName() << endl;
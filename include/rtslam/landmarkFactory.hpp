@@ -10,6 +10,7 @@
 #define LANDMARKFACTORY_HPP_
 
 #include "rtslam/rtSlam.hpp"
+#include "rtslam/objectPool.hpp"
 
 namespace jafar {
 namespace rtslam {
@@ -18,25 +19,41 @@ namespace rtslam {
 	{
 		public:
 			virtual landmark_ptr_t createInit(map_ptr_t mapPtr) = 0;
+			/**
+			 * Create a landmark to be initialized from sensor \a senPtr.
+			 * By default the sensor does not matter.
+			 */
+			virtual landmark_ptr_t createInit(map_ptr_t mapPtr, sensor_ptr_t senPtr) { return createInit(mapPtr); }
 			virtual landmark_ptr_t createConverged(map_ptr_t mapPtr) = 0;
 			virtual landmark_ptr_t createConverged(map_ptr_t mapPtr, landmark_ptr_t lmkinit, jblas::ind_array &_icomp) = 0;
+			/**
+			 * Number of states of the landmark to initialize that are not reused by the converged landmark.
+			 */
 			virtual size_t sizeComplement() = 0;
 			virtual size_t sizeInit() = 0;
+			/**
+			 * Number of new states in the map of the next landmark initialized from sensor \a senPtr,
+			 * less than sizeInit() if it reuses states of other landmarks. By default the sensor does not matter.
+			 */
+			virtual size_t sizeInit(map_ptr_t mapPtr, sensor_ptr_t senPtr) { return sizeInit(); }
 	};
 	
 	
+	/**
+	 * Factory of landmarks, that are created in pooled memory (see objectPool.hpp).
+	 */
 	template<class LandmarkInit, class LandmarkConverged>
 	class LandmarkFactory: public LandmarkFactoryAbstract
 	{
 		public:
 			virtual landmark_ptr_t createInit(map_ptr_t mapPtr) {
-				return boost::shared_ptr<LandmarkInit>(new LandmarkInit(mapPtr));
+				return pooledPtr(new (poolAllocate<LandmarkInit>()) LandmarkInit(mapPtr));
 			}
 			virtual landmark_ptr_t createConverged(map_ptr_t mapPtr) {
-				return boost::shared_ptr<LandmarkConverged>(new LandmarkConverged(mapPtr));
+				return pooledPtr(new (poolAllocate<LandmarkConverged>()) LandmarkConverged(mapPtr));
 			}
 			virtual landmark_ptr_t createConverged(map_ptr_t mapPtr, landmark_ptr_t lmkinit, jblas::ind_array &_icomp) {
-				return boost::shared_ptr<LandmarkConverged>(new LandmarkConverged(mapPtr, lmkinit, _icomp));
+				return pooledPtr(new (poolAllocate<LandmarkConverged>()) LandmarkConverged(mapPtr, lmkinit, _icomp));
 			}
 			virtual size_t sizeInit() {
 				return (LandmarkInit::size());
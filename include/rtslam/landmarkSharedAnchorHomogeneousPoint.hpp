@@ -0,0 +1,164 @@
+/**
+ * \file landmarkSharedAnchorHomogeneousPoint.hpp
+ * \author jsola
+ * \date 17/10/2026
+ *
+ * Header file for anchored homogeneous points sharing their anchor
+ * \ingroup rtslam
+ */
+
+#ifndef LANDMARKSHAREDANCHORHOMOGENEOUSPOINT_HPP_
+#define LANDMARKSHAREDANCHORHOMOGENEOUSPOINT_HPP_
+
+#include <map>
+#include "boost/shared_ptr.hpp"
+#include "boost/weak_ptr.hpp"
+#include "rtslam/landmarkAnchoredHomogeneousPoint.hpp"
+#include "rtslam/landmarkFactory.hpp"
+#include "rtslam/sensorAbstract.hpp"
+
+namespace jafar {
+	namespace rtslam {
+
+		class SharedAnchor;
+		typedef boost::shared_ptr<SharedAnchor> shared_anchor_ptr_t;
+
+		class LandmarkSharedAnchorHomogeneousPoint;
+		typedef boost::shared_ptr<LandmarkSharedAnchorHomogeneousPoint> sahp_ptr_t;
+
+
+		/**
+		 * Anchor state shared by several anchored homogeneous points.
+		 *
+		 * It is a 3-states block in the filter, that is liberated when the last landmark
+		 * using it is removed or reparametrized.
+		 * \ingroup rtslam
+		 */
+		class SharedAnchor {
+			protected:
+				size_t nUsers_;
+			public:
+				jblas::ind_array ia;   ///< the anchor states in the filter
+				unsigned long version; ///< version of the filter estimate when the anchor was created
+
+				/// anchor on new states of the map
+				SharedAnchor(const map_ptr_t & mapPtr);
+
+				/// number of landmarks using the anchor
+				size_t nUsers() const { return nUsers_; }
+				void attach() { ++nUsers_; }
+				/// stop using the anchor, it is liberated when it is not used anymore
+				void detach(const map_ptr_t & mapPtr);
+		};
+
+
+		/**
+		 * Class for anchored homogeneous 3D points sharing their anchor with other landmarks.
+		 *
+		 * The landmarks initialized from the same sensor with the same filter estimate (in general
+		 * the landmarks initialized in the same detection pass) all have the same anchor, the sensor position.
+		 * Instead of one anchor each, they refer to a single anchor state in the filter, and only own
+		 * their direction and inverse depth, that is 4 states instead of 7.
+		 *
+		 * The state of the landmark is still the full anchored homogeneous point, whose indirect array
+		 * points to the shared anchor followed by the own states, so that the observation models
+		 * of anchored homogeneous points apply as they are.
+		 * The reparametrization to Euclidean point is done per landmark, on its own states.
+		 * The anchors are created by LandmarkFactorySharedAnchor, that knows which one to reuse.
+		 * \ingroup rtslam
+		 */
+		class LandmarkSharedAnchorHomogeneousPoint: public LandmarkAnchoredHomogeneousPoint {
+			protected:
+				shared_anchor_ptr_t anchorPtr;
+				bool initAnchor; ///< this landmark initializes the anchor in the filter
+
+				static jblas::ind_array reserveStates(const map_ptr_t & mapPtr, const shared_anchor_ptr_t & anchorPtr);
+
+			public:
+
+				/**
+				 * Constructor from map and anchor.
+				 * \param anchorPtr the anchor. If it is not used by any other landmark,
+				 * this landmark will initialize it in the filter.
+				 */
+				LandmarkSharedAnchorHomogeneousPoint(const map_ptr_t & mapPtr, const shared_anchor_ptr_t & anchorPtr);
+
+				virtual ~LandmarkSharedAnchorHomogeneousPoint() {}
+
+				virtual std::string typeName() const {
+					return "Shared-anchor-homogeneous-point";
+				}
+
+				/**
+				 * Size of the own states
+				 */
+				static size_t ownSize(void) {
+					return 4;
+				}
+
+				virtual jblas::ind_array ownStates() const;
+				virtual jblas::ind_array initStates() const;
+				virtual void liberateStates(const map_ptr_t & _mapPtr, const jblas::ind_array & _ia);
+
+		}; // class LandmarkSharedAnchorHomogeneousPoint
+
+
+		/**
+		 * Factory of landmarks sharing their anchor.
+		 *
+		 * It creates all the anchors, keeps the last one of each sensor, and gives it to the new landmarks
+		 * as long as the filter estimate did not change. The landmarks created without a sensor get an anchor of their own.
+		 * \ingroup rtslam
+		 */
+		template<class LandmarkConverged>
+		class LandmarkFactorySharedAnchor: public LandmarkFactoryAbstract
+		{
+			protected:
+				std::map<size_t, boost::weak_ptr<SharedAnchor> > anchors; ///< last anchor of each sensor, by sensor id
+
+				/// the last anchor of the sensor if it can be reused, else null
+				shared_anchor_ptr_t reusableAnchor(const map_ptr_t & mapPtr, const sensor_ptr_t & senPtr) {
+					std::map<size_t, boost::weak_ptr<SharedAnchor> >::iterator it = anchors.find(senPtr->id());
+					if (it == anchors.end()) return shared_anchor_ptr_t();
+					shared_anchor_ptr_t anchorPtr = it->second.lock();
+					if (!anchorPtr || anchorPtr->nUsers() == 0 || anchorPtr->version != mapPtr->filterPtr->version())
+						return shared_anchor_ptr_t();
+					return anchorPtr;
+				}
+			public:
+				virtual size_t sizeInit(map_ptr_t mapPtr, sensor_ptr_t senPtr) {
+					if (senPtr && reusableAnchor(mapPtr, senPtr)) return LandmarkSharedAnchorHomogeneousPoint::ownSize();
+					return LandmarkSharedAnchorHomogeneousPoint::size();
+				}
+				virtual landmark_ptr_t createInit(map_ptr_t mapPtr) {
+					shared_anchor_ptr_t anchorPtr(new SharedAnchor(mapPtr));
+					return pooledPtr(new (poolAllocate<LandmarkSharedAnchorHomogeneousPoint>()) LandmarkSharedAnchorHomogeneousPoint(mapPtr, anchorPtr));
+				}
+				virtual landmark_ptr_t createInit(map_ptr_t mapPtr, sensor_ptr_t senPtr) {
+					shared_anchor_ptr_t anchorPtr = reusableAnchor(mapPtr, senPtr);
+					if (!anchorPtr)
+					{
+						anchorPtr.reset(new SharedAnchor(mapPtr));
+						anchors[senPtr->id()] = anchorPtr;
+					}
+					return pooledPtr(new (poolAllocate<LandmarkSharedAnchorHomogeneousPoint>()) LandmarkSharedAnchorHomogeneousPoint(mapPtr, anchorPtr));
+				}
+				virtual landmark_ptr_t createConverged(map_ptr_t mapPtr) {
+					return pooledPtr(new (poolAllocate<LandmarkConverged>()) LandmarkConverged(mapPtr));
+				}
+				virtual landmark_ptr_t createConverged(map_ptr_t mapPtr, landmark_ptr_t lmkinit, jblas::ind_array &_icomp) {
+					return pooledPtr(new (poolAllocate<LandmarkConverged>()) LandmarkConverged(mapPtr, lmkinit, _icomp));
+				}
+				virtual size_t sizeInit() {
+					return LandmarkSharedAnchorHomogeneousPoint::size();
+				}
+				virtual size_t sizeComplement() {
+					return LandmarkSharedAnchorHomogeneousPoint::size() - LandmarkConverged::size();
+				}
+		};
+
+
+	} // namespace rtslam
+} // namespace jafar
+
+#endif /* LANDMARKSHAREDANCHORHOMOGENEOUSPOINT_HPP_ */
@@ -0,0 +1,86 @@
+/**
+ * \file lkTracker.hpp
+ *
+ * \date 17/10/2026
+ * \author jsola
+ *
+ *  \ingroup rtslam
+ */
+
+#ifndef LKTRACKER_HPP_
+#define LKTRACKER_HPP_
+
+#include <vector>
+
+#include "image/Image.hpp"
+
+namespace jafar{
+	namespace rtslam{
+
+		/**
+		 * Inverse compositional Lucas-Kanade tracker of a patch in translation.
+		 * \ingroup rtslam
+		 * \author jsola
+		 *
+		 * The patch is searched with sub-pixel accuracy around an initial position, by Gauss-Newton
+		 * minimization of the difference between the patch and the bilinearly interpolated image.
+		 * The inverse compositional formulation uses the gradients of the patch instead of the gradients
+		 * of the image, so that the gradients and the Hessian are computed once in setTemplate(),
+		 * and each iteration only costs one interpolation of the window and one 2x2 solve.
+		 *
+		 * Before each iteration the window is normalized to the mean and the standard deviation
+		 * of the patch, so that the tracker has the same invariance to lighting as ZNCC,
+		 * and the final score is the ZNCC of the patch with the window.
+		 *
+		 * The covariance of the position is the residual variance times the inverse Hessian:
+		 * it is large along the edges and small at the corners.
+		 */
+		class LkTracker {
+			public:
+				/**
+				 * \param maxIter the max number of iterations
+				 * \param minStep the step under which the tracker converged, in pixels
+				 * \param maxMotion the max distance to the initial position, in pixels
+				 */
+				LkTracker(int maxIter = 10, double minStep = 0.02, double maxMotion = 3.0);
+
+				/**
+				 * Precompute the gradients and the Hessian of the patch.
+				 * \return false if the patch has no texture to be tracked
+				 */
+				bool setTemplate(const image::Image & patch);
+
+				/**
+				 * Track the patch in the image.
+				 * The position is the one of the center of the central pixel of the patch,
+				 * with the convention that pixel i covers [i,i+1[.
+				 * \param image the image
+				 * \param x,y the initial position, and the tracked position
+				 * \param score the ZNCC score at the tracked position
+				 * \param cov the covariance of the tracked position, in row order xx, xy, yy
+				 * \return true if the tracker converged inside the image
+				 */
+				bool track(const image::Image & image, double & x, double & y, double & score, double cov[3]) const;
+
+				int iterations() const { return m_iterations; }
+
+			private:
+				bool window(const image::Image & image, double x, double y, std::vector<float> & win) const;
+
+			private:
+				int m_maxIter;
+				double m_minStep;
+				double m_maxMotion;
+				int m_width, m_height;
+				double m_mean, m_std;
+				std::vector<float> m_tpl;  ///< patch, inner pixels only
+				std::vector<float> m_gx;   ///< patch gradients, inner pixels only
+				std::vector<float> m_gy;
+				double m_Hinv[3];          ///< inverse Hessian xx, xy, yy
+				mutable int m_iterations;
+		};
+
+	}
+}
+
+#endif /* LKTRACKER_HPP_ */
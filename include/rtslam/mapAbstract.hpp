@@ -18,9 +18,16 @@
 
 #include "rtslam/gaussian.hpp"
 #include "rtslam/kalmanFilter.hpp"
+#include "rtslam/marginalCache.hpp"
 #include "rtslam/parents.hpp"
 #include "rtslam/worldAbstract.hpp"
 
+/**
+Number of states allocated in the filter at map construction, if not given.
+The storage then grows geometrically when more states are reserved.
+*/
+#define MAP_DEFAULT_RESERVED_SIZE 100
+
 namespace jafar {
 	/**
 	 * Namespace rtslam for real-time slam module.
@@ -66,9 +73,12 @@ namespace jafar {
 
 
 				/**
-				 * Constructor
+				 * Constructor.
+				 * The filter storage starts at \a _reserved_size states and grows geometrically on demand, up to \a _max_size.
+				 * \param _max_size the maximum number of states in the map.
+				 * \param _reserved_size the number of states initially allocated, or 0 for a small default.
 				 */
-				MapAbstract(size_t _max_size);
+				MapAbstract(size_t _max_size, size_t _reserved_size = 0);
 				MapAbstract(const ekfInd_ptr_t & ekfPtr);
 
 				/**
@@ -89,11 +99,18 @@ namespace jafar {
 				ekfInd_ptr_t filterPtr;
 //				ExtendedKalmanFilterIndirect filter;
 
+				/**
+				 * Marginals of the robots and landmarks for the consumers, refreshed with marginals.update(*this)
+				 * after the corrections when there are consumers.
+				 */
+				MarginalCache marginals;
+
 				/**
 				 * Size things and map usage management
 				 */
-				size_t max_size;
-				size_t current_size;
+				size_t max_size; ///<      hard limit of the number of states
+				size_t current_size; ///<  number of used states
+				size_t reserved_size; ///< number of states allocated in the filter
 				jblas::vecb used_states;
 
 				/**
@@ -130,8 +147,16 @@ namespace jafar {
 					return (unusedStates() >= N);
 				}
 
+				/**
+				 * Allocate filter storage for at least \a _size states, bounded by max_size.
+				 * Like std::vector::reserve(), this never shrinks the storage.
+				 * \param _size the requested number of allocated states.
+				 */
+				void reserve(const std::size_t _size);
+
 				/**
 				 * Obtain free Map space of a given size.
+				 * The filter storage is grown geometrically if needed.
 				 * The free space in \a used_states and the current size \a current_size are modified accordingly.
 				 * Ig not enough space is available, the returned indirect array is of null size.
 				 * \param _size the requested free space size.
@@ -9,9 +9,13 @@
 #ifndef MAPMANAGER_HPP_
 #define MAPMANAGER_HPP_
 
+#include <vector>
+#include <map>
+
 #include "rtslam/parents.hpp"
 #include "rtslam/mapAbstract.hpp"
 #include "rtslam/landmarkFactory.hpp"
+#include "rtslam/indexedHeap.hpp"
 
 namespace jafar {
 	namespace rtslam {
@@ -42,22 +46,52 @@ namespace jafar {
 
 			protected:
 				landmark_factory_ptr_t lmkFactory;
+				int obsReclaimFrames; ///< number of frames without visibility after which an observation is reclaimed, 0 to keep them
 			public:
 				MapManagerAbstract(landmark_factory_ptr_t lmkFactory):
-					lmkFactory(lmkFactory) {}
+					lmkFactory(lmkFactory), obsReclaimFrames(0) {}
 				virtual ~MapManagerAbstract(void) {
 				}
 				/**
 				 Does map has enough space to init a new landmark ?
+				 \param senPtr the sensor the landmark is initialized from, if known, since the landmarks
+				 may share states with the previous ones of the same sensor (see LandmarkFactoryAbstract::sizeInit())
 				*/
-				virtual bool mapSpaceForInit() {
-					return mapPtr()->unusedStates(lmkFactory->sizeInit());
+				virtual bool mapSpaceForInit(const sensor_ptr_t & senPtr = sensor_ptr_t()) {
+					return mapPtr()->unusedStates(senPtr ? lmkFactory->sizeInit(mapPtr(), senPtr) : lmkFactory->sizeInit());
 				}
+				/**
+				 Can the map manager delete landmarks to make space for a new one ?
+				*/
+				virtual bool canMakeSpace() { return false; }
+				/**
+				 Make space to init a new landmark from sensor \a senPtr, deleting landmarks if the map manager can,
+				 and return if there is enough space.
+				*/
+				virtual bool makeSpaceForInit(const sensor_ptr_t & senPtr) { return mapSpaceForInit(senPtr); }
 				/**
 				 Return the pointer to the created observation that correspond to the dmaOrigin.
+				 The observations of the other data managers are created by manageObservations(),
+				 when the landmark becomes visible by their sensors.
 				*/
 				observation_ptr_t createNewLandmark(data_manager_ptr_t dmaOrigin);
+				/**
+				 Create the observation of a landmark by a data manager, and insert it in the graph.
+				*/
+				observation_ptr_t createObservation(landmark_ptr_t lmkPtr, data_manager_ptr_t dma);
+				/**
+				 Create the observations of the data manager for the landmarks predicted visible by its sensor,
+				 and reclaim the ones not visible for more than obsReclaimFrames frames.
+				 A landmark always keeps at least one observation, and the counters of the reclaimed ones.
+				 To be called by the data manager before projecting its observations.
+				*/
+				void manageObservations(data_manager_ptr_t dma);
+				void setObservationReclaim(int nFrames) { obsReclaimFrames = nFrames; }
 				void reparametrizeLandmark(landmark_ptr_t lmkIter);
+				/**
+				 Reparametrize several landmarks at once, with only one pass over the filter covariances.
+				*/
+				void reparametrizeLandmarks(const std::vector<landmark_ptr_t> & lmksInit);
 				LandmarkList::iterator reparametrizeLandmark(LandmarkList::iterator lmkIter)
 				{ // FIXME do better than this! will crash if only one element.
 					landmark_ptr_t lmkPtr = *lmkIter;
@@ -67,6 +101,11 @@ namespace jafar {
 					return lmkIter;
 				}
 				void unregisterLandmark(landmark_ptr_t lmkPtr, bool liberateFilter = true);
+				/**
+				 Called by unregisterLandmark(), when the landmark is deleted or reparametrized,
+				 for the map managers that keep information on their landmarks.
+				*/
+				virtual void landmarkUnregistered(const landmark_ptr_t & lmkPtr) {}
 				LandmarkList::iterator unregisterLandmark(LandmarkList::iterator lmkIter, bool liberateFilter = true)
 				{ // FIXME do better than this! will crash if only one element.
 					landmark_ptr_t lmkPtr = *lmkIter;
@@ -139,25 +178,56 @@ namespace jafar {
 			Map manager made for doing slam as long as possible while optimizing
 			the use of the map. When the map is full, lower quality and spatially
 			redundant landmarks are removed to make room for new landmarks.
+			The landmarks sharing states (see LandmarkSharedAnchorHomogeneousPoint)
+			only give back their own states when they are deleted, and the new
+			landmark only needs its own states if it reuses the shared ones, so that
+			the landmarks are deleted until the actual need is met, and no more.
 		*/
 		class MapManagerGlobal: public MapManager {
 			protected:
 				double killSearchTh;      ///< minimum number of times the landmark must have been searched to be deleted for match or consistency reasons
 				double killMatchTh;       ///< ratio match/search threshold
 				double killConsistencyTh; ///< ratio consistency/search threshold
+				double evictUtilityTh;    ///< utility under which a landmark can be deleted to make room for a new one, 0 to never do it
+				double evictDistRef;      ///< distance at which the utility of a point is halved, 0 to ignore the distance
+				unsigned nEvicted;        ///< number of landmarks deleted to make room for new ones
+				IndexedMinHeap<size_t> utilities; ///< utility of the landmarks, by id, updated by manageDeletion()
+				std::map<size_t, landmark_ptr_t> utilityLandmarks; ///< the landmarks in \a utilities, by id
 			public:
 				MapManagerGlobal(landmark_factory_ptr_t lmkFactory, double reparTh, double killSizeTh,
 				                double killSearchTh, double killMatchTh, double killConsistencyTh):
 				  MapManager(lmkFactory, reparTh, killSizeTh),
-				  killSearchTh(killSearchTh), killMatchTh(killMatchTh), killConsistencyTh(killConsistencyTh) {}
+				  killSearchTh(killSearchTh), killMatchTh(killMatchTh), killConsistencyTh(killConsistencyTh),
+				  evictUtilityTh(0.), evictDistRef(0.), nEvicted(0) {}
 				virtual void manageDeletion();
-				virtual bool mapSpaceForInit();
+				virtual void landmarkUnregistered(const landmark_ptr_t & lmkPtr);
+				virtual bool canMakeSpace() { return evictUtilityTh > 0. && !utilities.empty(); }
+				virtual bool makeSpaceForInit(const sensor_ptr_t & senPtr);
+				/**
+				 When the map is full, delete the landmarks with the lowest utility to make room for new ones,
+				 that are initialized in the image regions without landmarks.
+				 \param utilityTh the landmarks with a utility above this are never deleted, 0 to never delete landmarks for new ones
+				 \param distRef the distance at which the utility of a point is halved, 0 to ignore the distance
+				*/
+				void setEviction(double utilityTh, double distRef) { evictUtilityTh = utilityTh; evictDistRef = distRef; }
+				/**
+				 Utility of a landmark, the best of its observations. For an observation it is the product of
+				 - its reliability, the ratio of inliers over searches, with one more inlier and two more searches
+				   to not penalize the new landmarks,
+				 - its recency, 1/(1+n) where n is the number of searches since the last inlier,
+				 - the information it contributed, log(2+number of inliers).
+				 For the points, it is divided by (1+distance/distRef).
+				*/
+				double utility(const landmark_ptr_t & lmkPtr);
+				unsigned evictedCount() const { return nEvicted; }
 		};
 		
 		
 		/**
 			Map manager made for managing a spatially local map in a hierarchical
 			multimap framework. When the map is full, it is supposed to be closed.
+			It does not delete landmarks to make room for new ones (canMakeSpace() is false),
+			this is only supported by MapManagerGlobal.
 		*/
 		class MapManagerLocal: public MapManager {
 			public:
@@ -50,16 +50,22 @@ namespace jafar {
 				 * \param inFilter flag selecting filtered or non-filtered state vector.
 				 */
 				MapObject(const map_ptr_t & _mapPtr, const size_t _size, const filtered_obj_t inFilter = FILTERED);
+				/**
+				 * Constructor on states already reserved in the filter, possibly shared with other objects.
+				 * \param _mapPtr pointer to map
+				 * \param _ia the states of the object in the filter.
+				 */
+				MapObject(const map_ptr_t & _mapPtr, const jblas::ind_array & _ia);
  		                /*
 				 * Contructor by replacement: install the new object in place of the given arguments,
 				 * using the same position in the filter. The previous object has to be FILTERED, so is the new
 				 * object.
 				 * \param _mapPtr pointer to map
-				 * \parem _previousObj the object to be replaced in the filter. Should by FILTERED
+				 * \parem _previousIa the states of the object to be replaced in the filter, that can be reused.
 				 * \param _size the new size of the state vector.
 				 * \param _icomp the complementary of the new state wrt the previous state, ie the memory to be release when relaxing the previous object.
 				 */
-		    MapObject(const map_ptr_t & _mapPtr, const MapObject & _previousObj, const size_t _size, jblas::ind_array & _icomp);
+		    MapObject(const map_ptr_t & _mapPtr, const jblas::ind_array & _previousIa, const size_t _size, jblas::ind_array & _icomp);
 
 				/**
 				 * Mandatory virtual destructor
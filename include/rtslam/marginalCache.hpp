@@ -0,0 +1,98 @@
+/**
+ * \file marginalCache.hpp
+ *
+ * Marginal covariances of the map objects, extracted once per frame for the consumers.
+ *
+ * \date 17/10/2026
+ * \author croussil
+ *
+ * \ingroup rtslam
+ */
+
+#ifndef MARGINALCACHE_HPP_
+#define MARGINALCACHE_HPP_
+
+#include <map>
+#include <utility>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "jmath/jblas.hpp"
+
+namespace jafar {
+	namespace rtslam {
+
+		class MapAbstract;
+
+		/**
+		 * Marginal means and covariances of the robots and landmarks, for the consumers of the estimate
+		 * (display, exporters, pose predictor), that otherwise each gather the same blocks from the large P().
+		 *
+		 * update() is called in the slam thread after the corrections, only when there are consumers:
+		 * the robots alone at each frame for the exporters and the pose predictor, and the whole map at the
+		 * display rate, just before the viewers bufferize it. It builds a new snapshot, reusing the blocks of
+		 * the previous one when the filter version did not change, and replaces the current one under a small mutex.
+		 * A snapshot is never modified, so that a consumer in another thread can keep the pointer returned by snapshot()
+		 * and read it while the next frame is processed. The consumers of demo_slam all read it in the slam thread though,
+		 * the viewers in bufferize() under the display mutex.
+		 *
+		 * The blocks are obtained with ExtendedKalmanFilterIndirect::marginal(), so that the filters that keep
+		 * P() partially up to date can compute them without a global update.
+		 * The robot-landmark cross-variances are only computed if \a crossTerms is set.
+		 *
+		 * \ingroup rtslam
+		 */
+		class MarginalCache {
+			public:
+				/// the mean and marginal covariances of one map object
+				struct Block {
+					jblas::ind_array ia; ///< the states in the map
+					jblas::vec x;
+					jblas::sym_mat P;
+				};
+				typedef boost::shared_ptr<const Block> block_ptr_t;
+
+				struct Snapshot {
+					unsigned long version; ///< version of the filter, see ExtendedKalmanFilterIndirect::version()
+					std::map<size_t, block_ptr_t> blocks; ///< by first state
+					std::map<std::pair<size_t, size_t>, jblas::mat> crossBlocks; ///< robot-landmark, by first states
+
+					/// the block of the states \a ia, or NULL if not cached
+					const Block * block(const jblas::ind_array & ia) const;
+					/// the cross-variances of the states \a ia_rob and \a ia_lmk, or NULL if not cached
+					const jblas::mat * cross(const jblas::ind_array & ia_rob, const jblas::ind_array & ia_lmk) const;
+				};
+				typedef boost::shared_ptr<const Snapshot> snapshot_ptr_t;
+
+			private:
+				mutable boost::mutex mutex_snapshot;
+				snapshot_ptr_t snapshot_;
+
+				block_ptr_t makeBlock(MapAbstract & map, const jblas::ind_array & ia, const Snapshot * previous);
+
+			public:
+				bool crossTerms; ///< also cache the robot-landmark cross-variances
+
+				MarginalCache(): crossTerms(false) {}
+
+				/**
+				 * Refresh the cache from the map, after the last correction of the frame, in the slam thread.
+				 * \param landmarks also the landmarks, else the new snapshot only has the robots
+				 */
+				void update(MapAbstract & map, bool landmarks = true);
+
+				/// the last snapshot, that may be NULL before the first update
+				snapshot_ptr_t snapshot() const { boost::unique_lock<boost::mutex> l(mutex_snapshot); return snapshot_; }
+
+				/**
+				 * Get the block of the states \a ia from the last snapshot.
+				 * \return false if it is not cached, eg the object was created after the last update
+				 */
+				bool get(const jblas::ind_array & ia, jblas::vec & x, jblas::sym_mat & P) const;
+		};
+
+	}
+}
+
+#endif /* MARGINALCACHE_HPP_ */
@@ -0,0 +1,217 @@
+/**
+ * \file objectPool.hpp
+ *
+ * Pools recycling the memory and the objects that are created and deleted with each landmark.
+ *
+ * \date 17/10/2026
+ * \author jsola
+ *
+ * Landmarks, observations and appearances are created at each landmark initialization and
+ * deleted with the landmark, a few frames later for many of them. They are still held by
+ * boost::shared_ptr, as everywhere else in rtslam (the parent-child links use weak pointers),
+ * but their memory and the memory of their reference counts come from free lists:
+ *
+ * - pooledPtr(new (poolAllocate<T>()) T(...)) creates an object in a pooled block, with its
+ *   reference count in another pooled block, and gives the block back to the pool at deletion.
+ * - ObjectPool<T> recycles whole objects, with their internal buffers (e.g. image patches):
+ *   they are not deleted but given again by the next acquire().
+ *
+ * \ingroup rtslam
+ */
+
+#ifndef OBJECTPOOL_HPP_
+#define OBJECTPOOL_HPP_
+
+#include <vector>
+#include <cstddef>
+#include <new>
+#include <limits>
+
+#include "boost/shared_ptr.hpp"
+#include "boost/weak_ptr.hpp"
+#include "boost/enable_shared_from_this.hpp"
+#include "boost/function.hpp"
+#include "boost/thread/mutex.hpp"
+
+namespace jafar {
+	namespace rtslam {
+
+
+		/**
+		 * Free list of memory blocks of one size.
+		 *
+		 * The blocks are allocated by chunks and are only given back to the system allocator at the
+		 * destruction of the pool, so that once the pool has grown to the peak need, allocating and
+		 * freeing a block only pops and pushes a pointer.
+		 * There is one pool per block size, shared by all the types of this size, see forSize() and of().
+		 * \ingroup rtslam
+		 */
+		class BlockPool {
+			private:
+				size_t blockSize_;
+				size_t blocksPerChunk_;
+				std::vector<void*> freeBlocks_;
+				std::vector<char*> chunks_;
+				boost::mutex mutex_;
+
+				BlockPool(const BlockPool &);
+				BlockPool & operator=(const BlockPool &);
+				void grow();
+
+			public:
+				/// alignment of the blocks, and granularity of their sizes
+				static const size_t ALIGNMENT = 16;
+
+				BlockPool(size_t blockSize, size_t blocksPerChunk = 64);
+				~BlockPool();
+
+				void * allocate();
+				void deallocate(void * p);
+
+				size_t blockSize() const { return blockSize_; }
+				size_t nChunks() const { return chunks_.size(); }
+				size_t nFree() const { return freeBlocks_.size(); }
+
+				/// the pool of the blocks of at least this size
+				static BlockPool & forSize(size_t size);
+				/// the pool of the blocks of type T
+				template<class T>
+				static BlockPool & of() {
+					static BlockPool & pool = forSize(sizeof(T));
+					return pool;
+				}
+		};
+
+
+		/**
+		 * Standard allocator over the block pools, for the reference counts of the shared pointers.
+		 * \ingroup rtslam
+		 */
+		template<class T>
+		class PoolAllocator {
+			public:
+				typedef T value_type;
+				typedef T* pointer;
+				typedef const T* const_pointer;
+				typedef T& reference;
+				typedef const T& const_reference;
+				typedef size_t size_type;
+				typedef ptrdiff_t difference_type;
+				template<class U> struct rebind { typedef PoolAllocator<U> other; };
+
+				PoolAllocator() {}
+				template<class U> PoolAllocator(const PoolAllocator<U> &) {}
+
+				pointer address(reference x) const { return &x; }
+				const_pointer address(const_reference x) const { return &x; }
+				size_type max_size() const { return std::numeric_limits<size_type>::max() / sizeof(T); }
+				void construct(pointer p, const T & val) { new (p) T(val); }
+				void destroy(pointer p) { p->~T(); }
+
+				pointer allocate(size_type n, const void * = 0) {
+					if (n == 1) return static_cast<pointer>(BlockPool::of<T>().allocate());
+					return static_cast<pointer>(::operator new(n * sizeof(T)));
+				}
+				void deallocate(pointer p, size_type n) {
+					if (n == 1) BlockPool::of<T>().deallocate(p);
+					else ::operator delete(p);
+				}
+		};
+
+		template<class T, class U>
+		inline bool operator==(const PoolAllocator<T> &, const PoolAllocator<U> &) { return true; }
+		template<class T, class U>
+		inline bool operator!=(const PoolAllocator<T> &, const PoolAllocator<U> &) { return false; }
+
+
+		/**
+		 * Memory for one object of type T, to be constructed with placement new and given to pooledPtr().
+		 * If the constructor throws, the block is not given back to the pool.
+		 */
+		template<class T>
+		inline void * poolAllocate() {
+			return BlockPool::of<T>().allocate();
+		}
+
+		/**
+		 * Deleter of the objects created in the memory of poolAllocate().
+		 */
+		template<class T>
+		struct PoolDeleter {
+				void operator()(T * p) const {
+					p->~T();
+					BlockPool::of<T>().deallocate(p);
+				}
+		};
+
+		/**
+		 * Shared pointer to an object created in the memory of poolAllocate(), with a pooled reference count:
+		 *
+		 * landmark_ptr_t lmkPtr = pooledPtr(new (poolAllocate<LandmarkEuclideanPoint>()) LandmarkEuclideanPoint(mapPtr));
+		 */
+		template<class T>
+		inline boost::shared_ptr<T> pooledPtr(T * p) {
+			return boost::shared_ptr<T>(p, PoolDeleter<T>(), PoolAllocator<T>());
+		}
+
+
+		/**
+		 * Pool of recycled objects.
+		 *
+		 * The objects given by acquire() are given back to the pool instead of being deleted when their last
+		 * shared pointer is released, and given again by the next acquire() with all their buffers.
+		 * They keep their last contents, that the user must overwrite.
+		 * The pool must be held by a shared pointer. It can be destroyed before the objects it gave,
+		 * that are then deleted normally.
+		 * \ingroup rtslam
+		 */
+		template<class T>
+		class ObjectPool: public boost::enable_shared_from_this<ObjectPool<T> > {
+			public:
+				typedef boost::function<T*()> maker_t;
+
+			private:
+				maker_t make_;
+				std::vector<T*> free_;
+				boost::mutex mutex_;
+
+				struct Recycler {
+						boost::weak_ptr<ObjectPool> poolPtr;
+						void operator()(T * p) const {
+							boost::shared_ptr<ObjectPool> pool = poolPtr.lock();
+							if (pool) pool->release(p); else delete p;
+						}
+				};
+
+				void release(T * p) {
+					boost::mutex::scoped_lock lock(mutex_);
+					free_.push_back(p);
+				}
+
+			public:
+				/// \param make the function that creates a new object, when none can be recycled
+				ObjectPool(const maker_t & make): make_(make) {}
+				~ObjectPool() {
+					for (size_t i = 0; i < free_.size(); ++i) delete free_[i];
+				}
+
+				boost::shared_ptr<T> acquire() {
+					T * p = NULL;
+					{
+						boost::mutex::scoped_lock lock(mutex_);
+						if (!free_.empty()) { p = free_.back(); free_.pop_back(); }
+					}
+					if (p == NULL) p = make_();
+					Recycler recycler;
+					recycler.poolPtr = this->shared_from_this();
+					return boost::shared_ptr<T>(p, recycler, PoolAllocator<T>());
+				}
+
+				size_t nFree() const { return free_.size(); }
+		};
+
+
+	}
+}
+
+#endif /* OBJECTPOOL_HPP_ */
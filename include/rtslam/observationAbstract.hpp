@@ -88,13 +88,15 @@ namespace jafar {
 			
 				/**
 				 * Back-project function
+				 * \return false if the measurement cannot be back-projected, \a lmk is then not set.
 				 */
-				virtual void backProject_func(const vec7 & sg, const vec & meas, const vec & nobs, vec & lmk) = 0;
+				virtual bool backProject_func(const vec7 & sg, const vec & meas, const vec & nobs, vec & lmk) = 0;
 
 				/**
 				 * Back-project function
+				 * \return false if the measurement cannot be back-projected, \a lmk is then not set.
 				 */
-				virtual void backProject_func(const vec7 & sg, const vec & meas, const vec & nobs, vec & lmk, mat & LMK_sg,
+				virtual bool backProject_func(const vec7 & sg, const vec & meas, const vec & nobs, vec & lmk, mat & LMK_sg,
 				                              mat & LMK_meas, mat & LMK_nobs) = 0;
 
 				virtual bool predictVisibility_func(jblas::vec x, jblas::vec nobs) = 0;
@@ -178,6 +180,8 @@ namespace jafar {
 				appearance_ptr_t predictedAppearance;
 				appearance_ptr_t observedAppearance;
 				jblas::sym_mat noiseCovariance;
+				/// global sensor pose to predict the appearance from, when the data manager has a better one than the filter
+				boost::shared_ptr<jblas::vec7> appearancePosePtr;
 
 				// indirect arrays
 				ind_array ia_rsl; ///<    Ind. array of mapped indices of robot, sensor and landmark (ie, sensor might or might not be there).
@@ -200,13 +204,8 @@ namespace jafar {
 				/**
 				 * Counters
 				 */
-				struct Counters {
-						int nSearch; ///< Number of searches
-						int nMatch;  ///< Number of matches
-						int nInlier; ///< Number of times declared inlier
-						int nSearchSinceLastInlier; ///< Number of frames the landmark was searched since last time it was inlier
-						int nFrameSinceLastVisible; ///< Number of frames since last time it was visible
-				} counters;
+				typedef ObservationCounters Counters;
+				Counters counters;
 
 				/**
 				 * Events
@@ -258,9 +257,23 @@ namespace jafar {
 				}
 				
 				/**
-				 * Back-project
+				 * Back-project the measurement, and initialize the landmark in the filter.
+				 * \return false if the measurement cannot be back-projected, the filter is then not changed
+				 * and the landmark must be deleted.
 				 */
-				void backProject();
+				bool backProject();
+
+				/**
+				 * Improve the prior with another measurement of the same feature, from another sensor pose.
+				 *
+				 * The prior must be an inverse distance. The point is searched along the ray of the current
+				 * measurement, for the inverse distance that best reprojects to the other measurement.
+				 * \param sgOther the global sensor pose of the other measurement
+				 * \param measOther the other measurement
+				 * \param error the reprojection error of the best point in the other view (output), negative if not computed.
+				 * \return true if the parallax reduced the prior uncertainty and the prior was changed.
+				 */
+				bool triangulatePrior(const vec7 & sgOther, const vec & measOther, double & error);
 
 				/**
 				 * Compute innovation from measurement and expectation.
@@ -372,6 +385,14 @@ namespace jafar {
 
 				virtual bool predictAppearance_func() = 0;
 
+				/**
+				 * Global sensor pose to predict the appearance from: the one given by the data manager if any,
+				 * or else the current estimate.
+				 */
+				jblas::vec7 appearanceSensorPose() {
+					return appearancePosePtr ? *appearancePosePtr : sensorPtr()->globalPose();
+				}
+
 				virtual double getMatchScore() = 0;
 
 				void update() ;
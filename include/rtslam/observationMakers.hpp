@@ -9,7 +9,10 @@
  * \ingroup rtslam
  */
 
+#include "boost/bind.hpp"
+
 #include "rtslam/observationFactory.hpp"
+#include "rtslam/objectPool.hpp"
 #include "rtslam/featurePoint.hpp"
 #include "rtslam/descriptorImagePoint.hpp"
 #include "rtslam/descriptorImageSeg.hpp"
@@ -19,6 +22,10 @@
 namespace jafar {
 namespace rtslam {
 
+/**
+ * Maker of point observations. The observations are created in pooled memory, and their appearances
+ * are recycled with their patches (see objectPool.hpp).
+ */
 template<class ObsType, class SenType, class LmkType, class AppType,
 	 SensorAbstract::type_enum SenTypeId, LandmarkAbstract::type_enum LmkTypeId>
 class ImagePointObservationMaker
@@ -27,23 +34,31 @@ class ImagePointObservationMaker
 	private:
 		double dmin;
 		int patchSize;
+		boost::shared_ptr<ObjectPool<AppearanceAbstract> > appPool;
+
+		AppearanceAbstract* newAppearance()
+		{
+			if (boost::is_same<AppType,AppearanceImagePoint>::value)
+				return new AppearanceImagePoint(patchSize, patchSize, CV_8U);
+			else
+			if (boost::is_same<AppType,simu::AppearanceSimu>::value)
+				return new simu::AppearanceSimu();
+			return NULL;
+		}
+
 	public:
 
 		ImagePointObservationMaker(double _dmin, int _patchSize):
-			ObservationMakerAbstract(SenTypeId, LmkTypeId), dmin(_dmin), patchSize(_patchSize) {}
+			ObservationMakerAbstract(SenTypeId, LmkTypeId), dmin(_dmin), patchSize(_patchSize),
+			appPool(new ObjectPool<AppearanceAbstract>(boost::bind(&ImagePointObservationMaker::newAppearance, this))) {}
 
 		observation_ptr_t create(const sensor_ptr_t &senPtr, const landmark_ptr_t &lmkPtr)
 		{
-			boost::shared_ptr<ObsType> res(new ObsType(senPtr, lmkPtr));
-			if (boost::is_same<AppType,AppearanceImagePoint>::value)
-			{
-				res->predictedAppearance.reset(new AppearanceImagePoint(patchSize, patchSize, CV_8U));
-				res->observedAppearance.reset(new AppearanceImagePoint(patchSize, patchSize, CV_8U));
-			} else
-			if (boost::is_same<AppType,simu::AppearanceSimu>::value)
+			boost::shared_ptr<ObsType> res = pooledPtr(new (poolAllocate<ObsType>()) ObsType(senPtr, lmkPtr));
+			if (boost::is_same<AppType,AppearanceImagePoint>::value || boost::is_same<AppType,simu::AppearanceSimu>::value)
 			{
-				res->predictedAppearance.reset(new simu::AppearanceSimu());
-				res->observedAppearance.reset(new simu::AppearanceSimu());
+				res->predictedAppearance = appPool->acquire();
+				res->observedAppearance = appPool->acquire();
 			}
 			res->setup(dmin);
 			return res;
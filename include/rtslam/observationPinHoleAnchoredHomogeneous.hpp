@@ -77,11 +77,11 @@ namespace jafar {
 				/**
 				 * Retro-projection function, with Jacobians
 				 */
-				virtual void backProject_func(const vec7 & sg, const vec & meas, const vec & nobs, vec & lmk);
+				virtual bool backProject_func(const vec7 & sg, const vec & meas, const vec & nobs, vec & lmk);
 				/**
 				 * Retro-projection function, with Jacobians
 				 */
-				virtual void backProject_func(const vec7 & sg, const vec & meas, const vec & nobs, vec & lmk, mat & LMK_sg,
+				virtual bool backProject_func(const vec7 & sg, const vec & meas, const vec & nobs, vec & lmk, mat & LMK_sg,
 				                      mat & LMK_meas, mat & LMK_nobs);
 
 				/**
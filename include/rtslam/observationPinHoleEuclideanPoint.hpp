@@ -72,11 +72,11 @@ namespace jafar {
 				/**
 				 * Retro-projection function, with Jacobians
 				 */
-				virtual void backProject_func(const vec7 & sg, const vec & meas, const vec & nobs, vec & lmk);
+				virtual bool backProject_func(const vec7 & sg, const vec & meas, const vec & nobs, vec & lmk);
 				/**
 				 * Retro-projection function, with Jacobians
 				 */
-				virtual void backProject_func(const vec7 & sg, const vec & meas, const vec & nobs, vec & lmk, mat & EUC_sg,
+				virtual bool backProject_func(const vec7 & sg, const vec & meas, const vec & nobs, vec & lmk, mat & EUC_sg,
 				    mat & LMK_meas, mat & LMK_nobs);
 
 
@@ -13,8 +13,11 @@
 #include <vector>
 #include <iostream>
 #include <boost/smart_ptr.hpp>
+#include <boost/unordered_map.hpp>
 #include <boost/bind.hpp>
 
+#include "kernel/jafarDebug.hpp"
+
 #include "rtslam/rtSlam.hpp"
 
 
@@ -34,6 +37,17 @@ namespace jafar {
 /* Use this generic class by inhereting from it in the parent class.
  * The child class can be known only partially:
  * (ie class Child; class Parent : public ParentOf<Child> {...}; class Child { ... };)
+ *
+ * Along with the list, the parent keeps the slot (list iterator) of each child,
+ * indexed by the child address, so that unregisterChild() is O(1) instead of
+ * a linear scan of the list. The slot cannot be stored in the child itself,
+ * because a child can have several parents of the same ParentOf<Child> type
+ * (eg an observation is a child of both its landmark and its data manager).
+ * The list is still a std::list, so iterators remain valid while other children
+ * are unregistered, which is relied upon when deleting landmarks in a loop.
+ * The list must only be modified through registerChild() and unregisterChild(),
+ * the accessors give it for iteration only; unregisterChild() asserts that the
+ * list and the slots are still in sync.
  */
 template<class Child>
 class ParentOf {
@@ -41,21 +55,33 @@ public:
 	typedef boost::shared_ptr<Child> Child_ptr;
 	typedef std::list<Child_ptr> ChildList;
 
-public:
+protected:
+	typedef boost::unordered_map<const Child*, typename ChildList::iterator> ChildSlots;
+
 	ChildList childList;
+	ChildSlots childSlots;
 
 public:
 	~ParentOf(void) {
 //		std::cout << "Destroy Parent. " << std::endl;
 	}
 
+	/** Register a child. A child already registered is not added twice. */
 	void registerChild(const Child_ptr & ptr) {
-		childList.push_back(ptr);
+		if (childSlots.find(ptr.get()) != childSlots.end()) return;
+		childSlots[ptr.get()] = childList.insert(childList.end(), ptr);
 	}
+	/** Unregister a child, in constant time. Does nothing if the child is not registered. */
 	void unregisterChild(const Child_ptr & ptr) {
-//		remove(childList.begin(), childList.end(), ptr);
-		childList.remove(ptr);
-//		childList.pop_back();
+		typename ChildSlots::iterator slot = childSlots.find(ptr.get());
+		if (slot == childSlots.end()) return;
+		JFR_ASSERT(childList.size() == childSlots.size() && *slot->second == ptr,
+		           "ParentOf::unregisterChild: child list modified out of registerChild() and unregisterChild()");
+		childList.erase(slot->second);
+		childSlots.erase(slot);
+	}
+	bool isChild(const Child_ptr & ptr) const {
+		return childSlots.find(ptr.get()) != childSlots.end();
 	}
 
 	void display(std::ostream& os) const {
@@ -94,6 +94,7 @@ namespace jafar {
 					JFR_ASSERT(_P_ct.size1() == size(), "Matrix sizes mismatch.");
 					P_ct = _P_ct;
 				}
+				const sym_mat & P_continuous() const { return P_ct; }
 				template<class V>
 				void set_x_continuous(V & _x_ct) {
 					JFR_ASSERT(_x_ct.size() == size(), "Vector sizes mismatch.");
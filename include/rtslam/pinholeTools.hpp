@@ -308,6 +308,78 @@ namespace jafar {
 			}
 
 
+			/**
+			 * Radial undistortion by iterative inversion of the distortion model.
+			 *
+			 * Unlike undistortPoint(), which evaluates the approximate correction model, this
+			 * solves rd = r * s(r^2) for the undistorted radius r by Newton iterations, so that
+			 * distortPoint(d, up) = ud up to \a tol. Too costly per point, it is meant to build
+			 * lookup tables (see UndistortionMap).
+			 * Beyond the radius where the distortion stops being monotonic, the model cannot be
+			 * inverted and the iterations do not converge: the point must then be rejected.
+			 * \param d the radial distortion parameters vector
+			 * \param ud the distorted point
+			 * \param up the undistorted point, the last iterate if it did not converge
+			 * \param tol the tolerance on the undistorted radius
+			 * \return false if the iterations did not converge
+			 */
+			template<class VD, class VUd>
+			bool undistortPointIterative(const VD & d, const VUd & ud, jblas::vec2 & up, double tol = 1e-12) {
+				up = ud;
+				size_t n = d.size();
+				double rd = sqrt(ud(0) * ud(0) + ud(1) * ud(1));
+				if (n == 0 || rd < tol) return true;
+
+				double r = rd; // start with the distorted radius
+				bool converged = false;
+				for (size_t iter = 0; iter < 20 && !converged; iter++) {
+					double r2 = r * r;
+					double s = 1.0;
+					double r2i = 1.0;
+					double r2im1 = 1.0;
+					double S_r2 = 0.0;
+					for (size_t i = 0; i < n; i++) {
+						r2i = r2i * r2; //................. r2i = r^(2*(i+1))
+						s += d(i) * r2i; //................ s = 1 + d_0 * r^2 + d_1 * r^4 + ...
+						S_r2 += (i + 1) * d(i) * r2im1; //. S_r2 = d_0 + 2 * d_1 * r^2 + ...
+						r2im1 = r2im1 * r2;
+					}
+					double F_r = s + 2 * r2 * S_r2; // d(r*s)/dr
+					if (F_r < 1e-3) break; // past the monotony limit of the model
+					double dr = (r * s - rd) / F_r;
+					r -= dr;
+					converged = (fabs(dr) < tol);
+				}
+				up = (r / rd) * ud;
+				return converged;
+			}
+
+			/**
+			 * Radial undistortion by iterative inversion of the distortion model, with Jacobians.
+			 * The Jacobian is the inverse of the one of the distortion at the solution.
+			 * \param d the radial distortion parameters vector
+			 * \param ud the distorted point
+			 * \param up the undistorted point
+			 * \param UP_ud the Jacobian of \a up wrt \a ud
+			 * \return false if the iterations did not converge, the point must then be rejected
+			 */
+			template<class VD, class VUd, class VUp, class MUP_ud>
+			bool undistortPointIterative(const VD & d, const VUd & ud, VUp & up, MUP_ud & UP_ud) {
+				jblas::vec2 up_;
+				bool converged = undistortPointIterative(d, ud, up_);
+				up = up_;
+				jblas::vec2 ud_;
+				jblas::mat22 UD_up;
+				distortPoint(d, up, ud_, UD_up);
+				double det = UD_up(0, 0) * UD_up(1, 1) - UD_up(0, 1) * UD_up(1, 0);
+				UP_ud(0, 0) = UD_up(1, 1) / det;
+				UP_ud(0, 1) = -UD_up(0, 1) / det;
+				UP_ud(1, 0) = -UD_up(1, 0) / det;
+				UP_ud(1, 1) = UD_up(0, 0) / det;
+				return converged;
+			}
+
+
 			/**
 			 * Pixellization from k = [u_0, v_0, a_u, a_v]
 			 * \param k the vector of intrinsic parameters, k = [u0, v0, au, av]
@@ -0,0 +1,104 @@
+/**
+ * \file posePredictor.hpp
+ *
+ * Prediction of the robot pose at the rate of the proprioceptive sensor.
+ *
+ * \date 17/10/2026
+ * \author croussil
+ *
+ * \ingroup rtslam
+ */
+
+#ifndef POSEPREDICTOR_HPP_
+#define POSEPREDICTOR_HPP_
+
+#include <deque>
+
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "jmath/jblas.hpp"
+#include "rtslam/robotAbstract.hpp"
+
+namespace jafar {
+	namespace rtslam {
+
+		/**
+		 * Prediction of the robot pose at the rate of the proprioceptive sensor (IMU, odometry).
+		 *
+		 * The filtered robot state is only known after the processing of each exteroceptive data,
+		 * with its latency, and at the rate of this sensor. This class keeps a copy of the last filtered
+		 * robot state and of its covariance (robot block only, the map is not used), and moves it
+		 * with each new reading of the hardware estimator of the robot, in the acquisition thread,
+		 * to publish a predicted pose immediately.
+		 *
+		 * When a correction is done, correct() snaps the prediction to the filtered state,
+		 * and replays the readings received since its date, so that the prediction is always up to date.
+		 *
+		 * \ingroup rtslam
+		 */
+		class PosePredictor {
+			public:
+				/// called with the date, the robot state and its covariance for each predicted pose
+				typedef boost::function<void(double, const jblas::vec &, const jblas::sym_mat &)> listener_t;
+
+			private:
+				robot_ptr_t robPtr;
+				boost::mutex mutex_data;
+				listener_t listener;
+				size_t maxReadings;
+				std::deque<jblas::vec> readings; ///< last readings, to replay them after a correction
+				jblas::ind_array incrementArray; ///< indices in the control of the values that are increments since the previous reading
+
+				bool valid; ///< a filtered state was received
+				double time; ///< date of the prediction
+				double readingTime; ///< date of the last reading used, the increments are counted from there
+				jblas::vec x;
+				jblas::sym_mat P;
+				jblas::vec xnew;
+				jblas::mat XNEW_x;
+				jblas::mat XNEW_pert;
+				jblas::sym_mat Q;
+
+				void step(const jblas::vec & reading);
+				void publish() { if (listener) listener(time, x, P); }
+
+			public:
+				/**
+				 * Create the predictor and register it to the hardware estimator of the robot.
+				 * \param robPtr the robot, that must have a hardware estimator
+				 * \param maxReadings the number of readings kept to be replayed, it must cover the latency of the corrections
+				 */
+				PosePredictor(robot_ptr_t robPtr, size_t maxReadings = 1000);
+				~PosePredictor();
+
+				/**
+				 * Set the function called for each predicted pose, in the acquisition thread.
+				 * It must return quickly.
+				 */
+				void setListener(listener_t _listener) { boost::unique_lock<boost::mutex> l(mutex_data); listener = _listener; }
+
+				/**
+				 * Snap to the filtered state of the robot, to be called after each correction, in the slam thread.
+				 */
+				void correct();
+
+				/**
+				 * Move the prediction with a new reading of the hardware estimator, called in the acquisition thread.
+				 * \param reading the time and the control, as one line of HardwareEstimatorAbstract::acquireReadings
+				 */
+				void newReading(const jblas::vec & reading);
+
+				/**
+				 * Get the last predicted pose.
+				 * \return false if there is no prediction yet
+				 */
+				bool getPose(double & _time, jblas::vec & _x, jblas::sym_mat & _P);
+		};
+
+		typedef boost::shared_ptr<PosePredictor> pose_predictor_ptr_t;
+
+	}
+}
+
+#endif /* POSEPREDICTOR_HPP_ */
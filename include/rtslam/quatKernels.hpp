@@ -0,0 +1,443 @@
+/**
+ * \file quatKernels.hpp
+ *
+ * Fixed-size kernels for quaternion and frame operations.
+ *
+ * \date 17/10/2026
+ * \author jsola
+ *
+ * These are the operations of quatTools.hpp on plain arrays:
+ * quaternions are double[4] = [qw, qx, qy, qz], vectors double[3], frames double[7] = [t, q],
+ * and Jacobians are written row-major into caller-provided arrays, eg. double[3*4] for a 3x4 Jacobian.
+ * They do not allocate nor build expression temporaries, and are meant for the inner loops
+ * (robot motion, sensor pose, landmark transformations).
+ * Outputs must not alias inputs.
+ *
+ * \ingroup rtslam
+ */
+
+#ifndef QUATKERNELS_HPP_
+#define QUATKERNELS_HPP_
+
+#include <cmath>
+#include "jmath/ublasExtra.hpp"
+
+namespace jafar {
+	namespace rtslam {
+		namespace quaternion {
+			/**
+			 * Namespace for fixed-size quaternion kernels.
+			 * \ingroup rtslam
+			 */
+			namespace fixed {
+
+
+				/**
+				 * Copy \a n elements of a ublas vector, from \a i0, to an array.
+				 */
+				template<class V>
+				inline void load(const V & v, size_t i0, size_t n, double * out) {
+					for (size_t i = 0; i < n; ++i) out[i] = v(i0 + i);
+				}
+
+				/**
+				 * Copy an array of \a n elements to a ublas vector, from \a i0.
+				 */
+				template<class V>
+				inline void store(const double * in, size_t n, V & v, size_t i0) {
+					for (size_t i = 0; i < n; ++i) v(i0 + i) = in[i];
+				}
+
+				/**
+				 * Copy a row-major \a rows x \a cols Jacobian to a block of a ublas matrix at (\a r0, \a c0).
+				 */
+				template<class M>
+				inline void storeJac(const double * J, size_t rows, size_t cols, M & dst, size_t r0 = 0, size_t c0 = 0) {
+					for (size_t i = 0; i < rows; ++i)
+						for (size_t j = 0; j < cols; ++j)
+							dst(r0 + i, c0 + j) = J[i * cols + j];
+				}
+
+
+				/**
+				 * Conjugate of quaternion.
+				 */
+				inline void q2qc(const double q[4], double qc[4]) {
+					qc[0] = q[0]; qc[1] = -q[1]; qc[2] = -q[2]; qc[3] = -q[3];
+				}
+
+
+				/**
+				 * Rotation matrix from quaternion, row-major.
+				 */
+				inline void q2R(const double q[4], double R[9]) {
+					double ww = q[0] * q[0], wx = 2 * q[0] * q[1], wy = 2 * q[0] * q[2], wz = 2 * q[0] * q[3];
+					double xx = q[1] * q[1], xy = 2 * q[1] * q[2], xz = 2 * q[1] * q[3];
+					double yy = q[2] * q[2], yz = 2 * q[2] * q[3];
+					double zz = q[3] * q[3];
+					R[0] = ww + xx - yy - zz; R[1] = xy - wz;           R[2] = xz + wy;
+					R[3] = xy + wz;           R[4] = ww - xx + yy - zz; R[5] = yz - wx;
+					R[6] = xz - wy;           R[7] = yz + wx;           R[8] = ww - xx - yy + zz;
+				}
+
+
+				/**
+				 * Rotate a vector: vo = R(q) * v.
+				 */
+				inline void rotate(const double q[4], const double v[3], double vo[3]) {
+					double R[9];
+					q2R(q, R);
+					vo[0] = R[0] * v[0] + R[1] * v[1] + R[2] * v[2];
+					vo[1] = R[3] * v[0] + R[4] * v[1] + R[5] * v[2];
+					vo[2] = R[6] * v[0] + R[7] * v[1] + R[8] * v[2];
+				}
+
+				/**
+				 * Jacobian of R(q) * v wrt q, 3x4.
+				 */
+				inline void rotate_by_dq(const double q[4], const double v[3], double VO_q[12]) {
+					double t1 = 2 * (q[0] * v[0] - q[3] * v[1] + q[2] * v[2]);
+					double t2 = 2 * (q[1] * v[0] + q[2] * v[1] + q[3] * v[2]);
+					double t3 = 2 * (q[2] * v[0] - q[1] * v[1] - q[0] * v[2]);
+					double t4 = 2 * (q[3] * v[0] + q[0] * v[1] - q[1] * v[2]);
+					VO_q[0] = t1;  VO_q[1] = t2; VO_q[2] = -t3;  VO_q[3] = -t4;
+					VO_q[4] = t4;  VO_q[5] = t3; VO_q[6] = t2;   VO_q[7] = t1;
+					VO_q[8] = -t3; VO_q[9] = t4; VO_q[10] = -t1; VO_q[11] = t2;
+				}
+
+				/**
+				 * Rotate a vector, with Jacobians wrt q (3x4) and v (3x3, this is R(q)).
+				 */
+				inline void rotate(const double q[4], const double v[3], double vo[3], double VO_q[12], double VO_v[9]) {
+					q2R(q, VO_v);
+					vo[0] = VO_v[0] * v[0] + VO_v[1] * v[1] + VO_v[2] * v[2];
+					vo[1] = VO_v[3] * v[0] + VO_v[4] * v[1] + VO_v[5] * v[2];
+					vo[2] = VO_v[6] * v[0] + VO_v[7] * v[1] + VO_v[8] * v[2];
+					rotate_by_dq(q, v, VO_q);
+				}
+
+
+				/**
+				 * Rotate inversely a vector: vo = R(q)' * v.
+				 */
+				inline void rotateInv(const double q[4], const double v[3], double vo[3]) {
+					double R[9];
+					q2R(q, R);
+					vo[0] = R[0] * v[0] + R[3] * v[1] + R[6] * v[2];
+					vo[1] = R[1] * v[0] + R[4] * v[1] + R[7] * v[2];
+					vo[2] = R[2] * v[0] + R[5] * v[1] + R[8] * v[2];
+				}
+
+				/**
+				 * Jacobian of R(q)' * v wrt q, 3x4.
+				 */
+				inline void rotateInv_by_dq(const double q[4], const double v[3], double VO_q[12]) {
+					double s1 = 2 * (q[0] * v[0] + q[3] * v[1] - q[2] * v[2]);
+					double s2 = 2 * (q[1] * v[0] + q[2] * v[1] + q[3] * v[2]);
+					double s3 = 2 * (q[2] * v[0] - q[1] * v[1] + q[0] * v[2]);
+					double s4 = 2 * (q[3] * v[0] - q[0] * v[1] - q[1] * v[2]);
+					VO_q[0] = s1;  VO_q[1] = s2; VO_q[2] = -s3; VO_q[3] = -s4;
+					VO_q[4] = -s4; VO_q[5] = s3; VO_q[6] = s2;  VO_q[7] = -s1;
+					VO_q[8] = s3;  VO_q[9] = s4; VO_q[10] = s1; VO_q[11] = s2;
+				}
+
+				/**
+				 * Rotate inversely a vector, with Jacobians wrt q (3x4) and v (3x3, this is R(q)').
+				 */
+				inline void rotateInv(const double q[4], const double v[3], double vo[3], double VO_q[12], double VO_v[9]) {
+					double R[9];
+					q2R(q, R);
+					VO_v[0] = R[0]; VO_v[1] = R[3]; VO_v[2] = R[6];
+					VO_v[3] = R[1]; VO_v[4] = R[4]; VO_v[5] = R[7];
+					VO_v[6] = R[2]; VO_v[7] = R[5]; VO_v[8] = R[8];
+					vo[0] = VO_v[0] * v[0] + VO_v[1] * v[1] + VO_v[2] * v[2];
+					vo[1] = VO_v[3] * v[0] + VO_v[4] * v[1] + VO_v[5] * v[2];
+					vo[2] = VO_v[6] * v[0] + VO_v[7] * v[1] + VO_v[8] * v[2];
+					rotateInv_by_dq(q, v, VO_q);
+				}
+
+
+				/**
+				 * Quaternion product q = q1**q2.
+				 */
+				inline void qProd(const double q1[4], const double q2[4], double q[4]) {
+					q[0] = q1[0] * q2[0] - q1[1] * q2[1] - q1[2] * q2[2] - q1[3] * q2[3];
+					q[1] = q1[0] * q2[1] + q1[1] * q2[0] + q1[2] * q2[3] - q1[3] * q2[2];
+					q[2] = q1[0] * q2[2] - q1[1] * q2[3] + q1[2] * q2[0] + q1[3] * q2[1];
+					q[3] = q1[0] * q2[3] + q1[1] * q2[2] - q1[2] * q2[1] + q1[3] * q2[0];
+				}
+
+				/**
+				 * Jacobian of q1**q2 wrt q1, 4x4. It only depends on q2.
+				 */
+				inline void qProd_by_dq1(const double q2[4], double Q_q1[16]) {
+					Q_q1[0] = q2[0];  Q_q1[1] = -q2[1];  Q_q1[2] = -q2[2];  Q_q1[3] = -q2[3];
+					Q_q1[4] = q2[1];  Q_q1[5] = q2[0];   Q_q1[6] = q2[3];   Q_q1[7] = -q2[2];
+					Q_q1[8] = q2[2];  Q_q1[9] = -q2[3];  Q_q1[10] = q2[0];  Q_q1[11] = q2[1];
+					Q_q1[12] = q2[3]; Q_q1[13] = q2[2];  Q_q1[14] = -q2[1]; Q_q1[15] = q2[0];
+				}
+
+				/**
+				 * Jacobian of q1**q2 wrt q2, 4x4. It only depends on q1.
+				 */
+				inline void qProd_by_dq2(const double q1[4], double Q_q2[16]) {
+					Q_q2[0] = q1[0];  Q_q2[1] = -q1[1];  Q_q2[2] = -q1[2];  Q_q2[3] = -q1[3];
+					Q_q2[4] = q1[1];  Q_q2[5] = q1[0];   Q_q2[6] = -q1[3];  Q_q2[7] = q1[2];
+					Q_q2[8] = q1[2];  Q_q2[9] = q1[3];   Q_q2[10] = q1[0];  Q_q2[11] = -q1[1];
+					Q_q2[12] = q1[3]; Q_q2[13] = -q1[2]; Q_q2[14] = q1[1];  Q_q2[15] = q1[0];
+				}
+
+				/**
+				 * Quaternion product, with Jacobians.
+				 */
+				inline void qProd(const double q1[4], const double q2[4], double q[4], double Q_q1[16], double Q_q2[16]) {
+					qProd(q1, q2, q);
+					qProd_by_dq1(q2, Q_q1);
+					qProd_by_dq2(q1, Q_q2);
+				}
+
+
+				/**
+				 * Quaternion from rotation vector.
+				 */
+				inline void v2q(const double v[3], double q[4]) {
+					double a = sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+					if (a < 1e-6) { q[0] = 1.0; q[1] = q[2] = q[3] = 0.0; return; }
+					double san = sin(a / 2) / a;
+					q[0] = cos(a / 2);
+					q[1] = v[0] * san;
+					q[2] = v[1] * san;
+					q[3] = v[2] * san;
+				}
+
+				/**
+				 * Jacobian of quaternion wrt rotation vector, 4x3.
+				 */
+				inline void v2q_by_dv(const double v[3], double Q_v[12]) {
+					double a = sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+					if (a > jmath::ublasExtra::details::EPSILON) {
+						// Q_v = Q_a * u' + Q_u * (I - u*u')/a, with u = v/a
+						double u[3] = { v[0] / a, v[1] / a, v[2] / a };
+						double sa2 = sin(a / 2), ca22 = cos(a / 2) / 2, sa2_a = sa2 / a;
+						for (size_t j = 0; j < 3; ++j) {
+							Q_v[j] = -sa2 / 2 * u[j];
+							for (size_t i = 0; i < 3; ++i)
+								Q_v[3 * (i + 1) + j] = (ca22 - sa2_a) * u[i] * u[j] + (i == j ? sa2_a : 0.0);
+						}
+					}
+					else {
+						Q_v[0] = v[0] / 4; Q_v[1] = v[1] / 4; Q_v[2] = v[2] / 4;
+						Q_v[3] = 0.5; Q_v[4] = 0.0; Q_v[5] = 0.0;
+						Q_v[6] = 0.0; Q_v[7] = 0.5; Q_v[8] = 0.0;
+						Q_v[9] = 0.0; Q_v[10] = 0.0; Q_v[11] = 0.5;
+					}
+				}
+
+
+				/**
+				 * Quaternion from Euler angles [roll, pitch, yaw], closed form of qz**qy**qx.
+				 */
+				inline void e2q(const double e[3], double q[4]) {
+					double sr = sin(e[0] / 2), sp = sin(e[1] / 2), sy = sin(e[2] / 2);
+					double cr = cos(e[0] / 2), cp = cos(e[1] / 2), cy = cos(e[2] / 2);
+					q[0] = cy * cp * cr + sy * sp * sr;
+					q[1] = cy * cp * sr - sy * sp * cr;
+					q[2] = cy * sp * cr + sy * cp * sr;
+					q[3] = sy * cp * cr - cy * sp * sr;
+				}
+
+				/**
+				 * Quaternion from Euler angles, with Jacobian, 4x3.
+				 */
+				inline void e2q(const double e[3], double q[4], double Q_e[12]) {
+					double sr = sin(e[0] / 2), sp = sin(e[1] / 2), sy = sin(e[2] / 2);
+					double cr = cos(e[0] / 2), cp = cos(e[1] / 2), cy = cos(e[2] / 2);
+					q[0] = cy * cp * cr + sy * sp * sr;
+					q[1] = cy * cp * sr - sy * sp * cr;
+					q[2] = cy * sp * cr + sy * cp * sr;
+					q[3] = sy * cp * cr - cy * sp * sr;
+					Q_e[0] = (-cy * cp * sr + sy * sp * cr) / 2;
+					Q_e[1] = (-cy * sp * cr + sy * cp * sr) / 2;
+					Q_e[2] = (-sy * cp * cr + cy * sp * sr) / 2;
+					Q_e[3] = (cy * cp * cr + sy * sp * sr) / 2;
+					Q_e[4] = (-cy * sp * sr - sy * cp * cr) / 2;
+					Q_e[5] = (-sy * cp * sr - cy * sp * cr) / 2;
+					Q_e[6] = (-cy * sp * sr + sy * cp * cr) / 2;
+					Q_e[7] = (cy * cp * cr - sy * sp * sr) / 2;
+					Q_e[8] = (-sy * sp * cr + cy * cp * sr) / 2;
+					Q_e[9] = (-sy * cp * sr - cy * sp * cr) / 2;
+					Q_e[10] = (-cy * cp * sr - sy * sp * cr) / 2;
+					Q_e[11] = (cy * cp * cr + sy * sp * sr) / 2;
+				}
+
+
+				/**
+				 * From-frame transformation for Euclidean points: p = R(q) * pf + t.
+				 */
+				inline void eucFromFrame(const double F[7], const double pf[3], double p[3]) {
+					rotate(F + 3, pf, p);
+					p[0] += F[0]; p[1] += F[1]; p[2] += F[2];
+				}
+
+				/**
+				 * From-frame transformation for Euclidean points, with Jacobians wrt F (3x7) and pf (3x3).
+				 */
+				inline void eucFromFrame(const double F[7], const double pf[3], double p[3], double P_f[21], double P_pf[9]) {
+					double P_q[12];
+					rotate(F + 3, pf, p, P_q, P_pf);
+					p[0] += F[0]; p[1] += F[1]; p[2] += F[2];
+					for (size_t i = 0; i < 3; ++i) {
+						for (size_t j = 0; j < 3; ++j) P_f[7 * i + j] = (i == j ? 1.0 : 0.0);
+						for (size_t j = 0; j < 4; ++j) P_f[7 * i + 3 + j] = P_q[4 * i + j];
+					}
+				}
+
+				/**
+				 * To-frame transformation for Euclidean points: pf = R(q)' * (p - t).
+				 */
+				inline void eucToFrame(const double F[7], const double p[3], double pf[3]) {
+					double v[3] = { p[0] - F[0], p[1] - F[1], p[2] - F[2] };
+					rotateInv(F + 3, v, pf);
+				}
+
+				/**
+				 * To-frame transformation for Euclidean points, with Jacobians wrt F (3x7) and p (3x3).
+				 */
+				inline void eucToFrame(const double F[7], const double p[3], double pf[3], double PF_f[21], double PF_p[9]) {
+					double v[3] = { p[0] - F[0], p[1] - F[1], p[2] - F[2] };
+					double PF_q[12];
+					rotateInv(F + 3, v, pf, PF_q, PF_p);
+					for (size_t i = 0; i < 3; ++i) {
+						for (size_t j = 0; j < 3; ++j) PF_f[7 * i + j] = -PF_p[3 * i + j];
+						for (size_t j = 0; j < 4; ++j) PF_f[7 * i + 3 + j] = PF_q[4 * i + j];
+					}
+				}
+
+				/**
+				 * From-frame transformation for vectors: v = R(q) * vf.
+				 */
+				inline void vecFromFrame(const double F[7], const double vf[3], double v[3]) {
+					rotate(F + 3, vf, v);
+				}
+
+				/**
+				 * From-frame transformation for vectors, with Jacobians wrt F (3x7) and vf (3x3).
+				 */
+				inline void vecFromFrame(const double F[7], const double vf[3], double v[3], double V_f[21], double V_vf[9]) {
+					double V_q[12];
+					rotate(F + 3, vf, v, V_q, V_vf);
+					for (size_t i = 0; i < 3; ++i) {
+						for (size_t j = 0; j < 3; ++j) V_f[7 * i + j] = 0.0;
+						for (size_t j = 0; j < 4; ++j) V_f[7 * i + 3 + j] = V_q[4 * i + j];
+					}
+				}
+
+				/**
+				 * To-frame transformation for vectors: vf = R(q)' * v.
+				 */
+				inline void vecToFrame(const double F[7], const double v[3], double vf[3]) {
+					rotateInv(F + 3, v, vf);
+				}
+
+				/**
+				 * To-frame transformation for vectors, with Jacobians wrt F (3x7) and v (3x3).
+				 */
+				inline void vecToFrame(const double F[7], const double v[3], double vf[3], double VF_f[21], double VF_v[9]) {
+					double VF_q[12];
+					rotateInv(F + 3, v, vf, VF_q, VF_v);
+					for (size_t i = 0; i < 3; ++i) {
+						for (size_t j = 0; j < 3; ++j) VF_f[7 * i + j] = 0.0;
+						for (size_t j = 0; j < 4; ++j) VF_f[7 * i + 3 + j] = VF_q[4 * i + j];
+					}
+				}
+
+
+				/**
+				 * Compose frames C = GoL.
+				 */
+				inline void composeFrames(const double G[7], const double L[7], double C[7]) {
+					eucFromFrame(G, L, C);
+					qProd(G + 3, L + 3, C + 3);
+				}
+
+				/**
+				 * Jacobian of frame composition wrt the global frame, 7x7.
+				 *
+				 * C_g = [ I_3   rotate_by_dq ]
+				 *       [  0    qProd_by_dq1 ]
+				 */
+				inline void composeFrames_by_dglobal(const double G[7], const double L[7], double C_g[49]) {
+					double T_q[12], Q_q[16];
+					rotate_by_dq(G + 3, L, T_q);
+					qProd_by_dq1(L + 3, Q_q);
+					for (size_t i = 0; i < 3; ++i) {
+						for (size_t j = 0; j < 3; ++j) C_g[7 * i + j] = (i == j ? 1.0 : 0.0);
+						for (size_t j = 0; j < 4; ++j) C_g[7 * i + 3 + j] = T_q[4 * i + j];
+					}
+					for (size_t i = 0; i < 4; ++i) {
+						for (size_t j = 0; j < 3; ++j) C_g[7 * (3 + i) + j] = 0.0;
+						for (size_t j = 0; j < 4; ++j) C_g[7 * (3 + i) + 3 + j] = Q_q[4 * i + j];
+					}
+				}
+
+				/**
+				 * Jacobian of frame composition wrt the local frame, 7x7.
+				 *
+				 * C_l = [ R(qg)       0      ]
+				 *       [   0   qProd_by_dq2 ]
+				 */
+				inline void composeFrames_by_dlocal(const double G[7], double C_l[49]) {
+					double R[9], Q_q[16];
+					q2R(G + 3, R);
+					qProd_by_dq2(G + 3, Q_q);
+					for (size_t i = 0; i < 3; ++i) {
+						for (size_t j = 0; j < 3; ++j) C_l[7 * i + j] = R[3 * i + j];
+						for (size_t j = 0; j < 4; ++j) C_l[7 * i + 3 + j] = 0.0;
+					}
+					for (size_t i = 0; i < 4; ++i) {
+						for (size_t j = 0; j < 3; ++j) C_l[7 * (3 + i) + j] = 0.0;
+						for (size_t j = 0; j < 4; ++j) C_l[7 * (3 + i) + 3 + j] = Q_q[4 * i + j];
+					}
+				}
+
+				/**
+				 * Compose frames, with Jacobians wrt G and L, 7x7 each.
+				 */
+				inline void composeFrames(const double G[7], const double L[7], double C[7], double C_g[49], double C_l[49]) {
+					composeFrames(G, L, C);
+					composeFrames_by_dglobal(G, L, C_g);
+					composeFrames_by_dlocal(G, C_l);
+				}
+
+
+				/**
+				 * Invert frame: I = [ -R(q)' * t ; q* ].
+				 */
+				inline void invertFrame(const double F[7], double I[7]) {
+					rotateInv(F + 3, F, I);
+					I[0] = -I[0]; I[1] = -I[1]; I[2] = -I[2];
+					q2qc(F + 3, I + 3);
+				}
+
+				/**
+				 * Invert frame, with Jacobian, 7x7.
+				 */
+				inline void invertFrame(const double F[7], double I[7], double I_f[49]) {
+					double NT_q[12], NT_t[9];
+					rotateInv(F + 3, F, I, NT_q, NT_t);
+					I[0] = -I[0]; I[1] = -I[1]; I[2] = -I[2];
+					q2qc(F + 3, I + 3);
+					for (size_t k = 0; k < 49; ++k) I_f[k] = 0.0;
+					for (size_t i = 0; i < 3; ++i) {
+						for (size_t j = 0; j < 3; ++j) I_f[7 * i + j] = -NT_t[3 * i + j];
+						for (size_t j = 0; j < 4; ++j) I_f[7 * i + 3 + j] = -NT_q[4 * i + j];
+					}
+					I_f[7 * 3 + 3] = 1.0; I_f[7 * 4 + 4] = -1.0; I_f[7 * 5 + 5] = -1.0; I_f[7 * 6 + 6] = -1.0;
+				}
+
+			}
+		}
+	}
+}
+
+#endif /* QUATKERNELS_HPP_ */
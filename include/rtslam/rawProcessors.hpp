@@ -15,8 +15,12 @@
 #define RAWPROCESSORS_HPP_
 
 
+#include "jmath/misc.hpp"
 #include "correl/explorer.hpp"
 #include "rtslam/quickHarrisDetector.hpp"
+#include "rtslam/fastDetector.hpp"
+#include "rtslam/lkTracker.hpp"
+#include "rtslam/spiralSearch.hpp"
 
 
 #include "rtslam/rawImage.hpp"
@@ -28,10 +32,25 @@
 namespace jafar {
 namespace rtslam {
 
+	/**
+	 * ZNCC matcher.
+	 *
+	 * With spiralRings > 0 the search region is searched from the expectation to the border
+	 * in this number of rings, and the search stops at the first local maximum above the
+	 * threshold, see ZnccSpiralSearch. Otherwise the whole region is searched.
+	 */
 	class ImagePointZnccMatcher
 	{
 		private:
 			correl::FastTranslationMatcherZncc matcher;
+			ZnccSpiralSearch spiral;
+
+			double search(const image::Image & patch, const image::Image & image, const image::ConvexRoi & roi, double & x, double & y, double & xstd, double & ystd)
+			{
+				if (params.spiralRings > 0) return spiral.match(patch, image, roi, params.threshold, x, y, xstd, ystd);
+				spiral.stats.nSearch++; spiral.stats.nPositions += roi.count();
+				return matcher.match(patch, image, roi, x, y, xstd, ystd);
+			}
 		
 		public:
 			struct matcher_params_t {
@@ -43,11 +62,12 @@ namespace rtslam {
 				double relevanceTh; ///< Mahalanobis distance for no information rejection
 				double measStd;       ///<       measurement noise std deviation
 				double measVar;       ///<       measurement noise variance
+				int spiralRings;      ///<       number of rings of the search from the expectation, 0 to search the whole region
 			} params;
 
 		public:
-			ImagePointZnccMatcher(double minScore, double partialPosition, int patchSize, int maxSearchSize, double lowInnov, double threshold, double mahalanobisTh, double relevanceTh, double measStd):
-				matcher(minScore, partialPosition)
+			ImagePointZnccMatcher(double minScore, double partialPosition, int patchSize, int maxSearchSize, double lowInnov, double threshold, double mahalanobisTh, double relevanceTh, double measStd, int spiralRings = 0):
+				matcher(minScore, partialPosition), spiral(matcher, spiralRings)
 			{
 				JFR_ASSERT(patchSize%2, "patchSize must be an odd number!");
 				JFR_ASSERT(minScore>=0.0 && minScore<=1, "minScore must be between 0 and 1!");
@@ -59,15 +79,19 @@ namespace rtslam {
 				params.relevanceTh = relevanceTh;
 				params.measStd = measStd;
 				params.measVar = measStd * measStd;
+				params.spiralRings = spiralRings;
 			}
 
+			/// number of searches and of positions evaluated, all the positions of the region are counted for the full searches
+			const ZnccSpiralSearch::search_stats_t & searchStats() const { return spiral.stats; }
+
 			void match(const boost::shared_ptr<RawImage> & rawPtr, const appearance_ptr_t & targetApp, const image::ConvexRoi & roi, Measurement & measure, appearance_ptr_t & app)
 			{
 				app_img_pnt_ptr_t targetAppSpec = SPTR_CAST<AppearanceImagePoint>(targetApp);
 				app_img_pnt_ptr_t appSpec = SPTR_CAST<AppearanceImagePoint>(app);
 				
 				measure.std(params.measStd);
-				measure.matchScore = matcher.match(targetAppSpec->patch, *(rawPtr->img),
+				measure.matchScore = search(targetAppSpec->patch, *(rawPtr->img),
 					roi, measure.x()(0), measure.x()(1), measure.std_est(0), measure.std_est(1));
 				measure.x() += targetAppSpec->offset.x();
 				measure.P() += targetAppSpec->offset.P(); // no cross terms
@@ -78,6 +102,117 @@ namespace rtslam {
 			}
 	};
 
+	/**
+	 * ZNCC matcher with Lucas-Kanade refinement.
+	 *
+	 * The search regions smaller than lkDirectSize are tracked by LK from their center,
+	 * which is cheaper than the exhaustive correlation, that is only done if LK fails.
+	 * In the larger regions the best correlation is refined by LK.
+	 * The LK covariance is added to the measurement noise, so that the measurements
+	 * are less precise along the edges.
+	 * The correlation is done as in ImagePointZnccMatcher.
+	 * With lkIter = 0 it is the same as ImagePointZnccMatcher.
+	 */
+	class ImagePointLkMatcher
+	{
+		private:
+			correl::FastTranslationMatcherZncc matcher;
+			ZnccSpiralSearch spiral;
+			LkTracker tracker;
+
+			double search(const image::Image & patch, const image::Image & image, const image::ConvexRoi & roi, double & x, double & y, double & xstd, double & ystd)
+			{
+				if (params.spiralRings > 0) return spiral.match(patch, image, roi, params.threshold, x, y, xstd, ystd);
+				spiral.stats.nSearch++; spiral.stats.nPositions += roi.count();
+				return matcher.match(patch, image, roi, x, y, xstd, ystd);
+			}
+
+		public:
+			struct matcher_params_t {
+				int patchSize;
+				int maxSearchSize;
+				double lowInnov;      ///<     search region radius for first RANSAC consensus
+				double threshold;     ///<     matching threshold
+				double mahalanobisTh; ///< Mahalanobis distance for outlier rejection
+				double relevanceTh; ///< Mahalanobis distance for no information rejection
+				double measStd;       ///<       measurement noise std deviation
+				double measVar;       ///<       measurement noise variance
+				int lkDirectSize;     ///<       max size of the search regions tracked by LK without correlation
+				int lkIter;           ///<       max number of LK iterations, 0 to disable LK
+				int spiralRings;      ///<       number of rings of the search from the expectation, 0 to search the whole region
+			} params;
+
+		public:
+			ImagePointLkMatcher(double minScore, double partialPosition, int patchSize, int maxSearchSize, double lowInnov, double threshold, double mahalanobisTh, double relevanceTh, double measStd, int lkDirectSize, int lkIter, int spiralRings = 0):
+				matcher(minScore, partialPosition), spiral(matcher, spiralRings), tracker(lkIter, 0.02, lkDirectSize/2.0 + 1.0)
+			{
+				JFR_ASSERT(patchSize%2, "patchSize must be an odd number!");
+				JFR_ASSERT(minScore>=0.0 && minScore<=1, "minScore must be between 0 and 1!");
+				params.patchSize = patchSize;
+				params.maxSearchSize = maxSearchSize;
+				params.lowInnov = lowInnov;
+				params.threshold = threshold;
+				params.mahalanobisTh = mahalanobisTh;
+				params.relevanceTh = relevanceTh;
+				params.measStd = measStd;
+				params.measVar = measStd * measStd;
+				params.lkDirectSize = lkDirectSize;
+				params.lkIter = lkIter;
+				params.spiralRings = spiralRings;
+			}
+
+			/// number of correlation searches and of positions evaluated, see ImagePointZnccMatcher::searchStats()
+			const ZnccSpiralSearch::search_stats_t & searchStats() const { return spiral.stats; }
+
+			void match(const boost::shared_ptr<RawImage> & rawPtr, const appearance_ptr_t & targetApp, const image::ConvexRoi & roi, Measurement & measure, appearance_ptr_t & app)
+			{
+				app_img_pnt_ptr_t targetAppSpec = SPTR_CAST<AppearanceImagePoint>(targetApp);
+				app_img_pnt_ptr_t appSpec = SPTR_CAST<AppearanceImagePoint>(app);
+
+				measure.std(params.measStd);
+				// the gradients and the Hessian of the predicted patch are computed once for both stages
+				bool lk = params.lkIter > 0 && tracker.setTemplate(targetAppSpec->patch);
+				bool tracked = false;
+				double x, y, score, cov[3];
+				if (lk && roi.w() <= params.lkDirectSize && roi.h() <= params.lkDirectSize)
+				{
+					x = roi.x() + roi.w()/2.0 - targetAppSpec->offset.x()(0);
+					y = roi.y() + roi.h()/2.0 - targetAppSpec->offset.x()(1);
+					if (tracker.track(*(rawPtr->img), x, y, score, cov))
+					{
+						jblas::vec2 pix; pix(0) = x + targetAppSpec->offset.x()(0); pix(1) = y + targetAppSpec->offset.x()(1);
+						tracked = roi.isIn(pix);
+					}
+				}
+				if (!tracked)
+				{
+					measure.matchScore = search(targetAppSpec->patch, *(rawPtr->img),
+						roi, measure.x()(0), measure.x()(1), measure.std_est(0), measure.std_est(1));
+					if (lk && measure.matchScore > params.threshold)
+					{
+						// refinement only, not another search
+						x = measure.x()(0); y = measure.x()(1);
+						tracked = tracker.track(*(rawPtr->img), x, y, score, cov) &&
+							jmath::sqr(x - measure.x()(0)) + jmath::sqr(y - measure.x()(1)) <= 1.0;
+					}
+				}
+				if (tracked)
+				{
+					measure.matchScore = score;
+					measure.x()(0) = x; measure.x()(1) = y;
+					measure.P()(0,0) += cov[0]; measure.P()(0,1) += cov[1]; measure.P()(1,1) += cov[2];
+					measure.std_est(0) = sqrt(cov[0]); measure.std_est(1) = sqrt(cov[2]);
+				}
+
+				measure.x() += targetAppSpec->offset.x();
+				measure.P() += targetAppSpec->offset.P(); // no cross terms
+				rawPtr->img->extractPatch(appSpec->patch, (int)measure.x()(0), (int)measure.x()(1), appSpec->patch.width(), appSpec->patch.height());
+				appSpec->offset.x()(0) = measure.x()(0) - ((int)(measure.x()(0)) + 0.5);
+				appSpec->offset.x()(1) = measure.x()(1) - ((int)(measure.x()(1)) + 0.5);
+				appSpec->offset.P() = measure.P();
+			}
+	};
+
 	/*
 	*/
 
@@ -142,6 +277,70 @@ namespace rtslam {
 
 	};
 
+	/**
+	 * FAST detector, with the same interface as ImagePointHarrisDetector.
+	 *
+	 * With harrisScore the candidates of the segment test are scored with the Harris score,
+	 * with the same parameters as ImagePointHarrisDetector, see FastDetector.
+	 */
+	class ImagePointFastDetector
+	{
+		private:
+			FastDetector detector;
+			boost::shared_ptr<DescriptorFactoryAbstract> descFactory;
+
+		public:
+			struct detector_params_t {
+				int patchSize;  ///<       descriptor patch size
+				double measStd; ///<       measurement noise std deviation
+				double measVar; ///<       measurement noise variance
+			} params;
+
+		public:
+			ImagePointFastDetector(int arc, int threshold, bool harrisScore, int convSize, double thres, double edge, int patchSize, double measStd,
+				boost::shared_ptr<DescriptorFactoryAbstract> const &descFactory):
+				detector(arc, threshold, harrisScore, convSize, thres, edge), descFactory(descFactory)
+			{
+				JFR_ASSERT(convSize%2, "convSize must be an odd number!");
+				JFR_ASSERT(patchSize%2, "patchSize must be an odd number!");
+				params.patchSize = patchSize;
+				params.measStd = measStd;
+				params.measVar = measStd * measStd;
+			}
+
+			bool detect(const boost::shared_ptr<RawImage> & rawData, const image::ConvexRoi &roi, boost::shared_ptr<FeatureImagePoint> & featPtr)
+			{
+				featPtr.reset(new FeatureImagePoint(params.patchSize, params.patchSize, CV_8U));
+				featPtr->measurement.std(params.measStd);
+				if (detector.detectIn(*(rawData->img.get()), featPtr, &roi))
+				{
+					// extract appearance
+					vec pix = featPtr->measurement.x();
+					boost::shared_ptr<AppearanceImagePoint> appPtr = SPTR_CAST<AppearanceImagePoint>(featPtr->appearancePtr);
+					rawData->img->extractPatch(appPtr->patch, (int)pix(0), (int)pix(1), params.patchSize, params.patchSize);
+					appPtr->offset.x()(0) = pix(0) - ((int)pix(0) + 0.5);
+					appPtr->offset.x()(1) = pix(1) - ((int)pix(1) + 0.5);
+					appPtr->offset.P() = jblas::zero_mat(2); // by definition this is our landmark projection
+
+					return true;
+				} else return false;
+			}
+
+			void fillDataObs(const boost::shared_ptr<FeatureImagePoint> & featPtr, boost::shared_ptr<ObservationAbstract> & obsPtr)
+			{
+				// extract observed appearance
+				app_img_pnt_ptr_t app_src = SPTR_CAST<AppearanceImagePoint>(featPtr->appearancePtr);
+				app_img_pnt_ptr_t app_dst = SPTR_CAST<AppearanceImagePoint>(obsPtr->observedAppearance);
+				app_src->patch.copyTo(app_dst->patch);
+				app_dst->offset = app_src->offset;
+
+				// create descriptor
+				descriptor_ptr_t descPtr(descFactory->createDescriptor());
+				obsPtr->landmarkPtr()->setDescriptor(descPtr);
+			}
+
+	};
+
 }}
 
 #endif
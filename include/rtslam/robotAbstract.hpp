@@ -24,6 +24,8 @@
 #include "rtslam/gaussian.hpp"
 #include "rtslam/mapObject.hpp"
 #include "rtslam/perturbation.hpp"
+#include "rtslam/blockJacobian.hpp"
+#include "rtslam/stateHistory.hpp"
 // include parents
 #include "rtslam/mapAbstract.hpp"
 #include "rtslam/mapObject.hpp"
@@ -31,6 +33,8 @@
 
 #include "rtslam/hardwareEstimatorAbstract.hpp"
 
+#include <boost/thread/mutex.hpp>
+
 namespace jafar {
 	namespace rtslam {
 
@@ -132,14 +136,32 @@ namespace jafar {
 				double dt_or_dx; ///<           Sampling time or any other relevant increment (e.g. odometry is not time-driven but distance-driven)
 
 				jblas::mat XNEW_x; ///<         Jacobian wrt state
+				/**
+				 * Block structure of XNEW_x.
+				 * Derived classes declare here, at construction, the blocks of XNEW_x that differ from identity,
+				 * so that the filter prediction only multiplies these blocks into the cross-variances.
+				 * If left empty, the dense XNEW_x is used.
+				 */
+				BlockJacobian XNEW_x_blocks;
 				jblas::mat XNEW_pert; ///<      Jacobian wrt perturbation
 				jblas::sym_mat Q; ///<          Process noise covariances matrix in state space, Q = XNEW_pert * perturbation.P * trans(XNEW_pert);
+				/**
+				 * Short history of the pose, cloned in the map, to apply out-of-sequence measurements.
+				 * It is disabled by default, sensors that can handle delayed data enable it with the maximum delay they accept.
+				 */
+				StateHistory stateHistory;
 				
 				jblas::vec origin_sensors; ///< origin to get the initial state position at 0 / absolute sensors
 				jblas::vec origin_export; ///< origin of the exported position in absolute coordinates
 				void setOrigin(jblas::vec3 pos) { origin_export = pos; }
 				jblas::vec robot_pose; ///< the pose of the true robot in the slam robot frame, for exported position
 
+				/**
+				 * Indices in the map of the states that are calibration parameters rather than motion states,
+				 * eg biases, that may be made consider states of the filter (see ExtendedKalmanFilterIndirect::setConsider()).
+				 */
+				virtual ind_array calibrationStates() { return ind_array(0); }
+
 				virtual size_t mySize() = 0;
 				virtual size_t mySize_control() = 0;
 				virtual size_t mySize_perturbation() = 0;
@@ -172,7 +194,10 @@ namespace jafar {
 					vec n = perturbation.x();
 					vec xnew(x.size());
 
-					move_func(x, control, n, dt_or_dx, xnew, XNEW_x, XNEW_pert);
+					{
+						boost::unique_lock<boost::mutex> l(mutex_move);
+						move_func(x, control, n, dt_or_dx, xnew, XNEW_x, XNEW_pert);
+					}
 					state.x() = xnew;
 
 					if (mapPtr()->filterPtr){
@@ -180,7 +205,7 @@ namespace jafar {
 						if (!constantPerturbation)
 							computeStatePerturbation();
 
-						mapPtr()->filterPtr->predict(mapPtr()->ia_used_states(), XNEW_x, state.ia(), Q); // P = F*P*F' + Q
+						mapPtr()->filterPtr->predict(mapPtr()->ia_used_states(), XNEW_x, XNEW_x_blocks, state.ia(), Q); // P = F*P*F' + Q
 					}
 				}
 
@@ -220,6 +245,22 @@ namespace jafar {
 				
 				void move(double time);
 				void move_fake(double time);
+
+				/**
+				 * Predict a robot state one step ahead, without affecting the robot nor the SLAM filter.
+				 * It can be called from another thread than the one that moves the robot, eg to predict the pose at the rate of the proprioceptive sensors.
+				 * \param _x the robot state
+				 * \param _u the control vector
+				 * \param _dt the time interval
+				 * \param _xnew the new state
+				 * \param _XNEW_x the Jacobian of \a _xnew wrt \a _x, it must have been initialized like XNEW_x
+				 * \param _XNEW_pert the Jacobian of \a _xnew wrt the perturbation, not computed if constantPerturbation is \c true
+				 */
+				void predict(const vec & _x, const vec & _u, double _dt, vec & _xnew, mat & _XNEW_x, mat & _XNEW_pert) {
+					vec n(perturbation.size()); n.clear();
+					boost::unique_lock<boost::mutex> l(mutex_move);
+					move_func(_x, ublas::subrange(_u, 0, control.size()), n, _dt, _xnew, _XNEW_x, _XNEW_pert);
+				}
 				void move(const vec & u_, double time);
 
 				/**
@@ -238,6 +279,7 @@ namespace jafar {
 
 			protected:
 
+				boost::mutex mutex_move; ///< move_func uses members as temporaries, and can be called by predict() from another thread
 
 				/**
 				 * Move one step ahead.
@@ -74,6 +74,7 @@ namespace jafar {
 				    mat & _XNEW_pert);
 
 				void computePertJacobian();
+				void computeJacobianStructure();
 
 				/**
 				 * The size of the robot in map.
@@ -91,6 +91,7 @@ namespace jafar {
 				    mat & _XNEW_pert);
 
 				void computePertJacobian();
+				void computeJacobianStructure();
 
 				static size_t size() {
 					return 13;
@@ -117,6 +117,12 @@ namespace jafar {
 				 */
 				void move_func(const vec & _x, const vec & _u, const vec & _n, double _dt, vec & _xnew,
 				    mat & _XNEW_x, mat & _XNEW_pert);
+
+				/**
+				 * Declare the non-identity blocks of XNEW_x, see move_func().
+				 */
+				void computeJacobianStructure();
+
 				/**
 				 * Initialize the value of g with the average value of acceleration
 				 * in the past.
@@ -147,6 +153,13 @@ namespace jafar {
 				virtual size_t mySize_control() {return size_control();}
 				virtual size_t mySize_perturbation() {return size_perturbation();}
 
+				/// The biases and the gravity, \a ab, \a wb and \a g.
+				virtual ind_array calibrationStates() {
+					ind_array ia(6 + g_size);
+					for (size_t i = 0; i < ia.size(); i++) ia(i) = state.ia()(10 + i);
+					return ia;
+				}
+
 				// Set initial uncertainties on linear velocity and gravity.
 				void setInitialStd(double velLinStd, double aBiasStd, double wBiasStd, double gravStd){
 					for (size_t i = pose.size() + 0; i < pose.size() + 3; i++){
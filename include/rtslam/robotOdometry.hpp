@@ -86,6 +86,8 @@ namespace jafar {
 				 */
 				void move_func(const vec & _x, const vec & _u, const vec & _n,
 				    const double _dt, vec & _xnew, mat & _XNEW_x, mat & _XNEW_u);
+
+				void computeJacobianStructure();
 				
 				void init_func(const vec & _x, const vec & _u, vec & _xnew);
 
@@ -32,6 +32,12 @@ namespace jafar {
 		 * For now we assume that we have at least one reading before images and
 		 * that is is very precise. Improvements would be to start at 0,0,0
 		 * with uncertainty 0 and estimate the initial position.
+		 *
+		 * With setMaxDelay(), readings dated before the current robot time are
+		 * applied as out-of-sequence measurements: they observe the past robot poses
+		 * cloned in the map by the robot StateHistory, and correct the current state
+		 * through their cross-variances. The robot does not need to
+		 * wait for them, which is what sensor managers do otherwise.
 		 * \ingroup rtslam
 		 */
 		class SensorAbsloc: public SensorProprioAbstract {
@@ -46,6 +52,7 @@ namespace jafar {
 				int inns;
 				bool absolute;
 				bool first;
+				double max_delay;
 			public:
 				/**
 					@param absolute do we estimate the absolute position as returned by the sensor,
@@ -55,7 +62,7 @@ namespace jafar {
 				SensorAbsloc(const robot_ptr_t & robPtr, const filtered_obj_t inFilter = UNFILTERED, bool absolute = false):
 				  SensorProprioAbstract(robPtr, inFilter),
 					ia_rs(ia_globalPose), innovation(NULL), measurement(NULL), expectation(NULL),
-					inns(0), absolute(absolute), first(true)
+					inns(0), absolute(absolute), first(true), max_delay(0.)
 				{}
 				~SensorAbsloc() { delete innovation; delete measurement; }
 				virtual void setHardwareSensor(hardware::hardware_sensorprop_ptr_t hardwareSensorPtr_)
@@ -72,6 +79,19 @@ namespace jafar {
 				}
 				
 				
+				/**
+					Accept readings up to \a max_delay seconds older than the robot time.
+					The sensor must be linked to its robot. 0 disables out-of-sequence processing.
+					\param clone_period the min time between two clones of the robot pose, see StateHistory
+				*/
+				void setMaxDelay(double max_delay, double clone_period = 0.)
+				{
+					this->max_delay = max_delay;
+					StateHistory & history = robotPtr()->stateHistory;
+					if (max_delay > history.getDuration()) history.setDuration(max_delay, clone_period);
+				}
+				virtual bool handlesDelayedData() { return max_delay > 0.; }
+
 				virtual void init(unsigned id)
 				{
 					RawInfos infos;
@@ -111,11 +131,36 @@ namespace jafar {
 					else
 						hardwareSensorPtr->getRaw(id, reading);
 
+					// delayed reading: observe the robot state retrodicted at the date of the reading
+					robot_ptr_t robPtr = robotPtr();
+					bool delayed = false;
+					jblas::vec x_past;
+					jblas::ind_array ia_past;
+					jblas::mat X_past;
+					if (!first && max_delay > 0. && reading.data(0) < robPtr->self_time)
+					{
+						if (reading.data(0) < robPtr->self_time - max_delay ||
+						    !robPtr->stateHistory.retrodict(*robPtr->mapPtr(), reading.data(0), robPtr->pose.ia(), robPtr->self_time, x_past, ia_past, X_past))
+						{
+							JFR_DEBUG("AbsLoc reading at " << reading.data(0) << " is too old for robot time " << robPtr->self_time << ", discarded");
+							return;
+						}
+						delayed = true;
+					}
+
 					EXP_rs.clear();
 					jblas::vec T = ublas::subrange(pose.x(), 0, 3);
 					jblas::vec r = ublas::subrange(pose.x(), 3, 7);
-					jblas::vec p = ublas::subrange(robotPtr()->pose.x(), 0, 3);
-					jblas::vec q = ublas::subrange(robotPtr()->pose.x(), 3, 7);
+					jblas::vec p, q;
+					if (delayed)
+					{
+						p = ublas::subrange(x_past, 0, 3);
+						q = ublas::subrange(x_past, 3, 7);
+					} else
+					{
+						p = ublas::subrange(robotPtr()->pose.x(), 0, 3);
+						q = ublas::subrange(robotPtr()->pose.x(), 3, 7);
+					}
 					jblas::vec Tr = quaternion::rotate(q,T);
 
 					size_t indexE = 0;
@@ -210,17 +255,37 @@ namespace jafar {
 								" ; initial position " << ublas::subrange(robotPtr()->pose.x(), 0,3) <<
 								" ; initial position var " << ublas::subrange(robotPtr()->pose.P(), 0,3, 0,3) << std::endl;
 						}
+					} else if (delayed)
+					{
+						// the reading observes the past pose, interpolated between the clones of the pose around its date
+						size_t np = ia_past.size();
+						ind_array ia_xs(isInFilter ? np + 7 : np);
+						for (size_t i = 0; i < np; ++i) ia_xs(i) = ia_past(i);
+						if (isInFilter) for (size_t i = 0; i < 7; ++i) ia_xs(np+i) = pose.ia()(i);
+						jblas::mat EXP_xs(inns, ia_xs.size());
+						ublas::subrange(EXP_xs, 0,inns, 0,np) = ublas::prod(ublas::subrange(EXP_rs, 0,inns, 0,7), X_past);
+						if (isInFilter) ublas::subrange(EXP_xs, 0,inns, np,np+7) = ublas::subrange(EXP_rs, 0,inns, 7,14);
+
+						map_ptr_t mapPtr = robPtr->mapPtr();
+						mapPtr->filterPtr->recover(ia_xs);
+						ublas::subrange(expectation->P(), 0,inns, 0,inns) = ublasExtra::prod_JPJt(mapPtr->filterPtr->marginal(ia_xs), EXP_xs);
+						innovation->x() = measurement->x() - expectation->x();
+						innovation->P() = measurement->P() + expectation->P();
+						jblas::mat INN_xs = -EXP_xs;
+
+						ind_array ia_x = mapPtr->ia_used_states();
+						mapPtr->filterPtr->correct(ia_x,*innovation,INN_xs,ia_xs,measurement->P());
 					} else
 					{
 						// compute expectation->P and innovation
-						ublas::subrange(expectation->P(), 0,inns, 0,inns) = ublasExtra::prod_JPJt(ublas::project(robotPtr()->mapPtr()->filterPtr->P(), ia_rs, ia_rs), EXP_rs);
+						ublas::subrange(expectation->P(), 0,inns, 0,inns) = ublasExtra::prod_JPJt(robotPtr()->mapPtr()->filterPtr->marginal(ia_rs), EXP_rs);
 						innovation->x() = measurement->x() - expectation->x();
 						innovation->P() = measurement->P() + expectation->P();
 						INN_rs = -EXP_rs;
 
 						map_ptr_t mapPtr = robotPtr()->mapPtr();
 						ind_array ia_x = mapPtr->ia_used_states();
-						mapPtr->filterPtr->correct(ia_x,*innovation,INN_rs,ia_rs);
+						mapPtr->filterPtr->correct(ia_x,*innovation,INN_rs,ia_rs,measurement->P());
 					}
 
 					if (use_for_init)
@@ -75,6 +75,8 @@ namespace jafar {
 				bool getUseForInit() { return use_for_init; }
 				void setNeedInit(bool need_init) { this->need_init = need_init; }
 				bool getNeedInit() { return need_init; }
+				/// can process data dated before the current robot time, without moving the robot back (out-of-sequence measurements)
+				virtual bool handlesDelayedData() { return false; }
 
 				virtual int queryAvailableRaws(RawInfos &infos) = 0; ///< get information about the available raws and the estimated dates for next one
 				virtual int queryNextAvailableRaw(RawInfo &info) = 0; ///< get information about the next available raw
@@ -118,6 +120,8 @@ namespace jafar {
 				ind_array ia_globalPose;
 				/// Flag indicating if the sensor pose is being filtered
 				bool isInFilter;
+				/// Indices of the calibration states of the sensor in the map, ie its pose if it is filtered
+				ind_array calibrationStates() { return (isInFilter ? pose.ia() : ind_array(0)); }
 				
 				/**
 				 * Get sensor pose in global frame.
@@ -10,6 +10,7 @@
 #define SENSORIMAGEPARAMETERS_HPP_
 
 #include "rtslam/pinholeTools.hpp"
+#include "rtslam/undistortionMap.hpp"
 #include "jmath/jblas.hpp"
 
 namespace jafar{
@@ -24,6 +25,8 @@ namespace jafar{
 
 			public:
 
+				SensorImageParameters(): width(0), height(0) {}
+
 				// Image size
 				unsigned int width;
 				unsigned int height;
@@ -32,6 +35,7 @@ namespace jafar{
 				vec4 intrinsic;
 				vec distortion;
 				vec correction;
+				UndistortionMap undistortionMap; ///< exact undistortion of the image pixels, built with the calibration
 
 				// sensor precision in pixels
 				double pixNoise;
@@ -49,6 +53,7 @@ namespace jafar{
 
 				/**
 				 * Pin-hole sensor setup.
+				 * The image size must be set before, to build the undistortion map.
 				 * \param k the vector of intrinsic parameters <c>k = [u_0, v_0, a_u, a_v]</c>.
 				 * \param d the radial distortion parameters vector <c>d = [d_2, d_4, ...] </c>.
 				 * \param c the radial distortion correction parameters vector <c>c = [c_2, c_4, ...] </c>.
@@ -59,6 +64,56 @@ namespace jafar{
 					distortion = _d;
 					correction.resize(size_c);
 					pinhole::computeCorrectionModel(intrinsic, distortion, correction);
+					if (width > 0 && height > 0 && distortion.size() > 0)
+						undistortionMap.build(intrinsic, distortion, width, height);
+					else
+						undistortionMap.clear();
+				}
+
+				/**
+				 * Back-project a pixel, with the undistortion map if it covers the pixel, else with the correction model.
+				 * \param u the 2D pixel
+				 * \param p the back-projected 3D point
+				 * \param depth the depth prior
+				 * \return false if the distortion cannot be inverted at this pixel, past its monotony limit.
+				 * \a p is then not set, the pixel must be rejected.
+				 */
+				template<class U>
+				bool backprojectPoint(const U & u, vec3 & p, const double depth = 1.0) const {
+					vec2 pix, up;
+					pix(0) = u(0); pix(1) = u(1);
+					if (undistortionMap.undistort(pix, up))
+						p = pinhole::backprojectPointFromNormalizedPlane(up, depth);
+					else if (undistortionMap.covers(pix))
+						return false;
+					else
+						p = pinhole::backprojectPoint(intrinsic, correction, u, depth);
+					return true;
+				}
+
+				/**
+				 * Back-project a pixel, with the undistortion map if it covers the pixel, else with the correction model; give Jacobians.
+				 * \param u the 2D pixel
+				 * \param depth the depth prior
+				 * \param p the back-projected 3D point
+				 * \param P_u Jacobian of p wrt u
+				 * \param P_depth Jacobian of p wrt depth
+				 * \return false if the distortion cannot be inverted at this pixel, see backprojectPoint().
+				 */
+				template<class U, class P, class MP_u, class MP_depth>
+				bool backProjectPoint(const U & u, double depth, P & p, MP_u & P_u, MP_depth & P_depth) const {
+					vec2 pix, up;
+					mat22 UP_u;
+					pix(0) = u(0); pix(1) = u(1);
+					if (undistortionMap.undistort(pix, up, UP_u)) {
+						mat32 P_up;
+						pinhole::backprojectPointFromNormalizedPlane(up, depth, p, P_up, P_depth);
+						P_u = ublas::prod(P_up, UP_u);
+					} else if (undistortionMap.covers(pix))
+						return false;
+					else
+						pinhole::backProjectPoint(intrinsic, correction, u, depth, p, P_u, P_depth);
+					return true;
 				}
 
 				void setMiscellaneous(double _pixNoise,
@@ -173,6 +173,8 @@ namespace rtslam {
 		This sensor managers deals in a simple way with one sensor 
 		with integrate_all policy and one sensor with integrate_last policy.
 		It is temporary waiting for a good generic solution.
+		If the integrate_all sensor handles delayed data, the other one never
+		waits for it.
 		
 		\ingroup rtslam
 	*/
@@ -260,8 +262,8 @@ namespace rtslam {
 						else
 							return ProcessInfo(senLastPtr, infoLast.id);
 					} else
-					{ // has all but not last => use it if won't block next last (or next last hasn't arrived in time)
-						if (infoAll.timestamp < infosLast.next.timestamp || tnow > infosLast.next.arrival)
+					{ // has all but not last => use it if won't block next last (or next last hasn't arrived in time, or it can be applied late)
+						if (infoAll.timestamp < infosLast.next.timestamp || tnow > infosLast.next.arrival || senAllPtr->handlesDelayedData())
 							return ProcessInfo(senAllPtr, infoAll.id);
 						else
 							return ProcessInfo(no_more_data); // wait
@@ -269,11 +271,11 @@ namespace rtslam {
 				} else
 				{ // has not all
 					if (infosLast.available.size() > 0)
-					{ // has not all but last => use newest last that won't block next all (or next all hasn't arrived in time)
+					{ // has not all but last => use newest last that won't block next all (or next all hasn't arrived in time, or it can be applied late)
 						for(std::vector<RawInfo>::reverse_iterator it = infosLast.available.rbegin(); it != infosLast.available.rend(); ++it)
 						{
 							RawInfo &infoLast = *it;
-							if (infoLast.timestamp < infosAll.next.timestamp || tnow > infosAll.next.arrival)
+							if (infoLast.timestamp < infosAll.next.timestamp || tnow > infosAll.next.arrival || senAllPtr->handlesDelayedData())
 								return ProcessInfo(senLastPtr, infoLast.id);
 						}
 						return ProcessInfo(no_more_data); // wait
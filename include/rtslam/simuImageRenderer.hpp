@@ -0,0 +1,116 @@
+/**
+ * \file simuImageRenderer.hpp
+ *
+ * Rendering of gray-level images of simulated point landmarks.
+ * This is part of the ad-hoc simulator.
+ *
+ * \date 17/10/2026
+ * \author jsola
+ *
+ * \ingroup rtslam
+ */
+
+#ifndef SIMUIMAGERENDERER_HPP_
+#define SIMUIMAGERENDERER_HPP_
+
+#include <map>
+#include <vector>
+#include "jmath/jblas.hpp"
+#include "rtslam/undistortionMap.hpp"
+
+namespace jafar {
+	namespace image {
+		class Image;
+	}
+namespace rtslam {
+namespace simu {
+
+	/**
+	 * CPU renderer of pin-hole camera images of point landmarks.
+	 *
+	 * Each point landmark carries a small planar textured square, centered on the point, whose texture
+	 * is a corner (two dark and two light quadrants meeting at the point) surrounded by random blocks,
+	 * so that the point is what a corner detector finds, and the patch around it is distinctive.
+	 * The square is oriented once and for all towards the first camera that sees it, and is then seen
+	 * with the correct scale and perspective from the other poses: each pixel is back-projected through
+	 * the distortion model and intersected with the square. Textures are mip-mapped to avoid aliasing
+	 * when seen from far, and squares are drawn from the farthest to the nearest.
+	 * The image is then blurred and noised.
+	 *
+	 * Textures and noise only depend on the seed, the landmark ids and the frame seed, so that sequences
+	 * are reproducible. The exact projection of each visible landmark is kept as ground truth.
+	 *
+	 * \ingroup rtslam
+	 */
+	class ImageRenderer
+	{
+		public:
+			struct params_t {
+				unsigned width;       ///< image width
+				unsigned height;      ///< image height
+				jblas::vec4 intrinsic;///< intrinsic parameters, k = [u0, v0, au, av]
+				jblas::vec distortion;///< radial distortion parameters
+				double patchSize;     ///< side of the textured square of each landmark, in meters
+				unsigned textureSize; ///< side of the textures in texels, a power of 2
+				unsigned char background; ///< gray level of the background
+				double blurStd;       ///< std of the gaussian blur in pixels, 0 for none
+				double noiseStd;      ///< std of the additive gaussian noise in gray levels, 0 for none
+				unsigned seed;        ///< seed of the textures
+			} params;
+
+			typedef std::map<size_t, jblas::vec3> PointList; ///< positions of the point landmarks, by id
+			typedef std::map<size_t, jblas::vec2> GroundTruth; ///< exact pixel of each visible landmark, by id
+
+		private:
+			struct Texture {
+				jblas::vec3 normal, axis1, axis2; ///< frame of the square in the world
+				std::vector<std::vector<float> > levels; ///< mip-map, level l has textureSize>>l texels per side
+			};
+			std::map<size_t, Texture> textures;
+			UndistortionMap undistortionMap;
+			std::vector<float> buffer, tmp;
+			std::vector<int> owners; ///< for each pixel, the rank of the square drawn there, -1 for the background
+			GroundTruth truth;
+
+		public:
+			/**
+			 * \param width, height the image size
+			 * \param k the intrinsic parameters, k = [u0, v0, au, av]
+			 * \param d the radial distortion parameters
+			 * \param patchSize the side of the textured square of each landmark, in meters
+			 * \param blurStd the std of the gaussian blur in pixels
+			 * \param noiseStd the std of the image noise in gray levels
+			 * \param seed the seed of the textures
+			 */
+			ImageRenderer(unsigned width, unsigned height, const jblas::vec4 & k, const jblas::vec & d,
+				double patchSize = 0.2, double blurStd = 0.6, double noiseStd = 2.0, unsigned seed = 1);
+
+			unsigned width() const { return params.width; }
+			unsigned height() const { return params.height; }
+
+			/**
+			 * Render an image.
+			 * \param senGlobPose the global pose of the camera, [x, y, z, qw, qx, qy, qz]
+			 * \param points the point landmarks
+			 * \param frameSeed the seed of the image noise, e.g. the frame number
+			 * \param img the rendered image, gray level, 8 bits, of size width() x height()
+			 */
+			void render(const jblas::vec7 & senGlobPose, const PointList & points, unsigned frameSeed, image::Image & img);
+
+			/**
+			 * Exact projections of the landmarks visible in the last rendered image.
+			 */
+			const GroundTruth & groundTruth() const { return truth; }
+
+			/// forget the textures and their orientation
+			void clear() { textures.clear(); }
+
+		private:
+			const Texture & texture(size_t id, const jblas::vec3 & pos, const jblas::vec3 & camPos);
+			void splat(const Texture & tex, const jblas::vec3 & pos, const jblas::vec7 & senGlobPose, const jblas::mat33 & R, int owner);
+			void blur();
+	};
+
+}}}
+
+#endif
@@ -140,6 +140,25 @@ class AdhocSimulator
 		}
 		
 		
+		bool getSensorGlobalPose(size_t robId, size_t senId, double t, jblas::vec7 &senGlobPose) const
+		{
+			std::map<size_t,simu::Sensor*>::const_iterator itSen;
+			return getSenGlobPose(robId, senId, senGlobPose, itSen, t);
+		}
+		
+		/**
+		 * @return the positions of the point landmarks at time t, by id
+		 */
+		std::map<size_t,jblas::vec3> getPointLandmarks(double t) const
+		{
+			std::map<size_t,jblas::vec3> points;
+			for(std::map<size_t,simu::Landmark*>::const_iterator it = landmarks.begin(); it != landmarks.end(); ++it)
+				if (it->second->type == LandmarkAbstract::POINT)
+					points[it->first] = ublas::subrange(it->second->getPose(t), 0, 3);
+			return points;
+		}
+		
+		
 		bool getObservationPose(jblas::vec &obsPose, size_t robId, size_t senId, size_t lmkId, double t) const
 		{
 			std::map<size_t,simu::Sensor*>::const_iterator itSen;
@@ -0,0 +1,91 @@
+/**
+ * \file spiralSearch.hpp
+ *
+ * \date 17/10/2026
+ * \author jsola
+ *
+ *  \ingroup rtslam
+ */
+
+#ifndef SPIRALSEARCH_HPP_
+#define SPIRALSEARCH_HPP_
+
+#include <vector>
+
+#include "image/Image.hpp"
+#include "image/roi.hpp"
+#include "correl/explorer.hpp"
+
+
+namespace jafar{
+	namespace rtslam{
+
+		/**
+		 * ZNCC search of a patch in an elliptic region, from the center to the border.
+		 * \ingroup rtslam
+		 * \author jsola
+		 *
+		 * The match is usually close to the expectation, so that searching the whole 3-sigma
+		 * region is most often useless. The region is cut in nRings concentric elliptic rings, obtained
+		 * by scaling the region, that is by Mahalanobis distance to the expectation, and they are searched
+		 * from the inner one. As soon as a score above the threshold is found in a ring, the search
+		 * climbs to the nearest local maximum of the score, and stops there if it is still above the threshold.
+		 * Otherwise the next ring is searched. If the search did not stop in the inner rings, the whole region
+		 * is searched with the given correl::FastTranslationMatcherZncc, that uses integral images.
+		 *
+		 * The position has the same convention as correl::FastTranslationMatcherZncc:
+		 * it is the one of the center of the central pixel of the patch, interpolated with a parabola.
+		 */
+		class ZnccSpiralSearch {
+			public:
+				struct search_stats_t {
+					unsigned nSearch;          ///< number of searches
+					unsigned long nPositions;  ///< number of positions where the score was computed
+					unsigned nEarly;           ///< number of searches stopped before the last ring
+				} stats;
+
+			public:
+				/**
+				 * \param fullMatcher the matcher of the whole region when the search does not stop early
+				 * \param nRings the number of rings, 1 to always search the whole region with \a fullMatcher
+				 */
+				ZnccSpiralSearch(correl::FastTranslationMatcherZncc & fullMatcher, int nRings = 6);
+
+				/**
+				 * Search the patch in the region.
+				 * \param patch the patch
+				 * \param image the image
+				 * \param roi the search region
+				 * \param threshold the score above which the search can stop
+				 * \param xres,yres the position of the best match
+				 * \param xstd,ystd the width of the correlation peak, inverse square root of its curvature
+				 * \return the score of the best match
+				 */
+				double match(const image::Image & patch, const image::Image & image, const image::ConvexRoi & roi, double threshold,
+					double & xres, double & yres, double & xstd, double & ystd);
+
+				void clearStats() { stats.nSearch = stats.nEarly = 0; stats.nPositions = 0; }
+
+			private:
+				double score(int i);
+				bool climb(int & i, double & s);
+				double zncc(int x, int y);
+
+			private:
+				correl::FastTranslationMatcherZncc & m_fullMatcher;
+				int m_nRings;
+				std::vector<image::ConvexRoi> m_ringRois; ///< the region scaled to the outer border of each ring
+				const image::Image * m_patch;
+				const image::Image * m_image;
+				std::vector<float> m_patchCentered; ///< patch minus its mean
+				double m_patchNorm;
+				int m_x0, m_y0, m_w, m_h;         ///< searched positions, clipped to the image
+				std::vector<float> m_scores;      ///< score of each searched position, or < -1 if not computed
+				std::vector<int> m_rings;         ///< ring of each searched position, or nRings if outside the region
+				std::vector<std::vector<int> > m_ringPositions;
+		};
+
+	}
+}
+
+#endif /* SPIRALSEARCH_HPP_ */
@@ -0,0 +1,99 @@
+/**
+ * \file stateHistory.hpp
+ *
+ * Short history of the robot pose, for out-of-sequence measurements.
+ *
+ * \date 17/10/2026
+ * \author jsola
+ *
+ * \ingroup rtslam
+ */
+
+#ifndef STATEHISTORY_HPP_
+#define STATEHISTORY_HPP_
+
+#include <deque>
+#include "jmath/jblas.hpp"
+
+namespace jafar {
+	namespace rtslam {
+
+		class MapAbstract;
+
+		/**
+		 * Short history of the robot pose, for out-of-sequence measurements, by stochastic cloning.
+		 *
+		 * At the end of the robot moves, a copy of the robot pose [p q] is added to the filter, with the same
+		 * mean and covariances as the pose. The clones are then predicted (they do not move, but their cross-variances
+		 * with the robot follow it) and corrected with the rest of the map, so that they remain the estimates of the past poses
+		 * given all the data processed since. A delayed measurement is applied as a regular correction of the clones,
+		 * that corrects the current state through their cross-variances. The transition Jacobians are never inverted,
+		 * which would not be possible with the normalized quaternions.
+		 *
+		 * The pose at the date of a delayed measurement is interpolated between the two clones around it,
+		 * the last one being the current robot pose, so that the Jacobian wrt them is exact for the interpolation.
+		 * The quaternion of the interpolated pose is renormalized, this is neglected in the Jacobian.
+		 *
+		 * A clone is made at most every \a period seconds, and the clones older than \a duration are liberated,
+		 * keeping one at or before the start of the window. The clones are 7 states each in the map,
+		 * and they are not made when the map is full.
+		 *
+		 * \ingroup rtslam
+		 */
+		class StateHistory {
+			public:
+				struct Clone {
+					double time; ///< date of the pose
+					jblas::ind_array ia; ///< states of the clone in the map
+				};
+				typedef std::deque<Clone> CloneList;
+
+			private:
+				double duration;
+				double period;
+				CloneList clones;
+
+			public:
+				StateHistory(): duration(0.), period(0.) {}
+
+				/**
+				 * Enable the history.
+				 * \param _duration the maximum delay of the data to handle (s), 0 to disable.
+				 * \param _period the minimum time between two clones (s), 0 to clone the pose after each move.
+				 * The clones of a disabled history are only liberated by clear().
+				 */
+				void setDuration(double _duration, double _period = 0.) { duration = _duration; period = _period; }
+				double getDuration() const { return duration; }
+				bool enabled() const { return duration > 0.; }
+				const CloneList & list() const { return clones; }
+
+				/// liberate all the clones
+				void clear(MapAbstract & map);
+
+				/**
+				 * Clone the pose at the end of a move, and liberate the clones that became too old.
+				 * \param map the map
+				 * \param ia_pose the states of the robot pose
+				 * \param time the date of the pose
+				 */
+				void record(MapAbstract & map, const jblas::ind_array & ia_pose, double time);
+
+				/**
+				 * Retrodict the pose at a past date.
+				 * \param map the map
+				 * \param time the date of the delayed data
+				 * \param ia_pose the states of the current robot pose
+				 * \param time_now the date of the current robot pose
+				 * \param x_t the pose at \a time
+				 * \param ia_t the states it depends on, one or two clones or the current pose
+				 * \param X_t the Jacobian of \a x_t wrt the states \a ia_t
+				 * \return false if \a time is out of the history.
+				 */
+				bool retrodict(MapAbstract & map, double time, const jblas::ind_array & ia_pose, double time_now,
+					jblas::vec & x_t, jblas::ind_array & ia_t, jblas::mat & X_t) const;
+		};
+
+	}
+}
+
+#endif /* STATEHISTORY_HPP_ */
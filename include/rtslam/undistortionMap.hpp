@@ -0,0 +1,99 @@
+/**
+ * \file undistortionMap.hpp
+ *
+ * Lookup table for the undistortion of pin-hole cameras.
+ *
+ * \date 17/10/2026
+ * \author jsola
+ *
+ * \ingroup rtslam
+ */
+
+#ifndef UNDISTORTIONMAP_HPP_
+#define UNDISTORTIONMAP_HPP_
+
+#include <vector>
+#include "jmath/jblas.hpp"
+
+namespace jafar {
+	namespace image {
+		class Image;
+	}
+	namespace rtslam {
+
+		/**
+		 * Dense lookup table from pixels to undistorted points in the normalized plane.
+		 *
+		 * The table is built once from the calibration, by iterative inversion of the radial
+		 * distortion model (see pinhole::undistortPointIterative()), so it is exact up to the
+		 * interpolation, unlike the polynomial correction model that only approximates the inverse.
+		 * Each node stores the undistorted point and its Jacobian wrt the pixel, both are
+		 * interpolated bilinearly between nodes. Values are stored in single precision.
+		 *
+		 * The table covers the image plus a margin, for points slightly outside of it.
+		 * Queries out of the table return false, the caller then falls back to the analytic model.
+		 * They also return false near the nodes where the distortion model cannot be inverted,
+		 * past its monotony limit, the caller should then reject the pixel. covers() tells the two cases apart.
+		 *
+		 * It also provides the remapping of whole images to their undistorted version.
+		 *
+		 * \ingroup rtslam
+		 */
+		class UndistortionMap {
+			private:
+				jblas::vec4 k;
+				jblas::vec d;
+				int x0, y0; ///< pixel of the first node
+				unsigned nx, ny; ///< number of nodes
+				unsigned step; ///< pixels between nodes
+				std::vector<float> table; ///< for each node: up(0), up(1), UP_u(0,0), UP_u(0,1), UP_u(1,0), UP_u(1,1)
+				unsigned width, height;
+				std::vector<float> remap; ///< for each pixel of the undistorted image: its source pixel in the raw image
+
+			public:
+				UndistortionMap(): x0(0), y0(0), nx(0), ny(0), step(1), width(0), height(0) {}
+
+				/**
+				 * Build the table.
+				 * \param _k the intrinsic parameters, k = [u0, v0, au, av]
+				 * \param _d the radial distortion parameters
+				 * \param _width, _height the image size
+				 * \param _step the number of pixels between nodes, 1 for a dense table
+				 * \param margin the number of pixels covered outside of the image
+				 */
+				void build(const jblas::vec4 & _k, const jblas::vec & _d, unsigned _width, unsigned _height, unsigned _step = 1, unsigned margin = 8);
+				void clear() { table.clear(); remap.clear(); nx = ny = 0; }
+				bool empty() const { return table.empty(); }
+				size_t memory() const { return (table.size() + remap.size()) * sizeof(float); }
+
+				/// the pixel is in the table, whether it can be undistorted or not
+				bool covers(const jblas::vec2 & pix) const;
+
+				/**
+				 * Undistorted point in the normalized plane of a pixel.
+				 * \return false if the pixel is out of the table or cannot be undistorted.
+				 */
+				bool undistort(const jblas::vec2 & pix, jblas::vec2 & up) const;
+				/**
+				 * Undistorted point in the normalized plane of a pixel, with Jacobian.
+				 * \param UP_pix the Jacobian of \a up wrt \a pix
+				 * \return false if the pixel is out of the table or cannot be undistorted.
+				 */
+				bool undistort(const jblas::vec2 & pix, jblas::vec2 & up, jblas::mat22 & UP_pix) const;
+
+				/**
+				 * Undistort a whole gray-level image, keeping the same intrinsic parameters.
+				 * The source pixel of each undistorted pixel is computed at the first call and kept.
+				 * \param src the raw image
+				 * \param dst the undistorted image, with the same size and depth as \a src
+				 */
+				void undistortImage(const image::Image & src, image::Image & dst);
+
+			private:
+				bool interpolate(double u, double v, float * res, size_t n) const;
+		};
+
+	}
+}
+
+#endif /* UNDISTORTIONMAP_HPP_ */
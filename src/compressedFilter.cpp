@@ -0,0 +1,349 @@
+/**
+ * \file compressedFilter.cpp
+ * \date 17/10/2026
+ * \author jsola
+ * \ingroup rtslam
+ */
+
+#include "rtslam/compressedFilter.hpp"
+#include "jmath/jblas.hpp"
+#include "jmath/ublasExtra.hpp"
+
+namespace jafar {
+	namespace rtslam {
+		using namespace std;
+		using namespace jmath;
+		using namespace jblas;
+		using namespace ublas;
+		using namespace jmath::ublasExtra;
+
+
+		CompressedKalmanFilterIndirect::CompressedKalmanFilterIndirect(size_t _size, size_t maxActive) :
+			ExtendedKalmanFilterIndirect(_size), ia_active_(0), ia_base_(0), ia_x_(0), pos_(_size, -1), touched_(_size, false),
+			phi_(0, 0), psi_(0), pending_(false), lazySize_(0), maxActive_(maxActive), nGlobalUpdates_(0)
+		{
+		}
+
+		void CompressedKalmanFilterIndirect::grow(size_t _size)
+		{
+			if (_size <= size()) return;
+			ExtendedKalmanFilterIndirect::grow(_size);
+			pos_.resize(_size, -1);
+			touched_.resize(_size, false);
+		}
+
+
+		/*
+		 * Active region
+		 */
+
+		void CompressedKalmanFilterIndirect::setRegion(const ind_array & ia)
+		{
+			for (size_t i = 0; i < ia_active_.size(); ++i) pos_[ia_active_(i)] = -1;
+			ia_active_ = ia;
+			ia_base_ = ia;
+			for (size_t i = 0; i < ia.size(); ++i) pos_[ia(i)] = i;
+			phi_ = identity_mat(ia.size());
+			psi_.resize(ia.size(), false);
+			psi_.clear();
+			lazyCorrections_.clear();
+			lazySize_ = 0;
+			pending_ = false;
+		}
+
+		void CompressedKalmanFilterIndirect::addActive(const ind_array & ia, const mat & phi_rows)
+		{
+			size_t n = ia_active_.size(), n_add = 0;
+			for (size_t i = 0; i < ia.size(); ++i) if (pos_[ia(i)] < 0) ++n_add;
+			ind_array ia_active(n + n_add);
+			for (size_t i = 0; i < n; ++i) ia_active(i) = ia_active_(i);
+			phi_.resize(n + n_add, ia_base_.size(), true);
+			for (size_t i = 0; i < ia.size(); ++i)
+			{
+				if (pos_[ia(i)] < 0) { pos_[ia(i)] = n; ia_active(n) = ia(i); ++n; }
+				row(phi_, pos_[ia(i)]) = row(phi_rows, i);
+			}
+			ia_active_ = ia_active;
+		}
+
+		void CompressedKalmanFilterIndirect::touch(const ind_array & ia)
+		{
+			for (size_t i = 0; i < ia.size(); ++i) touched_[ia(i)] = true;
+		}
+
+		ind_array CompressedKalmanFilterIndirect::touchedStates()
+		{
+			std::vector<size_t> touched;
+			for (size_t i = 0; i < touched_.size(); ++i)
+				if (touched_[i]) { touched.push_back(i); touched_[i] = false; }
+			ind_array res(touched.size());
+			for (size_t i = 0; i < touched.size(); ++i) res(i) = touched[i];
+			return res;
+		}
+
+		ind_array CompressedKalmanFilterIndirect::activePos(const ind_array & ia)
+		{
+			ind_array res(ia.size());
+			for (size_t i = 0; i < ia.size(); ++i) res(i) = pos_[ia(i)];
+			return res;
+		}
+
+		bool CompressedKalmanFilterIndirect::isActive(const ind_array & ia)
+		{
+			for (size_t i = 0; i < ia.size(); ++i) if (pos_[ia(i)] < 0) return false;
+			return true;
+		}
+
+		mat CompressedKalmanFilterIndirect::phiRows(const ind_array & ia)
+		{
+			return project(phi_, activePos(ia), ia_set(0, ia_base_.size()));
+		}
+
+		/*
+		 * The covariances are globally updated and the region is extended,
+		 * or reduced to the states used since it was last reduced if it becomes too large.
+		 */
+		void CompressedKalmanFilterIndirect::activate(const ind_array & ia_used)
+		{
+			// the consider states stay in A, the lazy updates of B are not Schmidt updates
+			ind_array ia = ia_union(ia_used, consideredStates());
+			if (isActive(ia) && ia_active_.size() <= maxActive_) return;
+			globalUpdate();
+			ind_array ia_active = ia_union(ia_active_, ia);
+			if (ia_active.size() > maxActive_) ia_active = ia_union(touchedStates(), ia);
+			setRegion(ia_active);
+		}
+
+		void CompressedKalmanFilterIndirect::globalUpdate()
+		{
+			if (!pending_) return;
+			std::vector<size_t> outside;
+			for (size_t i = 0; i < ia_x_.size(); ++i) if (pos_[ia_x_(i)] < 0) outside.push_back(ia_x_(i));
+			ind_array ia_b(outside.size());
+			for (size_t i = 0; i < outside.size(); ++i) ia_b(i) = outside[i];
+
+			if (ia_b.size() > 0)
+			{
+				mat W = project(P_, ia_base_, ia_b);
+				if (lazySize_ < ia_base_.size())
+				{
+					for (std::list<LazyCorrection>::iterator it = lazyCorrections_.begin(); it != lazyCorrections_.end(); ++it)
+					{
+						mat U = prod(trans(W), it->Y);
+						mat UiZ = prod(U, it->iZ);
+						project(P_, ia_b, ia_b) -= prod<sym_mat>(UiZ, trans(U));
+					}
+				}
+				else
+				{
+					mat psiW = prod(psi_, W);
+					project(P_, ia_b, ia_b) -= prod<sym_mat>(trans(W), psiW);
+				}
+				project(P_, ia_active_, ia_b) = prod(phi_, W);
+			}
+			++nGlobalUpdates_;
+			pending_ = false;
+		}
+
+		/*
+		 * With P_rsl,B = phi_rsl * P_AB, and Y = phi_rsl' * INN_rsl':
+		 * - x_B <-- x_B - P_BA * Y * inv(Z) * z
+		 * - psi <-- psi + Y * inv(Z) * Y'
+		 * - phi <-- phi + K_A * Y'
+		 */
+		void CompressedKalmanFilterIndirect::correctLazy(const mat & Y, const sym_mat & iZ, const vec & z)
+		{
+			std::vector<size_t> outside;
+			for (size_t i = 0; i < ia_x_.size(); ++i) if (pos_[ia_x_(i)] < 0) outside.push_back(ia_x_(i));
+			if (!outside.empty())
+			{
+				ind_array ia_b(outside.size());
+				for (size_t i = 0; i < outside.size(); ++i) ia_b(i) = outside[i];
+				vec iZz = prod(iZ, z);
+				vec YiZz = prod(Y, iZz);
+				project(x_, ia_b) -= prod(project(P_, ia_b, ia_base_), YiZz);
+			}
+			mat YiZ = prod(Y, iZ);
+			psi_ += prod<sym_mat>(YiZ, trans(Y));
+			// the cross-variances of the consider states with B are updated by the rows of B, ie with their optimal gain
+			for (size_t i = 0; i < ia_active_.size(); ++i)
+				if (isConsider(ia_active_(i))) row(K, i) = - prod(row(PJt_tmp, i), iZ);
+			phi_ += prod(K, trans(Y));
+			lazyCorrections_.push_back(LazyCorrection(Y, iZ));
+			lazySize_ += z.size();
+			pending_ = true;
+		}
+
+
+		/*
+		 * Filter operations
+		 */
+
+		void CompressedKalmanFilterIndirect::predict(const ind_array & ia_x, const mat & F_v, const ind_array & ia_v,
+		    const mat & F_u, const sym_mat & U)
+		{
+			ia_x_ = ia_x;
+			activate(ia_v);
+			touch(ia_v);
+			if (!pending_) { ExtendedKalmanFilterIndirect::predict(ia_x, F_v, ia_v, F_u, U); return; }
+			ExtendedKalmanFilterIndirect::predict(ia_active_, F_v, ia_v, F_u, U);
+			project(phi_, activePos(ia_v), ia_set(0, ia_base_.size())) = prod(F_v, phiRows(ia_v));
+		}
+
+		void CompressedKalmanFilterIndirect::predict(const ind_array & ia_x, const mat & F_v, const ind_array & ia_v,
+		    const sym_mat & Q)
+		{
+			ia_x_ = ia_x;
+			activate(ia_v);
+			touch(ia_v);
+			if (!pending_) { ExtendedKalmanFilterIndirect::predict(ia_x, F_v, ia_v, Q); return; }
+			ExtendedKalmanFilterIndirect::predict(ia_active_, F_v, ia_v, Q);
+			project(phi_, activePos(ia_v), ia_set(0, ia_base_.size())) = prod(F_v, phiRows(ia_v));
+		}
+
+		void CompressedKalmanFilterIndirect::predict(const ind_array & ia_x, const mat & F_v, const BlockJacobian & F_blocks,
+		    const ind_array & ia_v, const sym_mat & Q)
+		{
+			ia_x_ = ia_x;
+			activate(ia_v);
+			touch(ia_v);
+			if (!pending_) { ExtendedKalmanFilterIndirect::predict(ia_x, F_v, F_blocks, ia_v, Q); return; }
+			ExtendedKalmanFilterIndirect::predict(ia_active_, F_v, F_blocks, ia_v, Q);
+			project(phi_, activePos(ia_v), ia_set(0, ia_base_.size())) = prod(F_v, phiRows(ia_v));
+		}
+
+		void CompressedKalmanFilterIndirect::initialize(const ind_array & ia_x, const mat & G_v, const ind_array & ia_rs, const ind_array & ia_l, const mat & G_y, const sym_mat & R)
+		{
+			ia_x_ = ia_x;
+			activate(ia_rs);
+			touch(ia_rs); touch(ia_l);
+			if (!pending_) { ExtendedKalmanFilterIndirect::initialize(ia_x, G_v, ia_rs, ia_l, G_y, R); return; }
+			addActive(ia_l, prod(G_v, phiRows(ia_rs)));
+			ExtendedKalmanFilterIndirect::initialize(ia_active_, G_v, ia_rs, ia_l, G_y, R);
+		}
+
+		void CompressedKalmanFilterIndirect::initialize(const ind_array & ia_x, const mat & G_v, const ind_array & ia_rs, const ind_array & ia_l, const mat & G_y, const sym_mat & R, const mat & G_n, const sym_mat & N)
+		{
+			ia_x_ = ia_x;
+			activate(ia_rs);
+			touch(ia_rs); touch(ia_l);
+			if (!pending_) { ExtendedKalmanFilterIndirect::initialize(ia_x, G_v, ia_rs, ia_l, G_y, R, G_n, N); return; }
+			addActive(ia_l, prod(G_v, phiRows(ia_rs)));
+			ExtendedKalmanFilterIndirect::initialize(ia_active_, G_v, ia_rs, ia_l, G_y, R, G_n, N);
+		}
+
+		void CompressedKalmanFilterIndirect::reparametrize(const ind_array & ia_x, const mat & J_l, const ind_array & ia_old, const ind_array & ia_new)
+		{
+			stackReparametrization(J_l, ia_old, ia_new);
+			reparametrizeAllStacked(ia_x);
+		}
+
+		void CompressedKalmanFilterIndirect::reparametrizeAllStacked(const ind_array & ia_x)
+		{
+			if (reparStack.empty()) return;
+			ia_x_ = ia_x;
+			ind_array ia_old(0), ia_new(0);
+			for(ReparametrizationList::iterator it = reparStack.begin(); it != reparStack.end(); ++it)
+			{
+				ia_old = ia_union(ia_old, it->ia_old);
+				ia_new = ia_union(ia_new, it->ia_new);
+			}
+			activate(ia_old);
+			touch(ia_old); touch(ia_new);
+			if (!pending_) { ExtendedKalmanFilterIndirect::reparametrizeAllStacked(ia_x); return; }
+
+			// the rows of phi of the new elements are read before the reused ones are written
+			std::vector<std::pair<ind_array, mat> > rows;
+			for(ReparametrizationList::iterator it = reparStack.begin(); it != reparStack.end(); ++it)
+				rows.push_back(std::make_pair(it->ia_new, mat(prod(it->J_l, phiRows(it->ia_old)))));
+			ExtendedKalmanFilterIndirect::reparametrizeAllStacked(ia_union(ia_active_, ia_new));
+			for (size_t i = 0; i < rows.size(); ++i) addActive(rows[i].first, rows[i].second);
+		}
+
+		void CompressedKalmanFilterIndirect::correct(const ind_array & ia_x, Innovation & inn, const mat & INN_rsl, const ind_array & ia_rsl, const sym_mat & R)
+		{
+			ia_x_ = ia_x;
+			activate(ia_rsl);
+			touch(ia_rsl);
+			mat Y = prod(trans(phiRows(ia_rsl)), trans(INN_rsl));
+			ExtendedKalmanFilterIndirect::correct(ia_active_, inn, INN_rsl, ia_rsl, R);
+			correctLazy(Y, inn.iP_, inn.x());
+		}
+
+		void CompressedKalmanFilterIndirect::correctAllStacked(const ind_array & ia_x)
+		{
+			if (corrStack.stack.empty()) return;
+			ia_x_ = ia_x;
+			ind_array ia_inn(0);
+			for(CorrectionList::iterator corrIter = corrStack.stack.begin(); corrIter != corrStack.stack.end(); ++corrIter)
+				ia_inn = ia_union(ia_inn, corrIter->ia_rsl);
+			activate(ia_inn);
+			touch(ia_inn);
+
+			mat Y(ia_base_.size(), corrStack.inn_size);
+			size_t col = 0;
+			for(CorrectionList::iterator corrIter = corrStack.stack.begin(); corrIter != corrStack.stack.end(); ++corrIter)
+			{
+				subrange(Y, 0, ia_base_.size(), col, col + corrIter->inn.size()) =
+					prod(trans(phiRows(corrIter->ia_rsl)), trans(corrIter->INN_rsl));
+				col += corrIter->inn.size();
+			}
+			ExtendedKalmanFilterIndirect::correctAllStacked(ia_active_);
+			correctLazy(Y, stackedInnovation_iP, stackedInnovation_x);
+		}
+
+		/*
+		 * The liberated states leave A, they stay in the columns of phi
+		 */
+		void CompressedKalmanFilterIndirect::liberate(const ind_array & ia)
+		{
+			std::vector<bool> liberated(size(), false);
+			for (size_t i = 0; i < ia.size(); ++i) { liberated[ia(i)] = true; touched_[ia(i)] = false; }
+			std::vector<size_t> keep;
+			for (size_t i = 0; i < ia_active_.size(); ++i) if (!liberated[ia_active_(i)]) keep.push_back(i);
+			if (keep.size() == ia_active_.size()) return;
+
+			ind_array pos_keep(keep.size()), ia_active(keep.size());
+			for (size_t i = 0; i < keep.size(); ++i) { pos_keep(i) = keep[i]; ia_active(i) = ia_active_(keep[i]); }
+			phi_ = mat(project(phi_, pos_keep, ia_set(0, ia_base_.size())));
+			for (size_t i = 0; i < ia_active_.size(); ++i) pos_[ia_active_(i)] = -1;
+			ia_active_ = ia_active;
+			for (size_t i = 0; i < ia_active_.size(); ++i) pos_[ia_active_(i)] = i;
+		}
+
+		void CompressedKalmanFilterIndirect::recover(const ind_array & ia)
+		{
+			if (!pending_ || isActive(ia)) return;
+			activate(ia);
+		}
+
+		/*
+		 * P_bb <-- P_bb - P_bA0 * psi * P_A0b, as in globalUpdate() but only for b
+		 */
+		sym_mat CompressedKalmanFilterIndirect::marginal(const ind_array & ia)
+		{
+			bool outside = true;
+			for (size_t i = 0; i < ia.size(); ++i) if (pos_[ia(i)] >= 0) outside = false;
+			if (!pending_ || isActive(ia) || !outside) return ExtendedKalmanFilterIndirect::marginal(ia);
+
+			sym_mat res = project(P_, ia, ia);
+			mat W = project(P_, ia_base_, ia);
+			if (lazySize_ < ia_base_.size())
+			{
+				for (std::list<LazyCorrection>::iterator it = lazyCorrections_.begin(); it != lazyCorrections_.end(); ++it)
+				{
+					mat U = prod(trans(W), it->Y);
+					mat UiZ = prod(U, it->iZ);
+					res -= prod<sym_mat>(UiZ, trans(U));
+				}
+			}
+			else
+			{
+				mat psiW = prod(psi_, W);
+				res -= prod<sym_mat>(trans(W), psiW);
+			}
+			return res;
+		}
+
+	}
+}
@@ -0,0 +1,38 @@
+/**
+ * \file dataManagerAbstract.cpp
+ * \date 17/10/2026
+ * \author jsola
+ * \ingroup rtslam
+ */
+
+#include "rtslam/dataManagerAbstract.hpp"
+#include "rtslam/observationAbstract.hpp"
+#include "rtslam/observationFactory.hpp"
+
+namespace jafar {
+	namespace rtslam {
+
+
+		/*
+		 * The probe is linked to the landmark without being registered as its child,
+		 * so that it does not appear in the observation lists.
+		 */
+		bool DataManagerAbstract::predictVisibility(const landmark_ptr_t & lmkPtr)
+		{
+			observation_ptr_t & probe = visibilityProbes[lmkPtr->type];
+			if (!probe)
+			{
+				probe = obsFactory->create(sensorPtr(), lmkPtr);
+				probe->linkToSensor(sensorPtr());
+				probe->linkToSensorSpecific(sensorPtr());
+			}
+			probe->ChildOf<LandmarkAbstract>::linkToParent(lmkPtr);
+			probe->projectMean();
+			bool visible = probe->predictVisibility();
+			probe->ChildOf<LandmarkAbstract>::unlinkFromParent();
+			return visible;
+		}
+
+
+	}
+}
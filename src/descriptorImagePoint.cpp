@@ -87,7 +87,7 @@ namespace jafar {
 			double zoom, rotation;
 			landmark_ptr_t lmkPtr = obsPtrNew->landmarkPtr();
 			vec pnt = lmkPtr->reparametrized();
-			quaternion::getZoomRotation(view.senPose, obsPtrNew->sensorPtr()->globalPose(), pnt, zoom, rotation);
+			quaternion::getZoomRotation(view.senPose, obsPtrNew->appearanceSensorPose(), pnt, zoom, rotation);
 			// normally we must cast to the derived type
 			app_img_pnt_ptr_t app_dst = SPTR_CAST<AppearanceImagePoint>(obsPtrNew->predictedAppearance);
 			app_img_pnt_ptr_t app_src = SPTR_CAST<AppearanceImagePoint>(view.appearancePtr);
@@ -176,7 +176,7 @@ app_dst->patch.save(buffer);
 				case ptAffine:
 				{
 					double zoom, rotation;
-					quaternion::getZoomRotation(view_src->senPose, obsPtr->sensorPtr()->globalPose(), lmk, zoom, rotation);
+					quaternion::getZoomRotation(view_src->senPose, obsPtr->appearanceSensorPose(), lmk, zoom, rotation);
 					app_src->patch.rotateScale(jmath::radToDeg(rotation), zoom, app_dst->patch);
 					
 					double alpha = zoom * cos(rotation);
@@ -81,8 +81,17 @@ namespace display {
 	
 	void RobotGdhe::bufferize()
 	{
-		poseQuat = slamRob_->pose.x();
-		poseQuatUncert = slamRob_->pose.P();
+		jblas::vec x;
+		jblas::sym_mat P;
+		if (slamRob_->mapPtr()->marginals.get(slamRob_->state.ia(), x, P))
+		{
+			poseQuat = ublas::subrange(x, 0, 7);
+			poseQuatUncert = ublas::subrange(P, 0, 7, 0, 7);
+		} else
+		{
+			poseQuat = slamRob_->pose.x();
+			poseQuatUncert = slamRob_->pose.P();
+		}
 	}
 	
 	void RobotGdhe::render()
@@ -172,8 +181,11 @@ JFR_DEBUG("robot EULER: " << uncertEuler);*/
 			events_.updated |= (*obs)->events.updated;
 		}
 */		
-		state_ = slamLmk_->state.x();
-		cov_ = slamLmk_->state.P();
+		if (!slamLmk_->mapManagerPtr()->mapPtr()->marginals.get(slamLmk_->state.ia(), state_, cov_))
+		{
+			state_ = slamLmk_->state.x();
+			cov_ = slamLmk_->state.P();
+		}
 	}
 	
 	void LandmarkGdhe::render()
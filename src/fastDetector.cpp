@@ -0,0 +1,260 @@
+/*
+ * \file fastDetector.cpp
+ * \date 17/10/2026
+ * \author jsola
+ * \ingroup rtslam
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "kernel/jafarDebug.hpp"
+#include "jmath/jblas.hpp"
+#include "jmath/misc.hpp"
+#include "image/roi.hpp"
+#include "rtslam/fastDetector.hpp"
+
+
+namespace jafar {
+	namespace rtslam {
+		using namespace std;
+		using namespace image;
+
+		// Bresenham circle of radius 3, clockwise from the top, the compass points being 0, 4, 8 and 12
+		static const int circle_x[16] = { 0, 1, 2, 3, 3, 3, 2, 1, 0, -1, -2, -3, -3, -3, -2, -1 };
+		static const int circle_y[16] = { -3, -3, -2, -1, 0, 1, 2, 3, 3, 3, 2, 1, 0, -1, -2, -3 };
+
+		FastDetector::FastDetector(int arc, int threshold, bool harrisScore, int convolutionBoxSize, float harrisThreshold, float edge):
+			m_arc(arc), m_threshold(threshold), m_harrisScore(harrisScore), m_convolutionSize(convolutionBoxSize),
+			m_harrisThreshold(harrisThreshold), m_edge(edge), m_step(-1), m_nCandidates(0)
+		{
+			JFR_ASSERT(arc >= 9 && arc <= 16, "FastDetector: arc must be between 9 and 16");
+			normCoeff = jmath::sqr(m_convolutionSize);
+			m_border = 3;
+			if (m_harrisScore) m_border = std::max(m_border, m_convolutionSize / 2 + 1);
+		}
+
+		void FastDetector::setOffsets(int step)
+		{
+			if (step == m_step) return;
+			m_step = step;
+			for (int i = 0; i < 16; ++i)
+				m_offsets[i] = circle_y[i] * step + circle_x[i];
+		}
+
+		bool FastDetector::clip(const image::Image & image, const image::ConvexRoi * roiPtr, int & x0, int & y0, int & x1, int & y1)
+		{
+			x0 = m_border; y0 = m_border;
+			x1 = image.width() - m_border; y1 = image.height() - m_border;
+			if (roiPtr)
+			{
+				// bounding box of the region, the corners outside its convex part are rejected by inRoi
+				x0 = std::max(x0, roiPtr->x()); y0 = std::max(y0, roiPtr->y());
+				x1 = std::min(x1, roiPtr->x() + roiPtr->w()); y1 = std::min(y1, roiPtr->y() + roiPtr->h());
+			}
+			setOffsets(image.step());
+			return (x0 < x1 && y0 < y1);
+		}
+
+		bool FastDetector::inRoi(const image::ConvexRoi * roiPtr, int x, int y)
+		{
+			if (!roiPtr) return true;
+			jblas::vec2 pix;
+			pix(0) = x + 0.5; pix(1) = y + 0.5;
+			return roiPtr->isIn(pix);
+		}
+
+		bool FastDetector::segmentTest(const uchar * pix)
+		{
+			int hi = *pix + m_threshold, lo = *pix - m_threshold;
+			const int * off = m_offsets;
+			// compass points: an arc of 9 or more contains two adjacent ones
+			int p0 = pix[off[0]], p4 = pix[off[4]], p8 = pix[off[8]], p12 = pix[off[12]];
+			bool bright = (p0 > hi || p8 > hi) && (p4 > hi || p12 > hi);
+			bool dark = (p0 < lo || p8 < lo) && (p4 < lo || p12 < lo);
+			if (!bright && !dark) return false;
+
+			unsigned b = 0, d = 0;
+			for (int i = 0; i < 16; ++i)
+			{
+				int p = pix[off[i]];
+				if (p > hi) b |= 1 << i;
+				if (p < lo) d |= 1 << i;
+			}
+			// look for arc contiguous bits in the circular masks
+			b |= b << 16; d |= d << 16;
+			unsigned rb = b, rd = d;
+			for (int k = 1; k < m_arc; ++k) { rb &= b >> k; rd &= d >> k; }
+			return (rb | rd) != 0;
+		}
+
+		void FastDetector::segmentTest(const image::Image & image, int y, int x0, int x1, unsigned char * hits)
+		{
+			const uchar * row = image.data() + y * image.step();
+			int x = x0;
+#ifdef __SSE2__
+			const __m128i t = _mm_set1_epi8((char)std::min(m_threshold, 255));
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i one = _mm_set1_epi8(1);
+			const __m128i arc1 = _mm_set1_epi8((char)(m_arc - 1));
+			__m128i bright[16], dark[16];
+			for (; x + 16 <= x1; x += 16)
+			{
+				const uchar * pix = row + x;
+				__m128i c = _mm_loadu_si128((const __m128i*)pix);
+				__m128i hi = _mm_adds_epu8(c, t), lo = _mm_subs_epu8(c, t);
+				// p > c+t and p < c-t, unsigned and saturated: nothing is brighter than 255 or darker than 0
+				#define FAST_SSE_TEST(i) { \
+					__m128i p = _mm_loadu_si128((const __m128i*)(pix + m_offsets[i])); \
+					bright[i] = _mm_andnot_si128(_mm_cmpeq_epi8(_mm_subs_epu8(p, hi), zero), _mm_cmpeq_epi8(zero, zero)); \
+					dark[i] = _mm_andnot_si128(_mm_cmpeq_epi8(_mm_subs_epu8(lo, p), zero), _mm_cmpeq_epi8(zero, zero)); }
+				FAST_SSE_TEST(0) FAST_SSE_TEST(4) FAST_SSE_TEST(8) FAST_SSE_TEST(12)
+				__m128i quick = _mm_or_si128(
+					_mm_and_si128(_mm_or_si128(bright[0], bright[8]), _mm_or_si128(bright[4], bright[12])),
+					_mm_and_si128(_mm_or_si128(dark[0], dark[8]), _mm_or_si128(dark[4], dark[12])));
+				if (_mm_movemask_epi8(quick) == 0)
+				{
+					for (int k = 0; k < 16; ++k) hits[x - x0 + k] = 0;
+					continue;
+				}
+				for (int i = 1; i < 16; ++i) if (i % 4) FAST_SSE_TEST(i)
+				#undef FAST_SSE_TEST
+
+				// length of the current run of brighter and darker pixels, going twice around the circle
+				__m128i nb = zero, nd = zero, maxb = zero, maxd = zero;
+				for (int k = 0; k < 16 + m_arc - 1; ++k)
+				{
+					nb = _mm_and_si128(_mm_add_epi8(nb, one), bright[k & 15]);
+					nd = _mm_and_si128(_mm_add_epi8(nd, one), dark[k & 15]);
+					maxb = _mm_max_epu8(maxb, nb);
+					maxd = _mm_max_epu8(maxd, nd);
+				}
+				int mask = _mm_movemask_epi8(_mm_cmpgt_epi8(_mm_max_epu8(maxb, maxd), arc1));
+				for (int k = 0; k < 16; ++k) hits[x - x0 + k] = (mask >> k) & 1;
+			}
+#endif
+			for (; x < x1; ++x)
+				hits[x - x0] = segmentTest(row + x);
+		}
+
+		float FastDetector::fastScore(const uchar * pix)
+		{
+			int hi = *pix + m_threshold, lo = *pix - m_threshold;
+			int sb = 0, sd = 0;
+			for (int i = 0; i < 16; ++i)
+			{
+				int p = pix[m_offsets[i]];
+				if (p > hi) sb += p - hi; else
+				if (p < lo) sd += lo - p;
+			}
+			return (float)std::max(sb, sd);
+		}
+
+		/*
+		 * Same computation as QuickHarrisDetector::quickConvolutionWithBestPoint, on a single pixel:
+		 * [-1 0 1] derivatives, summed on a square box, smallest eigenvalue normalized by the box size.
+		 * Returns 0 if the point is an edge.
+		 */
+		float FastDetector::harrisScore(const image::Image & image, int x, int y)
+		{
+			int shift_conv = (m_convolutionSize - 1) / 2;
+			int step = image.step();
+			int conv_xx = 0, conv_xy = 0, conv_yy = 0;
+			for (int i = y - shift_conv; i <= y + shift_conv; ++i)
+			{
+				const uchar * pix = image.data() + i * step + x - shift_conv;
+				for (int j = 0; j < m_convolutionSize; ++j, ++pix)
+				{
+					int im_x = pix[1] - pix[-1];
+					int im_y = pix[step] - pix[-step];
+					conv_xx += im_x * im_x;
+					conv_xy += im_x * im_y;
+					conv_yy += im_y * im_y;
+				}
+			}
+			double sm = (double)conv_xx + conv_yy;
+			double df = (double)conv_xx - conv_yy;
+			double sr = sqrt(df * df + 4. * (double)conv_xy * (double)conv_xy);
+			double high_curv = sm + sr, low_curv = sm - sr;
+			if (low_curv <= 0. || high_curv / low_curv >= m_edge) return 0.;
+			return sqrt(low_curv / normCoeff);
+		}
+
+		float FastDetector::score(const image::Image & image, int x, int y)
+		{
+			if (m_harrisScore)
+			{
+				float s = harrisScore(image, x, y);
+				return (s > m_harrisThreshold ? s : 0.);
+			}
+			return fastScore(image.data() + y * image.step() + x);
+		}
+
+		bool FastDetector::detectIn(const jafar::image::Image & image, feat_img_pnt_ptr_t featPtr, const image::ConvexRoi *roiPtr) {
+			m_nCandidates = 0;
+			int x0, y0, x1, y1;
+			if (!clip(image, roiPtr, x0, y0, x1, y1)) return false;
+
+			m_hits.resize(x1 - x0);
+			int pixBest[2] = { 0, 0 };
+			float scoreBest = 0.;
+			for (int y = y0; y < y1; ++y)
+			{
+				segmentTest(image, y, x0, x1, &m_hits[0]);
+				for (int x = x0; x < x1; ++x)
+				{
+					if (!m_hits[x - x0] || !inRoi(roiPtr, x, y)) continue;
+					++m_nCandidates;
+					float s = score(image, x, y);
+					if (s > scoreBest) { scoreBest = s; pixBest[0] = x; pixBest[1] = y; }
+				}
+			}
+
+			if (scoreBest > 0.)
+			{
+				featPtr->setup(pixBest[0]+0.5, pixBest[1]+0.5, scoreBest);
+				return true;
+			}
+			return false;
+		}
+
+		void FastDetector::detectAll(const jafar::image::Image & image, std::vector<corner_t> & corners, const image::ConvexRoi *roiPtr) {
+			corners.clear();
+			m_nCandidates = 0;
+			int x0, y0, x1, y1;
+			if (!clip(image, roiPtr, x0, y0, x1, y1)) return;
+
+			// scores with a margin of one pixel for the suppression, 0 for the non corners
+			int w = x1 - x0 + 2, h = y1 - y0 + 2;
+			m_hits.resize(x1 - x0);
+			m_scores.assign(w * h, 0.f);
+			for (int y = y0; y < y1; ++y)
+			{
+				segmentTest(image, y, x0, x1, &m_hits[0]);
+				float * srow = &m_scores[(y - y0 + 1) * w + 1];
+				for (int x = x0; x < x1; ++x)
+					if (m_hits[x - x0] && inRoi(roiPtr, x, y)) { ++m_nCandidates; srow[x - x0] = score(image, x, y); }
+			}
+
+			// 3x3 non-maximum suppression, the ties being won by the first pixel in raster order
+			for (int y = y0; y < y1; ++y)
+			{
+				const float * s = &m_scores[(y - y0 + 1) * w + 1];
+				for (int x = 0; x < x1 - x0; ++x, ++s)
+				{
+					float c = *s;
+					if (c <= 0.f) continue;
+					if (c <= s[-w-1] || c <= s[-w] || c <= s[-w+1] || c <= s[-1]) continue;
+					if (c < s[1] || c < s[w-1] || c < s[w] || c < s[w+1]) continue;
+					corner_t corner = { x0 + x, y, c };
+					corners.push_back(corner);
+				}
+			}
+		}
+
+	}
+}
@@ -76,6 +76,9 @@ namespace hardware {
 				// we put the maximum precision because we want repeatability with the original run
 				f << std::setprecision(50) << row << std::endl;
 			}
+			
+			row(0) += timestamps_correction;
+			newReading(row);
 		}
 		
 		if (mode == 1 || mode == 2)
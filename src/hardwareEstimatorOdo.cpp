@@ -52,6 +52,7 @@ namespace hardware {
 // 			buffer(write_position,0) += timestamps_correction;
 			++write_position; if (write_position >= bufferSize) write_position = 0;
 			l.unlock();
+			newReading(row);
 		}
 		
 	} catch (kernel::Exception &e) { std::cout << e.what(); throw e; } }
@@ -0,0 +1,633 @@
+/**
+ * \file informationFilter.cpp
+ * \date 17/10/2026
+ * \author jsola
+ * \ingroup rtslam
+ */
+
+#include <set>
+#include <algorithm>
+
+#include "rtslam/informationFilter.hpp"
+#include "jmath/jblas.hpp"
+#include "jmath/ublasExtra.hpp"
+
+namespace jafar {
+	namespace rtslam {
+		using namespace std;
+		using namespace jmath;
+		using namespace jblas;
+		using namespace ublas;
+		using namespace jmath::ublasExtra;
+
+		static const size_t NO_ELEMENT = (size_t)-1;
+
+		/// [ia1 ia2], the two arrays must be disjoint
+		static ind_array ia_concat(const ind_array & ia1, const ind_array & ia2)
+		{
+			ind_array res(ia1.size() + ia2.size());
+			for (size_t i = 0; i < ia1.size(); ++i) res(i) = ia1(i);
+			for (size_t i = 0; i < ia2.size(); ++i) res(ia1.size() + i) = ia2(i);
+			return res;
+		}
+
+		static ind_array ia_from(const std::vector<size_t> & v)
+		{
+			ind_array res(v.size());
+			for (size_t i = 0; i < v.size(); ++i) res(i) = v[i];
+			return res;
+		}
+
+		static mat inverse(const mat & M)
+		{
+			mat Minv(M.size1(), M.size2());
+			lu_inv(M, Minv);
+			return Minv;
+		}
+
+		/// Lu(:,c) * inv(Lu(c,c)) * Lu(c,:)
+		static mat schurTerm(const mat & Lu, const ind_array & c)
+		{
+			ind_array all = ia_set(0, Lu.size1());
+			mat Luc = project(Lu, all, c);
+			mat Lcc = project(Lu, c, c);
+			mat W = prod(inverse(Lcc), trans(Luc));
+			return prod(Luc, W);
+		}
+
+
+		SparseInformationFilterIndirect::SparseInformationFilterIndirect(size_t _size, size_t maxActive, double noiseFloor, size_t relaxSize) :
+			ExtendedKalmanFilterIndirect(_size, false), L_(_size), eta_(_size), known_(_size, false), element_(_size, NO_ELEMENT),
+			ia_robot_(0), pos_(_size, -1), recoveredPos_(_size, -1), ia_recovered_(0), P_recovered_(0), blocksOf_(_size),
+			maxActive_(maxActive), noiseFloor_(noiseFloor), relaxSize_(relaxSize), relaxNext_(0)
+		{
+			eta_.clear();
+		}
+
+		void SparseInformationFilterIndirect::grow(size_t _size)
+		{
+			size_t old_size = size();
+			if (_size <= old_size) return;
+			ExtendedKalmanFilterIndirect::grow(_size);
+			L_.resize(_size);
+			eta_.resize(_size, true);
+			for (size_t i = old_size; i < _size; ++i) eta_(i) = 0.;
+			known_.resize(_size, false);
+			element_.resize(_size, NO_ELEMENT);
+			pos_.resize(_size, -1);
+			recoveredPos_.resize(_size, -1);
+			blocksOf_.resize(_size);
+		}
+
+
+		/*
+		 * Covariances storage
+		 */
+
+		Gaussian SparseInformationFilterIndirect::objectState(const ind_array & ia)
+		{
+			CovarianceBlock * block = NULL;
+			for (size_t k = 0; k < freeBlocks_.size() && !block; ++k)
+				if (freeBlocks_[k]->P.size1() == ia.size())
+				{
+					block = freeBlocks_[k];
+					freeBlocks_.erase(freeBlocks_.begin() + k);
+				}
+			if (!block)
+			{
+				blocks_.push_back(CovarianceBlock());
+				block = &blocks_.back();
+				block->P.resize(ia.size(), false);
+			}
+			block->ia = ia;
+			block->P.clear();
+			for (size_t i = 0; i < ia.size(); ++i) blocksOf_[ia(i)].push_back(block);
+			return Gaussian(x_, block->ia, block->P);
+		}
+
+		void SparseInformationFilterIndirect::releaseBlocks(const ind_array & ia)
+		{
+			for (size_t i = 0; i < ia.size(); ++i)
+				while (!blocksOf_[ia(i)].empty())
+				{
+					CovarianceBlock * block = blocksOf_[ia(i)].back();
+					for (size_t j = 0; j < block->ia.size(); ++j)
+					{
+						std::vector<CovarianceBlock*> & blocks = blocksOf_[block->ia(j)];
+						blocks.erase(std::find(blocks.begin(), blocks.end(), block));
+					}
+					freeBlocks_.push_back(block);
+				}
+		}
+
+		/*
+		 * The states of ia that were recovered together get their recovered cross-variances,
+		 * the other ones those of the blocks that contain both states, or zero.
+		 */
+		sym_mat SparseInformationFilterIndirect::covariance(const ind_array & ia)
+		{
+			sym_mat res(ia.size()); res.clear();
+			setLocal(ia, true);
+			for (size_t a = 0; a < ia.size(); ++a)
+			{
+				std::vector<CovarianceBlock*> & blocks = blocksOf_[ia(a)];
+				for (size_t k = 0; k < blocks.size(); ++k)
+				{
+					CovarianceBlock & block = *blocks[k];
+					for (size_t i = 0; i < block.ia.size(); ++i)
+						if (block.ia(i) == ia(a))
+							for (size_t j = 0; j < block.ia.size(); ++j)
+								if (pos_[block.ia(j)] >= 0) res(a, pos_[block.ia(j)]) = block.P(i, j);
+				}
+			}
+			setLocal(ia, false);
+			for (size_t a = 0; a < ia.size(); ++a)
+				for (size_t b = 0; b <= a; ++b)
+					if (recoveredPos_[ia(a)] >= 0 && recoveredPos_[ia(b)] >= 0)
+						res(a, b) = P_recovered_(recoveredPos_[ia(a)], recoveredPos_[ia(b)]);
+			return res;
+		}
+
+
+		/*
+		 * Sparse storage
+		 */
+
+		void SparseInformationFilterIndirect::setLocal(const ind_array & ia, bool in)
+		{
+			for (size_t i = 0; i < ia.size(); ++i) pos_[ia(i)] = (in ? (int)i : -1);
+		}
+
+		void SparseInformationFilterIndirect::invalidateRecovered()
+		{
+			for (size_t i = 0; i < ia_recovered_.size(); ++i) recoveredPos_[ia_recovered_(i)] = -1;
+			ia_recovered_ = ind_array(0);
+		}
+
+		mat SparseInformationFilterIndirect::gather(const ind_array & ia)
+		{
+			mat Lloc(ia.size(), ia.size()); Lloc.clear();
+			setLocal(ia, true);
+			for (size_t a = 0; a < ia.size(); ++a)
+			{
+				InfoRow & row = L_[ia(a)];
+				for (InfoRow::iterator it = row.begin(); it != row.end(); ++it)
+					if (pos_[it->first] >= 0) Lloc(a, pos_[it->first]) = it->second;
+			}
+			setLocal(ia, false);
+			return Lloc;
+		}
+
+		void SparseInformationFilterIndirect::scatter(const ind_array & ia, const mat & Lloc)
+		{
+			invalidateRecovered();
+			for (size_t a = 0; a < ia.size(); ++a)
+				for (size_t b = 0; b < ia.size(); ++b)
+				{
+					double v = 0.5 * (Lloc(a, b) + Lloc(b, a));
+					if (v == 0.) L_[ia(a)].erase(ia(b)); else L_[ia(a)][ia(b)] = v;
+				}
+		}
+
+		void SparseInformationFilterIndirect::clearRows(const ind_array & ia)
+		{
+			invalidateRecovered();
+			for (size_t a = 0; a < ia.size(); ++a)
+			{
+				size_t i = ia(a);
+				for (InfoRow::iterator it = L_[i].begin(); it != L_[i].end(); ++it)
+					if (it->first != i) L_[it->first].erase(i);
+				L_[i].clear();
+				eta_(i) = 0.;
+			}
+		}
+
+		ind_array SparseInformationFilterIndirect::neighbors(const ind_array & ia)
+		{
+			std::set<size_t> res;
+			setLocal(ia, true);
+			for (size_t a = 0; a < ia.size(); ++a)
+			{
+				InfoRow & row = L_[ia(a)];
+				for (InfoRow::iterator it = row.begin(); it != row.end(); ++it)
+					if (pos_[it->first] < 0) res.insert(it->first);
+			}
+			setLocal(ia, false);
+			return ia_from(std::vector<size_t>(res.begin(), res.end()));
+		}
+
+		vec SparseInformationFilterIndirect::externalInfo(const ind_array & ia)
+		{
+			vec b = project(eta_, ia);
+			setLocal(ia, true);
+			for (size_t a = 0; a < ia.size(); ++a)
+			{
+				InfoRow & row = L_[ia(a)];
+				for (InfoRow::iterator it = row.begin(); it != row.end(); ++it)
+					if (pos_[it->first] < 0) b(a) -= it->second * x_(it->first);
+			}
+			setLocal(ia, false);
+			return b;
+		}
+
+		void SparseInformationFilterIndirect::refreshInfoVector(const ind_array & ia)
+		{
+			for (size_t a = 0; a < ia.size(); ++a)
+			{
+				size_t i = ia(a);
+				double e = 0.;
+				for (InfoRow::iterator it = L_[i].begin(); it != L_[i].end(); ++it) e += it->second * x_(it->first);
+				eta_(i) = e;
+			}
+		}
+
+		size_t SparseInformationFilterIndirect::nonZeros() const
+		{
+			size_t n = 0;
+			for (size_t i = 0; i < L_.size(); ++i) n += L_[i].size();
+			return n;
+		}
+
+		size_t SparseInformationFilterIndirect::activeCount()
+		{
+			ind_array ia_n = neighbors(ia_robot_);
+			std::set<size_t> elements;
+			for (size_t i = 0; i < ia_n.size(); ++i)
+				if (element_[ia_n(i)] != NO_ELEMENT) elements.insert(element_[ia_n(i)]);
+			return elements.size();
+		}
+
+
+		/*
+		 * Estimation
+		 */
+
+		void SparseInformationFilterIndirect::addPrior(const ind_array & ia)
+		{
+			std::vector<size_t> unknown;
+			for (size_t i = 0; i < ia.size(); ++i) if (!known_[ia(i)]) unknown.push_back(ia(i));
+			if (unknown.empty()) return;
+			ind_array ia_u = ia_from(unknown);
+			mat P_u = covariance(ia_u);
+			P_u += noiseFloor_ * identity_mat(ia_u.size());
+			clearRows(ia_u);
+			scatter(ia_u, inverse(P_u));
+			refreshInfoVector(ia_u);
+			for (size_t i = 0; i < unknown.size(); ++i) known_[unknown[i]] = true;
+		}
+
+		void SparseInformationFilterIndirect::solveLocal(const ind_array & ia)
+		{
+			if (ia.size() == 0) return;
+			mat Lloc = gather(ia);
+			vec b = externalInfo(ia);
+			project(x_, ia) = prod(inverse(Lloc), b);
+		}
+
+		void SparseInformationFilterIndirect::relax()
+		{
+			size_t n = size(), done = 0;
+			for (size_t k = 0; k < n && done < relaxSize_; ++k)
+			{
+				size_t i = relaxNext_;
+				relaxNext_ = (relaxNext_ + 1) % n;
+				if (!known_[i]) continue;
+				double d = 0., e = eta_(i);
+				for (InfoRow::iterator it = L_[i].begin(); it != L_[i].end(); ++it)
+					if (it->first == i) d = it->second; else e -= it->second * x_(it->first);
+				if (d > 0.) x_(i) = e / d;
+				++done;
+			}
+		}
+
+		void SparseInformationFilterIndirect::eliminate(const ind_array & ia)
+		{
+			ind_array ia_b = neighbors(ia);
+			size_t no = ia.size(), nb = ia_b.size();
+			if (nb > 0)
+			{
+				mat Lu = gather(ia_concat(ia, ia_b));
+				mat LoB = subrange(Lu, 0, no, no, no+nb);
+				mat W = prod(inverse(subrange(Lu, 0, no, 0, no)), LoB);
+				mat LBB = subrange(Lu, no, no+nb, no, no+nb) - prod(trans(LoB), W);
+				vec eta_o = project(eta_, ia);
+				project(eta_, ia_b) -= prod(trans(W), eta_o);
+				clearRows(ia);
+				scatter(ia_b, LBB);
+			} else
+				clearRows(ia);
+			for (size_t i = 0; i < no; ++i) { known_[ia(i)] = false; element_[ia(i)] = NO_ELEMENT; }
+		}
+
+		/*
+		 * Remove the links between the robot and its weakest landmarks, as in Thrun et al., IJRR 2004:
+		 * with x the robot, m0 the landmarks to deactivate and m+ the other active ones, all the other
+		 * states being fixed to their mean,
+		 * - L <-- L - L0 + L1 - L2 with Lc = L(:,c) * inv(L(c,c)) * L(c,:) for c = m0, {x,m0}, x.
+		 */
+		void SparseInformationFilterIndirect::sparsify()
+		{
+			if (ia_robot_.size() == 0) return;
+			ind_array ia_n = neighbors(ia_robot_);
+
+			// strength of the links of the landmarks with the robot
+			std::map<size_t, double> strength;
+			for (size_t r = 0; r < ia_robot_.size(); ++r)
+			{
+				InfoRow & row = L_[ia_robot_(r)];
+				for (InfoRow::iterator it = row.begin(); it != row.end(); ++it)
+					if (element_[it->first] != NO_ELEMENT) strength[element_[it->first]] += it->second * it->second;
+			}
+			if (strength.size() <= maxActive_) return;
+			std::vector<std::pair<double, size_t> > sorted;
+			for (std::map<size_t, double>::iterator it = strength.begin(); it != strength.end(); ++it)
+				sorted.push_back(std::make_pair(it->second, it->first));
+			std::sort(sorted.begin(), sorted.end());
+			std::set<size_t> passive;
+			for (size_t k = 0; k < sorted.size() - maxActive_; ++k) passive.insert(sorted[k].second);
+
+			std::vector<size_t> m0, mp;
+			for (size_t i = 0; i < ia_n.size(); ++i)
+				if (element_[ia_n(i)] != NO_ELEMENT && passive.count(element_[ia_n(i)])) m0.push_back(ia_n(i));
+				else mp.push_back(ia_n(i));
+			size_t nx = ia_robot_.size(), n0 = m0.size();
+			ind_array ia_u = ia_concat(ia_concat(ia_robot_, ia_from(m0)), ia_from(mp));
+
+			mat Lu = gather(ia_u);
+			mat Lt = Lu - schurTerm(Lu, ia_set(nx, nx+n0)) + schurTerm(Lu, ia_set(0, nx+n0)) - schurTerm(Lu, ia_set(0, nx));
+			subrange(Lt, 0, nx, nx, nx+n0) = zero_matrix<double>(nx, n0);
+			subrange(Lt, nx, nx+n0, 0, nx) = zero_matrix<double>(n0, nx);
+
+			vec x_u = project(x_, ia_u);
+			project(eta_, ia_u) += prod(mat(Lt - Lu), x_u);
+			scatter(ia_u, Lt);
+		}
+
+		void SparseInformationFilterIndirect::recover(const ind_array & ia)
+		{
+			std::vector<size_t> k;
+			for (size_t i = 0; i < ia.size(); ++i) if (known_[ia(i)]) k.push_back(ia(i));
+			if (k.empty()) return;
+			bool done = true;
+			for (size_t i = 0; i < k.size() && done; ++i) done = (recoveredPos_[k[i]] >= 0);
+			if (done) return;
+			ind_array ia_k = ia_from(k);
+			ind_array ia_m = ia_concat(ia_k, neighbors(ia_k));
+			mat Pm = inverse(gather(ia_m));
+			invalidateRecovered();
+			ia_recovered_ = ia_k;
+			P_recovered_ = sym_mat(subrange(Pm, 0, k.size(), 0, k.size()));
+			for (size_t i = 0; i < k.size(); ++i) recoveredPos_[k[i]] = i;
+
+			// the blocks of the map objects
+			for (size_t a = 0; a < k.size(); ++a)
+			{
+				std::vector<CovarianceBlock*> & blocks = blocksOf_[k[a]];
+				for (size_t n = 0; n < blocks.size(); ++n)
+				{
+					CovarianceBlock & block = *blocks[n];
+					for (size_t i = 0; i < block.ia.size(); ++i)
+						if (block.ia(i) == k[a])
+							for (size_t j = 0; j < block.ia.size(); ++j)
+								if (recoveredPos_[block.ia(j)] >= 0) block.P(i, j) = P_recovered_(a, recoveredPos_[block.ia(j)]);
+				}
+			}
+		}
+
+		sym_mat SparseInformationFilterIndirect::marginal(const ind_array & ia)
+		{
+			recover(ia);
+			return covariance(ia);
+		}
+
+
+		void SparseInformationFilterIndirect::predict(const ind_array & ia_x, const mat & F_v, const ind_array & ia_v,
+		    const mat & F_u, const sym_mat & U)
+		{
+			predict(ia_x, F_v, ia_v, prod_JPJt(U, F_u));
+		}
+
+		void SparseInformationFilterIndirect::predict(const ind_array & ia_x, const mat & F_v, const BlockJacobian & F_blocks,
+		    const ind_array & ia_v, const sym_mat & Q)
+		{
+			predict(ia_x, F_v, ia_v, Q);
+		}
+
+		/*
+		 * The new robot x_v+ = F_v * x_v + w, w ~ N(0,Q), is added as a new variable, and the old robot is marginalized out.
+		 * With iQ = inv(Q + noiseFloor), the old robot o, the new robot v and the neighbours b:
+		 * - L(o,o) = L(v,v) + F_v' * iQ * F_v, L(o,v) = -F_v' * iQ, L(o,b) = L(v,b), L(v,v) = iQ
+		 * - L(vb,vb) <-- L(vb,vb) - L(vb,o) * inv(L(o,o)) * L(o,vb)
+		 * which only touches the robot and its neighbours. F_v is not inverted, it is singular for the quaternions.
+		 * The mean of the robot has already been moved, the information vector follows.
+		 */
+		void SparseInformationFilterIndirect::predict(const ind_array & ia_x, const mat & F_v, const ind_array & ia_v,
+		    const sym_mat & Q)
+		{
+			ia_robot_ = ia_v;
+			addPrior(ia_v);
+			ind_array ia_s = ia_concat(ia_v, neighbors(ia_v));
+			size_t nv = ia_v.size(), ns = ia_s.size();
+
+			mat Ls = gather(ia_s);
+			mat Q_f = Q;
+			Q_f += noiseFloor_ * identity_mat(nv);
+			mat iQ = inverse(Q_f);
+			mat iQF = prod(iQ, F_v);
+			mat Loo = subrange(Ls, 0, nv, 0, nv) + prod(trans(F_v), iQF);
+			mat Los(nv, ns);
+			subrange(Los, 0, nv, 0, nv) = -trans(iQF);
+			subrange(Los, 0, nv, nv, ns) = subrange(Ls, 0, nv, nv, ns);
+
+			mat Lt = Ls;
+			subrange(Lt, 0, nv, 0, ns) = zero_matrix<double>(nv, ns);
+			subrange(Lt, nv, ns, 0, nv) = zero_matrix<double>(ns - nv, nv);
+			subrange(Lt, 0, nv, 0, nv) = iQ;
+			mat W = prod(inverse(Loo), Los);
+			Lt -= prod(trans(Los), W);
+
+			scatter(ia_s, Lt);
+			refreshInfoVector(ia_s);
+			++version_;
+			recover(ia_v);
+		}
+
+		/*
+		 * The new states are x_l = G_rs * x_rs + c + n, n ~ N(0,S), which adds the information
+		 * - [G_rs' ; -I] * inv(S) * [G_rs , -I] and [G_rs' ; -I] * inv(S) * (-c)
+		 */
+		void SparseInformationFilterIndirect::initializeWithNoise(const mat & G_rs, const ind_array & ia_rs, const ind_array & ia_l, const sym_mat & S)
+		{
+			addPrior(ia_rs);
+			clearRows(ia_l);
+			size_t nrs = ia_rs.size(), nl = ia_l.size();
+			mat S_f = S;
+			S_f += noiseFloor_ * identity_mat(nl);
+			mat iS = inverse(S_f);
+			mat GtiS = prod(trans(G_rs), iS);
+			vec c = project(x_, ia_l) - prod(G_rs, vec(project(x_, ia_rs)));
+
+			ind_array ia_a = ia_concat(ia_rs, ia_l);
+			mat La = gather(ia_a);
+			subrange(La, 0, nrs, 0, nrs) += prod(GtiS, G_rs);
+			subrange(La, 0, nrs, nrs, nrs+nl) -= GtiS;
+			subrange(La, nrs, nrs+nl, 0, nrs) -= trans(GtiS);
+			subrange(La, nrs, nrs+nl, nrs, nrs+nl) += iS;
+			scatter(ia_a, La);
+			project(eta_, ia_rs) -= prod(GtiS, c);
+			project(eta_, ia_l) = prod(iS, c);
+
+			for (size_t i = 0; i < nl; ++i) { known_[ia_l(i)] = true; element_[ia_l(i)] = ia_l(0); }
+			recover(ia_l);
+		}
+
+		void SparseInformationFilterIndirect::initialize(const ind_array & ia_x, const mat & G_v, const ind_array & ia_rs, const ind_array & ia_l, const mat & G_y, const sym_mat & R)
+		{
+			initializeWithNoise(G_v, ia_rs, ia_l, prod_JPJt(R, G_y));
+		}
+
+		void SparseInformationFilterIndirect::initialize(const ind_array & ia_x, const mat & G_v, const ind_array & ia_rs, const ind_array & ia_l, const mat & G_y, const sym_mat & R, const mat & G_n, const sym_mat & N)
+		{
+			sym_mat S = prod_JPJt(R, G_y);
+			S += prod_JPJt(N, G_n);
+			initializeWithNoise(G_v, ia_rs, ia_l, S);
+		}
+
+		void SparseInformationFilterIndirect::reparametrize(const ind_array & ia_x, const mat & J_l, const ind_array & ia_old, const ind_array & ia_new)
+		{
+			stackReparametrization(J_l, ia_old, ia_new);
+			reparametrizeAllStacked(ia_x);
+		}
+
+		/*
+		 * The new elements are x_new = J_l * x_old + n, n ~ N(0, noiseFloor), added as new variables.
+		 * The old states reused by the new elements are then marginalized out,
+		 * the others are kept, they are either shared with other landmarks or liberated afterwards.
+		 */
+		void SparseInformationFilterIndirect::reparametrizeAllStacked(const ind_array & ia_x)
+		{
+			if (reparStack.empty()) return;
+
+			// 1 the local problem: old states, their neighbours, new elements
+			ind_array ia_old(0), ia_new(0);
+			for(ReparametrizationList::iterator it = reparStack.begin(); it != reparStack.end(); ++it)
+			{
+				ia_old = ia_union(ia_old, it->ia_old);
+				ia_new = ia_concat(ia_new, it->ia_new);
+			}
+			addPrior(ia_old);
+			clearRows(ia_complement(ia_new, ia_old));
+			ind_array ia_ob = ia_concat(ia_old, neighbors(ia_old));
+			size_t nob = ia_ob.size(), nn = ia_new.size(), n = nob + nn;
+			mat Lloc(n, n); Lloc.clear();
+			subrange(Lloc, 0, nob, 0, nob) = gather(ia_ob);
+
+			// 2 the factors of the new elements
+			setLocal(ia_ob, true);
+			size_t col = nob;
+			for(ReparametrizationList::iterator it = reparStack.begin(); it != reparStack.end(); ++it)
+			{
+				ind_array pos_old(it->ia_old.size());
+				for (size_t i = 0; i < it->ia_old.size(); ++i) pos_old(i) = pos_[it->ia_old(i)];
+				ind_array pos_new = ia_set(col, col + it->ia_new.size());
+				mat JtiE = trans(it->J_l) / noiseFloor_;
+				project(Lloc, pos_old, pos_old) += prod(JtiE, it->J_l);
+				project(Lloc, pos_old, pos_new) -= JtiE;
+				project(Lloc, pos_new, pos_old) -= trans(JtiE);
+				project(Lloc, pos_new, pos_new) += identity_mat(it->ia_new.size()) / noiseFloor_;
+				col += it->ia_new.size();
+			}
+
+			// 3 marginalize out the reused old states
+			std::vector<size_t> reused, kept, kept_global;
+			for (size_t i = 0; i < nn; ++i) if (pos_[ia_new(i)] >= 0) reused.push_back(pos_[ia_new(i)]);
+			setLocal(ia_ob, false);
+			std::sort(reused.begin(), reused.end());
+			for (size_t i = 0; i < n; ++i)
+				if (!std::binary_search(reused.begin(), reused.end(), i))
+				{
+					kept.push_back(i);
+					kept_global.push_back(i < nob ? ia_ob(i) : ia_new(i - nob));
+				}
+			ind_array ia_k = ia_from(kept), ia_r = ia_from(reused);
+			mat Lk = project(Lloc, ia_k, ia_k);
+			if (reused.size() > 0)
+			{
+				mat Lkr = project(Lloc, ia_k, ia_r);
+				mat W = prod(inverse(project(Lloc, ia_r, ia_r)), trans(Lkr));
+				Lk -= prod(Lkr, W);
+			}
+
+			// 4 write, the means of the new elements are already set
+			ind_array ia_kg = ia_from(kept_global);
+			clearRows(ia_old);
+			scatter(ia_kg, Lk);
+			refreshInfoVector(ia_kg);
+			for(ReparametrizationList::iterator it = reparStack.begin(); it != reparStack.end(); ++it)
+				for (size_t i = 0; i < it->ia_new.size(); ++i) { known_[it->ia_new(i)] = true; element_[it->ia_new(i)] = it->ia_new(0); }
+			for(ReparametrizationList::iterator it = reparStack.begin(); it != reparStack.end(); ++it)
+				recover(it->ia_new);
+
+			reparStack.clear();
+		}
+
+		/*
+		 * With INN_rsl = -H, and the measurement noise R:
+		 * - L   <-- L + INN_rsl' * inv(R) * INN_rsl
+		 * - eta <-- eta + INN_rsl' * inv(R) * (INN_rsl * x_rsl - z)
+		 */
+		void SparseInformationFilterIndirect::addCorrection(Innovation & inn, const mat & INN_rsl, const ind_array & ia_rsl, const sym_mat & R)
+		{
+			addPrior(ia_rsl);
+			mat INNt_iR = prod(trans(INN_rsl), inverse(R));
+			mat Lrsl = gather(ia_rsl);
+			Lrsl += prod(INNt_iR, INN_rsl);
+			scatter(ia_rsl, Lrsl);
+			vec r = prod(INN_rsl, vec(project(x_, ia_rsl))) - inn.x();
+			project(eta_, ia_rsl) += prod(INNt_iR, r);
+		}
+
+		/*
+		 * The mean is solved on the corrected states, the robot and their neighbours,
+		 * so that the motion and the sparsification can use it.
+		 */
+		void SparseInformationFilterIndirect::finishCorrection(const ind_array & ia_inn)
+		{
+			relax();
+			ind_array ia_a = ia_union(ia_inn, ia_robot_);
+			ia_a = ia_union(ia_a, neighbors(ia_a));
+			solveLocal(ia_a);
+			sparsify();
+			++version_;
+			recover(ia_robot_);
+		}
+
+		void SparseInformationFilterIndirect::correct(const ind_array & ia_x, Innovation & inn, const mat & INN_rsl, const ind_array & ia_rsl, const sym_mat & R)
+		{
+			addCorrection(inn, INN_rsl, ia_rsl, R);
+			finishCorrection(ia_rsl);
+		}
+
+		void SparseInformationFilterIndirect::correctAllStacked(const ind_array & ia_x)
+		{
+			if (corrStack.stack.empty()) return;
+			ind_array ia_inn(0);
+			for(CorrectionList::iterator corrIter = corrStack.stack.begin(); corrIter != corrStack.stack.end(); ++corrIter)
+			{
+				addCorrection(corrIter->inn, corrIter->INN_rsl, corrIter->ia_rsl, corrIter->R);
+				ia_inn = ia_union(ia_inn, corrIter->ia_rsl);
+			}
+			finishCorrection(ia_inn);
+			corrStack.clear();
+		}
+
+		void SparseInformationFilterIndirect::liberate(const ind_array & ia)
+		{
+			std::vector<size_t> k;
+			for (size_t i = 0; i < ia.size(); ++i) if (known_[ia(i)]) k.push_back(ia(i));
+			if (!k.empty()) eliminate(ia_from(k));
+			releaseBlocks(ia);
+		}
+
+	}
+}
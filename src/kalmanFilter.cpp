@@ -19,17 +19,44 @@ namespace jafar {
 		using namespace jmath::ublasExtra;
 
 		ExtendedKalmanFilterIndirect::ExtendedKalmanFilterIndirect(size_t _size) :
-			size_(_size), x_(size_), P_(size_)
+			size_(_size), consider_(_size, false), nConsider_(0), estimateConsidered_(false), denseP_(true), x_(size_), P_(size_), version_(0)
 		{
 			x_.clear();
 			P_.clear();
 		}
 
+		ExtendedKalmanFilterIndirect::ExtendedKalmanFilterIndirect(size_t _size, bool _denseP) :
+			size_(_size), consider_(_size, false), nConsider_(0), estimateConsidered_(false), denseP_(_denseP), x_(size_), P_(denseP_ ? size_ : 0), version_(0)
+		{
+			x_.clear();
+			P_.clear();
+		}
+
+		void ExtendedKalmanFilterIndirect::grow(size_t _size)
+		{
+			if (_size <= size_) return;
+			vec x_new(_size);
+			x_new.clear();
+			ublas::subrange(x_new, 0, size_) = x_;
+			// swap the storage only, x_ and P_ objects are referenced by the remote Gaussians
+			x_.swap(x_new);
+			if (denseP_)
+			{
+				sym_mat P_new(_size);
+				P_new.clear();
+				ublas::subrange(P_new, 0, size_, 0, size_) = P_;
+				P_.swap(P_new);
+			}
+			consider_.resize(_size, false);
+			size_ = _size;
+		}
+
 		void ExtendedKalmanFilterIndirect::predict(const ind_array & ia_x, const mat & F_v, const ind_array & ia_v,
 		    const mat & F_u, const sym_mat & U)
 		{
 			ind_array ia_invariant = ublasExtra::ia_complement(ia_x, ia_v);
 			ixaxpy_prod(P_, ia_invariant, F_v, ia_v, ia_v, prod_JPJt(U, F_u));
+			++version_;
 		}
 
 		void ExtendedKalmanFilterIndirect::predict(const ind_array & ia_x, const mat & F_v, const ind_array & ia_v,
@@ -37,6 +64,38 @@ namespace jafar {
 		{
 			ind_array ia_inv = ublasExtra::ia_complement(ia_x, ia_v);
 			ixaxpy_prod(P_, ia_inv, F_v, ia_v, ia_v, Q);
+			++version_;
+		}
+
+		void ExtendedKalmanFilterIndirect::predict(const ind_array & ia_x, const mat & F_v, const BlockJacobian & F_blocks,
+		    const ind_array & ia_v, const sym_mat & Q)
+		{
+			if (F_blocks.empty()) { predict(ia_x, F_v, ia_v, Q); return; }
+			JFR_ASSERT(F_blocks.size() == ia_v.size(), "ExtendedKalmanFilterIndirect::predict: Jacobian structure size mismatch");
+			++version_;
+
+			ind_array ia_inv = ublasExtra::ia_complement(ia_x, ia_v);
+			size_t m = ia_inv.size();
+
+			// Pvv = F_v * Pvv * F_v' + Q, dense because it is small
+			sym_mat Pvv = ublas::project(P_, ia_v, ia_v);
+			ublas::project(P_, ia_v, ia_v) = ublasExtra::prod_JPJt(Pvv, F_v) + Q;
+			if (m == 0) return;
+
+			// Pvm = F_v * Pvm, only the non-zero blocks of the non-identity rows
+			mat PVM = ublas::project(P_, ia_v, ia_inv);
+			mat FPVM(ia_v.size(), m); FPVM.clear();
+			const BlockJacobian::BlockList & blocks = F_blocks.blocks();
+			for (BlockJacobian::BlockList::const_iterator it = blocks.begin(); it != blocks.end(); ++it)
+			{
+				ublas::matrix_range<mat> FPVM_b(FPVM, ublas::range(it->row, it->row + it->nrows), ublas::range(0, m));
+				if (it->identity)
+					FPVM_b += ublas::subrange(PVM, it->col, it->col + it->ncols, 0, m);
+				else
+					ublas::noalias(FPVM_b) += ublas::prod(ublas::subrange(F_v, it->row, it->row + it->nrows, it->col, it->col + it->ncols),
+					                                      ublas::subrange(PVM, it->col, it->col + it->ncols, 0, m));
+			}
+			ublas::project(P_, F_blocks.activeRows(ia_v), ia_inv) = ublas::project(FPVM, F_blocks.activeRows(), ia_set(0, m));
 		}
 
 		void ExtendedKalmanFilterIndirect::initialize(const ind_array & ia_x, const mat & G_v, const ind_array & ia_rs, const ind_array & ia_l, const mat & G_y, const sym_mat & R){
@@ -50,8 +109,9 @@ namespace jafar {
 		}
 
 		void ExtendedKalmanFilterIndirect::reparametrize(const ind_array & ia_x, const mat & J_l, const ind_array & ia_old, const ind_array & ia_new){
-			ind_array ia_invariant = ia_complement(ia_x, ia_union(ia_old,ia_new));
-			ixaxpy_prod(P_, ia_invariant, J_l, ia_old, ia_new);
+			// a stack of one, that keeps the cross-variances with the old states that are not reused (shared anchors)
+			stackReparametrization(J_l, ia_old, ia_new);
+			ExtendedKalmanFilterIndirect::reparametrizeAllStacked(ia_x);
 		}
 
 		void ExtendedKalmanFilterIndirect::computeKalmanGain(const ind_array & ia_x, Innovation & inn, const mat & INN_rsl, const ind_array & ia_rsl){
@@ -62,22 +122,88 @@ namespace jafar {
 			ublas::noalias(K) = - prod(PJt_tmp, inn.iP_);
 		}
 
-		void ExtendedKalmanFilterIndirect::correct(const ind_array & ia_x, Innovation & inn, const mat & INN_rsl, const ind_array & ia_rsl)
+		Gaussian ExtendedKalmanFilterIndirect::objectState(const ind_array & ia)
+		{
+			return Gaussian(x_, P_, ia);
+		}
+
+		void ExtendedKalmanFilterIndirect::correct(const ind_array & ia_x, Innovation & inn, const mat & INN_rsl, const ind_array & ia_rsl, const sym_mat & R)
 		{
 			// first the kalman gain
 			computeKalmanGain(ia_x, inn, INN_rsl, ia_rsl);
+			++version_;
 
 			// mean and covariances update:
+			if (considerUpdate(ia_x, inn.x())) return;
 			ublas::project(x_, ia_x) += prod(K, inn.x());
-			ublas::project(P_, ia_x, ia_x) += prod<sym_mat> (K, trans(PJt_tmp));
+			updateCovariance(ia_x);
 		}
 
+		sym_mat ExtendedKalmanFilterIndirect::marginal(const ind_array & ia)
+		{
+			recover(ia);
+			return ublas::project(P_, ia, ia);
+		}
+
+		void ExtendedKalmanFilterIndirect::setConsider(const ind_array & ia, bool consider)
+		{
+			for (size_t i = 0; i < ia.size(); ++i)
+			{
+				if (consider_[ia(i)] == consider) continue;
+				consider_[ia(i)] = consider;
+				if (consider) ++nConsider_; else --nConsider_;
+			}
+		}
+
+		ind_array ExtendedKalmanFilterIndirect::consideredStates() const
+		{
+			ind_array res(nConsider_);
+			for (size_t i = 0, j = 0; i < size_; ++i)
+				if (consider_[i]) res(j++) = i;
+			return res;
+		}
+
+		/*
+		 * With the gain K_c = 0 for the consider states c, and the optimal gain K_e for the estimated states e:
+		 * - x_e <-- x_e + K_e * z
+		 * - P_ee <-- P_ee + K_e * PJt_e'
+		 * - P_ec <-- P_ec + K_e * PJt_c'
+		 */
+		bool ExtendedKalmanFilterIndirect::considerUpdate(const ind_array & ia_x, const vec & z)
+		{
+			if (nConsider_ == 0 || estimateConsidered_) return false;
+			size_t nc = 0;
+			for (size_t i = 0; i < ia_x.size(); ++i) if (consider_[ia_x(i)]) ++nc;
+			if (nc == 0) return false;
+			size_t ne = ia_x.size() - nc;
+			ind_array ia_e(ne), ia_c(nc), pos_e(ne), pos_c(nc);
+			for (size_t i = 0, ie = 0, jc = 0; i < ia_x.size(); ++i)
+				if (consider_[ia_x(i)]) { ia_c(jc) = ia_x(i); pos_c(jc++) = i; }
+				else { ia_e(ie) = ia_x(i); pos_e(ie++) = i; }
+			ind_array ia_inn_cols = ia_set(0, K.size2());
+
+			for (size_t j = 0; j < nc; ++j) ublas::row(K, pos_c(j)) = ublas::zero_vector<double>(K.size2());
+			mat K_e = ublas::project(K, pos_e, ia_inn_cols);
+			mat PJt_e = ublas::project(PJt_tmp, pos_e, ia_inn_cols);
+			mat PJt_c = ublas::project(PJt_tmp, pos_c, ia_inn_cols);
+
+			ublas::project(x_, ia_e) += prod(K_e, z);
+			ublas::project(P_, ia_e, ia_e) += prod<sym_mat>(K_e, trans(PJt_e));
+			ublas::project(P_, ia_e, ia_c) += prod(K_e, trans(PJt_c));
+			return true;
+		}
+
+		void ExtendedKalmanFilterIndirect::updateCovariance(const ind_array & ia_x)
+		{
+			ublas::project(P_, ia_x, ia_x) += prod<sym_mat> (K, trans(PJt_tmp)); // noalias crashes
+		}
 
 
 
-		void ExtendedKalmanFilterIndirect::stackCorrection(Innovation & inn, const mat & INN_rsl, const ind_array & ia_rsl)
+
+		void ExtendedKalmanFilterIndirect::stackCorrection(Innovation & inn, const mat & INN_rsl, const ind_array & ia_rsl, const sym_mat & R)
 		{
-			corrStack.stack.push_back(StackedCorrection(inn, INN_rsl, ia_rsl));
+			corrStack.stack.push_back(StackedCorrection(inn, INN_rsl, ia_rsl, R));
 			corrStack.inn_size += inn.size();
 		}
 		
@@ -129,8 +255,10 @@ namespace jafar {
 // JFR_DEBUG("correctAllStacked: K " << K);
 // JFR_DEBUG("correctAllStacked: dx " << prod(K, stackedInnovation_x));
 			// 3 correct
+			++version_;
+			if (considerUpdate(ia_x, stackedInnovation_x)) { corrStack.clear(); return; }
 			ublas::noalias(ublas::project(x_, ia_x)) += prod(K, stackedInnovation_x);
-			ublas::project(P_, ia_x, ia_x) += prod<sym_mat>(K, trans(PJt_tmp)); // noalias crashes
+			updateCovariance(ia_x);
 			
 			corrStack.clear();
 		}
@@ -141,5 +269,56 @@ namespace jafar {
 		}
 
 
+		void ExtendedKalmanFilterIndirect::stackReparametrization(const mat & J_l, const ind_array & ia_old, const ind_array & ia_new)
+		{
+			reparStack.push_back(StackedReparametrization(J_l, ia_old, ia_new));
+		}
+
+		void ExtendedKalmanFilterIndirect::reparametrizeAllStacked(const ind_array & ia_x)
+		{
+			if (reparStack.empty()) return;
+
+			// 1 stack all old and new indices
+			size_t n_old = 0, n_new = 0;
+			for(ReparametrizationList::iterator it = reparStack.begin(); it != reparStack.end(); ++it)
+				{ n_old += it->ia_old.size(); n_new += it->ia_new.size(); }
+			ind_array ia_old(n_old), ia_new(n_new);
+			mat J(n_new, n_old); J.clear();
+			size_t row = 0, col = 0;
+			for(ReparametrizationList::iterator it = reparStack.begin(); it != reparStack.end(); ++it)
+			{
+				for (size_t i = 0; i < it->ia_old.size(); ++i) ia_old(col+i) = it->ia_old(i);
+				for (size_t i = 0; i < it->ia_new.size(); ++i) ia_new(row+i) = it->ia_new(i);
+				ublas::subrange(J, row, row + it->ia_new.size(), col, col + it->ia_old.size()) = it->J_l;
+				row += it->ia_new.size(); col += it->ia_old.size();
+			}
+			// the old states that are not reused stay in ia_inv: some of them may be shared with landmarks
+			// that are not reparametrized, and the others are liberated afterwards anyway
+			ind_array ia_inv = ia_complement(ia_x, ia_new);
+			size_t m = ia_inv.size();
+
+			// 2 read all old rows at once
+			mat P_old_inv = ublas::project(P_, ia_old, ia_inv);
+			sym_mat P_old_old = ublas::project(P_, ia_old, ia_old);
+
+			// 3 new cross-variances, block by block, and new covariances
+			mat P_new_inv(n_new, m);
+			row = 0; col = 0;
+			for(ReparametrizationList::iterator it = reparStack.begin(); it != reparStack.end(); ++it)
+			{
+				ublas::noalias(ublas::subrange(P_new_inv, row, row + it->ia_new.size(), 0, m)) =
+					ublas::prod(it->J_l, ublas::subrange(P_old_inv, col, col + it->ia_old.size(), 0, m));
+				row += it->ia_new.size(); col += it->ia_old.size();
+			}
+			sym_mat P_new_new = prod_JPJt(P_old_old, J);
+
+			// 4 write all new rows at once
+			ublas::project(P_, ia_new, ia_inv) = P_new_inv;
+			ublas::project(P_, ia_new, ia_new) = P_new_new;
+
+			reparStack.clear();
+		}
+
+
 	}
 }
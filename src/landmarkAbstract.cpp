@@ -44,7 +44,7 @@ namespace jafar {
 			category = LANDMARK;
 		}
 	  LandmarkAbstract::LandmarkAbstract(const map_ptr_t & _mapPtr, const landmark_ptr_t & _prevLmk, const size_t _size,jblas::ind_array & _icomp ) :
-	    MapObject(_mapPtr,*_prevLmk, _size, _icomp)
+	    MapObject(_mapPtr, _prevLmk->ownStates(), _size, _icomp)
 		{
 			category = LANDMARK;
 			descriptorPtr = _prevLmk->descriptorPtr;
@@ -57,6 +57,12 @@ namespace jafar {
 			category = LANDMARK;
 		}
 
+		LandmarkAbstract::LandmarkAbstract(const map_ptr_t & _mapPtr, const jblas::ind_array & _ia) :
+			MapObject(_mapPtr, _ia)
+		{
+			category = LANDMARK;
+		}
+
 		LandmarkAbstract::~LandmarkAbstract() {
 //			cout << "Deleted landmark: " << id() << ": " << typeName() << endl;
 		}
@@ -221,11 +227,17 @@ namespace jafar {
 		}
 
 
+		void LandmarkAbstract::liberateStates(const map_ptr_t & _mapPtr, const jblas::ind_array & _ia) {
+			_mapPtr->liberateStates(_ia);
+		}
+
+
 		void LandmarkAbstract::transferInfoLmk(landmark_ptr_t & lmkSourcePtr){
 
 			this->id(lmkSourcePtr->id());
 			this->name(lmkSourcePtr->name());
 			this->geomType = lmkSourcePtr->getGeomType();
+			this->reclaimedCounters = lmkSourcePtr->reclaimedCounters;
 
 		}
 #if 0
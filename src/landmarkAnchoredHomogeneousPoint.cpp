@@ -28,6 +28,14 @@ namespace jafar {
 			converged = false;
 		}
 
+		LandmarkAnchoredHomogeneousPoint::LandmarkAnchoredHomogeneousPoint(const map_ptr_t & mapPtr, const jblas::ind_array & _ia) :
+			LandmarkAbstract(mapPtr, _ia) {
+			JFR_ASSERT(_ia.size() == size(), "LandmarkAnchoredHomogeneousPoint: wrong state size");
+			geomType = POINT,
+			type = PNT_AH;
+			converged = false;
+		}
+
 		bool LandmarkAnchoredHomogeneousPoint::needToDie(){
 			double rho = state.x(6);
 			if (rho < 0)
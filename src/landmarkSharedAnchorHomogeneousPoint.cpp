@@ -0,0 +1,71 @@
+/**
+ * \file landmarkSharedAnchorHomogeneousPoint.cpp
+ * \date 17/10/2026
+ * \author jsola
+ * \ingroup rtslam
+ */
+
+#include "rtslam/landmarkSharedAnchorHomogeneousPoint.hpp"
+
+namespace jafar {
+	namespace rtslam {
+
+
+		SharedAnchor::SharedAnchor(const map_ptr_t & mapPtr) :
+			nUsers_(0), ia(mapPtr->reserveStates(3)), version(mapPtr->filterPtr->version())
+		{
+			JFR_ASSERT(ia.size() == 3, "SharedAnchor: no space in map");
+		}
+
+		void SharedAnchor::detach(const map_ptr_t & mapPtr)
+		{
+			JFR_ASSERT(nUsers_ > 0, "SharedAnchor: detached more than attached");
+			if (--nUsers_ == 0) mapPtr->liberateStates(ia);
+		}
+
+
+		/*
+		 * The shared anchor followed by the own states.
+		 */
+		jblas::ind_array LandmarkSharedAnchorHomogeneousPoint::reserveStates(const map_ptr_t & mapPtr, const shared_anchor_ptr_t & anchorPtr)
+		{
+			JFR_ASSERT(anchorPtr, "LandmarkSharedAnchorHomogeneousPoint: no anchor, the landmarks must be created by LandmarkFactorySharedAnchor");
+			jblas::ind_array ia_own = mapPtr->reserveStates(ownSize());
+			JFR_ASSERT(ia_own.size() == ownSize(), "LandmarkSharedAnchorHomogeneousPoint: no space in map");
+			jblas::ind_array res(size());
+			for (size_t i = 0; i < 3; ++i) res(i) = anchorPtr->ia(i);
+			for (size_t i = 0; i < ownSize(); ++i) res(3 + i) = ia_own(i);
+			return res;
+		}
+
+		LandmarkSharedAnchorHomogeneousPoint::LandmarkSharedAnchorHomogeneousPoint(const map_ptr_t & mapPtr, const shared_anchor_ptr_t & _anchorPtr) :
+			LandmarkAnchoredHomogeneousPoint(mapPtr, reserveStates(mapPtr, _anchorPtr)), anchorPtr(_anchorPtr)
+		{
+			initAnchor = (anchorPtr->nUsers() == 0);
+			anchorPtr->attach();
+		}
+
+		jblas::ind_array LandmarkSharedAnchorHomogeneousPoint::ownStates() const
+		{
+			jblas::ind_array res(ownSize());
+			for (size_t i = 0; i < ownSize(); ++i) res(i) = state.ia()(3 + i);
+			return res;
+		}
+
+		jblas::ind_array LandmarkSharedAnchorHomogeneousPoint::initStates() const
+		{
+			return jmath::ublasExtra::ia_set(initAnchor ? 0 : 3, size());
+		}
+
+		void LandmarkSharedAnchorHomogeneousPoint::liberateStates(const map_ptr_t & _mapPtr, const jblas::ind_array & _ia)
+		{
+			_mapPtr->liberateStates(_ia);
+			if (anchorPtr)
+			{
+				anchorPtr->detach(_mapPtr);
+				anchorPtr.reset();
+			}
+		}
+
+	} // namespace rtslam
+} // namespace jafar
@@ -0,0 +1,131 @@
+/*
+ * \file lkTracker.cpp
+ * \date 17/10/2026
+ * \author jsola
+ * \ingroup rtslam
+ */
+
+#include <cmath>
+#include <algorithm>
+
+#include "rtslam/lkTracker.hpp"
+
+
+namespace jafar {
+	namespace rtslam {
+		using namespace std;
+		using namespace image;
+
+		LkTracker::LkTracker(int maxIter, double minStep, double maxMotion):
+			m_maxIter(maxIter), m_minStep(minStep), m_maxMotion(maxMotion),
+			m_width(0), m_height(0), m_mean(0), m_std(0), m_iterations(0)
+		{
+			m_Hinv[0] = m_Hinv[1] = m_Hinv[2] = 0.;
+		}
+
+		bool LkTracker::setTemplate(const image::Image & patch)
+		{
+			m_width = patch.width();
+			m_height = patch.height();
+			if (m_width < 3 || m_height < 3) return false;
+
+			// the border pixels are only used for the derivatives [-1 0 1]
+			size_t n = (m_width-2) * (m_height-2);
+			m_tpl.resize(n); m_gx.resize(n); m_gy.resize(n);
+			double hxx = 0., hxy = 0., hyy = 0., sum = 0., sum2 = 0.;
+			int step = patch.step();
+			size_t k = 0;
+			for (int i = 1; i < m_height-1; ++i)
+			{
+				const unsigned char * pix = patch.data() + i * step + 1;
+				for (int j = 1; j < m_width-1; ++j, ++pix, ++k)
+				{
+					float gx = 0.5f * ((float)pix[1] - (float)pix[-1]);
+					float gy = 0.5f * ((float)pix[step] - (float)pix[-step]);
+					m_tpl[k] = pix[0]; m_gx[k] = gx; m_gy[k] = gy;
+					hxx += gx*gx; hxy += gx*gy; hyy += gy*gy;
+					sum += pix[0]; sum2 += (double)pix[0]*pix[0];
+				}
+			}
+			m_mean = sum / n;
+			m_std = sqrt(std::max(sum2 / n - m_mean*m_mean, 0.));
+
+			double trace = hxx + hyy;
+			double det = hxx*hyy - hxy*hxy;
+			if (m_std < 1e-3 || trace <= 0. || det <= 1e-9 * trace*trace) return false;
+			m_Hinv[0] = hyy / det; m_Hinv[1] = -hxy / det; m_Hinv[2] = hxx / det;
+			return true;
+		}
+
+		/*
+		 * Bilinear interpolation of the inner pixels of the patch at position x,y,
+		 * normalized to the mean and standard deviation of the patch.
+		 */
+		bool LkTracker::window(const image::Image & image, double x, double y, std::vector<float> & win) const
+		{
+			// position of the first inner pixel, in pixel index
+			double u0 = x - 0.5 - (m_width-1)/2 + 1;
+			double v0 = y - 0.5 - (m_height-1)/2 + 1;
+			int iu = (int)floor(u0), iv = (int)floor(v0);
+			if (iu < 0 || iv < 0 || iu + m_width-2 >= image.width() || iv + m_height-2 >= image.height()) return false;
+			float a = u0 - iu, b = v0 - iv;
+			float w00 = (1-a)*(1-b), w01 = a*(1-b), w10 = (1-a)*b, w11 = a*b;
+			int step = image.step();
+
+			win.resize(m_tpl.size());
+			double sum = 0., sum2 = 0.;
+			size_t k = 0;
+			for (int i = 0; i < m_height-2; ++i)
+			{
+				const unsigned char * pix = image.data() + (iv+i) * step + iu;
+				for (int j = 0; j < m_width-2; ++j, ++pix, ++k)
+				{
+					float val = w00*pix[0] + w01*pix[1] + w10*pix[step] + w11*pix[step+1];
+					win[k] = val; sum += val; sum2 += val*val;
+				}
+			}
+			double mean = sum / win.size();
+			double sigma = sqrt(std::max(sum2 / win.size() - mean*mean, 0.));
+			if (sigma < 1e-3) return false;
+			float gain = m_std / sigma, bias = m_mean - gain * mean;
+			for (k = 0; k < win.size(); ++k) win[k] = gain * win[k] + bias;
+			return true;
+		}
+
+		bool LkTracker::track(const image::Image & image, double & x, double & y, double & score, double cov[3]) const
+		{
+			if (m_tpl.empty()) return false;
+			std::vector<float> win;
+			double x0 = x, y0 = y;
+			bool converged = false;
+			for (m_iterations = 0; m_iterations < m_maxIter && !converged; ++m_iterations)
+			{
+				if (!window(image, x, y, win)) return false;
+				double bx = 0., by = 0.;
+				for (size_t k = 0; k < win.size(); ++k)
+				{
+					float e = win[k] - m_tpl[k];
+					bx += m_gx[k] * e; by += m_gy[k] * e;
+				}
+				// inverse composition of the translation step
+				double dx = m_Hinv[0]*bx + m_Hinv[1]*by;
+				double dy = m_Hinv[1]*bx + m_Hinv[2]*by;
+				x -= dx; y -= dy;
+				if ((x-x0)*(x-x0) + (y-y0)*(y-y0) > m_maxMotion*m_maxMotion) return false;
+				converged = (dx*dx + dy*dy < m_minStep*m_minStep);
+			}
+			if (!converged || !window(image, x, y, win)) return false;
+
+			double ssd = 0.;
+			for (size_t k = 0; k < win.size(); ++k)
+				ssd += (win[k] - m_tpl[k]) * (win[k] - m_tpl[k]);
+			// both are normalized to the same mean and variance, so ssd = 2 n var (1 - zncc)
+			size_t n = win.size();
+			score = 1. - ssd / (2. * n * m_std*m_std);
+			double var = ssd / (n - 2);
+			for (int i = 0; i < 3; ++i) cov[i] = var * m_Hinv[i];
+			return true;
+		}
+
+	}
+}
@@ -5,6 +5,9 @@
  * \ingroup rtslam
  */
 
+#include <algorithm>
+#include <vector>
+
 #include "jmath/indirectArray.hpp"
 #include <boost/shared_ptr.hpp>
 #include "jmath/random.hpp"
@@ -25,14 +28,16 @@ namespace jafar {
 		/**
 		 * Constructor
 		 */
-		MapAbstract::MapAbstract(size_t _max_size) :
-			state(7), max_size(_max_size), current_size(0), used_states(max_size) {
+		MapAbstract::MapAbstract(size_t _max_size, size_t _reserved_size) :
+			state(7), max_size(_max_size), current_size(0),
+			reserved_size(std::min(_max_size, _reserved_size ? _reserved_size : MAP_DEFAULT_RESERVED_SIZE)),
+			used_states(reserved_size) {
 			used_states.clear();
-			filterPtr.reset(new ExtendedKalmanFilterIndirect(_max_size));
+			filterPtr.reset(new ExtendedKalmanFilterIndirect(reserved_size));
 		}
 		MapAbstract::MapAbstract(const ekfInd_ptr_t & ekfPtr) :
 			state(7), filterPtr(ekfPtr), max_size(ekfPtr->size()), current_size(0),
-			    used_states(ekfPtr->size()) {
+			    reserved_size(ekfPtr->size()), used_states(ekfPtr->size()) {
 			used_states.clear();
 		}
 
@@ -49,8 +54,20 @@ namespace jafar {
 			return filterPtr->P(i, j);
 		}
 
+		void MapAbstract::reserve(const std::size_t _size) {
+			size_t new_size = std::min(_size, max_size);
+			if (new_size <= reserved_size) return;
+			filterPtr->grow(new_size);
+			used_states.resize(new_size, true);
+			for (size_t i = reserved_size; i < new_size; ++i)
+				used_states(i) = false;
+			reserved_size = new_size;
+		}
+
 		jblas::ind_array MapAbstract::reserveStates(const std::size_t N) {
 			if (unusedStates(N)) {
+				if (current_size + N > reserved_size)
+					reserve(std::max(current_size + N, 2 * reserved_size)); // geometric growth for amortized copy
 				jblas::ind_array res = jmath::ublasExtra::ia_pushfront(used_states, N);
 				current_size += N;
 				return res;
@@ -84,6 +101,13 @@ namespace jafar {
 		}
 
 		void MapAbstract::liberateStates(const jblas::ind_array & _ia) {
+			std::vector<size_t> used;
+			for (size_t i = 0; i < _ia.size(); i++)
+				if (used_states(_ia(i)) == true) used.push_back(_ia(i));
+			jblas::ind_array ia_used(used.size());
+			for (size_t i = 0; i < used.size(); i++) ia_used(i) = used[i];
+			filterPtr->liberate(ia_used);
+
 			for (size_t i = 0; i < _ia.size(); i++) {
 				int j = _ia(i);
 				if (used_states(j) == true) {
@@ -100,22 +124,22 @@ namespace jafar {
 		}
 
 		void MapAbstract::fillSeq() {
-			for (size_t i = 0; i < max_size; i++) {
+			for (size_t i = 0; i < reserved_size; i++) {
 				x(i) = i;
-				for (size_t j = 0; j < max_size; j++)
+				for (size_t j = 0; j < reserved_size; j++)
 					P(i, j) = i + 100 * j;
 			}
 		}
 
 		void MapAbstract::fillDiag() {
-			for (size_t i = 0; i < max_size; i++) {
+			for (size_t i = 0; i < reserved_size; i++) {
 				x(i) = i;
 				P(i, i) = 1;
 			}
 		}
 
 		void MapAbstract::fillDiagSeq() {
-			for (size_t i = 0; i < max_size; i++) {
+			for (size_t i = 0; i < reserved_size; i++) {
 				x(i) = i;
 				P(i, i) = i;
 			}
@@ -24,31 +24,68 @@ namespace jafar {
 	
 		observation_ptr_t MapManagerAbstract::createNewLandmark(data_manager_ptr_t dmaOrigin)
 		{
-			landmark_ptr_t newLmk = lmkFactory->createInit(mapPtr());
+			landmark_ptr_t newLmk = lmkFactory->createInit(mapPtr(), dmaOrigin->sensorPtr());
 			newLmk->setId();
 			newLmk->linkToParentMapManager(shared_from_this());
-			observation_ptr_t resObs;
 
-			for (MapManagerAbstract::DataManagerList::iterator
-			     iterDMA = dataManagerList().begin();
-			     iterDMA != dataManagerList().end(); ++iterDMA)
+			return createObservation(newLmk, dmaOrigin);
+		}
+
+		observation_ptr_t MapManagerAbstract::createObservation(landmark_ptr_t lmkPtr, data_manager_ptr_t dma)
+		{
+			observation_ptr_t newObs =
+			    dma->observationFactory()->create(dma->sensorPtr(), lmkPtr);
+
+			/* Insert the observation in the graph. */
+			newObs->linkToParentDataManager(dma);
+			newObs->linkToParentLandmark(lmkPtr);
+			newObs->linkToSensor(dma->sensorPtr());
+			newObs->linkToSensorSpecific(dma->sensorPtr());
+			newObs->setId();
+
+			/* Give back the counters of a previous observation by the same sensor. */
+			std::map<size_t, ObservationCounters>::iterator counters = lmkPtr->reclaimedCounters.find(dma->sensorPtr()->id());
+			if (counters != lmkPtr->reclaimedCounters.end())
 			{
-				data_manager_ptr_t dma = *iterDMA;
-				observation_ptr_t newObs =
-				    dma->observationFactory()->create(dma->sensorPtr(), newLmk);
-
-				/* Insert the observation in the graph. */
-				newObs->linkToParentDataManager(dma);
-				newObs->linkToParentLandmark(newLmk);
-				newObs->linkToSensor(dma->sensorPtr());
-				newObs->linkToSensorSpecific(dma->sensorPtr());
-				newObs->setId();
-
-				/* Store for the return the obs corresponding to the dma origin. */
-				if (dma == dmaOrigin) resObs = newObs;
+				newObs->counters = counters->second;
+				lmkPtr->reclaimedCounters.erase(counters);
+			}
+
+			return newObs;
+		}
+
+		void MapManagerAbstract::manageObservations(data_manager_ptr_t dma)
+		{
+			// reclaim the observations not visible for a long time
+			if (obsReclaimFrames > 0)
+			for (DataManagerAbstract::ObservationList::iterator
+			     obsIter = dma->observationList().begin();
+			     obsIter != dma->observationList().end(); )
+			{
+				observation_ptr_t obsPtr = *obsIter++;
+				if (obsPtr->counters.nFrameSinceLastVisible <= obsReclaimFrames) continue;
+				landmark_ptr_t lmkPtr = obsPtr->landmarkPtr();
+				if (lmkPtr->observationList().size() <= 1) continue;
+
+				lmkPtr->reclaimedCounters[dma->sensorPtr()->id()] = obsPtr->counters;
+				dma->unregisterChild(obsPtr);
+				lmkPtr->unregisterChild(obsPtr);
+			}
+
+			// create the observations of the landmarks becoming visible
+			for (LandmarkList::iterator lmkIter = landmarkList().begin(); lmkIter != landmarkList().end(); ++lmkIter)
+			{
+				landmark_ptr_t lmkPtr = *lmkIter;
+				bool observed = false;
+				for (LandmarkAbstract::ObservationList::iterator
+				     obsIter = lmkPtr->observationList().begin();
+				     obsIter != lmkPtr->observationList().end(); ++obsIter)
+					if ((*obsIter)->dataManagerPtr() == dma) { observed = true; break; }
+				if (observed) continue;
+
+				if (dma->predictVisibility(lmkPtr))
+					createObservation(lmkPtr, dma);
 			}
-			
-			return resObs;
 		}
 
 	  void MapManagerAbstract::unregisterLandmark(landmark_ptr_t lmkPtr, bool liberateFilter)
@@ -63,70 +100,94 @@ namespace jafar {
 			}
 			// liberate map space
 			if( liberateFilter )
-			  mapPtr()->liberateStates(lmkPtr->state.ia());
+			  lmkPtr->liberateStates(mapPtr(), lmkPtr->ownStates());
 			// now unlink landmark
 			ParentOf<LandmarkAbstract>::unregisterChild(lmkPtr);
+			landmarkUnregistered(lmkPtr);
 		}
 
 
 
     void MapManagerAbstract::reparametrizeLandmark(landmark_ptr_t lmkinit)
+		{
+			reparametrizeLandmarks(std::vector<landmark_ptr_t>(1, lmkinit));
+		}
+
+		void MapManagerAbstract::reparametrizeLandmarks(const std::vector<landmark_ptr_t> & lmksInit)
 		{
 			//cout<<__PRETTY_FUNCTION__<<"(#"<<__LINE__<<"): " <<"" << endl;
+			if (lmksInit.empty()) return;
+			std::vector<landmark_ptr_t> lmksConv(lmksInit.size());
+			std::vector<jblas::ind_array> idxComps(lmksInit.size());
 
-			// unregister lmk
-			unregisterLandmark(lmkinit, false);
-			//lmkinit->destroyDisplay(); // cannot do that here, display is using it...
-
-			// Create a new landmark advanced instead of the previous init lmk.
-			jblas::ind_array idxComp(lmkFactory->sizeComplement());
-			//cout << __PRETTY_FUNCTION__ << "about to create lmkcv." << endl;
-			landmark_ptr_t lmkconv = lmkFactory->createConverged(mapPtr(), lmkinit, idxComp);
-
-			// link new landmark
-			lmkconv->linkToParentMapManager(shared_from_this());
-
-			// Algebra: 2a. compute the jac and 2b. update the filter.
-			// a. Call reparametrize_func()
-			const size_t size_init = lmkinit->mySize();
-			const size_t size_conv = lmkconv->mySize();
-			mat CONV_init(size_conv, size_init);
-			vec sinit = lmkinit->state.x();
-			vec sconv(size_conv);
-			//cout << __PRETTY_FUNCTION__ << "about to call lmk->reparametrize_func()" << endl;
-			lmkinit->reparametrize_func(sinit, sconv, CONV_init);
-
-			// b. Call filter->reparametrize().
-			//cout << __PRETTY_FUNCTION__ << "about to call filter->reparametrize()" << endl;
-			lmkconv->state.x() = sconv;
-			mapPtr()->filterPtr->reparametrize(mapPtr()->ia_used_states(),
-				CONV_init, lmkinit->state.ia(), lmkconv->state.ia());
-
-			// Transfer info from the old lmk to the new one.
-			//cout << __PRETTY_FUNCTION__ << "about to transfer lmk info." << endl;
-			lmkconv->transferInfoLmk(lmkinit);
-
-			// Create the cv-lmk set of observations, one per sensor.
-			for(LandmarkAbstract::ObservationList::iterator
-			    obsIter = lmkinit->observationList().begin();
-			    obsIter != lmkinit->observationList().end(); ++obsIter)
+			for (size_t i = 0; i < lmksInit.size(); ++i)
 			{
-				observation_ptr_t obsinit = *obsIter;
-				data_manager_ptr_t dma = obsinit->dataManagerPtr();
-				sensor_ptr_t sen = obsinit->sensorPtr();
-
-				//cout << __PRETTY_FUNCTION__ << "about to create new obs" << endl;
-				observation_ptr_t obsconv = dma->observationFactory()->create(sen, lmkconv);
-				obsconv->linkToParentDataManager(dma);
-				obsconv->linkToParentLandmark(lmkconv);
-				obsconv->linkToSensor(sen);
-				obsconv->linkToSensorSpecific(sen);
-				// transfer info to new obs
-				obsconv->transferInfoObs(obsinit);
+				const landmark_ptr_t & lmkinit = lmksInit[i];
+
+				// unregister lmk
+				unregisterLandmark(lmkinit, false);
+				//lmkinit->destroyDisplay(); // cannot do that here, display is using it...
+
+				// Create a new landmark advanced instead of the previous init lmk.
+				// (the states shared with other landmarks, if any, are neither reused nor liberated here)
+				idxComps[i] = jblas::ind_array(lmkFactory->sizeComplement() - (lmkinit->mySize() - lmkinit->ownStates().size()));
+				//cout << __PRETTY_FUNCTION__ << "about to create lmkcv." << endl;
+				landmark_ptr_t lmkconv = lmkFactory->createConverged(mapPtr(), lmkinit, idxComps[i]);
+				lmksConv[i] = lmkconv;
+
+				// link new landmark
+				lmkconv->linkToParentMapManager(shared_from_this());
+
+				// Algebra: 2a. compute the jac and 2b. stack the filter update.
+				// a. Call reparametrize_func()
+				const size_t size_init = lmkinit->mySize();
+				const size_t size_conv = lmkconv->mySize();
+				mat CONV_init(size_conv, size_init);
+				vec sinit = lmkinit->state.x();
+				vec sconv(size_conv);
+				//cout << __PRETTY_FUNCTION__ << "about to call lmk->reparametrize_func()" << endl;
+				lmkinit->reparametrize_func(sinit, sconv, CONV_init);
+
+				// b. Stack filter->reparametrize().
+				lmkconv->state.x() = sconv;
+				mapPtr()->filterPtr->stackReparametrization(CONV_init, lmkinit->state.ia(), lmkconv->state.ia());
 			}
 
-			// liberate unused map space.
-			mapPtr()->liberateStates(idxComp);
+			// Update the filter for all landmarks together.
+			//cout << __PRETTY_FUNCTION__ << "about to call filter->reparametrizeAllStacked()" << endl;
+			mapPtr()->filterPtr->reparametrizeAllStacked(mapPtr()->ia_used_states());
+
+			for (size_t i = 0; i < lmksInit.size(); ++i)
+			{
+				const landmark_ptr_t & lmkinit = lmksInit[i];
+				const landmark_ptr_t & lmkconv = lmksConv[i];
+
+				// Transfer info from the old lmk to the new one.
+				//cout << __PRETTY_FUNCTION__ << "about to transfer lmk info." << endl;
+				lmkconv->transferInfoLmk(lmkinit);
+
+				// Create the cv-lmk set of observations, one per sensor.
+				for(LandmarkAbstract::ObservationList::iterator
+				    obsIter = lmkinit->observationList().begin();
+				    obsIter != lmkinit->observationList().end(); ++obsIter)
+				{
+					observation_ptr_t obsinit = *obsIter;
+					data_manager_ptr_t dma = obsinit->dataManagerPtr();
+					sensor_ptr_t sen = obsinit->sensorPtr();
+
+					//cout << __PRETTY_FUNCTION__ << "about to create new obs" << endl;
+					observation_ptr_t obsconv = dma->observationFactory()->create(sen, lmkconv);
+					obsconv->linkToParentDataManager(dma);
+					obsconv->linkToParentLandmark(lmkconv);
+					obsconv->linkToSensor(sen);
+					obsconv->linkToSensorSpecific(sen);
+					// transfer info to new obs
+					obsconv->transferInfoObs(obsinit);
+				}
+
+				// liberate unused map space.
+				lmkinit->liberateStates(mapPtr(), idxComps[i]);
+			}
 		}
 		
 		
@@ -170,6 +231,7 @@ namespace jafar {
 		
 		void MapManager::manageReparametrization()
 		{
+			std::vector<landmark_ptr_t> lmksToReparametrize;
 			for(LandmarkList::iterator lmkIter = landmarkList().begin();
 					 lmkIter != landmarkList().end(); ++lmkIter)
 			{
@@ -189,8 +251,10 @@ namespace jafar {
 					}
 				}
 				if (hasObserved && needToReparametrize)
-					lmkIter = reparametrizeLandmark(lmkIter);
+					lmksToReparametrize.push_back(lmkPtr);
 			}
+			// all landmarks converging in the same frame are reparametrized in one pass
+			reparametrizeLandmarks(lmksToReparametrize);
 		}
 
 		
@@ -264,14 +328,61 @@ namespace jafar {
 					lmkIter = unregisterLandmark(lmkIter);
 				}
 			}
+
+			// update the utilities, the deleted and reparametrized landmarks are removed by landmarkUnregistered()
+			if (evictUtilityTh <= 0.) return;
+			for(MapManagerAbstract::LandmarkList::iterator lmkIter = this->landmarkList().begin();
+					 lmkIter != this->landmarkList().end(); ++lmkIter)
+			{
+				utilities.update((*lmkIter)->id(), utility(*lmkIter));
+				utilityLandmarks[(*lmkIter)->id()] = *lmkIter;
+			}
+		}
+
+		void MapManagerGlobal::landmarkUnregistered(const landmark_ptr_t & lmkPtr)
+		{
+			utilities.remove(lmkPtr->id());
+			utilityLandmarks.erase(lmkPtr->id());
 		}
 		
-		 bool MapManagerGlobal::mapSpaceForInit()
+		double MapManagerGlobal::utility(const landmark_ptr_t & lmkPtr)
+		{
+			double res = 0.;
+			for(LandmarkAbstract::ObservationList::iterator obsIter = lmkPtr->observationList().begin();
+					obsIter != lmkPtr->observationList().end(); ++obsIter)
+			{
+				const ObservationCounters & counters = (*obsIter)->counters;
+				double reliability = (counters.nInlier + 1.) / (counters.nSearch + 2.);
+				double recency = 1. / (1. + counters.nSearchSinceLastInlier);
+				double information = log(2. + counters.nInlier);
+				res = std::max(res, reliability * recency * information);
+			}
+			if (evictDistRef > 0. && lmkPtr->reparamSize() == 3 && lmkPtr->observationList().size() > 0)
+			{
+				vec p = lmkPtr->reparametrize_func(lmkPtr->state.x());
+				vec7 senPose = lmkPtr->observationList().front()->sensorPtr()->globalPose();
+				double dist = ublas::norm_2(p - ublas::subrange(senPose, 0, 3));
+				res /= 1. + dist / evictDistRef;
+			}
+			return res;
+		}
+
+		/*
+		 * The need is evaluated again after each deletion: a landmark sharing states only gives back its own ones,
+		 * and the deletion of the last user of an anchor makes the new landmark need a new anchor.
+		 */
+		bool MapManagerGlobal::makeSpaceForInit(const sensor_ptr_t & senPtr)
 		{
-			if (!MapManager::mapSpaceForInit())
+			while (!mapSpaceForInit(senPtr))
 			{
-				// TODO delete some landmarks
-				return false;
+				if (evictUtilityTh <= 0. || utilities.empty() || utilities.topScore() >= evictUtilityTh) return false;
+				size_t id = utilities.topKey();
+				std::map<size_t, landmark_ptr_t>::iterator it = utilityLandmarks.find(id);
+				if (it == utilityLandmarks.end()) { utilities.pop(); continue; }
+				landmark_ptr_t lmkPtr = it->second;
+				JFR_DEBUG( "Lmk " << id << " Killed to make room for a new one");
+				unregisterLandmark(lmkPtr);
+				nEvicted++;
 			}
 			return true;
 		}
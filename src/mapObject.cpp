@@ -31,15 +31,21 @@ namespace jafar {
 		 */
 		MapObject::MapObject(const map_ptr_t & _mapPtr, const size_t _size, const filtered_obj_t inFilter) :
 			ObjectAbstract(),
-			state(inFilter == FILTERED ? Gaussian(_mapPtr->x(), _mapPtr->P(), _mapPtr->reserveStates(_size)) : _size)
+			state(inFilter == FILTERED ? _mapPtr->filterPtr->objectState(_mapPtr->reserveStates(_size)) : Gaussian(_size))
 		{
 				category = MAPPABLE_OBJECT;
 		}
 
-		MapObject::MapObject(const map_ptr_t & _mapPtr, const MapObject & prevObj, const size_t _size, jblas::ind_array & _icomp) :
+		MapObject::MapObject(const map_ptr_t & _mapPtr, const jblas::ind_array & _ia) :
 			ObjectAbstract(),
-			state( Gaussian(_mapPtr->x(), _mapPtr->P(),
-					_mapPtr->convertStates(prevObj.state.ia(),_size,_icomp)) )
+			state(_mapPtr->filterPtr->objectState(_ia))
+		{
+				category = MAPPABLE_OBJECT;
+		}
+
+		MapObject::MapObject(const map_ptr_t & _mapPtr, const jblas::ind_array & prevIa, const size_t _size, jblas::ind_array & _icomp) :
+			ObjectAbstract(),
+			state(_mapPtr->filterPtr->objectState(_mapPtr->convertStates(prevIa,_size,_icomp)))
 		{
 				category = MAPPABLE_OBJECT;
 		}
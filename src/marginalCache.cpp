@@ -0,0 +1,107 @@
+/**
+ * \file marginalCache.cpp
+ * \date 17/10/2026
+ * \author croussil
+ * \ingroup rtslam
+ */
+
+#include "jmath/ublasExtra.hpp"
+
+#include "rtslam/marginalCache.hpp"
+#include "rtslam/mapAbstract.hpp"
+#include "rtslam/mapManager.hpp"
+#include "rtslam/robotAbstract.hpp"
+#include "rtslam/landmarkAbstract.hpp"
+
+namespace jafar {
+	namespace rtslam {
+		using namespace std;
+
+		static bool sameStates(const jblas::ind_array & ia1, const jblas::ind_array & ia2)
+		{
+			if (ia1.size() != ia2.size()) return false;
+			for (size_t i = 0; i < ia1.size(); ++i) if (ia1(i) != ia2(i)) return false;
+			return true;
+		}
+
+		const MarginalCache::Block * MarginalCache::Snapshot::block(const jblas::ind_array & ia) const
+		{
+			if (ia.size() == 0) return NULL;
+			std::map<size_t, block_ptr_t>::const_iterator it = blocks.find(ia(0));
+			if (it == blocks.end() || !sameStates(it->second->ia, ia)) return NULL;
+			return it->second.get();
+		}
+
+		const jblas::mat * MarginalCache::Snapshot::cross(const jblas::ind_array & ia_rob, const jblas::ind_array & ia_lmk) const
+		{
+			if (ia_rob.size() == 0 || ia_lmk.size() == 0) return NULL;
+			std::map<std::pair<size_t, size_t>, jblas::mat>::const_iterator it = crossBlocks.find(std::make_pair(ia_rob(0), ia_lmk(0)));
+			if (it == crossBlocks.end() || it->second.size1() != ia_rob.size() || it->second.size2() != ia_lmk.size()) return NULL;
+			return &it->second;
+		}
+
+		/*
+		 * The block of the previous snapshot is reused if the estimate did not change since,
+		 * and if it is the same object: landmarks can be created or reparametrized without changing the version.
+		 */
+		MarginalCache::block_ptr_t MarginalCache::makeBlock(MapAbstract & map, const jblas::ind_array & ia, const Snapshot * previous)
+		{
+			if (previous && previous->version == map.filterPtr->version())
+			{
+				const Block * block = previous->block(ia);
+				if (block && ublas::norm_inf(block->x - ublas::project(map.x(), ia)) == 0.)
+					return previous->blocks.find(ia(0))->second;
+			}
+			boost::shared_ptr<Block> block(new Block());
+			block->ia = ia;
+			block->x = ublas::project(map.x(), ia);
+			block->P = map.filterPtr->marginal(ia);
+			return block;
+		}
+
+		void MarginalCache::update(MapAbstract & map, bool landmarks)
+		{
+			snapshot_ptr_t previous = snapshot();
+			boost::shared_ptr<Snapshot> snap(new Snapshot());
+			snap->version = map.filterPtr->version();
+
+			for (MapAbstract::RobotList::iterator robIter = map.robotList().begin(); robIter != map.robotList().end(); ++robIter)
+				snap->blocks[(*robIter)->state.ia()(0)] = makeBlock(map, (*robIter)->state.ia(), previous.get());
+
+			if (landmarks)
+				for (MapAbstract::MapManagerList::iterator mmIter = map.mapManagerList().begin(); mmIter != map.mapManagerList().end(); ++mmIter)
+					for (MapManagerAbstract::LandmarkList::iterator lmkIter = (*mmIter)->landmarkList().begin();
+					     lmkIter != (*mmIter)->landmarkList().end(); ++lmkIter)
+					{
+						const jblas::ind_array & ia_lmk = (*lmkIter)->state.ia();
+						snap->blocks[ia_lmk(0)] = makeBlock(map, ia_lmk, previous.get());
+						if (!crossTerms) continue;
+						for (MapAbstract::RobotList::iterator robIter = map.robotList().begin(); robIter != map.robotList().end(); ++robIter)
+						{
+							const jblas::ind_array & ia_rob = (*robIter)->state.ia();
+							size_t nr = ia_rob.size(), nl = ia_lmk.size();
+							jblas::ind_array ia_rl(nr + nl);
+							for (size_t i = 0; i < nr; ++i) ia_rl(i) = ia_rob(i);
+							for (size_t i = 0; i < nl; ++i) ia_rl(nr + i) = ia_lmk(i);
+							map.filterPtr->recover(ia_rl);
+							jblas::sym_mat P_rl = map.filterPtr->marginal(ia_rl);
+							snap->crossBlocks[std::make_pair(ia_rob(0), ia_lmk(0))] = ublas::subrange(P_rl, 0, nr, nr, nr + nl);
+						}
+					}
+
+			boost::unique_lock<boost::mutex> l(mutex_snapshot);
+			snapshot_ = snap;
+		}
+
+		bool MarginalCache::get(const jblas::ind_array & ia, jblas::vec & x, jblas::sym_mat & P) const
+		{
+			snapshot_ptr_t snap = snapshot();
+			const Block * block = (snap ? snap->block(ia) : NULL);
+			if (!block) return false;
+			x = block->x;
+			P = block->P;
+			return true;
+		}
+
+	}
+}
@@ -0,0 +1,71 @@
+/**
+ * \file objectPool.cpp
+ * \date 17/10/2026
+ * \author jsola
+ * \ingroup rtslam
+ */
+
+#include <map>
+#include <algorithm>
+
+#include "rtslam/objectPool.hpp"
+
+namespace jafar {
+	namespace rtslam {
+
+
+		BlockPool::BlockPool(size_t blockSize, size_t blocksPerChunk) :
+			blockSize_((blockSize + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT), blocksPerChunk_(blocksPerChunk)
+		{
+		}
+
+		BlockPool::~BlockPool()
+		{
+			for (size_t i = 0; i < chunks_.size(); ++i)
+				::operator delete(chunks_[i]);
+		}
+
+		/*
+		 * Allocate a new chunk, twice as large as the previous one, and cut it in free blocks.
+		 */
+		void BlockPool::grow()
+		{
+			size_t nBlocks = blocksPerChunk_ << std::min(chunks_.size(), (size_t)10);
+			char * chunk = static_cast<char*>(::operator new(nBlocks * blockSize_));
+			chunks_.push_back(chunk);
+			freeBlocks_.reserve(freeBlocks_.size() + nBlocks);
+			for (size_t i = nBlocks; i > 0; --i)
+				freeBlocks_.push_back(chunk + (i - 1) * blockSize_);
+		}
+
+		void * BlockPool::allocate()
+		{
+			boost::mutex::scoped_lock lock(mutex_);
+			if (freeBlocks_.empty()) grow();
+			void * p = freeBlocks_.back();
+			freeBlocks_.pop_back();
+			return p;
+		}
+
+		void BlockPool::deallocate(void * p)
+		{
+			boost::mutex::scoped_lock lock(mutex_);
+			freeBlocks_.push_back(p);
+		}
+
+		BlockPool & BlockPool::forSize(size_t size)
+		{
+			// the pools are never destroyed, because blocks can be given back by static objects destroyed after them
+			static std::map<size_t, BlockPool*> * pools = new std::map<size_t, BlockPool*>();
+			static boost::mutex poolsMutex;
+
+			size_t blockSize = (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+			boost::mutex::scoped_lock lock(poolsMutex);
+			BlockPool * & pool = (*pools)[blockSize];
+			if (pool == NULL) pool = new BlockPool(blockSize);
+			return *pool;
+		}
+
+
+	}
+}
@@ -5,6 +5,9 @@
  * \ingroup rtslam
  */
 
+#include <limits>
+#include <algorithm>
+
 #include "kernel/jafarDebug.hpp"
 
 #include "rtslam/observationAbstract.hpp"
@@ -144,7 +147,8 @@ namespace jafar {
 			// x+ = f(x, u, n) :
 			expectation.x() = exp;
 			// P+ = F_x * P * F_x' + F_n * Q * F_n' :
-         expectation.P() = ublasExtra::prod_JPJt(ublas::project(landmarkPtr()->mapManagerPtr()->mapPtr()->filterPtr->P(), ia_rsl, ia_rsl), EXP_rsl);
+			landmarkPtr()->mapManagerPtr()->mapPtr()->filterPtr->recover(ia_rsl);
+         expectation.P() = ublasExtra::prod_JPJt(landmarkPtr()->mapManagerPtr()->mapPtr()->filterPtr->marginal(ia_rsl), EXP_rsl);
 //         JFR_DEBUG("EXP_rsl \n" << EXP_rsl);
 //         JFR_DEBUG("ia_rsl \n" << ia_rsl);
 //         JFR_DEBUG("proj \n" << ublas::project(landmarkPtr()->mapManagerPtr()->mapPtr()->filterPtr->P(), ia_rsl, ia_rsl));
@@ -168,7 +172,7 @@ namespace jafar {
 			expectation.nonObs = nobs;
 		}
 
-		void ObservationAbstract::backProject(){
+		bool ObservationAbstract::backProject(){
 			vec7 sg;
 
 			// Get global sensor pose
@@ -178,23 +182,114 @@ namespace jafar {
 			vec pix = measurement.x();
 			vec invDist = prior.x();
 			vec lmk(landmarkPtr()->mySize());
-			model->backProject_func(sg, pix, invDist, lmk, LMK_sg, LMK_meas, LMK_prior);
+			if (!model->backProject_func(sg, pix, invDist, lmk, LMK_sg, LMK_meas, LMK_prior)) return false;
 
 			landmarkPtr()->state.x(lmk);
 
 			LMK_rs = ublas::prod(LMK_sg, SG_rs);
 
 			// Initialize in map
-			landmarkPtr()->mapManagerPtr()->mapPtr()->filterPtr
-			  ->initialize(
-				       landmarkPtr()->mapManagerPtr()->mapPtr()->ia_used_states(),
-					LMK_rs,
-					sensorPtr()->ia_globalPose,
-					landmarkPtr()->state.ia(),
-					LMK_meas,
-					measurement.P(),
-					LMK_prior,
-					prior.P());
+			ind_array ia_init = landmarkPtr()->initStates();
+			if (ia_init.size() == lmk.size())
+			{
+				landmarkPtr()->mapManagerPtr()->mapPtr()->filterPtr
+				  ->initialize(
+					       landmarkPtr()->mapManagerPtr()->mapPtr()->ia_used_states(),
+						LMK_rs,
+						sensorPtr()->ia_globalPose,
+						landmarkPtr()->state.ia(),
+						LMK_meas,
+						measurement.P(),
+						LMK_prior,
+						prior.P());
+			}
+			else
+			{
+				// the shared states are already initialized, from the same estimate of the sensor pose,
+				// so the cross-variances of the new states with them follow from the ones with the sensor pose
+				mat NEW_rs = ublas::project(LMK_rs, ia_init, ublasExtra::ia_set(0, LMK_rs.size2()));
+				mat NEW_meas = ublas::project(LMK_meas, ia_init, ublasExtra::ia_set(0, LMK_meas.size2()));
+				mat NEW_prior = ublas::project(LMK_prior, ia_init, ublasExtra::ia_set(0, LMK_prior.size2()));
+				landmarkPtr()->mapManagerPtr()->mapPtr()->filterPtr
+				  ->initialize(
+					       landmarkPtr()->mapManagerPtr()->mapPtr()->ia_used_states(),
+						NEW_rs,
+						sensorPtr()->ia_globalPose,
+						landmarkPtr()->state.ia().compose(ia_init),
+						NEW_meas,
+						measurement.P(),
+						NEW_prior,
+						prior.P());
+			}
+			return true;
+		}
+
+		/*
+		 * Reprojection error in the other view of the point at inverse distance invDist on the ray of meas.
+		 */
+		static double rayReprojectionError(ObservationModelAbstract & model, size_t lmkSize, const vec7 & sg, const vec & meas,
+		                                   const vec7 & sgOther, const vec & measOther, double invDist, vec & exp)
+		{
+			vec nobs(1), nobsOther(1);
+			vec lmk(lmkSize);
+			nobs(0) = invDist;
+			if (!model.backProject_func(sg, meas, nobs, lmk)) return std::numeric_limits<double>::max();
+			model.project_func(sgOther, lmk, exp, nobsOther);
+			if (!(nobsOther(0) > 0.0)) return std::numeric_limits<double>::max(); // behind the other sensor
+			return ublas::norm_2(exp - measOther);
+		}
+
+		bool ObservationAbstract::triangulatePrior(const vec7 & sgOther, const vec & measOther, double & error)
+		{
+			error = -1.0;
+			if (prior.size() != 1) return false;
+
+			vec7 sg = sensorPtr()->globalPose();
+			vec meas = measurement.x();
+			size_t lmkSize = landmarkPtr()->mySize();
+			double stdPrior = sqrt(prior.P(0,0));
+			double invDistMax = prior.x(0) + 3.0 * stdPrior;
+			vec exp;
+
+			// coarse search along the ray, from infinity to the closest point of the prior
+			const size_t nSamples = 64;
+			double step = invDistMax / nSamples;
+			double best = 0.0;
+			error = std::numeric_limits<double>::max();
+			for (size_t i = 0; i <= nSamples; ++i)
+			{
+				double e = rayReprojectionError(*model, lmkSize, sg, meas, sgOther, measOther, i * step, exp);
+				if (e < error) { error = e; best = i * step; }
+			}
+			if (error == std::numeric_limits<double>::max()) { error = -1.0; return false; }
+
+			// golden section refinement between the neighbour samples
+			const double gr = (sqrt(5.0) - 1.0) / 2.0;
+			double a = std::max(0.0, best - step), b = best + step;
+			double c = b - gr * (b - a), d = a + gr * (b - a);
+			double ec = rayReprojectionError(*model, lmkSize, sg, meas, sgOther, measOther, c, exp);
+			double ed = rayReprojectionError(*model, lmkSize, sg, meas, sgOther, measOther, d, exp);
+			for (int i = 0; i < 30; ++i)
+			{
+				if (ec < ed) { b = d; d = c; ed = ec; c = b - gr * (b - a); ec = rayReprojectionError(*model, lmkSize, sg, meas, sgOther, measOther, c, exp); }
+				        else { a = c; c = d; ec = ed; d = a + gr * (b - a); ed = rayReprojectionError(*model, lmkSize, sg, meas, sgOther, measOther, d, exp); }
+			}
+			if (std::min(ec, ed) < error) { error = std::min(ec, ed); best = (ec < ed ? c : d); }
+
+			// uncertainty of the inverse distance from the sensitivity of the reprojection, for both measurements noises
+			double h = 0.01 * step;
+			double lo = std::max(0.0, best - h), hi = best + h;
+			vec expLo, expHi;
+			if (rayReprojectionError(*model, lmkSize, sg, meas, sgOther, measOther, lo, expLo) == std::numeric_limits<double>::max() ||
+			    rayReprojectionError(*model, lmkSize, sg, meas, sgOther, measOther, hi, expHi) == std::numeric_limits<double>::max())
+				return false;
+			double sensitivity = ublas::norm_2(expHi - expLo) / (hi - lo);
+			double stdMeas = sqrt(measurement.P(0,0));
+			if (sensitivity * stdPrior <= sqrt(2.0) * stdMeas) return false; // not enough parallax
+
+			prior.x(0) = best;
+			prior.P(0,0) = 2.0 * jmath::sqr(stdMeas / sensitivity);
+			return true;
 		}
 
 		void ObservationAbstract::computeInnovation() {
@@ -244,7 +339,7 @@ namespace jafar {
 		void ObservationAbstract::update() {
 			map_ptr_t mapPtr = sensorPtr()->robotPtr()->mapPtr();
 			ind_array ia_x = mapPtr->ia_used_states();
-			mapPtr->filterPtr->correct(ia_x,innovation,INN_rsl,ia_rsl) ;
+			mapPtr->filterPtr->correct(ia_x,innovation,INN_rsl,ia_rsl,measurement.P()) ;
 		}
 #if 0
 		bool ObservationAbstract::voteForKillingLandmark(){
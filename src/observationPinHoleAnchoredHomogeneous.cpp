@@ -93,16 +93,17 @@ namespace jafar {
 			EXP_lmk = prod(EXP_v, V_lmk);
 		}
 
-		void ObservationModelPinHoleAnchoredHomogeneousPoint::backProject_func(
+		bool ObservationModelPinHoleAnchoredHomogeneousPoint::backProject_func(
 		    const vec7 & sg, const vec & pix, const vec & invDist, vec & ahp) {
 			// OK JS 12/6/2010
 			vec3 v;
-			v = pinhole::backprojectPoint(pinHolePtr()->params.intrinsic, pinHolePtr()->params.correction, pix, (double)1.0);
+			if (!pinHolePtr()->params.backprojectPoint(pix, v, (double)1.0)) return false;
 			ublasExtra::normalize(v);
 			ahp = lmkAHP::fromBearingOnlyFrame(sg, v, invDist(0));
+			return true;
 		}
 
-		void ObservationModelPinHoleAnchoredHomogeneousPoint::backProject_func(
+		bool ObservationModelPinHoleAnchoredHomogeneousPoint::backProject_func(
 		    const vec7 & sg, const vec & pix, const vec & invDist, vec & ahp,
 		    mat & AHP_sg, mat & AHP_pix, mat & AHP_invDist) {
 			// OK JS 12/6/2010
@@ -114,8 +115,7 @@ namespace jafar {
 			mat V_1(3, 1);
 			mat VN_v(3,3), VN_pix(3,2);
 
-			pinhole::backProjectPoint(pinHolePtr()->params.intrinsic, pinHolePtr()->params.correction, pix, 1.0,
-			                          v, V_pix, V_1);
+			if (!pinHolePtr()->params.backProjectPoint(pix, 1.0, v, V_pix, V_1)) return false;
 
 			vn = v;
 			ublasExtra::normalize(vn);
@@ -127,7 +127,7 @@ namespace jafar {
 			// Here we apply the chain rule for composing Jacobians
 			VN_pix = prod(VN_v, V_pix);
 			AHP_pix = prod(AHP_vn, VN_pix);
-
+			return true;
 		}
 
 		bool ObservationModelPinHoleAnchoredHomogeneousPoint::predictVisibility_func(jblas::vec x, jblas::vec nobs)
@@ -117,18 +117,19 @@ namespace jafar {
          EXP_lmk = prod(EXP_v, V_lmk);
       }
 
-      void ObservationModelPinHoleAnchoredHomogeneousPointsLine::backProject_func(
+      bool ObservationModelPinHoleAnchoredHomogeneousPointsLine::backProject_func(
           const vec7 & sg, const vec & pix, const vec & invDist, vec & ahpl) {
          vec3 v1;
          vec3 v2;
-         v1 = pinhole::backprojectPoint(pinHolePtr()->params.intrinsic, pinHolePtr()->params.correction, subrange(pix,0,2), (double)1.0);
+         if (!pinHolePtr()->params.backprojectPoint(subrange(pix,0,2), v1, (double)1.0)) return false;
          ublasExtra::normalize(v1);
-         v2 = pinhole::backprojectPoint(pinHolePtr()->params.intrinsic, pinHolePtr()->params.correction, subrange(pix,2,4), (double)1.0);
+         if (!pinHolePtr()->params.backprojectPoint(subrange(pix,2,4), v2, (double)1.0)) return false;
          ublasExtra::normalize(v2);
          ahpl = lmkAHPL::fromBearingOnlyFrame(sg, v1, v2, invDist(0), invDist(1));
+         return true;
       }
 
-      void ObservationModelPinHoleAnchoredHomogeneousPointsLine::backProject_func(
+      bool ObservationModelPinHoleAnchoredHomogeneousPointsLine::backProject_func(
           const vec7 & sg, const vec & pix, const vec & invDist, vec & ahpl,
           mat & AHPL_sg, mat & AHPL_pix, mat & AHPL_invDist) {
 
@@ -151,11 +152,9 @@ namespace jafar {
          pix1 = subrange(pix, 0, 2);
          pix2 = subrange(pix, 2, 4);
 
-         pinhole::backProjectPoint(pinHolePtr()->params.intrinsic, pinHolePtr()->params.correction,
-                                   pix1, 1.0, v1, V1_pix1, V1_1);
+         if (!pinHolePtr()->params.backProjectPoint(pix1, 1.0, v1, V1_pix1, V1_1)) return false;
 
-         pinhole::backProjectPoint(pinHolePtr()->params.intrinsic, pinHolePtr()->params.correction,
-                                   pix2, 1.0, v2, V2_pix2, V2_1);
+         if (!pinHolePtr()->params.backProjectPoint(pix2, 1.0, v2, V2_pix2, V2_1)) return false;
 
          subrange(v,0,3) = v1;
          subrange(v,3,6) = v2;
@@ -185,6 +184,7 @@ namespace jafar {
          VN_pix = prod(VN_v, V_pix);
          AHPL_pix = prod(AHPL_vn, VN_pix);
 
+         return true;
       }
 
       bool ObservationModelPinHoleAnchoredHomogeneousPointsLine::predictVisibility_func(jblas::vec x, jblas::vec nobs)
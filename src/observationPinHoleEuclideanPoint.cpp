@@ -80,19 +80,18 @@ namespace jafar {
 			EXP_lmk = prod(EXP_v, V_lmk);
 		}
 
-		void ObservationModelPinHoleEuclideanPoint::backProject_func(const vec7 & sg,
+		bool ObservationModelPinHoleEuclideanPoint::backProject_func(const vec7 & sg,
 		    const vec & meas, const vec & nobs, vec & euc) {
 
 			vec3 v;
-			vec4 k = pinHolePtr()->params.intrinsic;
-			vec c = pinHolePtr()->params.correction;
-			v = pinhole::backprojectPoint(k, c, meas, (double)1.0);
+			if (!pinHolePtr()->params.backprojectPoint(meas, v, (double)1.0)) return false;
 			ublasExtra::normalize(v);
 			v *= nobs(0); // nobs is distance
 			euc = quaternion::eucFromFrame(sg, v);
+			return true;
 		}
 
-		void ObservationModelPinHoleEuclideanPoint::backProject_func(const vec7 & sg,
+		bool ObservationModelPinHoleEuclideanPoint::backProject_func(const vec7 & sg,
 		    const vec & meas, const vec & nobs, vec & euc, mat & EUC_sg,
 		    mat & EUC_meas, mat & EUC_nobs) {
 
@@ -100,8 +99,7 @@ namespace jafar {
 			mat V_meas(3, 2);
 			mat V_1(3, 1), VN_v(3,3), VN_meas(3, 2), VS_nobs(3,1), VS_vn(3,3), EUC_vs(3,3), VS_meas(3,2);
 
-			pinhole::backProjectPoint(pinHolePtr()->params.intrinsic, pinHolePtr()->params.correction, meas, 1.0,
-			                          v, V_meas, V_1);
+			if (!pinHolePtr()->params.backProjectPoint(meas, 1.0, v, V_meas, V_1)) return false;
 
 			vec3 vn = v;
 			ublasExtra::normalize(vn); // nobs is inverse-distance
@@ -117,6 +115,7 @@ namespace jafar {
 			EUC_nobs = prod(EUC_vs, VS_nobs);
 			EUC_meas = prod(EUC_vs, VS_meas);
 
+			return true;
 		}
 
 		bool ObservationModelPinHoleEuclideanPoint::predictVisibility_func(jblas::vec x, jblas::vec nobs)
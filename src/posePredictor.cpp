@@ -0,0 +1,102 @@
+/*
+ * \file posePredictor.cpp
+ * \date 17/10/2026
+ * \author croussil
+ * \ingroup rtslam
+ */
+
+#include <algorithm>
+#include <boost/bind.hpp>
+
+#include "jmath/indirectArray.hpp"
+
+#include "rtslam/posePredictor.hpp"
+
+
+namespace jafar {
+	namespace rtslam {
+		using namespace std;
+
+		PosePredictor::PosePredictor(robot_ptr_t robPtr, size_t maxReadings):
+			robPtr(robPtr), maxReadings(maxReadings), valid(false), time(0.), readingTime(0.),
+			XNEW_x(robPtr->XNEW_x), XNEW_pert(robPtr->XNEW_pert), Q(robPtr->Q)
+		{
+			JFR_ASSERT(robPtr->hardwareEstimatorPtr, "PosePredictor: the robot has no hardware estimator");
+			incrementArray = robPtr->hardwareEstimatorPtr->incrementValues()-1;
+			robPtr->hardwareEstimatorPtr->setReadingCallback(boost::bind(&PosePredictor::newReading, this, _1));
+		}
+
+		PosePredictor::~PosePredictor()
+		{
+			// waits for the end of a newReading() in the acquisition thread, if any
+			robPtr->hardwareEstimatorPtr->setReadingCallback(hardware::HardwareEstimatorAbstract::reading_callback_t());
+		}
+
+		/*
+		 * Same integration as RobotAbstract::move(double), with the control of the reading
+		 * held since the date of the prediction, and its increments counted from the previous reading.
+		 */
+		void PosePredictor::step(const jblas::vec & reading)
+		{
+			double t = reading(0);
+			if (t <= time) { readingTime = t; return; }
+			double dt = t - time;
+
+			jblas::vec u = ublas::subrange(reading, 1, reading.size());
+			if (incrementArray.size() > 0 && t > readingTime)
+			{
+				double a = std::min(dt / (t - readingTime), 1.);
+				for (size_t i = 0; i < incrementArray.size(); ++i) u(incrementArray(i)) *= a;
+			}
+
+			xnew.resize(x.size());
+			robPtr->predict(x, u, dt, xnew, XNEW_x, XNEW_pert);
+			if (!robPtr->constantPerturbation)
+			{
+				jblas::mat PERT_Pct = ublas::prod(XNEW_pert, robPtr->perturbation.P_continuous() * dt);
+				Q = ublas::prod(PERT_Pct, ublas::trans(XNEW_pert));
+			}
+			jblas::mat P_Ft = ublas::prod(P, ublas::trans(XNEW_x));
+			P = ublas::prod(XNEW_x, P_Ft) + Q;
+			x = xnew;
+			time = readingTime = t;
+		}
+
+		void PosePredictor::correct()
+		{
+			boost::unique_lock<boost::mutex> l(mutex_data);
+			if (!robPtr->mapPtr()->marginals.get(robPtr->state.ia(), x, P))
+			{
+				x = robPtr->state.x();
+				P = robPtr->state.P();
+			}
+			time = readingTime = robPtr->self_time;
+			valid = true;
+
+			// forget the readings already integrated by the filter, but the last one
+			while (readings.size() > 1 && readings[1](0) <= time) readings.pop_front();
+			for (std::deque<jblas::vec>::iterator it = readings.begin(); it != readings.end(); ++it)
+				step(*it);
+			publish();
+		}
+
+		void PosePredictor::newReading(const jblas::vec & reading)
+		{
+			boost::unique_lock<boost::mutex> l(mutex_data);
+			readings.push_back(reading);
+			if (readings.size() > maxReadings) readings.pop_front();
+			if (!valid) return;
+			step(reading);
+			publish();
+		}
+
+		bool PosePredictor::getPose(double & _time, jblas::vec & _x, jblas::sym_mat & _P)
+		{
+			boost::unique_lock<boost::mutex> l(mutex_data);
+			if (!valid) return false;
+			_time = time; _x = x; _P = P;
+			return true;
+		}
+
+	}
+}
@@ -49,6 +49,7 @@ namespace jafar {
 			control(_size_control),
 			perturbation(_size_pert),
 			XNEW_x(_size_state, _size_state),
+			XNEW_x_blocks(_size_state),
 			XNEW_pert(_size_state, _size_pert),
 			Q(_size_state, _size_state),
 			origin_sensors(3), origin_export(3), robot_pose(6)
@@ -68,6 +69,7 @@ namespace jafar {
 			control(_size_control),
 			perturbation(_size_pert),
 			XNEW_x(_size_state, _size_state),
+			XNEW_x_blocks(_size_state),
 			XNEW_pert(_size_state, _size_pert),
 			Q(_size_state, _size_state),
 			origin_sensors(3), origin_export(3), robot_pose(6)
@@ -200,6 +202,7 @@ namespace jafar {
 				move();
 			}
 			self_time = time;
+			stateHistory.record(*mapPtr(), pose.ia(), time);
 		}
 
 		void RobotAbstract::move_fake(double time){
@@ -268,6 +271,7 @@ namespace jafar {
 				}
 			} 
 			self_time = time;
+			stateHistory.record(*mapPtr(), pose.ia(), time);
 		}
 
 		void RobotAbstract::writeLogHeader(kernel::DataLogger& log) const
@@ -31,6 +31,7 @@ namespace jafar {
 			// Build constant perturbation Jacobian
 			constantPerturbation = true;
 			computePertJacobian();
+			computeJacobianStructure();
 			type = CENTERED_CONSTANT_VELOCITY;
 		}
 
@@ -42,6 +43,7 @@ namespace jafar {
 			// Build constant perturbation Jacobian
 			constantPerturbation = true;
 			computePertJacobian();
+			computeJacobianStructure();
 			type = CENTERED_CONSTANT_VELOCITY;
 		}
 
@@ -215,5 +217,23 @@ namespace jafar {
 			subrange(XNEW_pert, 10, 13, 3, 6) = I;
 		}
 
+		/*
+		 * Declare block structure of XNEW_x.
+		 *
+		 * All the rows of the robot state are changed, but XNEW_x is still very sparse,
+		 * see move_func() for the blocks.
+		 */
+		void RobotCenteredConstantVelocity::computeJacobianStructure() {
+			XNEW_x_blocks.clear();
+			XNEW_x_blocks.addBlock(0, 7, 3, 3);    // PNEW_v
+			XNEW_x_blocks.addBlock(3, 10, 4, 3);   // QNEW_wdt
+			XNEW_x_blocks.addIdentity(7, 3);
+			XNEW_x_blocks.addIdentity(10, 3);
+			XNEW_x_blocks.addBlock(13, 0, 3, 7);   // PBASENEW_f
+			XNEW_x_blocks.addBlock(13, 13, 3, 3);  // PBASENEW_pbase
+			XNEW_x_blocks.addBlock(16, 3, 4, 4);   // QBASENEW_q
+			XNEW_x_blocks.addBlock(16, 16, 4, 4);  // QBASENEW_qbase
+		}
+
 	}
 }
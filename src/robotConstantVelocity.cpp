@@ -31,6 +31,7 @@ namespace jafar {
 			// Build constant perturbation Jacobian
 			constantPerturbation = true;
 			computePertJacobian();
+			computeJacobianStructure();
 			type = CONSTANT_VELOCITY;
 		}
 
@@ -42,6 +43,7 @@ namespace jafar {
 			// Build constant perturbation Jacobian
 			constantPerturbation = true;
 			computePertJacobian();
+			computeJacobianStructure();
 			type = CONSTANT_VELOCITY;
 		}
 
@@ -159,6 +161,26 @@ namespace jafar {
 		}
 
 
+		/*
+		 * Declare block structure of XNEW_x.
+		 *
+		 * Only the p and q rows differ from identity:
+		 *
+		 * var    |  p     q       v       w
+		 *    pos |  0     3       7       10
+		 * -------+----------------------------
+		 *  p  0  |  I            PNEW_v
+		 *  q  3  |      QNEW_q          QNEW_w
+		 */
+		void RobotConstantVelocity::computeJacobianStructure() {
+			XNEW_x_blocks.clear();
+			XNEW_x_blocks.addIdentity(0, 3);
+			XNEW_x_blocks.addBlock(0, 7, 3, 3);
+			XNEW_x_blocks.addBlock(3, 3, 4, 4);
+			XNEW_x_blocks.addBlock(3, 10, 4, 3);
+		}
+
+
 		void RobotConstantVelocity::writeLogHeader(kernel::DataLogger& log) const
 		{
 			std::ostringstream oss; oss << "Robot " << id();
@@ -11,6 +11,7 @@
 #include "rtslam/robotInertial.hpp"
 
 #include "rtslam/quatTools.hpp"
+#include "rtslam/quatKernels.hpp"
 
 namespace jafar {
 	namespace rtslam {
@@ -35,12 +36,14 @@ namespace jafar {
 			RobotAbstract(_mapPtr, RobotInertial::size(), RobotInertial::size_control(), RobotInertial::size_perturbation())
 		{
 			constantPerturbation = false;
+			computeJacobianStructure();
 			type = INERTIAL;
 			z_axis.clear(); z_axis(2) = 1;
 		}
 		RobotInertial::RobotInertial(const simulation_t dummy, const map_ptr_t & _mapPtr) :
 			RobotAbstract(FOR_SIMULATION, _mapPtr, RobotInertial::size(), RobotInertial::size_control(), RobotInertial::size_perturbation()) {
 			constantPerturbation = true;
+			computeJacobianStructure();
 			type = INERTIAL;
 		}
 
@@ -118,7 +121,11 @@ namespace jafar {
 			splitPert(_n, vi, ti, abi, wbi);
 
 			// It is useful to start obtaining a nice rotation matrix and the product R*dt
-			Rold = q2R(q);
+			// quaternion operations are done with the fixed-size kernels on these arrays
+			double aq[4], aR[9], aqwdt[4], aqnew[4], awdt[3], J16[16], J12[12];
+			fixed::load(q, 0, 4, aq);
+			fixed::q2R(aq, aR);
+			fixed::storeJac(aR, 3, 3, Rold);
 			Rdt = Rold * _dt;
 
 			// Invert sensor functions. Get true acc. and ang. rates
@@ -135,8 +142,10 @@ namespace jafar {
 
 			// qnew = q x q(w * dt)
 			// Keep qwt ( = q(w * dt)) for later use
-			vec4 qwdt = v2q(wtrue * _dt + ti);
-			qnew = qProd(q, qwdt); //    orientation
+			for (size_t i = 0; i < 3; ++i) awdt[i] = wtrue(i) * _dt + ti(i);
+			fixed::v2q(awdt, aqwdt);
+			fixed::qProd(aq, aqwdt, aqnew);
+			fixed::store(aqnew, 4, qnew, 0); //    orientation
 			vnew = v + atrue * _dt + vi; //    velocity
 			#if AVGSPEED
 			pnew = p + (v+vnew)/2 * _dt; //     position
@@ -186,23 +195,31 @@ namespace jafar {
 
 			// Fill in QNEW_q
 			// qnew = qold ** qwdt  ( qnew = q1 ** q2 = qProd(q1, q2) in rtslam/quatTools.hpp )
-			qProd_by_dq1(qwdt, QNEW_q);
+			fixed::qProd_by_dq1(aqwdt, J16);
+			fixed::storeJac(J16, 4, 4, QNEW_q);
 			subrange(_XNEW_x, 3, 7, 3, 7) = prod(QNORM_qnew, QNEW_q);
 
 			// Fill in QNEW_wb
 			// QNEW_wb = QNEW_qwdt * QWDT_wdt * WDT_w * W_wb
 			//         = QNEW_qwdt * QWDT_w * W_wb
 			//         = QNEW_qwdt * QWDT_w * (-1)
-			qProd_by_dq2(q, QNEW_qwdt);
+			fixed::qProd_by_dq2(aq, J16);
+			fixed::storeJac(J16, 4, 4, QNEW_qwdt);
 			// Here we get the derivative of qwdt wrt wtrue, so we consider dt = 1 and call for the derivative of v2q() with v = w*dt
 //			v2q_by_dv(wtrue, QWDT_w);
-			v2q_by_dv(wtrue*_dt, QWDT_w); QWDT_w *= _dt;
+			for (size_t i = 0; i < 3; ++i) awdt[i] = wtrue(i) * _dt;
+			fixed::v2q_by_dv(awdt, J12);
+			for (size_t i = 0; i < 12; ++i) J12[i] *= _dt;
+			fixed::storeJac(J12, 4, 3, QWDT_w);
 			QNEW_w = prod ( QNEW_qwdt, QWDT_w);
 			subrange(_XNEW_x, 3, 7, 13, 16) = -prod(QNORM_qnew,QNEW_w);
 
 			// Fill VNEW_q
 			// VNEW_q = d(R(q)*v) / dq
-			rotate_by_dq(q, am-ab, VNEW_q); VNEW_q *= _dt;
+			double aa[3] = { am(0) - ab(0), am(1) - ab(1), am(2) - ab(2) };
+			fixed::rotate_by_dq(aq, aa, J12);
+			for (size_t i = 0; i < 12; ++i) J12[i] *= _dt;
+			fixed::storeJac(J12, 3, 4, VNEW_q);
 			subrange(_XNEW_x, 7, 10, 3, 7) = VNEW_q;
 			#if AVGSPEED
 			subrange(_XNEW_x, 0, 3, 3, 7) = VNEW_q*_dt/2;
@@ -259,6 +276,38 @@ namespace jafar {
 			subrange(_XNEW_pert, 3, 7, 3, 6) = prod (QNORM_qnew, QNEW_w) * (1 / _dt);
 		}
 
+		/*
+		 * Declare block structure of XNEW_x.
+		 *
+		 * Only the p, q and v rows differ from identity, the biases and gravity are random walks:
+		 *   var    |  p       q        v        ab       wb       g
+		 *      pos |  0       3        7        10       13       16
+		 *   -------+----------------------------------------------------
+		 * #if AVGSPEED
+		 *   p   0  |  I  [VNEW_q*dt/2  I*dt -R*dt*dt/2]   0     I*dt*dt/2
+		 * #else
+		 *   p   0  |  I       0      [I*dt]     0        0        0
+		 * #endif
+		 *   q   3  |  0    [QNEW_q]    0        0     [QNEW_wb]   0
+		 *   v   7  |  0    [VNEW_q]    I     [-R*dt]     0      [I*dt]
+		 */
+		void RobotInertial::computeJacobianStructure() {
+			XNEW_x_blocks.clear();
+			XNEW_x_blocks.addIdentity(0, 3);
+			#if AVGSPEED
+			XNEW_x_blocks.addBlock(0, 3, 3, 10);
+			XNEW_x_blocks.addBlock(0, 16, 3, g_size);
+			#else
+			XNEW_x_blocks.addBlock(0, 7, 3, 3);
+			#endif
+			XNEW_x_blocks.addBlock(3, 3, 4, 4);
+			XNEW_x_blocks.addBlock(3, 13, 4, 3);
+			XNEW_x_blocks.addBlock(7, 3, 3, 4);
+			XNEW_x_blocks.addIdentity(7, 3);
+			XNEW_x_blocks.addBlock(7, 10, 3, 3);
+			XNEW_x_blocks.addBlock(7, 16, 3, g_size);
+		}
+
 #if 1
 		vec RobotInertial::e_from_g(const vec3 & _g)
 		{
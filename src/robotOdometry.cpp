@@ -30,6 +30,7 @@ namespace jafar {
 			              RobotOdometry::size_control(),
 			              RobotOdometry::size_perturbation()) {
 			constantPerturbation = false;
+			computeJacobianStructure();
 			type = ODOMETRY;
 		}
 
@@ -39,6 +40,7 @@ namespace jafar {
 			              RobotOdometry::size_control(),
 			              RobotOdometry::size_perturbation()) {
 			constantPerturbation = true;
+			computeJacobianStructure();
 			type = ODOMETRY;
 		}
 
@@ -113,6 +115,24 @@ namespace jafar {
 			subrange(_XNEW_u, 3, 7, 3, 6) = QNEW_dv;			
 		}
 			
+		/*
+		 * Declare block structure of XNEW_x.
+		 *
+		 * PNEW_x = [PNEW_p PNEW_q] with PNEW_p = I:
+		 *
+		 * var    |  p       q
+		 *    pos |  0       3
+		 * -------+---------------
+		 *  p  0  |  I     PNEW_q
+		 *  q  3  |  0     QNEW_q
+		 */
+		void RobotOdometry::computeJacobianStructure() {
+			XNEW_x_blocks.clear();
+			XNEW_x_blocks.addIdentity(0, 3);
+			XNEW_x_blocks.addBlock(0, 3, 3, 4);
+			XNEW_x_blocks.addBlock(3, 3, 4, 4);
+		}
+
 		void RobotOdometry::init_func(const vec & _x, const vec & _u, vec & _xnew) {
 			
 			using namespace jblas;
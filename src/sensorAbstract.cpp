@@ -12,6 +12,7 @@
 #include "rtslam/robotAbstract.hpp"
 #include "rtslam/observationAbstract.hpp"
 #include "rtslam/quatTools.hpp"
+#include "rtslam/quatKernels.hpp"
 
 #include "jmath/angle.hpp"
 #include <vector>
@@ -98,11 +99,13 @@ namespace jafar {
 		 * Get sensor pose in global frame.
 		 */
 		vec7 SensorAbstract::globalPose() {
-			vec7 globPose;
-			jblas::vec7 robotPose = robotPtr()->pose.x();
-			jblas::vec7 sensorPose = pose.x();
-			globPose = quaternion::composeFrames(robotPose, sensorPose);
-			return globPose;
+			double robotPose[7], sensorPose[7], globPose[7];
+			quaternion::fixed::load(robotPtr()->pose.x(), 0, 7, robotPose);
+			quaternion::fixed::load(pose.x(), 0, 7, sensorPose);
+			quaternion::fixed::composeFrames(robotPose, sensorPose, globPose);
+			vec7 res;
+			quaternion::fixed::store(globPose, 7, res, 0);
+			return res;
 		}
 
 		/*
@@ -110,22 +113,22 @@ namespace jafar {
 		 */
 		void SensorAbstract::globalPose(jblas::vec7 & senGlobalPos,
 		    jblas::mat & SG_rs) {
-			using boost::numeric::ublas::range;
-			jblas::vec7 robotPose = robotPtr()->pose.x();
-			jblas::vec7 sensorPose = pose.x();
+			double robotPose[7], sensorPose[7], globPose[7], PG_r[49], PG_s[49];
+			quaternion::fixed::load(robotPtr()->pose.x(), 0, 7, robotPose);
+			quaternion::fixed::load(pose.x(), 0, 7, sensorPose);
 
 			if (state.storage() == Gaussian::LOCAL) {
 				// Sensor is not in the map. Jacobian only wrt robot.
-				senGlobalPos = quaternion::composeFrames(robotPose, sensorPose);
-				quaternion::composeFrames_by_dglobal(robotPose, sensorPose, SG_rs);
+				quaternion::fixed::composeFrames(robotPose, sensorPose, globPose);
+				quaternion::fixed::composeFrames_by_dglobal(robotPose, sensorPose, PG_r);
+				quaternion::fixed::storeJac(PG_r, 7, 7, SG_rs, 0, 0);
 			} else {
 				// Sensor is in the map. Give composed Jacobian.
-				jblas::mat PG_r(7, 7), PG_s(7, 7);
-				quaternion::composeFrames(robotPose, sensorPose, senGlobalPos, PG_r,
-				                          PG_s);
-				project(SG_rs, range(0, 7), range(0, 7)) = PG_r;
-				project(SG_rs, range(0, 7), range(7, 14)) = PG_s;
+				quaternion::fixed::composeFrames(robotPose, sensorPose, globPose, PG_r, PG_s);
+				quaternion::fixed::storeJac(PG_r, 7, 7, SG_rs, 0, 0);
+				quaternion::fixed::storeJac(PG_s, 7, 7, SG_rs, 0, 7);
 			}
+			quaternion::fixed::store(globPose, 7, senGlobalPos, 0);
 		}
 		
 		void SensorExteroAbstract::process(unsigned id)
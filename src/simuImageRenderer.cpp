@@ -0,0 +1,272 @@
+/**
+ * \file simuImageRenderer.cpp
+ * \date 17/10/2026
+ * \author jsola
+ * \ingroup rtslam
+ */
+
+#include <cmath>
+#include <algorithm>
+
+#include "kernel/jafarDebug.hpp"
+#include "image/Image.hpp"
+
+#include "rtslam/simuImageRenderer.hpp"
+#include "rtslam/quatTools.hpp"
+#include "rtslam/pinholeTools.hpp"
+
+namespace jafar {
+namespace rtslam {
+namespace simu {
+	using namespace std;
+	using namespace jblas;
+
+	/// linear congruential generator, so that the sequences do not depend on the platform
+	static inline unsigned nextRand(unsigned & state)
+	{
+		state = state * 1664525u + 1013904223u;
+		return state >> 8;
+	}
+
+	static inline double uniformRand(unsigned & state)
+	{
+		return (nextRand(state) + 0.5) / 16777216.0;
+	}
+
+	static inline double gaussianRand(unsigned & state)
+	{
+		// the two draws in sequence, their order in a single expression is unspecified
+		double u1 = uniformRand(state);
+		double u2 = uniformRand(state);
+		return sqrt(-2. * log(u1)) * cos(2. * M_PI * u2);
+	}
+
+	static inline vec3 cross(const vec3 & a, const vec3 & b)
+	{
+		vec3 c;
+		c(0) = a(1)*b(2) - a(2)*b(1);
+		c(1) = a(2)*b(0) - a(0)*b(2);
+		c(2) = a(0)*b(1) - a(1)*b(0);
+		return c;
+	}
+
+
+	ImageRenderer::ImageRenderer(unsigned width, unsigned height, const vec4 & k, const vec & d,
+		double patchSize, double blurStd, double noiseStd, unsigned seed)
+	{
+		params.width = width;
+		params.height = height;
+		params.intrinsic = k;
+		params.distortion.resize(d.size());
+		params.distortion = d;
+		params.patchSize = patchSize;
+		params.textureSize = 32;
+		params.background = 128;
+		params.blurStd = blurStd;
+		params.noiseStd = noiseStd;
+		params.seed = seed;
+		// the interpolated map is largely precise enough for the rendering
+		if (d.size() > 0) undistortionMap.build(k, d, width, height, 2, 0);
+	}
+
+
+	const ImageRenderer::Texture & ImageRenderer::texture(size_t id, const vec3 & pos, const vec3 & camPos)
+	{
+		std::map<size_t, Texture>::iterator it = textures.find(id);
+		if (it != textures.end()) return it->second;
+		Texture & tex = textures[id];
+
+		// the square faces the first camera that sees it, with its first axis horizontal
+		tex.normal = camPos - pos;
+		double n = ublas::norm_2(tex.normal);
+		if (n < 1e-9) { tex.normal.clear(); tex.normal(0) = 1.; } else tex.normal /= n;
+		vec3 up; up.clear(); up(2) = 1.;
+		if (fabs(ublas::inner_prod(up, tex.normal)) > 0.9) { up.clear(); up(0) = 1.; }
+		tex.axis1 = cross(up, tex.normal);
+		tex.axis1 /= ublas::norm_2(tex.axis1);
+		tex.axis2 = cross(tex.normal, tex.axis1);
+
+		// a corner at the landmark, surrounded by random blocks
+		const int T = params.textureSize;
+		unsigned state = params.seed * 2654435761u + (unsigned)id * 40503u + 1u;
+		float dark = 30 + 70 * uniformRand(state), light = 150 + 80 * uniformRand(state);
+		tex.levels.resize(1);
+		std::vector<float> & level0 = tex.levels[0];
+		level0.resize(T * T);
+		for (int j = 0; j < T; ++j)
+			for (int i = 0; i < T; ++i)
+				level0[j*T + i] = ((i < T/2) == (j < T/2) ? dark : light);
+		for (int r = 0; r < 12; ++r)
+		{
+			int x0 = nextRand(state) % T, y0 = nextRand(state) % T;
+			int x1 = std::min(T, x0 + 2 + (int)(nextRand(state) % (T/4))), y1 = std::min(T, y0 + 2 + (int)(nextRand(state) % (T/4)));
+			float gray = nextRand(state) % 256;
+			// keep the central corner clean
+			if (x1 > T/4 && x0 < 3*T/4 && y1 > T/4 && y0 < 3*T/4) continue;
+			for (int y = y0; y < y1; ++y)
+				for (int x = x0; x < x1; ++x)
+					level0[y*T + x] = gray;
+		}
+
+		// mip-map
+		for (int s = T/2; s >= 1; s /= 2)
+		{
+			const std::vector<float> & prev = tex.levels.back();
+			std::vector<float> level(s * s);
+			for (int j = 0; j < s; ++j)
+				for (int i = 0; i < s; ++i)
+					level[j*s + i] = 0.25f * (prev[(2*j)*2*s + 2*i] + prev[(2*j)*2*s + 2*i+1] + prev[(2*j+1)*2*s + 2*i] + prev[(2*j+1)*2*s + 2*i+1]);
+			tex.levels.push_back(level);
+		}
+		return tex;
+	}
+
+
+	void ImageRenderer::splat(const Texture & tex, const vec3 & pos, const vec7 & senGlobPose, const mat33 & R, int owner)
+	{
+		const int W = params.width, H = params.height;
+		const double h = params.patchSize / 2.;
+
+		// landmark and square frame in the camera frame
+		vec3 Lc = ublas::prod(ublas::trans(R), pos - ublas::subrange(senGlobPose, 0, 3));
+		vec3 nc = ublas::prod(ublas::trans(R), tex.normal);
+		vec3 ac = ublas::prod(ublas::trans(R), tex.axis1);
+		vec3 bc = ublas::prod(ublas::trans(R), tex.axis2);
+
+		// bounding box of the projected square, only when all of it is in front of the camera
+		double xmin = W, xmax = -1, ymin = H, ymax = -1;
+		for (int c = 0; c < 4; ++c)
+		{
+			vec3 corner = Lc + ((c & 1) ? h : -h) * ac + ((c & 2) ? h : -h) * bc;
+			if (corner(2) < 0.05) return;
+			vec2 u = pinhole::projectPoint(params.intrinsic, params.distortion, corner);
+			xmin = std::min(xmin, u(0)); xmax = std::max(xmax, u(0));
+			ymin = std::min(ymin, u(1)); ymax = std::max(ymax, u(1));
+		}
+		int x0 = std::max(0, (int)floor(xmin)), x1 = std::min(W - 1, (int)ceil(xmax));
+		int y0 = std::max(0, (int)floor(ymin)), y1 = std::min(H - 1, (int)ceil(ymax));
+		if (x0 > x1 || y0 > y1) return;
+
+		// mip-map level for the texel footprint of one pixel
+		double side = params.intrinsic(2) * params.patchSize / Lc(2);
+		int level = 0;
+		for (double texelsPerPixel = params.textureSize / side; texelsPerPixel >= 2. && level + 1 < (int)tex.levels.size(); texelsPerPixel /= 2.) ++level;
+		const std::vector<float> & texels = tex.levels[level];
+		const int T = params.textureSize >> level;
+
+		const double Ln = Lc(0)*nc(0) + Lc(1)*nc(1) + Lc(2)*nc(2);
+		vec2 pix, up;
+		for (int y = y0; y <= y1; ++y)
+			for (int x = x0; x <= x1; ++x)
+			{
+				// pixel x covers [x, x+1), sample at its center
+				pix(0) = x + 0.5; pix(1) = y + 0.5;
+				if (params.distortion.size() == 0)
+					up = pinhole::depixellizePoint(params.intrinsic, pix);
+				else if (!undistortionMap.undistort(pix, up)
+				      && !pinhole::undistortPointIterative(params.distortion, pinhole::depixellizePoint(params.intrinsic, pix), up))
+					continue; // the distortion model cannot be inverted at this pixel
+
+				// intersection of the ray with the square
+				double rn = up(0)*nc(0) + up(1)*nc(1) + nc(2);
+				if (fabs(rn) < 1e-9) continue;
+				double lambda = Ln / rn;
+				if (lambda <= 0.) continue;
+				double d0 = lambda * up(0) - Lc(0), d1 = lambda * up(1) - Lc(1), d2 = lambda - Lc(2);
+				double s = d0*ac(0) + d1*ac(1) + d2*ac(2);
+				double t = d0*bc(0) + d1*bc(1) + d2*bc(2);
+				if (s < -h || s >= h || t < -h || t >= h) continue;
+
+				// bilinear sampling
+				double tu = (s / params.patchSize + 0.5) * T - 0.5, tv = (t / params.patchSize + 0.5) * T - 0.5;
+				tu = std::max(0., std::min(T - 1., tu)); tv = std::max(0., std::min(T - 1., tv));
+				int i = std::min((int)tu, T - 2 < 0 ? 0 : T - 2), j = std::min((int)tv, T - 2 < 0 ? 0 : T - 2);
+				float a = tu - i, b = tv - j;
+				const float *p = &texels[j*T + i];
+				float value = (T == 1 ? p[0] : (1-a)*(1-b)*p[0] + a*(1-b)*p[1] + (1-a)*b*p[T] + a*b*p[T+1]);
+				buffer[y*W + x] = value;
+				owners[y*W + x] = owner;
+			}
+	}
+
+
+	void ImageRenderer::blur()
+	{
+		if (params.blurStd <= 0.) return;
+		const int W = params.width, H = params.height;
+		const int r = (int)ceil(3. * params.blurStd);
+		std::vector<float> kernel(2*r + 1);
+		float sum = 0.f;
+		for (int i = -r; i <= r; ++i) sum += kernel[i + r] = exp(-0.5 * i * i / (params.blurStd * params.blurStd));
+		for (int i = 0; i <= 2*r; ++i) kernel[i] /= sum;
+
+		// separable, with clamped borders
+		tmp.resize(buffer.size());
+		for (int y = 0; y < H; ++y)
+			for (int x = 0; x < W; ++x)
+			{
+				float v = 0.f;
+				for (int i = -r; i <= r; ++i) v += kernel[i + r] * buffer[y*W + std::max(0, std::min(W - 1, x + i))];
+				tmp[y*W + x] = v;
+			}
+		for (int y = 0; y < H; ++y)
+			for (int x = 0; x < W; ++x)
+			{
+				float v = 0.f;
+				for (int i = -r; i <= r; ++i) v += kernel[i + r] * tmp[std::max(0, std::min(H - 1, y + i))*W + x];
+				buffer[y*W + x] = v;
+			}
+	}
+
+
+	void ImageRenderer::render(const vec7 & senGlobPose, const PointList & points, unsigned frameSeed, image::Image & img)
+	{
+		JFR_ASSERT(img.width() == (int)params.width && img.height() == (int)params.height, "ImageRenderer: image size differs from the camera");
+		const int W = params.width, H = params.height;
+		buffer.assign(W * H, (float)params.background);
+		owners.assign(W * H, -1);
+		truth.clear();
+
+		vec3 camPos = ublas::subrange(senGlobPose, 0, 3);
+		mat33 R = quaternion::q2R(ublas::subrange(senGlobPose, 3, 7));
+
+		// from the farthest to the nearest
+		std::vector<std::pair<double, size_t> > order;
+		for (PointList::const_iterator it = points.begin(); it != points.end(); ++it)
+		{
+			vec3 pc = ublas::prod(ublas::trans(R), it->second - camPos);
+			if (pc(2) > 0.) order.push_back(std::make_pair(-pc(2), it->first));
+		}
+		std::sort(order.begin(), order.end());
+		for (size_t i = 0; i < order.size(); ++i)
+		{
+			PointList::const_iterator it = points.find(order[i].second);
+			splat(texture(it->first, it->second, camPos), it->second, senGlobPose, R, (int)i);
+		}
+
+		// ground truth of the landmarks that are in the image and not hidden by another square
+		for (size_t i = 0; i < order.size(); ++i)
+		{
+			PointList::const_iterator it = points.find(order[i].second);
+			vec3 pc = ublas::prod(ublas::trans(R), it->second - camPos);
+			vec2 u = pinhole::projectPoint(params.intrinsic, params.distortion, pc);
+			if (u(0) < 0 || u(1) < 0 || u(0) >= W || u(1) >= H) continue;
+			if (owners[(int)u(1)*W + (int)u(0)] != (int)i) continue;
+			truth[it->first] = u;
+		}
+
+		blur();
+
+		unsigned state = params.seed * 2246822519u + frameSeed * 3266489917u + 7u;
+		unsigned char *data = img.data();
+		const int step = img.step();
+		for (int y = 0; y < H; ++y)
+			for (int x = 0; x < W; ++x)
+			{
+				double v = buffer[y*W + x];
+				if (params.noiseStd > 0.) v += params.noiseStd * gaussianRand(state);
+				data[y*step + x] = (unsigned char)std::max(0., std::min(255., v + 0.5));
+			}
+	}
+
+}}}
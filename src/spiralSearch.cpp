@@ -0,0 +1,170 @@
+/*
+ * \file spiralSearch.cpp
+ * \date 17/10/2026
+ * \author jsola
+ * \ingroup rtslam
+ */
+
+#include <cmath>
+#include <algorithm>
+
+#include "jmath/jblas.hpp"
+#include "rtslam/spiralSearch.hpp"
+
+
+namespace jafar {
+	namespace rtslam {
+		using namespace std;
+		using namespace image;
+
+		ZnccSpiralSearch::ZnccSpiralSearch(correl::FastTranslationMatcherZncc & fullMatcher, int nRings):
+			m_fullMatcher(fullMatcher), m_nRings(std::max(nRings, 1)), m_patch(NULL), m_image(NULL), m_patchNorm(0.),
+			m_x0(0), m_y0(0), m_w(0), m_h(0)
+		{
+			clearStats();
+		}
+
+		double ZnccSpiralSearch::zncc(int x, int y)
+		{
+			int pw = m_patch->width(), ph = m_patch->height();
+			int step = m_image->step();
+			double sum = 0., sum2 = 0., sumProd = 0.;
+			const float * pc = &m_patchCentered[0];
+			for (int i = 0; i < ph; ++i)
+			{
+				const unsigned char * pix = m_image->data() + (y - ph/2 + i) * step + x - pw/2;
+				for (int j = 0; j < pw; ++j, ++pix, ++pc)
+				{
+					sum += pix[0]; sum2 += (double)pix[0]*pix[0]; sumProd += pix[0] * (*pc);
+				}
+			}
+			double norm = sum2 - sum*sum / (pw*ph);
+			if (norm <= 1e-6) return 0.;
+			return sumProd / sqrt(norm * m_patchNorm);
+		}
+
+		double ZnccSpiralSearch::score(int i)
+		{
+			if (m_scores[i] < -1.5)
+			{
+				m_scores[i] = zncc(m_x0 + i % m_w, m_y0 + i / m_w);
+				stats.nPositions++;
+			}
+			return m_scores[i];
+		}
+
+		/*
+		 * Move to the best neighbor as long as it is better, inside the region.
+		 * Returns true if a local maximum was reached.
+		 */
+		bool ZnccSpiralSearch::climb(int & i, double & s)
+		{
+			while (true)
+			{
+				int x = i % m_w, y = i / m_w;
+				int iBest = i; double sBest = s;
+				for (int dy = -1; dy <= 1; ++dy)
+					for (int dx = -1; dx <= 1; ++dx)
+					{
+						if (dx == 0 && dy == 0) continue;
+						if (x+dx < 0 || x+dx >= m_w || y+dy < 0 || y+dy >= m_h) return false;
+						int j = i + dy*m_w + dx;
+						double sj = score(j);
+						if (sj > sBest) { iBest = j; sBest = sj; }
+					}
+				if (iBest == i) return true;
+				if (m_rings[iBest] >= m_nRings) return false;
+				i = iBest; s = sBest;
+			}
+		}
+
+		double ZnccSpiralSearch::match(const image::Image & patch, const image::Image & image, const image::ConvexRoi & roi, double threshold,
+			double & xres, double & yres, double & xstd, double & ystd)
+		{
+			stats.nSearch++;
+			m_patch = &patch; m_image = &image;
+			int pw = patch.width(), ph = patch.height();
+			xres = roi.x() + roi.w()/2.0; yres = roi.y() + roi.h()/2.0;
+			xstd = ystd = 0.;
+
+			// positions where the patch is inside the image
+			m_x0 = std::max(roi.x(), pw/2); m_y0 = std::max(roi.y(), ph/2);
+			m_w = std::min(roi.x() + roi.w(), image.width() - pw + pw/2 + 1) - m_x0;
+			m_h = std::min(roi.y() + roi.h(), image.height() - ph + ph/2 + 1) - m_y0;
+			if (m_w <= 0 || m_h <= 0) return 0.;
+
+			// patch
+			m_patchCentered.resize(pw*ph);
+			double sum = 0.;
+			for (int i = 0; i < ph; ++i)
+				for (int j = 0; j < pw; ++j)
+					sum += m_patchCentered[i*pw+j] = patch.data()[i*patch.step()+j];
+			double mean = sum / (pw*ph);
+			m_patchNorm = 0.;
+			for (size_t k = 0; k < m_patchCentered.size(); ++k)
+			{
+				m_patchCentered[k] -= mean;
+				m_patchNorm += m_patchCentered[k] * m_patchCentered[k];
+			}
+			if (m_patchNorm <= 1e-6) return 0.;
+
+			// rings, the positions being the centers of the pixels
+			m_ringRois.assign(m_nRings, roi);
+			for (int k = 0; k < m_nRings-1; ++k) m_ringRois[k].scale((k+1) / (double)m_nRings);
+			m_scores.assign(m_w*m_h, -2.f);
+			m_rings.assign(m_w*m_h, m_nRings);
+			m_ringPositions.resize(m_nRings);
+			for (int k = 0; k < m_nRings; ++k) m_ringPositions[k].clear();
+			jblas::vec2 pos;
+			for (int i = 0; i < m_w*m_h; ++i)
+			{
+				pos(0) = m_x0 + i % m_w + 0.5; pos(1) = m_y0 + i / m_w + 0.5;
+				for (int k = 0; k < m_nRings; ++k)
+					if (m_ringRois[k].isIn(pos)) { m_rings[i] = k; m_ringPositions[k].push_back(i); break; }
+			}
+
+			// search the inner rings from the center
+			int iBest = -1; double sBest = -2.;
+			bool early = false;
+			for (int k = 0; k < m_nRings-1 && !early; ++k)
+			{
+				for (size_t n = 0; n < m_ringPositions[k].size(); ++n)
+				{
+					int i = m_ringPositions[k][n];
+					double s = score(i);
+					if (s > sBest) { iBest = i; sBest = s; }
+				}
+				if (sBest > threshold)
+				{
+					int i = iBest; double s = sBest;
+					early = climb(i, s);
+					iBest = i; sBest = s;
+				}
+			}
+
+			// else the whole region
+			if (!early)
+			{
+				stats.nPositions += roi.count();
+				return m_fullMatcher.match(patch, image, roi, xres, yres, xstd, ystd);
+			}
+			stats.nEarly++;
+
+			// sub-pixel position with a parabola in each direction
+			int x = iBest % m_w, y = iBest / m_w;
+			xres = m_x0 + x + 0.5; yres = m_y0 + y + 0.5;
+			if (x > 0 && x < m_w-1)
+			{
+				double sl = score(iBest-1), sr = score(iBest+1), c = sl - 2*sBest + sr;
+				if (c < 0.) { xres += 0.5 * (sl - sr) / c; xstd = 1. / sqrt(-c); }
+			}
+			if (y > 0 && y < m_h-1)
+			{
+				double su = score(iBest-m_w), sd = score(iBest+m_w), c = su - 2*sBest + sd;
+				if (c < 0.) { yres += 0.5 * (su - sd) / c; ystd = 1. / sqrt(-c); }
+			}
+			return sBest;
+		}
+
+	}
+}
@@ -0,0 +1,89 @@
+/**
+ * \file stateHistory.cpp
+ * \date 17/10/2026
+ * \author jsola
+ * \ingroup rtslam
+ */
+
+#include <algorithm>
+
+#include "jmath/ublasExtra.hpp"
+
+#include "rtslam/stateHistory.hpp"
+#include "rtslam/mapAbstract.hpp"
+#include "rtslam/kalmanFilter.hpp"
+
+namespace jafar {
+	namespace rtslam {
+
+		void StateHistory::clear(MapAbstract & map)
+		{
+			for (CloneList::iterator it = clones.begin(); it != clones.end(); ++it)
+				map.liberateStates(it->ia);
+			clones.clear();
+		}
+
+		void StateHistory::record(MapAbstract & map, const jblas::ind_array & ia_pose, double time)
+		{
+			if (!enabled() || !map.filterPtr) return;
+
+			// keep one clone at or before the start of the window
+			while (clones.size() > 1 && clones[1].time <= time - duration)
+			{
+				map.liberateStates(clones.front().ia);
+				clones.pop_front();
+			}
+			if (!clones.empty() && time - clones.back().time < std::max(period, 1e-9)) return;
+
+			size_t n = ia_pose.size();
+			jblas::ind_array ia = map.reserveStates(n);
+			if (ia.size() == 0) return; // map full
+
+			// same mean, same variances and cross-variances with the whole map as the pose
+			ublas::project(map.x(), ia) = ublas::project(map.x(), ia_pose);
+			map.filterPtr->initialize(map.ia_used_states(), jblas::identity_mat(n), ia_pose, ia,
+				jblas::identity_mat(n), jblas::sym_mat(jblas::zero_mat(n)));
+
+			clones.push_back(Clone());
+			clones.back().time = time;
+			clones.back().ia = ia;
+		}
+
+		bool StateHistory::retrodict(MapAbstract & map, double time, const jblas::ind_array & ia_pose, double time_now,
+			jblas::vec & x_t, jblas::ind_array & ia_t, jblas::mat & X_t) const
+		{
+			if (clones.empty() || time < clones.front().time || time > time_now) return false;
+
+			// the clones around the date, the current pose closing the list
+			size_t d = 0;
+			while (d + 1 < clones.size() && clones[d+1].time <= time) ++d;
+			double t0 = clones[d].time;
+			double t1 = (d + 1 < clones.size() ? clones[d+1].time : time_now);
+			const jblas::ind_array & ia0 = clones[d].ia;
+			const jblas::ind_array & ia1 = (d + 1 < clones.size() ? clones[d+1].ia : ia_pose);
+			size_t n = ia0.size();
+
+			if (time == t0 || t1 <= t0)
+			{
+				ia_t = ia0;
+				x_t = ublas::project(map.x(), ia0);
+				X_t = jblas::identity_mat(n);
+				return true;
+			}
+
+			double a = (time - t0) / (t1 - t0);
+			ia_t = jblas::ind_array(2*n);
+			for (size_t i = 0; i < n; ++i) { ia_t(i) = ia0(i); ia_t(n+i) = ia1(i); }
+			x_t = (1-a) * ublas::project(map.x(), ia0) + a * ublas::project(map.x(), ia1);
+			X_t.resize(n, 2*n, false);
+			ublas::subrange(X_t, 0,n, 0,n) = (1-a) * jblas::identity_mat(n);
+			ublas::subrange(X_t, 0,n, n,2*n) = a * jblas::identity_mat(n);
+
+			jblas::vec q = ublas::subrange(x_t, 3, 7);
+			jmath::ublasExtra::normalize(q);
+			ublas::subrange(x_t, 3, 7) = q;
+			return true;
+		}
+
+	}
+}
@@ -0,0 +1,146 @@
+/**
+ * \file undistortionMap.cpp
+ * \date 17/10/2026
+ * \author jsola
+ * \ingroup rtslam
+ */
+
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+#include "kernel/jafarDebug.hpp"
+#include "image/Image.hpp"
+
+#include "rtslam/undistortionMap.hpp"
+#include "rtslam/pinholeTools.hpp"
+
+namespace jafar {
+	namespace rtslam {
+		using namespace std;
+		using namespace jblas;
+
+		/// the nodes that could not be undistorted are NaN
+		static inline bool isValid(const float * node) { return node[0] == node[0]; }
+
+		void UndistortionMap::build(const vec4 & _k, const vec & _d, unsigned _width, unsigned _height, unsigned _step, unsigned margin)
+		{
+			JFR_ASSERT(_step > 0, "UndistortionMap: step must be positive");
+			k = _k; d = _d;
+			width = _width; height = _height;
+			step = _step;
+			x0 = -(int)margin; y0 = -(int)margin;
+			nx = (width - 1 + 2*margin + step - 1) / step + 1;
+			ny = (height - 1 + 2*margin + step - 1) / step + 1;
+			table.resize(6 * nx * ny);
+			remap.clear();
+
+			vec2 pix, ud, up;
+			mat22 UD_u, UP_ud, UP_u;
+			float *node = &table[0];
+			for (unsigned j = 0; j < ny; ++j)
+				for (unsigned i = 0; i < nx; ++i, node += 6)
+				{
+					pix(0) = x0 + (int)(i * step);
+					pix(1) = y0 + (int)(j * step);
+					pinhole::depixellizePoint(k, pix, ud, UD_u);
+					if (!pinhole::undistortPointIterative(d, ud, up, UP_ud))
+					{
+						// past the monotony limit of the distortion: no undistorted point
+						std::fill(node, node + 6, std::numeric_limits<float>::quiet_NaN());
+						continue;
+					}
+					UP_u = ublas::prod(UP_ud, UD_u);
+					node[0] = up(0); node[1] = up(1);
+					node[2] = UP_u(0,0); node[3] = UP_u(0,1);
+					node[4] = UP_u(1,0); node[5] = UP_u(1,1);
+				}
+		}
+
+
+		bool UndistortionMap::covers(const vec2 & pix) const
+		{
+			if (table.empty()) return false;
+			double fx = (pix(0) - x0) / step, fy = (pix(1) - y0) / step;
+			return !(fx < 0 || fy < 0 || fx > nx - 1 || fy > ny - 1);
+		}
+
+
+		bool UndistortionMap::interpolate(double u, double v, float * res, size_t n) const
+		{
+			if (table.empty()) return false;
+			double fx = (u - x0) / step, fy = (v - y0) / step;
+			if (fx < 0 || fy < 0 || fx > nx - 1 || fy > ny - 1) return false;
+			unsigned i = std::min((unsigned)fx, nx - 2), j = std::min((unsigned)fy, ny - 2);
+			float a = fx - i, b = fy - j;
+			float w00 = (1-a)*(1-b), w10 = a*(1-b), w01 = (1-a)*b, w11 = a*b;
+			const float *n00 = &table[6 * (j * nx + i)], *n10 = n00 + 6, *n01 = n00 + 6 * nx, *n11 = n01 + 6;
+			if (!isValid(n00) || !isValid(n10) || !isValid(n01) || !isValid(n11)) return false;
+			for (size_t c = 0; c < n; ++c)
+				res[c] = w00 * n00[c] + w10 * n10[c] + w01 * n01[c] + w11 * n11[c];
+			return true;
+		}
+
+
+		bool UndistortionMap::undistort(const vec2 & pix, vec2 & up) const
+		{
+			float res[2];
+			if (!interpolate(pix(0), pix(1), res, 2)) return false;
+			up(0) = res[0]; up(1) = res[1];
+			return true;
+		}
+
+
+		bool UndistortionMap::undistort(const vec2 & pix, vec2 & up, mat22 & UP_pix) const
+		{
+			float res[6];
+			if (!interpolate(pix(0), pix(1), res, 6)) return false;
+			up(0) = res[0]; up(1) = res[1];
+			UP_pix(0,0) = res[2]; UP_pix(0,1) = res[3];
+			UP_pix(1,0) = res[4]; UP_pix(1,1) = res[5];
+			return true;
+		}
+
+
+		void UndistortionMap::undistortImage(const image::Image & src, image::Image & dst)
+		{
+			JFR_ASSERT(src.width() == (int)width && src.height() == (int)height, "UndistortionMap: image size differs from the calibration");
+			JFR_ASSERT(dst.width() == src.width() && dst.height() == src.height(), "UndistortionMap: destination image size differs");
+
+			if (remap.empty())
+			{
+				// source pixel of each undistorted pixel: forward model, exact
+				remap.resize(2 * width * height);
+				vec2 pix, ud;
+				float *m = &remap[0];
+				for (unsigned y = 0; y < height; ++y)
+					for (unsigned x = 0; x < width; ++x, m += 2)
+					{
+						pix(0) = x; pix(1) = y;
+						ud = pinhole::distortPoint(d, pinhole::depixellizePoint(k, pix));
+						pix = pinhole::pixellizePoint(k, ud);
+						m[0] = pix(0); m[1] = pix(1);
+					}
+			}
+
+			const unsigned char *in = src.data();
+			unsigned char *out = dst.data();
+			int in_step = src.step(), out_step = dst.step();
+			const float *m = &remap[0];
+			for (unsigned y = 0; y < height; ++y)
+			{
+				unsigned char *row = out + y * out_step;
+				for (unsigned x = 0; x < width; ++x, m += 2)
+				{
+					float sx = m[0], sy = m[1];
+					if (sx < 0 || sy < 0 || sx > width - 1 || sy > height - 1) { row[x] = 0; continue; }
+					unsigned i = std::min((unsigned)sx, width - 2), j = std::min((unsigned)sy, height - 2);
+					float a = sx - i, b = sy - j;
+					const unsigned char *p = in + j * in_step + i;
+					row[x] = (unsigned char)((1-a)*(1-b)*p[0] + a*(1-b)*p[1] + (1-a)*b*p[in_step] + a*b*p[in_step+1] + 0.5f);
+				}
+			}
+		}
+
+	}
+}
@@ -0,0 +1,195 @@
+/**
+ * test_absloc.cpp
+ *
+ * \date 17/10/2026
+ * \author jsola@laas.fr
+ *
+ *  \file test_absloc.cpp
+ *
+ *  Simulate a constant-velocity robot (quaternion orientation) with camera-rate predictions
+ *  and a delayed GPS, and compare waiting for the GPS, applying it as an out-of-sequence
+ *  measurement on the cloned past poses, and applying it naively at its arrival.
+ *  Once all the readings are processed, the out-of-sequence estimate must be the one of
+ *  the chronological processing.
+ *
+ * \ingroup rtslam
+ */
+
+// boost unit test includes
+#include <boost/test/auto_unit_test.hpp>
+
+// jafar debug include
+#include "kernel/jafarDebug.hpp"
+#include "kernel/threads.hpp"
+
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+#include "jmath/random.hpp"
+#include "jmath/jblas.hpp"
+#include "jmath/ublasExtra.hpp"
+
+#include "rtslam/rtSlam.hpp"
+#include "rtslam/mapAbstract.hpp"
+#include "rtslam/robotConstantVelocity.hpp"
+#include "rtslam/sensorAbsloc.hpp"
+#include "rtslam/hardwareSensorAbstract.hpp"
+
+using namespace jafar;
+using namespace jafar::rtslam;
+using namespace jafar::jmath;
+using namespace jblas;
+using namespace std;
+
+/// GPS fed synchronously by the test
+class HardwareSensorGpsTest: public hardware::HardwareSensorProprioAbstract
+{
+	private:
+		double last_timestamp;
+	public:
+		HardwareSensorGpsTest(kernel::VariableCondition<int> &condition):
+			HardwareSensorProprioAbstract(condition, 100), last_timestamp(0.)
+		{
+			addQuantity(qPos, 1, 3);
+		}
+		virtual void start() {}
+		virtual double getLastTimestamp() { return last_timestamp; }
+
+		unsigned push(double timestamp, const vec & pos, double std)
+		{
+			int id = getWritePos();
+			RawVec reading(7);
+			reading.data(0) = timestamp;
+			ublas::subrange(reading.data, 1, 4) = pos;
+			for (size_t i = 4; i < 7; ++i) reading.data(i) = std;
+			reading.arrival = timestamp;
+			buffer(id) = reading;
+			last_timestamp = timestamp;
+			incWritePos();
+			return id;
+		}
+};
+
+enum { GPS_BLOCKING, GPS_OOSM, GPS_NAIVE };
+
+static vec truePosition(double t)
+{
+	vec p(3);
+	p(0) = t; p(1) = sin(0.5*t); p(2) = 0.;
+	return p;
+}
+
+/**
+ * Run the simulation.
+ * \param mode GPS_BLOCKING: all data processed in chronological order, camera frames wait for the GPS;
+ *             GPS_OOSM: data processed in order of arrival, the GPS as out-of-sequence measurements;
+ *             GPS_NAIVE: data processed in order of arrival, the GPS as if dated at its arrival.
+ * \param rms the rms position error at the camera frames
+ * \param latency the average delay between the date of a camera frame and the moment its estimate is available
+ * \param x_end the position at the end of the simulation, once all the readings are processed
+ */
+static void runDelayedGps(int mode, double & rms, double & latency, vec & x_end)
+{
+	const double cam_period = 1./30., gps_period = 0.2, gps_delay = 0.3, gps_std = 0.05, duration = 20., settle = 2.;
+
+	// room for the 13 robot states and the clones of the pose, 7 states per camera frame of the last second
+	map_ptr_t mapPtr(new MapAbstract(300));
+	robconstvel_ptr_t robPtr(new RobotConstantVelocity(mapPtr));
+	robPtr->linkToParentMap(mapPtr);
+	robPtr->setPoseDegStd(0,0,0, 0,0,0, 1.,1.,1., 1.,1.,1.);
+	robPtr->setVelocityStd(1., 0.01);
+	vec pertStd(6);
+	pertStd(0) = pertStd(1) = pertStd(2) = 0.3;
+	pertStd(3) = pertStd(4) = pertStd(5) = 0.001;
+	robPtr->perturbation.set_std_continuous(pertStd);
+	robPtr->constantPerturbation = false;
+
+	kernel::VariableCondition<int> condition(0);
+	boost::shared_ptr<HardwareSensorGpsTest> gps(new HardwareSensorGpsTest(condition));
+	absloc_ptr_t senPtr(new SensorAbsloc(robPtr, MapObject::UNFILTERED, true));
+	senPtr->linkToParentRobot(robPtr);
+	senPtr->setPose(0,0,0, 0,0,0);
+	senPtr->setHardwareSensor(gps);
+	senPtr->setIntegrationPolicy(true);
+	if (mode == GPS_OOSM) senPtr->setMaxDelay(1.);
+
+	// same noise sequence for all modes
+	vec zero3(3); zero3.clear();
+	MultiDimNormalDistribution noise(zero3, scalar_vec(3, gps_std*gps_std), 1);
+
+	// first reading initializes the position
+	robPtr->move(0.);
+	senPtr->process(gps->push(0., truePosition(0.) + noise.get(), gps_std));
+
+	size_t k = 1, j = 1, n_frames = 0;
+	double sum_err2 = 0., sum_latency = 0.;
+	while (k * cam_period < duration)
+	{
+		double t_cam = k * cam_period, t_gps = j * gps_period;
+		// date at which each data is available to the filter
+		double a_cam = t_cam;
+		double a_gps = (mode == GPS_BLOCKING ? t_gps : t_gps + gps_delay);
+		if (a_gps <= a_cam)
+		{
+			vec z = truePosition(t_gps) + noise.get();
+			double date = (mode == GPS_NAIVE ? t_gps + gps_delay : t_gps);
+			if (!senPtr->handlesDelayedData() || date >= robPtr->self_time) robPtr->move(date);
+			senPtr->process(gps->push(date, z, gps_std));
+			++j;
+		} else
+		{
+			robPtr->move(t_cam);
+			if (t_cam > settle)
+			{
+				vec err = ublas::subrange(robPtr->state.x(), 0, 3) - truePosition(t_cam);
+				sum_err2 += ublas::inner_prod(err, err);
+				// when waiting for the GPS, the frame is only available after the arrival of the last GPS dated before it
+				double t_last_gps = floor(t_cam / gps_period) * gps_period;
+				if (mode == GPS_BLOCKING) sum_latency += std::max(0., t_last_gps + gps_delay - t_cam);
+				++n_frames;
+			}
+			++k;
+		}
+	}
+	// the GPS readings still in transit
+	for (; j * gps_period < duration; ++j)
+	{
+		double t_gps = j * gps_period;
+		vec z = truePosition(t_gps) + noise.get();
+		double date = (mode == GPS_NAIVE ? t_gps + gps_delay : t_gps);
+		if (!senPtr->handlesDelayedData() || date >= robPtr->self_time) robPtr->move(date);
+		senPtr->process(gps->push(date, z, gps_std));
+	}
+	if (robPtr->self_time < duration + gps_delay) robPtr->move(duration + gps_delay);
+	x_end = ublas::subrange(robPtr->state.x(), 0, 3);
+
+	rms = sqrt(sum_err2 / n_frames);
+	latency = sum_latency / n_frames;
+}
+
+void test_absloc01(void) {
+
+	double rms_blocking, rms_oosm, rms_naive, lat_blocking, lat_oosm, lat_naive;
+	vec x_blocking, x_oosm, x_naive;
+	runDelayedGps(GPS_BLOCKING, rms_blocking, lat_blocking, x_blocking);
+	runDelayedGps(GPS_OOSM, rms_oosm, lat_oosm, x_oosm);
+	runDelayedGps(GPS_NAIVE, rms_naive, lat_naive, x_naive);
+
+	double d_oosm = ublas::norm_2(x_oosm - x_blocking), d_naive = ublas::norm_2(x_naive - x_blocking);
+	cout << "% delayed GPS   rms_error_m   latency_ms   final_diff_to_blocking_m" << endl;
+	cout << "blocking  " << rms_blocking << "  " << lat_blocking*1000. << "  0" << endl;
+	cout << "oosm      " << rms_oosm << "  " << lat_oosm*1000. << "  " << d_oosm << endl;
+	cout << "naive     " << rms_naive << "  " << lat_naive*1000. << "  " << d_naive << endl;
+
+	// the GPS dated in the past is better than the GPS dated at its arrival
+	BOOST_CHECK(rms_oosm < rms_naive);
+	// with the same readings processed, the out-of-sequence update is the chronological one
+	BOOST_CHECK_SMALL(d_oosm, 0.2 * 0.05);
+	BOOST_CHECK(d_oosm < 0.1 * d_naive);
+}
+
+
+BOOST_AUTO_TEST_CASE( test_absloc )
+{
+	test_absloc01();
+}
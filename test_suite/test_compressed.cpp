@@ -0,0 +1,183 @@
+/**
+ * test_compressed.cpp
+ *
+ * \date 17/10/2026
+ * \author jsola
+ *
+ *  \file test_compressed.cpp
+ *
+ *  Test that the compressed Kalman filter gives the same results as the Kalman filter.
+ *
+ * \ingroup rtslam
+ */
+
+// boost unit test includes
+#include <boost/test/auto_unit_test.hpp>
+
+// jafar debug include
+#include "kernel/jafarDebug.hpp"
+
+#include <iostream>
+#include <cmath>
+
+#include "jmath/jblas.hpp"
+#include "jmath/ublasExtra.hpp"
+
+#include "rtslam/kalmanFilter.hpp"
+#include "rtslam/compressedFilter.hpp"
+
+using namespace jblas;
+using namespace jafar;
+using namespace jafar::rtslam;
+using namespace jafar::jmath::ublasExtra;
+using namespace std;
+
+const size_t ROB = 3;
+const size_t LMK = 2;
+const size_t N_LMK = 12;
+
+/// deterministic pseudo-random value, the same for both filters
+static double value(size_t a, size_t b, size_t c)
+{
+	return std::sin(1.3 * a + 2.7 * b + 0.9 * c + 0.1);
+}
+
+static ind_array iaLmk(size_t j) { return ia_set(ROB + j * LMK, ROB + (j + 1) * LMK); }
+
+/// the landmark 1 is deleted at t = 20
+static ind_array iaUsed(size_t n_lmk, size_t t)
+{
+	ind_array ia = ia_set(0, ROB + n_lmk * LMK);
+	return (t > 20 ? ia_complement(ia, iaLmk(1)) : ia);
+}
+
+static void observe(ExtendedKalmanFilterIndirect & filter, size_t t, size_t j, mat & INN_rsl, ind_array & ia_rsl, Innovation & inn, sym_mat & R)
+{
+	ia_rsl = ia_union(ia_set(0, ROB), iaLmk(j));
+	filter.recover(ia_rsl);
+	INN_rsl.resize(LMK, ROB + LMK);
+	for (size_t r = 0; r < LMK; ++r)
+		for (size_t c = 0; c < ROB + LMK; ++c) INN_rsl(r, c) = 0.5 * value(t, j, 10 * r + c);
+	R = 0.01 * identity_mat(LMK);
+	inn.P() = R + prod_JPJt(ublas::project(filter.P(), ia_rsl, ia_rsl), INN_rsl);
+	for (size_t r = 0; r < LMK; ++r) inn.x()(r) = 0.1 * value(j, t, r);
+}
+
+/*
+ * The robot moves along the landmarks and observes the last 4 initialized ones,
+ * with single and stacked corrections, reparametrizations and deletions,
+ * the whole map being read only from time to time.
+ */
+static void run(ExtendedKalmanFilterIndirect & filter, size_t nSteps)
+{
+	for (size_t i = 0; i < ROB; ++i) { filter.x(i) = value(i, 0, 0); filter.P()(i,i) = 0.1; }
+	size_t n_lmk = 0;
+
+	for (size_t t = 0; t < nSteps; ++t)
+	{
+		ind_array ia_x = iaUsed(n_lmk, t);
+		mat F = identity_mat(ROB);
+		for (size_t i = 0; i < ROB; ++i) F(i, (i + 1) % ROB) = 0.1 * value(t, i, 1);
+		sym_mat Q = 1e-3 * identity_mat(ROB);
+		vec xv = ublas::project(filter.x(), ia_set(0, ROB));
+		ublas::project(filter.x(), ia_set(0, ROB)) = prod(F, xv);
+		filter.predict(ia_x, F, ia_set(0, ROB), Q);
+
+		if (n_lmk < N_LMK && t % 2 == 0)
+		{
+			mat G_rs(LMK, ROB), G_y(LMK, LMK);
+			for (size_t r = 0; r < LMK; ++r)
+			{
+				for (size_t c = 0; c < ROB; ++c) G_rs(r, c) = value(t, r, c + 3);
+				for (size_t c = 0; c < LMK; ++c) G_y(r, c) = (r == c ? 1. : 0.2);
+			}
+			for (size_t r = 0; r < LMK; ++r) filter.x(ROB + n_lmk * LMK + r) = value(t, r, 7);
+			++n_lmk;
+			ia_x = iaUsed(n_lmk, t);
+			filter.initialize(ia_x, G_rs, ia_set(0, ROB), iaLmk(n_lmk - 1), G_y, 0.01 * identity_mat(LMK));
+		}
+
+		size_t first = (n_lmk > 4 ? n_lmk - 4 : 0);
+		if (t == 30) first = 0; // loop closure
+		for (size_t j = first; j < n_lmk; ++j)
+		{
+			if (t > 20 && j == 1) continue;
+			Innovation inn(LMK); mat INN_rsl; ind_array ia_rsl; sym_mat R;
+			observe(filter, t, j, INN_rsl, ia_rsl, inn, R);
+			if (t % 3 == 0)
+				filter.stackCorrection(inn, INN_rsl, ia_rsl, R);
+			else
+				filter.correct(ia_x, inn, INN_rsl, ia_rsl, R);
+		}
+		filter.correctAllStacked(ia_x);
+
+		if (t == 12 || t == 24)
+		{
+			// one active and one old landmark, in place
+			mat J = identity_mat(LMK); J(0,1) = 0.5;
+			for (size_t k = 0; k < 2; ++k)
+			{
+				size_t j = (k == 0 ? n_lmk - 1 : 0);
+				vec xl = ublas::project(filter.x(), iaLmk(j));
+				ublas::project(filter.x(), iaLmk(j)) = prod(J, xl);
+				filter.reparametrize(ia_x, J, iaLmk(j), iaLmk(j));
+			}
+		}
+		if (t == 20) filter.liberate(iaLmk(1));
+		if (t % 10 == 9) filter.recover(ia_x);
+	}
+	filter.recover(iaUsed(n_lmk, nSteps));
+}
+
+void test_compressed01(void) {
+	size_t n = ROB + N_LMK * LMK;
+	ExtendedKalmanFilterIndirect ekf(n);
+	CompressedKalmanFilterIndirect cekf(n, 16);
+	run(ekf, 40);
+	run(cekf, 40);
+	double dx = 0., dP = 0.;
+	for (size_t i = 0; i < n; ++i)
+	{
+		if (i >= ROB + LMK && i < ROB + 2*LMK) continue; // liberated
+		dx = std::max(dx, std::fabs(cekf.x(i) - ekf.x(i)));
+		for (size_t j = 0; j < n; ++j)
+		{
+			if (j >= ROB + LMK && j < ROB + 2*LMK) continue;
+			dP = std::max(dP, std::fabs(cekf.P()(i,j) - ekf.P()(i,j)));
+		}
+	}
+	cout << "max error x " << dx << " P " << dP << ", " << cekf.globalUpdates() << " global updates" << endl;
+	BOOST_CHECK_SMALL(dx, 1e-9);
+	BOOST_CHECK_SMALL(dP, 1e-9);
+	BOOST_CHECK(cekf.globalUpdates() < 40);
+}
+
+void test_compressed02(void) {
+	// the marginals of the rest of the map are computed without a global update
+	size_t n = ROB + N_LMK * LMK;
+	ExtendedKalmanFilterIndirect ekf(n);
+	CompressedKalmanFilterIndirect cekf(n, 16);
+	run(ekf, 40);
+	run(cekf, 40);
+	ind_array ia_x = iaUsed(N_LMK, 40);
+	for (size_t k = 0; k < 2; ++k)
+	{
+		Innovation inn(LMK); mat INN_rsl; ind_array ia_rsl; sym_mat R;
+		observe(ekf, 40 + k, N_LMK - 1, INN_rsl, ia_rsl, inn, R);
+		ekf.correct(ia_x, inn, INN_rsl, ia_rsl, R);
+		observe(cekf, 40 + k, N_LMK - 1, INN_rsl, ia_rsl, inn, R);
+		cekf.correct(ia_x, inn, INN_rsl, ia_rsl, R);
+	}
+	size_t nGlobalUpdates = cekf.globalUpdates();
+	sym_mat P_ekf = ublas::project(ekf.P(), iaLmk(0), iaLmk(0));
+	sym_mat P_cekf = cekf.marginal(iaLmk(0));
+	for (size_t i = 0; i < LMK; ++i)
+		for (size_t j = 0; j < LMK; ++j) BOOST_CHECK_SMALL(P_cekf(i,j) - P_ekf(i,j), 1e-9);
+	BOOST_CHECK_EQUAL(cekf.globalUpdates(), nGlobalUpdates);
+}
+
+BOOST_AUTO_TEST_CASE( test_compressed )
+{
+	test_compressed01();
+	test_compressed02();
+}
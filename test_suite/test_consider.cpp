@@ -0,0 +1,151 @@
+/**
+ * test_consider.cpp
+ *
+ * \date 17/10/2026
+ * \author jsola
+ *
+ *  \file test_consider.cpp
+ *
+ *  Test the consider states (Schmidt-Kalman filter) against the Joseph form of the covariance update.
+ *
+ * \ingroup rtslam
+ */
+
+// boost unit test includes
+#include <boost/test/auto_unit_test.hpp>
+
+// jafar debug include
+#include "kernel/jafarDebug.hpp"
+
+#include <iostream>
+#include <cmath>
+
+#include "jmath/jblas.hpp"
+#include "jmath/ublasExtra.hpp"
+
+#include "rtslam/kalmanFilter.hpp"
+#include "rtslam/compressedFilter.hpp"
+
+using namespace jblas;
+using namespace jafar;
+using namespace jafar::rtslam;
+using namespace jafar::jmath::ublasExtra;
+using namespace std;
+
+const size_t N = 8;
+
+/// deterministic pseudo-random value
+static double value(size_t a, size_t b)
+{
+	return std::sin(1.7 * a + 3.1 * b + 0.3);
+}
+
+static void setup(ExtendedKalmanFilterIndirect & filter)
+{
+	mat A(N, N);
+	for (size_t i = 0; i < N; ++i)
+		for (size_t j = 0; j < N; ++j) A(i,j) = value(i, j);
+	filter.P() = prod(A, trans(A)) / (double)N + 0.1 * identity_mat(N);
+	for (size_t i = 0; i < N; ++i) filter.x(i) = value(i, 20);
+}
+
+/// the states 0 1 (robot) and 5 6 (calibration), and a landmark that depends on t
+static void observe(ExtendedKalmanFilterIndirect & filter, size_t t, bool stack)
+{
+	ind_array ia_x = ia_set(0, N);
+	size_t _rsl[5] = { 0, 1, 5, 6, 2 + t % 3 };
+	ind_array ia_rsl(5);
+	for (size_t i = 0; i < 5; ++i) ia_rsl(i) = _rsl[i];
+	filter.recover(ia_rsl);
+	mat INN_rsl(2, 5);
+	for (size_t r = 0; r < 2; ++r)
+		for (size_t c = 0; c < 5; ++c) INN_rsl(r, c) = value(t + r, 10 + c);
+	Innovation inn(2);
+	sym_mat R = 0.01 * identity_mat(2);
+	inn.P() = R + prod_JPJt(ublas::project(filter.P(), ia_rsl, ia_rsl), INN_rsl);
+	for (size_t r = 0; r < 2; ++r) inn.x()(r) = 0.1 * value(r, t);
+	if (stack) filter.stackCorrection(inn, INN_rsl, ia_rsl, R);
+	else filter.correct(ia_x, inn, INN_rsl, ia_rsl, R);
+}
+
+void test_consider01(void) {
+	// one correction, compared to the Joseph form with a zero gain for the consider states
+	ExtendedKalmanFilterIndirect ekf(N), skf(N);
+	setup(ekf); setup(skf);
+	skf.setConsider(ia_set(5, 7));
+	BOOST_CHECK(skf.isConsider(5) && skf.isConsider(6) && !skf.isConsider(4));
+
+	vec x0 = skf.x();
+	sym_mat P0 = skf.P();
+	observe(ekf, 0, false);
+	observe(skf, 0, false);
+
+	// dense Joseph form, with H = -INN and R = Z - H P H'
+	mat H(2, N); H.clear();
+	size_t _rsl[5] = { 0, 1, 5, 6, 2 };
+	for (size_t r = 0; r < 2; ++r)
+		for (size_t c = 0; c < 5; ++c) H(r, _rsl[c]) = -value(r, 10 + c);
+	mat PHt = prod(P0, trans(H));
+	sym_mat R = 0.01 * identity_mat(2);
+	mat Z = prod(H, PHt) + R;
+	mat iZ(2, 2);
+	lu_inv(Z, iZ);
+	mat K = prod(PHt, iZ);
+	row(K, 5) = ublas::zero_vector<double>(2);
+	row(K, 6) = ublas::zero_vector<double>(2);
+	mat IKH = identity_mat(N) - prod(K, H);
+	mat P1 = prod(IKH, mat(prod(P0, trans(IKH)))) + prod(K, mat(prod(R, trans(K))));
+
+	for (size_t i = 0; i < N; ++i)
+	{
+		for (size_t j = 0; j < N; ++j) BOOST_CHECK_SMALL(skf.P()(i,j) - P1(i,j), 1e-12);
+		bool consider = (i == 5 || i == 6);
+		// the consider states do not move, the others move as with the EKF
+		BOOST_CHECK_SMALL(skf.x(i) - (consider ? x0(i) : ekf.x(i)), 1e-12);
+		// less information is used: the filter is less confident
+		BOOST_CHECK(skf.P()(i,i) >= ekf.P()(i,i) - 1e-12);
+	}
+}
+
+void test_consider02(void) {
+	// single and stacked corrections, the consider states being estimated every 4 corrections
+	ExtendedKalmanFilterIndirect ekf(N), skf(N);
+	CompressedKalmanFilterIndirect cekf(N, 6);
+	setup(ekf); setup(skf); setup(cekf);
+	skf.setConsider(ia_set(5, 7));
+	cekf.setConsider(ia_set(5, 7));
+	double dx = 0.;
+	for (size_t t = 0; t < 12; ++t)
+	{
+		bool estimate = (t % 4 == 0);
+		skf.estimateConsidered(estimate);
+		cekf.estimateConsidered(estimate);
+		vec x = skf.x();
+		bool stack = (t % 3 == 0);
+		observe(ekf, t, stack); observe(skf, t, stack); observe(cekf, t, stack);
+		if (stack) { ekf.correctAllStacked(ia_set(0, N)); skf.correctAllStacked(ia_set(0, N)); cekf.correctAllStacked(ia_set(0, N)); }
+		if (!estimate) dx = std::max(dx, std::fabs(skf.x(5) - x(5)) + std::fabs(skf.x(6) - x(6)));
+		if (t == 0) BOOST_CHECK_SMALL(ublas::norm_inf(skf.x() - ekf.x()), 1e-12);
+	}
+	BOOST_CHECK(dx == 0.);
+	BOOST_CHECK(skf.consideredStates().size() == 2);
+
+	// the compressed filter gives the same Schmidt-Kalman filter
+	cekf.recover(ia_set(0, N));
+	for (size_t i = 0; i < N; ++i)
+	{
+		BOOST_CHECK_SMALL(cekf.x(i) - skf.x(i), 1e-9);
+		for (size_t j = 0; j < N; ++j) BOOST_CHECK_SMALL(cekf.P()(i,j) - skf.P()(i,j), 1e-9);
+	}
+
+	// the states are estimated again
+	skf.setConsider(ia_set(5, 7), false);
+	BOOST_CHECK(skf.consideredStates().size() == 0);
+	cout << "ekf " << ekf.x() << "\nskf " << skf.x() << endl;
+}
+
+BOOST_AUTO_TEST_CASE( test_consider )
+{
+	test_consider01();
+	test_consider02();
+}
@@ -0,0 +1,177 @@
+/**
+ * test_fast.cpp
+ *
+ * \date 17/10/2026
+ * \author jsola@laas.fr
+ *
+ *  \file test_fast.cpp
+ *
+ *  Test the FAST detector: segment test against a direct implementation, corners of a square, scores.
+ *
+ * \ingroup rtslam
+ */
+
+// boost unit test includes
+#include <boost/test/auto_unit_test.hpp>
+
+// jafar debug include
+#include "kernel/jafarDebug.hpp"
+
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "jmath/jblas.hpp"
+#include "image/Image.hpp"
+#include "image/roi.hpp"
+#include "rtslam/featurePoint.hpp"
+#include "rtslam/fastDetector.hpp"
+
+using namespace jafar;
+using namespace jafar::rtslam;
+using namespace jblas;
+using namespace std;
+
+const int IMG_W = 100;
+const int IMG_H = 60;
+
+/// a bright square on a dark background, from (x0,y0) to (x1,y1) excluded
+static void fillSquare(image::Image & img, int x0, int y0, int x1, int y1)
+{
+	for (int i = 0; i < img.height(); ++i)
+		for (int j = 0; j < img.width(); ++j)
+			img.data()[i * img.step() + j] = (i >= y0 && i < y1 && j >= x0 && j < x1 ? 200 : 40);
+}
+
+/// the segment test, written directly from its definition
+static bool isCorner(const image::Image & img, int x, int y, int arc, int threshold)
+{
+	static const int cx[16] = { 0, 1, 2, 3, 3, 3, 2, 1, 0, -1, -2, -3, -3, -3, -2, -1 };
+	static const int cy[16] = { -3, -3, -2, -1, 0, 1, 2, 3, 3, 3, 2, 1, 0, -1, -2, -3 };
+	int c = img.data()[y * img.step() + x];
+	for (int sign = -1; sign <= 1; sign += 2)
+		for (int start = 0; start < 16; ++start)
+		{
+			int n = 0;
+			while (n < arc)
+			{
+				int k = (start + n) % 16;
+				int p = img.data()[(y + cy[k]) * img.step() + x + cx[k]];
+				if (sign * (p - c) <= threshold) break;
+				++n;
+			}
+			if (n == arc) return true;
+		}
+	return false;
+}
+
+void test_fast01(void) {
+	// the number of candidates is the one of the direct segment test, on random texture
+	image::Image img(IMG_W, IMG_H, CV_8U, JfrImage_CS_GRAY);
+	std::srand(1);
+	for (int i = 0; i < IMG_H; ++i)
+		for (int j = 0; j < IMG_W; ++j)
+			img.data()[i * img.step() + j] = (unsigned char)(std::rand() % 256);
+	// saturated pixels
+	for (int j = 0; j < IMG_W; ++j) { img.data()[10 * img.step() + j] = 255; img.data()[20 * img.step() + j] = 0; }
+
+	const int arcs[2] = { 9, 12 };
+	for (int a = 0; a < 2; ++a)
+	{
+		unsigned n = 0;
+		for (int i = 3; i < IMG_H - 3; ++i)
+			for (int j = 3; j < IMG_W - 3; ++j)
+				if (isCorner(img, j, i, arcs[a], 30)) ++n;
+		FastDetector detector(arcs[a], 30);
+		std::vector<FastDetector::corner_t> corners;
+		detector.detectAll(img, corners);
+		cout << "FAST-" << arcs[a] << ": " << detector.nCandidates() << " candidates, " << corners.size() << " corners" << endl;
+		BOOST_CHECK_EQUAL(detector.nCandidates(), n);
+		BOOST_CHECK(n > 0);
+		BOOST_CHECK(corners.size() > 0 && corners.size() <= n);
+		// no two corners are neighbors after the suppression
+		for (size_t k = 0; k < corners.size(); ++k)
+			for (size_t l = k + 1; l < corners.size(); ++l)
+				BOOST_CHECK(std::abs(corners[k].x - corners[l].x) > 1 || std::abs(corners[k].y - corners[l].y) > 1);
+	}
+}
+
+void test_fast02(void) {
+	// the 4 corners of a square, and nothing on its edges
+	image::Image img(IMG_W, IMG_H, CV_8U, JfrImage_CS_GRAY);
+	fillSquare(img, 30, 20, 70, 45);
+	FastDetector detector(9, 30);
+	std::vector<FastDetector::corner_t> corners;
+	detector.detectAll(img, corners);
+	const int cx[4] = { 30, 69, 30, 69 }, cy[4] = { 20, 20, 44, 44 };
+	BOOST_CHECK_EQUAL(corners.size(), 4u);
+	for (size_t k = 0; k < corners.size(); ++k)
+	{
+		cout << "corner " << corners[k].x << " " << corners[k].y << " score " << corners[k].score << endl;
+		int best = 100;
+		for (int c = 0; c < 4; ++c) best = std::min(best, std::abs(corners[k].x - cx[c]) + std::abs(corners[k].y - cy[c]));
+		BOOST_CHECK(best <= 2);
+	}
+}
+
+void test_fast03(void) {
+	// the best point of a region, with the FAST and the Harris scores
+	image::Image img(IMG_W, IMG_H, CV_8U, JfrImage_CS_GRAY);
+	fillSquare(img, 30, 20, 70, 45);
+	vec exp(2); exp(0) = 68.; exp(1) = 22.;
+	sym_mat P = 4. * identity_mat(2);
+	image::ConvexRoi roi(exp, P, 3.);
+
+	feat_img_pnt_ptr_t featPtr(new FeatureImagePoint(11, 11, CV_8U));
+	FastDetector fast(9, 30);
+	BOOST_CHECK(fast.detectIn(img, featPtr, &roi));
+	BOOST_CHECK_SMALL(featPtr->measurement.x()(0) - 69.5, 2.);
+	BOOST_CHECK_SMALL(featPtr->measurement.x()(1) - 20.5, 2.);
+
+	FastDetector harris(9, 30, true, 5, 15., 2.);
+	BOOST_CHECK(harris.detectIn(img, featPtr, &roi));
+	BOOST_CHECK_SMALL(featPtr->measurement.x()(0) - 69.5, 2.);
+	BOOST_CHECK_SMALL(featPtr->measurement.x()(1) - 20.5, 2.);
+
+	// an edge only, no corner
+	exp(0) = 50.; exp(1) = 20.;
+	image::ConvexRoi roiEdge(exp, P, 3.);
+	BOOST_CHECK(!fast.detectIn(img, featPtr, &roiEdge));
+	BOOST_CHECK(!harris.detectIn(img, featPtr, &roiEdge));
+}
+
+void test_fast04(void) {
+	// the corners in the bounding box of an elliptic region but outside the ellipse are not detected
+	image::Image img(IMG_W, IMG_H, CV_8U, JfrImage_CS_GRAY);
+	fillSquare(img, 30, 20, 70, 45);
+	vec exp(2); exp(0) = 50.; exp(1) = 32.5;
+	sym_mat P(2); P.clear(); P(0,0) = 64.; P(1,1) = 25.;
+	image::ConvexRoi roi(exp, P, 3.);
+	BOOST_CHECK(roi.x() <= 30 && roi.x() + roi.w() > 69 && roi.y() <= 20 && roi.y() + roi.h() > 44);
+
+	FastDetector detector(9, 30);
+	std::vector<FastDetector::corner_t> corners;
+	detector.detectAll(img, corners);
+	BOOST_CHECK_EQUAL(corners.size(), 4u);
+	detector.detectAll(img, corners, &roi);
+	BOOST_CHECK_EQUAL(corners.size(), 0u);
+	BOOST_CHECK_EQUAL(detector.nCandidates(), 0u);
+
+	feat_img_pnt_ptr_t featPtr(new FeatureImagePoint(11, 11, CV_8U));
+	BOOST_CHECK(!detector.detectIn(img, featPtr, &roi));
+
+	// a larger ellipse contains them
+	image::ConvexRoi roiLarge(exp, P, 4.);
+	detector.detectAll(img, corners, &roiLarge);
+	BOOST_CHECK_EQUAL(corners.size(), 4u);
+	BOOST_CHECK(detector.detectIn(img, featPtr, &roiLarge));
+}
+
+BOOST_AUTO_TEST_CASE( test_fast )
+{
+	test_fast01();
+	test_fast02();
+	test_fast03();
+	test_fast04();
+}
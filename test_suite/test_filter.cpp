@@ -18,11 +18,14 @@
 #include "kernel/jafarDebug.hpp"
 
 
+#include "rtslam/rtSlam.hpp"
 #include "rtslam/kalmanFilter.hpp"
 #include <iostream>
+#include <cmath>
 #include "jmath/matlab.hpp"
 #include "jmath/random.hpp"
 #include "jmath/indirectArray.hpp"
+#include "jmath/ublasExtra.hpp"
 
 void test_filter01(void) {
 
@@ -72,9 +75,212 @@ void test_filter01(void) {
 
 }
 
+void test_filter02(void) {
+
+	using namespace jafar::rtslam;
+	using namespace jafar::jmath;
+	using namespace std;
+
+	// inertial-like structure, 7 states of robot out of 12 used states
+	size_t max_size = 14;
+	size_t motion_size = 7;
+	ExtendedKalmanFilterIndirect filter_dense(max_size), filter_blocks(max_size);
+	jblas::mat A(max_size, max_size);
+	randMatrix(A);
+	filter_dense.P() = prod(A, trans(A));
+	filter_blocks.P() = filter_dense.P();
+
+	BlockJacobian F_blocks(motion_size);
+	F_blocks.addIdentity(0, 3);
+	F_blocks.addBlock(0, 3, 3, 2);
+	F_blocks.addBlock(3, 3, 2, 2);
+	jblas::mat F_v(motion_size, motion_size);
+	F_v.assign(jblas::identity_mat(motion_size));
+	jblas::mat F_32(3, 2); randMatrix(F_32);
+	jblas::mat F_22(2, 2); randMatrix(F_22);
+	ublas::subrange(F_v, 0, 3, 3, 5) = F_32;
+	ublas::subrange(F_v, 3, 5, 3, 5) = F_22;
+	jblas::sym_mat Q(motion_size);
+	randMatrix(Q);
+
+	jblas::ind_array iax = jafar::jmath::ublasExtra::ia_set(0, 12);
+	jblas::ind_array iav = jafar::jmath::ublasExtra::ia_set(2, 9);
+
+	filter_dense.predict(iax, F_v, iav, Q);
+	filter_blocks.predict(iax, F_v, F_blocks, iav, Q);
+
+	cout << "F_blocks.cost = " << F_blocks.cost() << " instead of " << motion_size*motion_size << endl;
+	double err = ublas::norm_frobenius(filter_dense.P() - filter_blocks.P());
+	BOOST_CHECK(err < 1e-10 * ublas::norm_frobenius(filter_dense.P()));
+}
+
+/*
+ * Consistency of the filter: average NEES of a linear robot-landmark problem over Monte-Carlo runs.
+ */
+void test_filter03(void) {
+
+	using namespace jafar::rtslam;
+	using namespace jafar::jmath;
+	using namespace std;
+
+	const size_t n_lmks = 10, n_steps = 20, n_runs = 50;
+	const size_t size = 3 + 3*n_lmks;
+	const double q = 0.01, r = 0.01, l0 = 1.;
+	jblas::ind_array iax = ublasExtra::ia_set(0, size);
+	jblas::ind_array iar = ublasExtra::ia_set(0, 3);
+	jblas::mat F_v(jblas::identity_mat(3));
+	jblas::sym_mat Q(jblas::identity_mat(3) * q);
+	jblas::sym_mat R(jblas::identity_mat(3) * r);
+	jblas::mat INN_rl(3, 6); INN_rl.clear();
+	ublas::subrange(INN_rl, 0, 3, 0, 3) = jblas::identity_mat(3);
+	ublas::subrange(INN_rl, 0, 3, 3, 6) = -jblas::identity_mat(3);
+	jblas::vec zero3(3); zero3.clear();
+
+	// fixed seeds, so that the test is deterministic
+	MultiDimNormalDistribution pert(zero3, jblas::scalar_vec(3, q), 1);
+	MultiDimNormalDistribution noise(zero3, jblas::scalar_vec(3, r), 2);
+	MultiDimNormalDistribution prior(zero3, jblas::scalar_vec(3, l0), 3);
+
+	double nees = 0.;
+	for (size_t run = 0; run < n_runs; ++run)
+	{
+		ExtendedKalmanFilterIndirect filter(size);
+		jblas::vec x_true(size); x_true.clear();
+		for (size_t l = 0; l < n_lmks; ++l)
+		{
+			ublas::subrange(x_true, 3+3*l, 6+3*l) = 10. * ublas::scalar_vector<double>(3, l);
+			ublas::subrange(filter.x(), 3+3*l, 6+3*l) = ublas::subrange(x_true, 3+3*l, 6+3*l) + prior.get();
+			for (size_t i = 3+3*l; i < 6+3*l; ++i) filter.P(i, i) = l0;
+		}
+
+		for (size_t step = 0; step < n_steps; ++step)
+		{
+			// move robot
+			ublas::subrange(x_true, 0, 3) += pert.get();
+			filter.predict(iax, F_v, iar, Q);
+			// observe all landmarks
+			for (size_t l = 0; l < n_lmks; ++l)
+			{
+				jblas::ind_array ia_rl = ublasExtra::ia_union(iar, ublasExtra::ia_set(3+3*l, 6+3*l));
+				jblas::vec z = ublas::subrange(x_true, 3+3*l, 6+3*l) - ublas::subrange(x_true, 0, 3) + noise.get();
+				Innovation inn(3);
+				inn.x() = z - (ublas::subrange(filter.x(), 3+3*l, 6+3*l) - ublas::subrange(filter.x(), 0, 3));
+				inn.P() = ublasExtra::prod_JPJt(ublas::project(filter.P(), ia_rl, ia_rl), INN_rl) + R;
+				filter.correct(iax, inn, INN_rl, ia_rl, R);
+			}
+		}
+
+		jblas::vec err = x_true - filter.x();
+		jblas::sym_mat iP(size);
+		ublasExtra::lu_inv(filter.P(), iP);
+		nees += ublas::inner_prod(err, ublas::prod(iP, err));
+	}
+	nees /= n_runs;
+
+	double bound = 3. * sqrt(2. * size / n_runs);
+	cout << "average NEES = " << nees << " for " << size << " states (bounds +-" << bound << ")" << endl;
+	BOOST_CHECK(std::abs(nees - size) < bound);
+}
+
+void test_filter04(void) {
+
+	using namespace jafar::rtslam;
+	using namespace jafar::jmath;
+	using namespace std;
+
+	// reparametrize two 7-states landmarks into 3-states ones, in place, one by one and stacked
+	size_t size = 20;
+	ExtendedKalmanFilterIndirect filter_seq(size), filter_stack(size);
+	jblas::mat A(size, size);
+	randMatrix(A);
+	filter_seq.P() = prod(A, trans(A));
+	filter_stack.P() = filter_seq.P();
+	jblas::mat J1(3, 7), J2(3, 7);
+	randMatrix(J1); randMatrix(J2);
+	jblas::ind_array iax = ublasExtra::ia_set(0, size);
+	jblas::ind_array ia_old1 = ublasExtra::ia_set(6, 13), ia_new1 = ublasExtra::ia_set(6, 9);
+	jblas::ind_array ia_old2 = ublasExtra::ia_set(13, 20), ia_new2 = ublasExtra::ia_set(13, 16);
+
+	filter_seq.reparametrize(iax, J1, ia_old1, ia_new1);
+	filter_seq.reparametrize(iax, J2, ia_old2, ia_new2);
+	filter_stack.stackReparametrization(J1, ia_old1, ia_new1);
+	filter_stack.stackReparametrization(J2, ia_old2, ia_new2);
+	filter_stack.reparametrizeAllStacked(iax);
+
+	jblas::ind_array ia_used = ublasExtra::ia_union(ublasExtra::ia_set(0, 9), ublasExtra::ia_set(13, 16));
+	jblas::sym_mat P_seq = ublas::project(filter_seq.P(), ia_used, ia_used);
+	jblas::sym_mat P_stack = ublas::project(filter_stack.P(), ia_used, ia_used);
+	double err = ublas::norm_frobenius(P_seq - P_stack);
+	BOOST_CHECK(err < 1e-10 * ublas::norm_frobenius(P_seq));
+}
+
+void test_filter05(void) {
+
+	using namespace jafar::rtslam;
+	using namespace jafar::jmath;
+	using namespace std;
+
+	// two anchored points sharing their anchor: initialize the second one on its own states only,
+	// and check that it is the same as initializing both at once
+	size_t size = 20;
+	ExtendedKalmanFilterIndirect filter_shared(size), filter_joint(size);
+	jblas::mat A(7, 7);
+	randMatrix(A);
+	jblas::ind_array ia_rs = ublasExtra::ia_set(0, 7);
+	ublas::project(filter_shared.P(), ia_rs, ia_rs) = prod(A, trans(A));
+	filter_joint.P() = filter_shared.P();
+	jblas::ind_array iax = ublasExtra::ia_set(0, size);
+
+	jblas::mat G_rs1(7, 7), G_rs2(4, 7), G_y1(7, 2), G_y2(4, 2);
+	randMatrix(G_rs1); randMatrix(G_rs2); randMatrix(G_y1); randMatrix(G_y2);
+	ublas::subrange(G_rs1, 0, 3, 0, 7) = ublas::zero_matrix<double>(3, 7);
+	ublas::subrange(G_rs1, 0, 3, 0, 3) = jblas::identity_mat(3); // the anchor is the sensor position
+	ublas::subrange(G_y1, 0, 3, 0, 2) = ublas::zero_matrix<double>(3, 2);
+	jblas::sym_mat R1 = jblas::identity_mat(2), R2 = 2. * jblas::identity_mat(2);
+
+	filter_shared.initialize(iax, G_rs1, ia_rs, ublasExtra::ia_set(7, 14), G_y1, R1);
+	filter_shared.initialize(iax, G_rs2, ia_rs, ublasExtra::ia_set(14, 18), G_y2, R2);
+
+	jblas::mat G_rs(11, 7), G_y(11, 2), G_n(11, 2);
+	G_y.clear(); G_n.clear();
+	ublas::subrange(G_rs, 0, 7, 0, 7) = G_rs1;
+	ublas::subrange(G_rs, 7, 11, 0, 7) = G_rs2;
+	ublas::subrange(G_y, 0, 7, 0, 2) = G_y1;
+	ublas::subrange(G_n, 7, 11, 0, 2) = G_y2;
+	filter_joint.initialize(iax, G_rs, ia_rs, ublasExtra::ia_set(7, 18), G_y, R1, G_n, R2);
+
+	jblas::ind_array ia_used = ublasExtra::ia_set(0, 18);
+	jblas::sym_mat P_shared = ublas::project(filter_shared.P(), ia_used, ia_used);
+	jblas::sym_mat P_joint = ublas::project(filter_joint.P(), ia_used, ia_used);
+	double err = ublas::norm_frobenius(P_shared - P_joint);
+	BOOST_CHECK(err < 1e-10 * ublas::norm_frobenius(P_joint));
+
+	// reparametrize the first point on its own states: the cross-variances with
+	// the anchor, still used by the second point, must be kept
+	jblas::mat J(3, 7);
+	randMatrix(J);
+	jblas::ind_array ia_old = ublasExtra::ia_set(7, 14), ia_new = ublasExtra::ia_set(10, 13);
+	jblas::ind_array ia_keep = ublasExtra::ia_union(ublasExtra::ia_set(0, 10), ublasExtra::ia_set(14, 18));
+	jblas::mat P_new_keep = prod(J, ublas::project(P_shared, ia_old, ia_keep));
+	filter_shared.stackReparametrization(J, ia_old, ia_new);
+	filter_shared.reparametrizeAllStacked(ia_used);
+	err = ublas::norm_frobenius(ublas::project(filter_shared.P(), ia_new, ia_keep) - P_new_keep);
+	BOOST_CHECK(err < 1e-10 * ublas::norm_frobenius(P_new_keep));
+
+	// same with the single reparametrization
+	P_new_keep = prod(J, ublas::project(P_joint, ia_old, ia_keep));
+	filter_joint.reparametrize(ia_used, J, ia_old, ia_new);
+	err = ublas::norm_frobenius(ublas::project(filter_joint.P(), ia_new, ia_keep) - P_new_keep);
+	BOOST_CHECK(err < 1e-10 * ublas::norm_frobenius(P_new_keep));
+}
+
 
 BOOST_AUTO_TEST_CASE( test_filter )
 {
 	test_filter01();
+	test_filter02();
+	test_filter03();
+	test_filter04();
+	test_filter05();
 }
 
@@ -420,6 +420,22 @@ void test_gaussian05(){
 	cout << "NEES_err = NEES - NEES_mat" << endl;
 }
 
+void test_gaussian06(){
+	// remote Gaussian with a covariances block of its own, and a part of it
+	vec x(10); x.clear();
+	sym_mat B(4);
+	randMatrix(B, 4, 4);
+	Gaussian Gb(x, ublasExtra::ia_set(5, 9), B);
+	Gaussian Gp(Gb, ublasExtra::ia_set(1, 3));
+	BOOST_CHECK_EQUAL(Gp.ia()(0), 6u);
+	BOOST_CHECK_EQUAL(Gp.P()(1,0), B(2,1));
+	x(7) = 3.;
+	BOOST_CHECK_EQUAL(Gp.x()(1), 3.);
+	Gaussian Gc(Gb);
+	Gc.P()(0,3) = -1.;
+	BOOST_CHECK_EQUAL(B(3,0), -1.);
+}
+
 BOOST_AUTO_TEST_CASE( test_gaussian )
 {
 	test_gaussian01();
@@ -427,5 +443,6 @@ BOOST_AUTO_TEST_CASE( test_gaussian )
 	test_gaussian03();
 	test_gaussian04();
 	test_gaussian05();
+	test_gaussian06();
 }
 
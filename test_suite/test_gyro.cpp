@@ -0,0 +1,181 @@
+/**
+ * test_gyro.cpp
+ *
+ * \date 17/10/2026
+ * \author jsola
+ *
+ *  \file test_gyro.cpp
+ *
+ *  Test the search regions of the points predicted with the gyrometers.
+ *
+ * \ingroup rtslam
+ */
+
+// boost unit test includes
+#include <boost/test/auto_unit_test.hpp>
+
+// jafar debug include
+#include "kernel/jafarDebug.hpp"
+
+#include <iostream>
+#include <boost/shared_ptr.hpp>
+
+#include "jmath/jblas.hpp"
+#include "jmath/ublasExtra.hpp"
+
+#include "rtslam/rtSlam.hpp"
+#include "rtslam/quatTools.hpp"
+#include "rtslam/robotConstantVelocity.hpp"
+#include "rtslam/sensorPinhole.hpp"
+#include "rtslam/landmarkAnchoredHomogeneousPoint.hpp"
+#include "rtslam/landmarkEuclideanPoint.hpp"
+#include "rtslam/observationPinHoleAnchoredHomogeneous.hpp"
+#include "rtslam/observationFactory.hpp"
+#include "rtslam/observationMakers.hpp"
+#include "rtslam/activeSearch.hpp"
+#include "rtslam/simuRawProcessors.hpp"
+#include "rtslam/dataManagerOnePointRansac.hpp"
+
+using namespace jblas;
+using namespace jafar;
+using namespace jafar::rtslam;
+using namespace std;
+
+/// gyrometer readings given by hand, a line is [t wx wy wz]
+class HardwareEstimatorGyroTest: public hardware::HardwareEstimatorAbstract
+{
+	public:
+		jblas::mat buffer;
+		HardwareEstimatorGyroTest(): buffer(0,4) {}
+		jblas::mat_indirect acquireReadings(double t1, double t2)
+		{
+			return ublas::project(buffer, jmath::ublasExtra::ia_set(0,buffer.size1()), jmath::ublasExtra::ia_set(0,4));
+		}
+		void releaseReadings() {}
+		jblas::ind_array instantValues() { return jmath::ublasExtra::ia_set(1,4); }
+		jblas::ind_array incrementValues() { return jmath::ublasExtra::ia_set(1,1); }
+		/// constant angular velocity w from t0 to t1, a reading every dt
+		void set(double t0, double t1, double dt, const vec3 & w)
+		{
+			size_t n = (size_t)((t1 - t0) / dt + 0.5) + 1;
+			buffer.resize(n, 4, false);
+			for (size_t i = 0; i < n; ++i) { buffer(i,0) = t0 + i * dt; for (size_t j = 0; j < 3; ++j) buffer(i,1+j) = w(j); }
+		}
+};
+
+typedef DataManagerOnePointRansac<simu::RawSimu, SensorPinhole, simu::FeatureSimu, image::ConvexRoi, ActiveSearchGrid,
+	simu::DetectorSimu<image::ConvexRoi>, simu::MatcherSimu<image::ConvexRoi> > DataManagerSimu;
+
+/// gives access to the gyrometer aid
+class DataManagerGyroTest: public DataManagerSimu
+{
+	public:
+		DataManagerGyroTest(const boost::shared_ptr<simu::DetectorSimu<image::ConvexRoi> > & _detector,
+			const boost::shared_ptr<simu::MatcherSimu<image::ConvexRoi> > & _matcher, const boost::shared_ptr<ActiveSearchGrid> _featMan):
+			DataManagerSimu(_detector, _matcher, _featMan, 10, 5, 3, 5, 3) {}
+		using DataManagerSimu::expectedPointRoi;
+		using DataManagerSimu::predictGyroPose;
+		using DataManagerSimu::saveGyroPose;
+		bool gyroValid() const { return gyroAid.valid; }
+		const vec7 & gyroSenPose() const { return *gyroAid.senPosePtr; }
+};
+
+void test_gyro01(void) {
+	// a camera on a robot rotating fast, that the constant velocity model did not predict
+	map_ptr_t mapPtr(new MapAbstract(100));
+	robconstvel_ptr_t robPtr(new RobotConstantVelocity(mapPtr));
+	robPtr->id(robPtr->robotIds.getId());
+	robPtr->linkToParentMap(mapPtr);
+	robPtr->pose.x(quaternion::originFrame());
+	robPtr->state.P() = 1e-4 * jblas::identity_mat(robPtr->state.size());
+
+	pinhole_ptr_t senPtr(new SensorPinhole(robPtr, MapObject::UNFILTERED));
+	senPtr->id(senPtr->sensorIds.getId());
+	senPtr->linkToParentRobot(robPtr);
+	vec4 k; k(0) = 320; k(1) = 240; k(2) = 320; k(3) = 320;
+	vec d(0);
+	senPtr->params.setImgSize(640, 480);
+	senPtr->params.setIntrinsicCalibration(k, d, d.size());
+	senPtr->pose.x(quaternion::originFrame());
+
+	landmark_factory_ptr_t lmkFactory(new LandmarkFactory<LandmarkAnchoredHomogeneousPoint, LandmarkEuclideanPoint>());
+	map_manager_ptr_t mmPoint(new MapManager(lmkFactory));
+	mmPoint->linkToParentMap(mapPtr);
+	boost::shared_ptr<ObservationFactory> obsFactory(new ObservationFactory());
+	obsFactory->addMaker(boost::shared_ptr<ObservationMakerAbstract>(new ImagePointObservationMaker<
+		ObservationPinHoleAnchoredHomogeneousPoint, SensorPinhole, LandmarkAnchoredHomogeneousPoint,
+		AppearanceImagePoint, SensorAbstract::PINHOLE, LandmarkAbstract::PNT_AH>(0.5, 11)));
+
+	const double measStd = 1.0, mahalanobisTh = 3.0;
+	boost::shared_ptr<simu::DetectorSimu<image::ConvexRoi> > detector(new simu::DetectorSimu<image::ConvexRoi>(LandmarkAbstract::POINT, 2, 11, measStd, measStd));
+	boost::shared_ptr<simu::MatcherSimu<image::ConvexRoi> > matcher(new simu::MatcherSimu<image::ConvexRoi>(LandmarkAbstract::POINT, 2, 11, 1000000, 2.0, 0.8, mahalanobisTh, 2.0, measStd, measStd));
+	boost::shared_ptr<ActiveSearchGrid> asGrid(new ActiveSearchGrid(640, 480, 4, 4, 10, 5));
+	boost::shared_ptr<DataManagerGyroTest> dmPtr(new DataManagerGyroTest(detector, matcher, asGrid));
+	dmPtr->linkToParentSensorSpec(senPtr);
+	dmPtr->linkToParentMapManager(mmPoint);
+	dmPtr->setObservationFactory(obsFactory);
+	boost::shared_ptr<HardwareEstimatorGyroTest> estimator(new HardwareEstimatorGyroTest());
+	dmPtr->setGyroAid(estimator, 1, 0.001, 0.001);
+
+	// a point at 4m, with a well known position
+	observation_ptr_t obsPtr = mmPoint->createNewLandmark(dmPtr);
+	landmark_ptr_t lmkPtr = obsPtr->landmarkPtr();
+	vec u(2), r(1), ahp(7);
+	u(0) = 400; u(1) = 260;
+	r(0) = 0.25;
+	obsPtr->model->backProject_func(senPtr->globalPose(), u, r, ahp);
+	lmkPtr->state.x(ahp);
+	lmkPtr->state.P() = 1e-8 * jblas::identity_mat(lmkPtr->state.size());
+
+	// frame at t=0, then 0.1 rad about the robot y axis in 0.1s
+	dmPtr->saveGyroPose(0.0);
+	vec3 w; w(0) = 0.; w(1) = 1.; w(2) = 0.;
+	estimator->set(0.0, 0.1, 0.01, w);
+	vec3 rot = 0.1 * w;
+	vec4 q_true = quaternion::v2q(rot);
+	vec7 sg_true = quaternion::originFrame();
+	ublas::subrange(sg_true, 3, 7) = q_true;
+	vec u_true, nobs;
+	obsPtr->model->project_func(sg_true, ahp, u_true, nobs);
+
+	// the motion model predicts no rotation, with a large orientation uncertainty
+	for (size_t i = 3; i < 7; ++i) robPtr->state.P()(i,i) = 5e-3;
+	obsPtr->project();
+	image::ConvexRoi unaidedRoi(obsPtr->expectation.x(), obsPtr->expectation.P() + jmath::sqr(measStd)*identity_mat(2), mahalanobisTh);
+	cout << "true projection " << u_true << ", expected " << obsPtr->expectation.x() << ", unaided region " << unaidedRoi.count() << " pixels" << endl;
+	BOOST_CHECK(unaidedRoi.isIn(u_true));
+
+	// the gyrometers predict the right orientation, and a much smaller region that contains the point
+	dmPtr->predictGyroPose(0.1);
+	BOOST_CHECK(dmPtr->gyroValid());
+	for (size_t i = 0; i < 4; ++i) BOOST_CHECK_SMALL(dmPtr->gyroSenPose()(3+i) - q_true(i), 1e-9);
+	image::ConvexRoi gyroRoi = dmPtr->expectedPointRoi(obsPtr);
+	cout << "gyro region " << gyroRoi.count() << " pixels" << endl;
+	BOOST_CHECK_EQUAL(dmPtr->matchStats.nGyroRoi, 1u);
+	BOOST_CHECK(gyroRoi.isIn(u_true));
+	BOOST_CHECK(gyroRoi.count() < unaidedRoi.count());
+	BOOST_CHECK_EQUAL(obsPtr->searchSize, gyroRoi.count());
+
+	// the estimate of this frame is the start of the next one: no rotation, same orientation
+	robPtr->pose.x(sg_true);
+	robPtr->state.P() = 1e-4 * jblas::identity_mat(robPtr->state.size());
+	dmPtr->saveGyroPose(0.1);
+	w(1) = 0.;
+	estimator->set(0.1, 0.2, 0.01, w);
+	dmPtr->predictGyroPose(0.2);
+	BOOST_CHECK(dmPtr->gyroValid());
+	for (size_t i = 0; i < 4; ++i) BOOST_CHECK_SMALL(dmPtr->gyroSenPose()(3+i) - q_true(i), 1e-9);
+
+	// without readings, the region of the filter is used
+	estimator->buffer.resize(0, 4, false);
+	dmPtr->predictGyroPose(0.3);
+	BOOST_CHECK(!dmPtr->gyroValid());
+	obsPtr->project();
+	dmPtr->expectedPointRoi(obsPtr);
+	BOOST_CHECK_EQUAL(dmPtr->matchStats.nGyroRoi, 1u);
+}
+
+BOOST_AUTO_TEST_CASE( test_gyro )
+{
+	test_gyro01();
+}
@@ -0,0 +1,56 @@
+/**
+ * test_heap.cpp
+ *
+ * \date 17/10/2026
+ * \author jsola@laas.fr
+ *
+ *  \file test_heap.cpp
+ *
+ *  Test the indexed heap of the landmark utilities.
+ *
+ * \ingroup rtslam
+ */
+
+// boost unit test includes
+#include <boost/test/auto_unit_test.hpp>
+
+// jafar debug include
+#include "kernel/jafarDebug.hpp"
+
+#include <iostream>
+#include <map>
+#include <cstdlib>
+
+#include "rtslam/indexedHeap.hpp"
+
+using namespace jafar;
+using namespace jafar::rtslam;
+using namespace std;
+
+void test_heap01(void) {
+	// the top of the heap is always the lowest score, while scores are changed and keys removed
+	IndexedMinHeap<size_t> heap;
+	std::map<size_t, double> ref;
+	srand(1);
+	for (int n = 0; n < 2000; ++n)
+	{
+		size_t key = rand() % 50;
+		int op = rand() % 4;
+		if (op == 0) { heap.remove(key); ref.erase(key); }
+		else if (op == 1 && !heap.empty()) { ref.erase(heap.topKey()); heap.pop(); }
+		else { double score = rand() / (double)RAND_MAX; heap.update(key, score); ref[key] = score; }
+
+		BOOST_REQUIRE_EQUAL(heap.size(), ref.size());
+		if (ref.empty()) continue;
+		size_t minKey = ref.begin()->first;
+		for (std::map<size_t, double>::iterator it = ref.begin(); it != ref.end(); ++it)
+			if (it->second < ref[minKey]) minKey = it->first;
+		BOOST_CHECK_EQUAL(heap.topScore(), ref[minKey]);
+		BOOST_CHECK(heap.contains(key) == (ref.find(key) != ref.end()));
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_heap )
+{
+	test_heap01();
+}
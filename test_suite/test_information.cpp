@@ -0,0 +1,261 @@
+/**
+ * test_information.cpp
+ *
+ * \date 17/10/2026
+ * \author jsola
+ *
+ *  \file test_information.cpp
+ *
+ *  Test the sparse information filter against the Kalman filter on a linear problem,
+ *  and on a robot with a quaternion, whose transition Jacobian is singular.
+ *  The covariances are read with marginal() and written through objectState(), as the map objects do,
+ *  since the information filter has no dense covariances matrix.
+ *
+ * \ingroup rtslam
+ */
+
+// boost unit test includes
+#include <boost/test/auto_unit_test.hpp>
+
+// jafar debug include
+#include "kernel/jafarDebug.hpp"
+
+#include <iostream>
+#include <cmath>
+
+#include "jmath/jblas.hpp"
+#include "jmath/ublasExtra.hpp"
+
+#include "rtslam/kalmanFilter.hpp"
+#include "rtslam/informationFilter.hpp"
+
+using namespace jblas;
+using namespace jafar;
+using namespace jafar::rtslam;
+using namespace jafar::jmath::ublasExtra;
+using namespace std;
+
+/*
+ * A robot on a line with state [p v], and scalar landmarks at states 2..n+1,
+ * observed with z = l - p. The means are written before the filter calls, as in the map objects.
+ */
+static void observe(ExtendedKalmanFilterIndirect & filter, size_t j, double z)
+{
+	ind_array ia_x = ia_set(0, filter.size());
+	ind_array ia_rsl = ia_union(ia_set(0, 2), ia_set(2 + j, 3 + j));
+	sym_mat R(1); R(0,0) = 1e-2;
+	mat INN_rsl(1,3); INN_rsl(0,0) = 1.; INN_rsl(0,1) = 0.; INN_rsl(0,2) = -1.;
+	Innovation inn(1);
+	inn.x()(0) = z - (filter.x(2 + j) - filter.x(0));
+	inn.P() = R + prod_JPJt(filter.marginal(ia_rsl), INN_rsl);
+	filter.correct(ia_x, inn, INN_rsl, ia_rsl, R);
+}
+
+/// \return the state of the robot
+static Gaussian run(ExtendedKalmanFilterIndirect & filter, size_t nLmks, size_t nSteps)
+{
+	ind_array ia_v = ia_set(0, 2);
+	ind_array ia_x = ia_set(0, 2 + nLmks);
+	Gaussian robot = filter.objectState(ia_v);
+	filter.x(0) = 0.; filter.x(1) = 1.;
+	robot.P()(0,0) = 0.01; robot.P()(1,1) = 0.1;
+
+	double dt = 0.1;
+	mat F = identity_mat(2); F(0,1) = dt;
+	sym_mat Q(2); Q.clear(); Q(0,0) = 1e-4; Q(1,1) = 1e-3;
+	sym_mat R(1); R(0,0) = 1e-2;
+	double p = 0.;
+
+	for (size_t t = 0; t < nSteps; ++t)
+	{
+		p += 1.2 * dt;
+		vec xv = project(filter.x(), ia_v);
+		project(filter.x(), ia_v) = prod(F, xv);
+		filter.predict(ia_x, F, ia_v, Q);
+
+		for (size_t j = 0; j < nLmks; ++j)
+		{
+			double z = 0.5 * j - p + 0.01 * std::sin(double(7 * t + 3 * j));
+			if (t == 0)
+			{
+				mat G_rs(1,2); G_rs(0,0) = 1.; G_rs(0,1) = 0.;
+				mat G_y = identity_mat(1);
+				filter.x(2 + j) = filter.x(0) + z;
+				filter.initialize(ia_x, G_rs, ia_v, ia_set(2 + j, 3 + j), G_y, R);
+			}
+			else
+				observe(filter, j, z);
+		}
+	}
+	return robot;
+}
+
+void test_information01(void) {
+	// without sparsification the information filter is the Kalman filter
+	size_t n = 4;
+	ExtendedKalmanFilterIndirect ekf(2 + n);
+	SparseInformationFilterIndirect seif(2 + n, 10, 1e-9);
+	Gaussian robot_ekf = run(ekf, n, 20);
+	Gaussian robot_seif = run(seif, n, 20);
+	for (size_t i = 0; i < 2; ++i)
+		BOOST_CHECK_CLOSE(robot_seif.P()(i,i), robot_ekf.P()(i,i), 1e-3);
+	sym_mat P_seif = seif.marginal(ia_set(0, 2 + n));
+	for (size_t i = 0; i < 2 + n; ++i)
+	{
+		BOOST_CHECK_SMALL(seif.x(i) - ekf.x(i), 1e-6);
+		BOOST_CHECK_CLOSE(P_seif(i,i), ekf.P()(i,i), 1e-3);
+	}
+	BOOST_CHECK_CLOSE(P_seif(0,2), ekf.P()(0,2), 1e-3);
+	cout << "ekf " << ekf.x() << "\nseif " << seif.x() << endl;
+}
+
+void test_information02(void) {
+	// the robot is only linked to maxActive landmarks, and the map is still close to the Kalman one
+	size_t n = 8;
+	ExtendedKalmanFilterIndirect ekf(2 + n);
+	SparseInformationFilterIndirect seif(2 + n, 3, 1e-9);
+	run(ekf, n, 20);
+	run(seif, n, 20);
+	BOOST_CHECK(seif.activeCount() <= 3);
+	for (size_t i = 2; i < 2 + n; ++i)
+		BOOST_CHECK_SMALL((seif.x(i) - seif.x(0)) - (ekf.x(i) - ekf.x(0)), 0.01);
+	BOOST_CHECK_SMALL(seif.x(1) - ekf.x(1), 0.01);
+	cout << "ekf " << ekf.x() << "\nseif " << seif.x() << "\nnon zeros " << seif.nonZeros() << endl;
+
+	// deleting a landmark keeps the others, an observation without innovation does not move them
+	seif.liberate(ia_set(2, 3));
+	vec x = seif.x();
+	observe(seif, 1, seif.x(3) - seif.x(0));
+	for (size_t i = 0; i < 2 + n; ++i)
+		if (i != 2) BOOST_CHECK_SMALL(seif.x(i) - x(i), 1e-6);
+	BOOST_CHECK(seif.activeCount() <= 3);
+}
+
+/*
+ * A constant-velocity robot with state [p q v w], the velocities in the robot frame,
+ * and point landmarks at states 13.. observed with z = l - p.
+ * The transition Jacobian is computed numerically, with the quaternion normalization it is singular.
+ */
+static vec moveQuat(const vec & x, double dt)
+{
+	vec y = x;
+	double q0 = x(3), q1 = x(4), q2 = x(5), q3 = x(6);
+	double R[3][3] = {
+		{ q0*q0+q1*q1-q2*q2-q3*q3, 2*(q1*q2-q0*q3), 2*(q1*q3+q0*q2) },
+		{ 2*(q1*q2+q0*q3), q0*q0-q1*q1+q2*q2-q3*q3, 2*(q2*q3-q0*q1) },
+		{ 2*(q1*q3-q0*q2), 2*(q2*q3+q0*q1), q0*q0-q1*q1-q2*q2+q3*q3 } };
+	for (size_t i = 0; i < 3; ++i)
+		for (size_t j = 0; j < 3; ++j) y(i) += R[i][j] * x(7 + j) * dt;
+	double r0 = 1., r1 = x(10)*dt/2, r2 = x(11)*dt/2, r3 = x(12)*dt/2;
+	y(3) = q0*r0 - q1*r1 - q2*r2 - q3*r3;
+	y(4) = q0*r1 + q1*r0 + q2*r3 - q3*r2;
+	y(5) = q0*r2 - q1*r3 + q2*r0 + q3*r1;
+	y(6) = q0*r3 + q1*r2 - q2*r1 + q3*r0;
+	double n = std::sqrt(y(3)*y(3) + y(4)*y(4) + y(5)*y(5) + y(6)*y(6));
+	for (size_t i = 3; i < 7; ++i) y(i) /= n;
+	return y;
+}
+
+static void runQuat(ExtendedKalmanFilterIndirect & filter, size_t nLmks, size_t nSteps)
+{
+	ind_array ia_v = ia_set(0, 13);
+	ind_array ia_x = ia_set(0, 13 + 3*nLmks);
+	Gaussian robot = filter.objectState(ia_v);
+	filter.x().clear();
+	filter.x(3) = 1.; filter.x(7) = 1.; filter.x(12) = 0.2;
+	for (size_t i = 0; i < 13; ++i) robot.P()(i,i) = (i < 7 ? 1e-6 : 1e-2);
+
+	double dt = 0.1;
+	sym_mat Q(13); Q.clear();
+	for (size_t i = 7; i < 13; ++i) Q(i,i) = 1e-3;
+	sym_mat R = 1e-2 * identity_mat(3);
+	vec xt = filter.x();
+
+	for (size_t t = 0; t < nSteps; ++t)
+	{
+		xt = moveQuat(xt, dt);
+		vec xv = project(filter.x(), ia_v);
+		mat F(13,13);
+		for (size_t j = 0; j < 13; ++j)
+		{
+			vec xa = xv, xb = xv;
+			xa(j) += 1e-6; xb(j) -= 1e-6;
+			column(F, j) = (moveQuat(xa, dt) - moveQuat(xb, dt)) / 2e-6;
+		}
+		project(filter.x(), ia_v) = moveQuat(xv, dt);
+		filter.predict(ia_x, F, ia_v, Q);
+
+		for (size_t j = 0; j < nLmks; ++j)
+		{
+			ind_array ia_l = ia_set(13 + 3*j, 16 + 3*j);
+			vec z(3);
+			for (size_t i = 0; i < 3; ++i) z(i) = (i == j % 3 ? 2. : 0.5) + j - xt(i) + 0.01 * std::sin(double(7 * t + 3 * j + i));
+			mat INN_rsl(3, 6); INN_rsl.clear();
+			subrange(INN_rsl, 0, 3, 0, 3) = identity_mat(3);
+			subrange(INN_rsl, 0, 3, 3, 6) = -identity_mat(3);
+			ind_array ia_rsl = ia_union(ia_set(0, 3), ia_l);
+			if (t == 0)
+			{
+				mat G_rs(3,13); G_rs.clear(); subrange(G_rs, 0, 3, 0, 3) = identity_mat(3);
+				mat G_y = identity_mat(3);
+				project(filter.x(), ia_l) = subrange(filter.x(), 0, 3) + z;
+				filter.initialize(ia_x, G_rs, ia_v, ia_l, G_y, R);
+			}
+			else
+			{
+				Innovation inn(3);
+				inn.x() = z - (project(filter.x(), ia_l) - subrange(filter.x(), 0, 3));
+				inn.P() = R + prod_JPJt(filter.marginal(ia_rsl), INN_rsl);
+				filter.correct(ia_x, inn, INN_rsl, ia_rsl, R);
+			}
+		}
+	}
+}
+
+void test_information03(void) {
+	// the prediction with a singular transition Jacobian, without sparsification
+	size_t n = 3, N = 13 + 3*n;
+	ExtendedKalmanFilterIndirect ekf(N);
+	SparseInformationFilterIndirect seif(N, 10, 1e-9);
+	runQuat(ekf, n, 20);
+	runQuat(seif, n, 20);
+	sym_mat P_seif = seif.marginal(ia_set(0, N));
+	for (size_t i = 0; i < N; ++i)
+	{
+		BOOST_CHECK_SMALL(seif.x(i) - ekf.x(i), 1e-4);
+		BOOST_CHECK_SMALL(P_seif(i,i) - ekf.P()(i,i), 1e-3 * ekf.P()(i,i) + 1e-9);
+	}
+	cout << "ekf " << ekf.x() << "\nseif " << seif.x() << endl;
+}
+
+void test_information04(void) {
+	// there is no dense covariances matrix, and a correction only depends on its measurement noise,
+	// not on the covariances recovered between the projection and the correction
+	size_t n = 4;
+	SparseInformationFilterIndirect seif1(2 + n, 10, 1e-9), seif2(2 + n, 10, 1e-9);
+	run(seif1, n, 5);
+	run(seif2, n, 5);
+	BOOST_CHECK_EQUAL(seif1.P().size1(), 0u);
+
+	ind_array ia_x = ia_set(0, 2 + n);
+	ind_array ia_rsl = ia_union(ia_set(0, 2), ia_set(3, 4));
+	sym_mat R(1); R(0,0) = 1e-2;
+	mat INN_rsl(1,3); INN_rsl(0,0) = 1.; INN_rsl(0,1) = 0.; INN_rsl(0,2) = -1.;
+	Innovation inn(1);
+	inn.x()(0) = 0.05;
+	inn.P() = R + prod_JPJt(seif1.marginal(ia_rsl), INN_rsl);
+	seif1.correct(ia_x, inn, INN_rsl, ia_rsl, R);
+	seif2.marginal(ia_rsl);
+	seif2.marginal(ia_union(ia_set(0, 2), ia_set(1 + n, 2 + n)));
+	seif2.correct(ia_x, inn, INN_rsl, ia_rsl, R);
+	for (size_t i = 0; i < 2 + n; ++i)
+		BOOST_CHECK_SMALL(seif2.x(i) - seif1.x(i), 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE( test_information )
+{
+	test_information01();
+	test_information02();
+	test_information03();
+	test_information04();
+}
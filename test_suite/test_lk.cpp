@@ -0,0 +1,86 @@
+/**
+ * test_lk.cpp
+ *
+ * \date 17/10/2026
+ * \author jsola@laas.fr
+ *
+ *  \file test_lk.cpp
+ *
+ *  Test the Lucas-Kanade tracker used to refine the matches.
+ *
+ * \ingroup rtslam
+ */
+
+// boost unit test includes
+#include <boost/test/auto_unit_test.hpp>
+
+// jafar debug include
+#include "kernel/jafarDebug.hpp"
+
+#include <iostream>
+#include <cmath>
+
+#include "image/Image.hpp"
+#include "rtslam/lkTracker.hpp"
+
+using namespace jafar;
+using namespace jafar::rtslam;
+using namespace std;
+
+const int IMG_SIZE = 60;
+const int PATCH_SIZE = 15;
+
+/// smooth texture at position u,v, moved by su,sv, with gain and bias
+static void fillImage(image::Image & img, double su, double sv, double gain, double bias, bool stripes)
+{
+	for (int i = 0; i < img.height(); ++i)
+		for (int j = 0; j < img.width(); ++j)
+		{
+			double u = j + 0.5 - su, v = i + 0.5 - sv;
+			double val = 50. * sin(u / 3.1 + 0.7);
+			if (!stripes) val = val * cos(v / 2.3) + 60. * exp(-((u-30.)*(u-30.) + (v-28.)*(v-28.)) / 20.);
+			img.data()[i * img.step() + j] = (unsigned char)(gain * (100. + val) + bias + 0.5);
+		}
+}
+
+void test_lk01(void) {
+	// a textured patch is found with sub-pixel accuracy, despite a change of lighting
+	image::Image img1(IMG_SIZE, IMG_SIZE, CV_8U, JfrImage_CS_GRAY);
+	image::Image img2(IMG_SIZE, IMG_SIZE, CV_8U, JfrImage_CS_GRAY);
+	image::Image patch(PATCH_SIZE, PATCH_SIZE, CV_8U, JfrImage_CS_GRAY);
+	fillImage(img1, 0., 0., 1., 0., false);
+	fillImage(img2, 0.3, -0.6, 0.8, 20., false);
+	img1.extractPatch(patch, 30, 28, PATCH_SIZE, PATCH_SIZE);
+
+	LkTracker tracker(20, 0.01, 3.);
+	BOOST_CHECK(tracker.setTemplate(patch));
+	double x = 30.5 + 1.0, y = 28.5 + 0.5, score, cov[3];
+	BOOST_CHECK(tracker.track(img2, x, y, score, cov));
+	cout << "tracked at " << x << " " << y << " in " << tracker.iterations() << " iterations, score " << score << endl;
+	BOOST_CHECK_SMALL(x - 30.8, 0.05);
+	BOOST_CHECK_SMALL(y - 27.9, 0.05);
+	BOOST_CHECK(score > 0.99);
+	BOOST_CHECK(cov[0] > 0. && cov[2] > 0. && cov[0]*cov[2] > cov[1]*cov[1]);
+
+	// too far from the initial position
+	x = 30.5 + 2.5; y = 28.5 - 2.5;
+	LkTracker near(20, 0.01, 1.);
+	near.setTemplate(patch);
+	BOOST_CHECK(!near.track(img2, x, y, score, cov));
+}
+
+void test_lk02(void) {
+	// a patch that has no texture in one direction cannot be tracked
+	image::Image img(IMG_SIZE, IMG_SIZE, CV_8U, JfrImage_CS_GRAY);
+	image::Image patch(PATCH_SIZE, PATCH_SIZE, CV_8U, JfrImage_CS_GRAY);
+	fillImage(img, 0., 0., 1., 0., true);
+	img.extractPatch(patch, 30, 28, PATCH_SIZE, PATCH_SIZE);
+	LkTracker tracker;
+	BOOST_CHECK(!tracker.setTemplate(patch));
+}
+
+BOOST_AUTO_TEST_CASE( test_lk )
+{
+	test_lk01();
+	test_lk02();
+}
@@ -0,0 +1,166 @@
+/**
+ * test_map.cpp
+ *
+ * \date 17/10/2026
+ * \author jsola@laas.fr
+ *
+ *  \file test_map.cpp
+ *
+ *  Test the growth of the map storage while states are reserved,
+ *  and report memory and time over a run growing from 0 to 2000 landmarks.
+ *  Test the cache of the marginals of the map objects.
+ *
+ * \ingroup rtslam
+ */
+
+// boost unit test includes
+#include <boost/test/auto_unit_test.hpp>
+
+// jafar debug include
+#include "kernel/jafarDebug.hpp"
+#include "kernel/timingTools.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdlib>
+#include "jmath/random.hpp"
+#include "jmath/jblas.hpp"
+#include "jmath/ublasExtra.hpp"
+
+#include "rtslam/mapAbstract.hpp"
+#include "rtslam/gaussian.hpp"
+#include "rtslam/mapManager.hpp"
+#include "rtslam/landmarkFactory.hpp"
+#include "rtslam/landmarkAnchoredHomogeneousPoint.hpp"
+#include "rtslam/landmarkEuclideanPoint.hpp"
+#include "rtslam/robotConstantVelocity.hpp"
+
+using namespace jafar;
+using namespace jafar::rtslam;
+using namespace jblas;
+using namespace jafar::jmath;
+using namespace std;
+
+/// resident memory of the process in kB, from /proc, or 0 if not available
+static long residentMemory()
+{
+	ifstream f("/proc/self/status");
+	string line;
+	while (getline(f, line))
+		if (line.compare(0, 6, "VmRSS:") == 0) return atol(line.c_str() + 6);
+	return 0;
+}
+
+void test_map01(void) {
+
+	// remote Gaussians must survive the growth of the storage
+	size_t max_size = 1000;
+	map_ptr_t mapPtr(new MapAbstract(max_size, 10));
+	BOOST_CHECK_EQUAL(mapPtr->reserved_size, 10u);
+
+	Gaussian G1(mapPtr->x(), mapPtr->P(), mapPtr->reserveStates(7));
+	randVector(G1.x());
+	for (size_t i = 0; i < 7; ++i) G1.P(i,i) = i+1.;
+	vec x1 = G1.x();
+
+	Gaussian G2(mapPtr->x(), mapPtr->P(), mapPtr->reserveStates(7));
+	BOOST_CHECK(mapPtr->reserved_size >= 14);
+	BOOST_CHECK_EQUAL(mapPtr->filterPtr->size(), mapPtr->reserved_size);
+	BOOST_CHECK(ublas::norm_2(G1.x() - x1) < 1e-12);
+	for (size_t i = 0; i < 7; ++i) BOOST_CHECK_EQUAL(G1.P(i,i), i+1.);
+	BOOST_CHECK_EQUAL(ublas::norm_2(G2.x()), 0.);
+
+	// hard limit
+	while (mapPtr->unusedStates(7)) mapPtr->reserveStates(7);
+	BOOST_CHECK(mapPtr->reserved_size <= max_size);
+	BOOST_CHECK_EQUAL(mapPtr->reserveStates(7).size(), 0u);
+}
+
+void test_map02(void) {
+
+	// run from 0 to 2000 euclidean landmarks, one frame is 10 new landmarks and a robot prediction
+	const size_t rob_size = 13, lmk_size = 3, n_lmks = 2000, n_init = 10;
+	size_t max_size = rob_size + n_lmks * lmk_size;
+
+	long mem0 = residentMemory();
+	map_ptr_t mapPtr(new MapAbstract(max_size));
+	jblas::ind_array ia_rob = mapPtr->reserveStates(rob_size);
+	for (size_t i = 0; i < rob_size; ++i) mapPtr->P(ia_rob(i), ia_rob(i)) = 1.;
+	jblas::mat F_v(rob_size, rob_size); F_v.assign(jblas::identity_mat(rob_size));
+	jblas::sym_mat Q(rob_size); Q.assign(jblas::identity_mat(rob_size) * 1e-4);
+
+	cout << "% frame  landmarks  reserved_size  rss_kB  time_ms" << endl;
+	for (size_t frame = 0; frame < n_lmks / n_init; ++frame)
+	{
+		double t = kernel::Clock::getTime();
+		for (size_t i = 0; i < n_init; ++i)
+		{
+			jblas::ind_array ia_lmk = mapPtr->reserveStates(lmk_size);
+			BOOST_REQUIRE(ia_lmk.size() == lmk_size);
+			for (size_t j = 0; j < lmk_size; ++j) mapPtr->P(ia_lmk(j), ia_lmk(j)) = 1.;
+		}
+		mapPtr->filterPtr->predict(mapPtr->ia_used_states(), F_v, ia_rob, Q);
+		t = kernel::Clock::getTime() - t;
+		if ((frame+1) % 20 == 0)
+			cout << frame+1 << "  " << (frame+1)*n_init << "  " << mapPtr->reserved_size << "  " << residentMemory() - mem0 << "  " << t*1000. << endl;
+	}
+	BOOST_CHECK_EQUAL(mapPtr->current_size, max_size);
+}
+
+void test_map03(void) {
+
+	// the marginals are read once per version, and the snapshots kept by the consumers do not change
+	map_ptr_t mapPtr(new MapAbstract(100));
+	robconstvel_ptr_t robPtr(new RobotConstantVelocity(mapPtr));
+	robPtr->linkToParentMap(mapPtr);
+	robPtr->state.P() = 0.01 * jblas::identity_mat(robPtr->state.size());
+	landmark_factory_ptr_t lmkFactory(new LandmarkFactory<LandmarkAnchoredHomogeneousPoint, LandmarkEuclideanPoint>());
+	map_manager_ptr_t mmPoint(new MapManager(lmkFactory));
+	mmPoint->linkToParentMap(mapPtr);
+	eucp_ptr_t lmkPtr(new LandmarkEuclideanPoint(mapPtr));
+	lmkPtr->linkToParentMapManager(mmPoint);
+	for (size_t i = 0; i < 3; ++i) { lmkPtr->state.x(i) = i + 1.; lmkPtr->state.P(i,i) = 1.; }
+
+	vec x; sym_mat P;
+	BOOST_CHECK(!mapPtr->marginals.snapshot());
+	BOOST_CHECK(!mapPtr->marginals.get(lmkPtr->state.ia(), x, P));
+
+	mapPtr->marginals.crossTerms = true;
+	mapPtr->marginals.update(*mapPtr);
+	MarginalCache::snapshot_ptr_t snap1 = mapPtr->marginals.snapshot();
+	BOOST_REQUIRE(snap1);
+	BOOST_CHECK(mapPtr->marginals.get(lmkPtr->state.ia(), x, P));
+	BOOST_CHECK_EQUAL(ublas::norm_inf(x - lmkPtr->state.x()), 0.);
+	BOOST_CHECK_EQUAL(P(1,1), 1.);
+	BOOST_CHECK(snap1->block(robPtr->state.ia()) != NULL);
+	BOOST_CHECK(snap1->cross(robPtr->state.ia(), lmkPtr->state.ia()) != NULL);
+
+	// same version: the blocks are shared
+	mapPtr->marginals.update(*mapPtr);
+	MarginalCache::snapshot_ptr_t snap2 = mapPtr->marginals.snapshot();
+	BOOST_CHECK(snap2->block(lmkPtr->state.ia()) == snap1->block(lmkPtr->state.ia()));
+
+	// new version: the blocks are read again
+	jblas::mat F_v = jblas::identity_mat(robPtr->state.size());
+	jblas::sym_mat Q = jblas::identity_mat(robPtr->state.size());
+	mapPtr->filterPtr->predict(mapPtr->ia_used_states(), F_v, robPtr->state.ia(), Q);
+	mapPtr->marginals.update(*mapPtr);
+	MarginalCache::snapshot_ptr_t snap3 = mapPtr->marginals.snapshot();
+	BOOST_CHECK(snap3->version > snap1->version);
+	BOOST_CHECK_CLOSE(snap3->block(robPtr->state.ia())->P(0,0), 1.01, 1e-6);
+	BOOST_CHECK_CLOSE(snap1->block(robPtr->state.ia())->P(0,0), 0.01, 1e-6);
+
+	// the robots only, for the exporters
+	mapPtr->marginals.update(*mapPtr, false);
+	BOOST_CHECK(mapPtr->marginals.get(robPtr->state.ia(), x, P));
+	BOOST_CHECK(!mapPtr->marginals.get(lmkPtr->state.ia(), x, P));
+}
+
+
+BOOST_AUTO_TEST_CASE( test_map )
+{
+	test_map01();
+	test_map02();
+	test_map03();
+}
@@ -27,6 +27,9 @@
 #include "rtslam/landmarkEuclideanPoint.hpp"
 #include "rtslam/landmarkAnchoredHomogeneousPoint.hpp"
 #include "rtslam/observationPinHoleAnchoredHomogeneous.hpp"
+#include "rtslam/observationFactory.hpp"
+#include "rtslam/observationMakers.hpp"
+#include "rtslam/dataManagerAbstract.hpp"
 
 using namespace std;
 using namespace jafar;
@@ -168,7 +171,156 @@ void test_obsap01(void) {
 
 }
 
+void test_obsap02(void) {
+
+	// create all objects
+	map_ptr_t mapPtr(new MapAbstract(100));
+	robodo_ptr_t robPtr(new RobotOdometry(mapPtr));
+	robPtr->id(robPtr->robotIds.getId());
+	robPtr->linkToParentMap(mapPtr);
+	pinhole_ptr_t pinholePtr(new SensorPinhole(robPtr,MapObject::UNFILTERED));
+	pinholePtr->id(pinholePtr->sensorIds.getId());
+	pinholePtr->linkToParentRobot(robPtr);
+	vec4 k; k(0) = 320; k(1) = 240; k(2) = 320; k(3) = 320;
+	vec d(0);
+	pinholePtr->params.setImgSize(640, 480);
+	pinholePtr->params.setIntrinsicCalibration(k, d, d.size());
+
+	landmark_factory_ptr_t lmkFactory(new LandmarkFactory<LandmarkAnchoredHomogeneousPoint, LandmarkEuclideanPoint>());
+	map_manager_ptr_t mmPoint(new MapManager(lmkFactory));
+	mmPoint->linkToParentMap(mapPtr);
+	ahp_ptr_t ahpPtr(new LandmarkAnchoredHomogeneousPoint(mapPtr));
+	ahpPtr->linkToParentMapManager(mmPoint);
+	obs_ph_ahp_ptr_t obspaPtr(new ObservationPinHoleAnchoredHomogeneousPoint(pinholePtr, ahpPtr));
+	obspaPtr->linkToParentAHP(ahpPtr);
+	obspaPtr->linkToPinHole(pinholePtr);
+
+	robPtr->pose.x(quaternion::originFrame());
+	pinholePtr->pose.x(quaternion::originFrame());
+	vec7 sg = pinholePtr->globalPose();
+
+	// a point at 4m, seen from the current pose and from a pose 30cm aside
+	vec u(2), r(1), ahp(7), u2(2), r2(1);
+	u(0) = 250; u(1) = 200;
+	r(0) = 0.25;
+	obspaPtr->model->backProject_func(sg, u, r, ahp);
+	vec7 sgOther = sg;
+	sgOther(0) += 0.3;
+	obspaPtr->model->project_func(sgOther, ahp, u2, r2);
+
+	obspaPtr->measurement.x(u);
+	obspaPtr->measurement.std(1.0);
+	obspaPtr->setup(0.5);
+	double error;
+
+	// no parallax: the prior is not changed
+	BOOST_CHECK(!obspaPtr->triangulatePrior(sg, u, error));
+	BOOST_CHECK_SMALL(obspaPtr->prior.x(0) - 1/1.5, 1e-12);
+
+	// parallax: the prior is the inverse distance of the point, and much more certain
+	BOOST_CHECK(obspaPtr->triangulatePrior(sgOther, u2, error));
+	BOOST_CHECK_SMALL(error, 1e-3);
+	BOOST_CHECK_SMALL(obspaPtr->prior.x(0) - 0.25, 1e-4);
+	BOOST_CHECK(sqrt(obspaPtr->prior.P(0,0)) < 0.1 * (1/1.5));
+
+	// the other measurement is not on the epipolar line: large reprojection error
+	obspaPtr->setup(0.5);
+	u2(1) += 20;
+	obspaPtr->triangulatePrior(sgOther, u2, error);
+	BOOST_CHECK(error > 10);
+}
+
+class DataManagerTest: public DataManagerAbstract {
+	public:
+		void processKnown(raw_ptr_t data) {}
+		void detectNew(raw_ptr_t data) {}
+};
+
+void test_obsap03(void) {
+
+	// a map manager with two cameras, the landmark is initialized by the first one
+	map_ptr_t mapPtr(new MapAbstract(100));
+	robodo_ptr_t robPtr(new RobotOdometry(mapPtr));
+	robPtr->id(robPtr->robotIds.getId());
+	robPtr->linkToParentMap(mapPtr);
+	robPtr->pose.x(quaternion::originFrame());
+
+	landmark_factory_ptr_t lmkFactory(new LandmarkFactory<LandmarkAnchoredHomogeneousPoint, LandmarkEuclideanPoint>());
+	map_manager_ptr_t mmPoint(new MapManager(lmkFactory));
+	mmPoint->linkToParentMap(mapPtr);
+	boost::shared_ptr<ObservationFactory> obsFactory(new ObservationFactory());
+	obsFactory->addMaker(boost::shared_ptr<ObservationMakerAbstract>(new ImagePointObservationMaker<
+		ObservationPinHoleAnchoredHomogeneousPoint, SensorPinhole, LandmarkAnchoredHomogeneousPoint,
+		AppearanceImagePoint, SensorAbstract::PINHOLE, LandmarkAbstract::PNT_AH>(0.5, 11)));
+
+	pinhole_ptr_t pinholePtr[2];
+	boost::shared_ptr<DataManagerTest> dmPtr[2];
+	vec4 k; k(0) = 320; k(1) = 240; k(2) = 320; k(3) = 320;
+	vec d(0);
+	for (int i = 0; i < 2; ++i)
+	{
+		pinholePtr[i].reset(new SensorPinhole(robPtr,MapObject::UNFILTERED));
+		pinholePtr[i]->id(pinholePtr[i]->sensorIds.getId());
+		pinholePtr[i]->linkToParentRobot(robPtr);
+		pinholePtr[i]->params.setImgSize(640, 480);
+		pinholePtr[i]->params.setIntrinsicCalibration(k, d, d.size());
+		pinholePtr[i]->pose.x(quaternion::originFrame());
+		dmPtr[i].reset(new DataManagerTest());
+		dmPtr[i]->linkToParentSensor(pinholePtr[i]);
+		dmPtr[i]->linkToParentMapManager(mmPoint);
+		dmPtr[i]->setObservationFactory(obsFactory);
+	}
+
+	observation_ptr_t obsPtr = mmPoint->createNewLandmark(dmPtr[0]);
+	landmark_ptr_t lmkPtr = obsPtr->landmarkPtr();
+	vec u(2), r(1), ahp(7);
+	u(0) = 250; u(1) = 200;
+	r(0) = 0.25;
+	obsPtr->model->backProject_func(pinholePtr[0]->globalPose(), u, r, ahp);
+	lmkPtr->state.x(ahp);
+	BOOST_CHECK_EQUAL(lmkPtr->observationList().size(), 1u);
+	BOOST_CHECK_EQUAL(dmPtr[1]->observationList().size(), 0u);
+
+	// the second camera, beyond the point, does not see it: no observation
+	vec7 beyond = quaternion::originFrame();
+	subrange(beyond, 0, 3) = 2.0 * lmkPtr->reparametrized();
+	pinholePtr[1]->pose.x(beyond);
+	mmPoint->manageObservations(dmPtr[1]);
+	BOOST_CHECK_EQUAL(lmkPtr->observationList().size(), 1u);
+
+	// it sees it: the observation is created
+	pinholePtr[1]->pose.x(quaternion::originFrame());
+	mmPoint->manageObservations(dmPtr[1]);
+	BOOST_CHECK_EQUAL(lmkPtr->observationList().size(), 2u);
+	BOOST_CHECK_EQUAL(dmPtr[1]->observationList().size(), 1u);
+	observation_ptr_t obs2Ptr = dmPtr[1]->observationList().front();
+	BOOST_CHECK(obs2Ptr->landmarkPtr() == lmkPtr);
+
+	// not visible for a long time: it is reclaimed, and its counters are kept by the landmark
+	mmPoint->setObservationReclaim(3);
+	obs2Ptr->counters.nSearch = 7;
+	obs2Ptr->counters.nFrameSinceLastVisible = 5;
+	pinholePtr[1]->pose.x(beyond);
+	mmPoint->manageObservations(dmPtr[1]);
+	BOOST_CHECK_EQUAL(lmkPtr->observationList().size(), 1u);
+	BOOST_CHECK_EQUAL(dmPtr[1]->observationList().size(), 0u);
+
+	// the last observation of the landmark is never reclaimed
+	obsPtr->counters.nFrameSinceLastVisible = 100;
+	mmPoint->manageObservations(dmPtr[0]);
+	BOOST_CHECK_EQUAL(lmkPtr->observationList().size(), 1u);
+
+	// visible again: a new observation with the previous counters
+	pinholePtr[1]->pose.x(quaternion::originFrame());
+	mmPoint->manageObservations(dmPtr[1]);
+	BOOST_CHECK_EQUAL(dmPtr[1]->observationList().size(), 1u);
+	BOOST_CHECK_EQUAL(dmPtr[1]->observationList().front()->counters.nSearch, 7);
+	BOOST_CHECK(lmkPtr->reclaimedCounters.empty());
+}
+
 BOOST_AUTO_TEST_CASE( test_obsap )
 {
 	test_obsap01();
+	test_obsap02();
+	test_obsap03();
 }
@@ -0,0 +1,169 @@
+/**
+ * test_parents.cpp
+ *
+ * \date 17/10/2026
+ * \author jsola@laas.fr
+ *
+ *  \file test_parents.cpp
+ *
+ *  Test the parent/child registry, and benchmark landmark churn in large maps
+ *  against the former linear std::list::remove.
+ *
+ * \ingroup rtslam
+ */
+
+// boost unit test includes
+#include <boost/test/auto_unit_test.hpp>
+
+// jafar debug include
+#include "kernel/jafarDebug.hpp"
+#include "kernel/timingTools.hpp"
+
+#include <iostream>
+#include <vector>
+#include <list>
+#include <boost/enable_shared_from_this.hpp>
+
+#include "rtslam/parents.hpp"
+
+using namespace jafar;
+using namespace jafar::rtslam;
+using namespace std;
+
+// a minimal graph, with one child type having two parents, like observations with landmarks and data managers
+class TestParentA;
+class TestParentB;
+class TestChild;
+
+class TestParentA: public ParentOf<TestChild> {
+	public:
+		ENABLE_ACCESS_TO_CHILDREN(TestChild,Child,child);
+};
+class TestParentB: public ParentOf<TestChild> {
+	public:
+		ENABLE_ACCESS_TO_CHILDREN(TestChild,Child,child);
+};
+class TestChild: public ChildOf<TestParentA>, public ChildOf<TestParentB>, public boost::enable_shared_from_this<TestChild> {
+	public:
+		size_t n;
+		TestChild(size_t _n): n(_n) {}
+		ENABLE_LINK_TO_PARENT(TestParentA,A,TestChild);
+		ENABLE_LINK_TO_PARENT(TestParentB,B,TestChild);
+		ENABLE_ACCESS_TO_PARENT(TestParentA,parentA);
+		ENABLE_ACCESS_TO_PARENT(TestParentB,parentB);
+};
+typedef boost::shared_ptr<TestChild> test_child_ptr_t;
+
+
+void test_parents01(void) {
+
+	boost::shared_ptr<TestParentA> pa(new TestParentA());
+	boost::shared_ptr<TestParentB> pb(new TestParentB());
+	vector<test_child_ptr_t> children;
+	for (size_t i = 0; i < 10; ++i) {
+		children.push_back(test_child_ptr_t(new TestChild(i)));
+		children.back()->linkToParentA(pa);
+		children.back()->linkToParentB(pb);
+	}
+	BOOST_CHECK_EQUAL(pa->childList().size(), 10u);
+	BOOST_CHECK_EQUAL(pb->childList().size(), 10u);
+
+	// registering twice does not duplicate
+	pa->registerChild(children[3]);
+	BOOST_CHECK_EQUAL(pa->childList().size(), 10u);
+
+	// unregister from one parent only, order of the others is kept
+	pa->unregisterChild(children[0]);
+	pa->unregisterChild(children[5]);
+	pa->unregisterChild(children[9]);
+	pa->unregisterChild(children[5]); // not registered any more: no-op
+	BOOST_CHECK_EQUAL(pa->childList().size(), 7u);
+	BOOST_CHECK_EQUAL(pb->childList().size(), 10u);
+	BOOST_CHECK(!pa->isChild(children[5]));
+	BOOST_CHECK(pb->isChild(children[5]));
+	size_t expected[] = {1, 2, 3, 4, 6, 7, 8};
+	size_t k = 0;
+	for (TestParentA::ChildList::iterator it = pa->childList().begin(); it != pa->childList().end(); ++it, ++k)
+		BOOST_CHECK_EQUAL((*it)->n, expected[k]);
+
+	// unregister while iterating, the way map managers delete landmarks
+	for (TestParentB::ChildList::iterator it = pb->childList().begin(); it != pb->childList().end(); ) {
+		test_child_ptr_t ch = *it;
+		++it;
+		if (ch->n % 2 == 0) pb->unregisterChild(ch);
+	}
+	BOOST_CHECK_EQUAL(pb->childList().size(), 5u);
+	for (TestParentB::ChildList::iterator it = pb->childList().begin(); it != pb->childList().end(); ++it)
+		BOOST_CHECK_EQUAL((*it)->n % 2, 1u);
+
+	// re-register after unregistration
+	pb->registerChild(children[0]);
+	BOOST_CHECK_EQUAL(pb->childList().size(), 6u);
+	BOOST_CHECK(pb->childList().back() == children[0]);
+}
+
+
+void test_parents02(void) {
+
+	// churn: each frame, kill n_churn landmarks at random and create as many, in maps of n_lmk landmarks
+	const size_t n_frames = 100, n_churn = 20;
+	size_t sizes[] = {1000, 2000, 5000};
+
+	cout << "% landmarks  registry_us_per_frame  list_remove_us_per_frame" << endl;
+	for (size_t s = 0; s < 3; ++s)
+	{
+		size_t n_lmk = sizes[s];
+		boost::shared_ptr<TestParentA> pa(new TestParentA());
+		boost::shared_ptr<TestParentB> pb(new TestParentB());
+		std::list<test_child_ptr_t> refList;
+		vector<test_child_ptr_t> alive;
+		for (size_t i = 0; i < n_lmk; ++i) {
+			alive.push_back(test_child_ptr_t(new TestChild(i)));
+			alive.back()->linkToParentA(pa);
+			alive.back()->linkToParentB(pb);
+			refList.push_back(alive.back());
+		}
+
+		double t_reg = 0, t_ref = 0;
+		size_t next = n_lmk;
+		for (size_t f = 0; f < n_frames; ++f)
+		{
+			vector<test_child_ptr_t> dying;
+			for (size_t i = 0; i < n_churn; ++i) {
+				size_t j = (f * 7919 + i * 104729) % alive.size();
+				dying.push_back(alive[j]);
+				alive[j] = test_child_ptr_t(new TestChild(next++));
+			}
+
+			double t = kernel::Clock::getTime();
+			for (size_t i = 0; i < n_churn; ++i) {
+				pa->unregisterChild(dying[i]);
+				pb->unregisterChild(dying[i]);
+			}
+			for (size_t i = 0; i < n_churn; ++i) {
+				test_child_ptr_t ch = alive[(f * 7919 + i * 104729) % alive.size()];
+				ch->linkToParentA(pa);
+				ch->linkToParentB(pb);
+			}
+			t_reg += kernel::Clock::getTime() - t;
+
+			t = kernel::Clock::getTime();
+			for (size_t i = 0; i < n_churn; ++i) {
+				refList.remove(dying[i]);
+			}
+			for (size_t i = 0; i < n_churn; ++i)
+				refList.push_back(alive[(f * 7919 + i * 104729) % alive.size()]);
+			t_ref += kernel::Clock::getTime() - t;
+		}
+		BOOST_CHECK_EQUAL(pa->childList().size(), refList.size());
+		BOOST_CHECK_EQUAL(pb->childList().size(), refList.size());
+		cout << n_lmk << "  " << t_reg * 1e6 / n_frames << "  " << t_ref * 1e6 / n_frames << endl;
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE( test_parents )
+{
+	test_parents01();
+	test_parents02();
+}
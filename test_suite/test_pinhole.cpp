@@ -11,6 +11,7 @@
 // jafar debug include
 #include "kernel/jafarDebug.hpp"
 #include "kernel/jafarTestMacro.hpp"
+#include "kernel/timingTools.hpp"
 
 #include <iostream>
 #include "jmath/random.hpp"
@@ -65,8 +66,116 @@ void test_ph01(void) {
 
 }
 
+void test_ph02(void) {
+
+	// back-projection through the undistortion map vs the correction model:
+	// reproject the bearing with the exact distortion model and measure the error in pixels
+	vec intrinsic = jmath::ublasExtra::createVector<4> (INTRINSIC);
+	vec distortion = jmath::ublasExtra::createVector<sizeof(DISTORTION)/sizeof(double)> (DISTORTION);
+	SensorImageParameters params;
+	params.setImgSize(IMG_WIDTH, IMG_HEIGHT);
+	params.setIntrinsicCalibration(intrinsic, distortion, 2);
+	BOOST_REQUIRE(!params.undistortionMap.empty());
+
+	double err_map = 0., err_iter = 0., err_corr = 0., err_jac = 0.;
+	jblas::vec2 pix, up, pix_re;
+	jblas::vec3 p, p_d;
+	jblas::mat P_u(3,2), P_depth(3,1), P_u_num(3,2);
+	for (double v = 0.25; v < IMG_HEIGHT - 1; v += 7.7)
+		for (double u = 0.25; u < IMG_WIDTH - 1; u += 7.7)
+		{
+			pix(0) = u; pix(1) = v;
+			BOOST_CHECK(params.backprojectPoint(pix, p));
+			up = ublas::subrange(p, 0, 2);
+			pix_re = pinhole::pixellizePoint(params.intrinsic, pinhole::distortPoint(params.distortion, up));
+			err_map = std::max(err_map, ublas::norm_inf(pix_re - pix));
+
+			BOOST_CHECK(pinhole::undistortPointIterative(params.distortion, pinhole::depixellizePoint(params.intrinsic, pix), up));
+			pix_re = pinhole::pixellizePoint(params.intrinsic, pinhole::distortPoint(params.distortion, up));
+			err_iter = std::max(err_iter, ublas::norm_inf(pix_re - pix));
+
+			p = pinhole::backprojectPoint(params.intrinsic, params.correction, pix);
+			up = ublas::subrange(p, 0, 2);
+			pix_re = pinhole::pixellizePoint(params.intrinsic, pinhole::distortPoint(params.distortion, up));
+			err_corr = std::max(err_corr, ublas::norm_inf(pix_re - pix));
+
+			// Jacobian vs finite differences of the interpolated map, large enough for the float storage
+			params.backProjectPoint(pix, 1.0, p, P_u, P_depth);
+			for (size_t j = 0; j < 2; ++j) {
+				jblas::vec2 pix_d = pix; pix_d(j) += 0.1;
+				params.backprojectPoint(pix_d, p_d);
+				ublas::column(P_u_num, j) = (p_d - p) / 0.1;
+			}
+			err_jac = std::max(err_jac, ublas::norm_inf(P_u - P_u_num) / ublas::norm_inf(P_u));
+		}
+	std::cout << "% max reprojection error (pix): map " << err_map << " iterative " << err_iter << " correction " << err_corr << std::endl;
+	std::cout << "% max relative Jacobian error of the map: " << err_jac << std::endl;
+	BOOST_CHECK(err_iter < 1e-6);
+	BOOST_CHECK(err_map < 1e-2);
+	BOOST_CHECK(err_map < err_corr);
+	BOOST_CHECK(err_jac < 1e-2);
+
+	// cost of a back-projection with Jacobians
+	const int n = 100000;
+	double t = kernel::Clock::getTime();
+	for (int i = 0; i < n; ++i) {
+		pix(0) = (i * 7) % IMG_WIDTH; pix(1) = (i * 13) % IMG_HEIGHT;
+		params.backProjectPoint(pix, 1.0, p, P_u, P_depth);
+	}
+	double t_map = kernel::Clock::getTime() - t;
+	t = kernel::Clock::getTime();
+	for (int i = 0; i < n; ++i) {
+		pix(0) = (i * 7) % IMG_WIDTH; pix(1) = (i * 13) % IMG_HEIGHT;
+		pinhole::backProjectPoint(params.intrinsic, params.correction, pix, 1.0, p, P_u, P_depth);
+	}
+	double t_corr = kernel::Clock::getTime() - t;
+	std::cout << "% back-projection (ns): map " << t_map * 1e9 / n << " correction " << t_corr * 1e9 / n
+	          << ", map memory " << params.undistortionMap.memory() / 1024 << " kB" << std::endl;
+}
+
+void test_ph03(void) {
+
+	// the iterative undistortion fails past the monotony limit of the distortion:
+	// with d = [-0.5], r * (1 - 0.5 * r^2) is at most 0.544, at r = 0.816
+	vec distortion(1); distortion(0) = -0.5;
+	jblas::vec2 ud, up;
+	ud(0) = 0.3; ud(1) = 0.;
+	BOOST_CHECK(pinhole::undistortPointIterative(distortion, ud, up));
+	BOOST_CHECK_SMALL(ublas::norm_inf(pinhole::distortPoint(distortion, up) - ud), 1e-9);
+	ud(0) = 0.5; ud(1) = 0.4;
+	BOOST_CHECK(!pinhole::undistortPointIterative(distortion, ud, up));
+	jblas::mat22 UP_ud;
+	BOOST_CHECK(!pinhole::undistortPointIterative(distortion, ud, up, UP_ud));
+
+	// the map rejects the pixels around these points
+	vec intrinsic(4); intrinsic(0) = 320.; intrinsic(1) = 240.; intrinsic(2) = 400.; intrinsic(3) = 400.;
+	UndistortionMap map;
+	map.build(intrinsic, distortion, IMG_WIDTH, IMG_HEIGHT);
+	jblas::vec2 pix;
+	pix(0) = 320. + 400. * 0.3; pix(1) = 240.;
+	BOOST_CHECK(map.undistort(pix, up));
+	pix(0) = 320. + 400. * 0.5; pix(1) = 240. + 400. * 0.4;
+	BOOST_CHECK(!map.undistort(pix, up));
+	BOOST_CHECK(map.covers(pix));
+
+	// the camera rejects them, and falls back to the correction model out of the map only
+	SensorImageParameters params;
+	params.setImgSize(IMG_WIDTH, IMG_HEIGHT);
+	params.setIntrinsicCalibration(intrinsic, distortion, 2);
+	jblas::vec3 p;
+	jblas::mat P_u(3,2), P_depth(3,1);
+	BOOST_CHECK(!params.backprojectPoint(pix, p));
+	BOOST_CHECK(!params.backProjectPoint(pix, 1.0, p, P_u, P_depth));
+	pix(0) = -100.; pix(1) = 240.;
+	BOOST_CHECK(!map.covers(pix));
+	BOOST_CHECK(params.backprojectPoint(pix, p));
+	BOOST_CHECK(params.backProjectPoint(pix, 1.0, p, P_u, P_depth));
+}
+
 BOOST_AUTO_TEST_CASE( test_pinhole )
 {
 	std::cout << "##### TEST PINHOLE #####" << std::endl;
 	test_ph01();
+	test_ph02();
+	test_ph03();
 }
\ No newline at end of file
@@ -0,0 +1,104 @@
+/**
+ * test_pool.cpp
+ *
+ * \date 17/10/2026
+ * \author jsola@laas.fr
+ *
+ *  \file test_pool.cpp
+ *
+ *  Test the block pools and object pools used for landmarks, observations and appearances.
+ *
+ * \ingroup rtslam
+ */
+
+// boost unit test includes
+#include <boost/test/auto_unit_test.hpp>
+
+// jafar debug include
+#include "kernel/jafarDebug.hpp"
+
+#include <iostream>
+#include <vector>
+#include <boost/enable_shared_from_this.hpp>
+
+#include "rtslam/objectPool.hpp"
+
+using namespace jafar;
+using namespace jafar::rtslam;
+using namespace std;
+
+class TestPooled: public boost::enable_shared_from_this<TestPooled> {
+	public:
+		static int nAlive;
+		double data[13];
+		std::vector<int> buffer;
+		TestPooled(size_t n): buffer(n) { ++nAlive; }
+		virtual ~TestPooled() { --nAlive; }
+};
+int TestPooled::nAlive = 0;
+
+static TestPooled * newTestPooled() { return new TestPooled(100); }
+
+
+void test_pool01(void) {
+	// block pool: the blocks are recycled, aligned, and of the rounded size
+	BlockPool pool(40, 4);
+	BOOST_CHECK_EQUAL(pool.blockSize(), 48u);
+	std::vector<void*> blocks;
+	for (size_t i = 0; i < 10; ++i) blocks.push_back(pool.allocate());
+	BOOST_CHECK_EQUAL(pool.nChunks(), 2u); // 4 + 8 blocks
+	for (size_t i = 0; i < blocks.size(); ++i)
+		BOOST_CHECK_EQUAL((size_t)blocks[i] % BlockPool::ALIGNMENT, 0u);
+	void * last = blocks.back();
+	pool.deallocate(last);
+	BOOST_CHECK_EQUAL(pool.allocate(), last);
+	for (size_t i = 0; i < blocks.size(); ++i) pool.deallocate(blocks[i]);
+	for (size_t i = 0; i < 12; ++i) pool.allocate();
+	BOOST_CHECK_EQUAL(pool.nChunks(), 2u); // no new chunk once grown to the peak
+	BOOST_CHECK_EQUAL(&BlockPool::forSize(40), &BlockPool::forSize(48));
+}
+
+void test_pool02(void) {
+	// pooled objects: memory given back to the pool, shared_from_this and weak pointers work
+	BlockPool & pool = BlockPool::of<TestPooled>();
+	boost::shared_ptr<TestPooled> p = pooledPtr(new (poolAllocate<TestPooled>()) TestPooled(10));
+	BOOST_CHECK_EQUAL(TestPooled::nAlive, 1);
+	BOOST_CHECK(p->shared_from_this() == p);
+	boost::weak_ptr<TestPooled> w = p;
+	void * mem = p.get();
+	size_t nFree = pool.nFree();
+	p.reset();
+	BOOST_CHECK_EQUAL(TestPooled::nAlive, 0);
+	BOOST_CHECK(w.expired());
+	BOOST_CHECK_EQUAL(pool.nFree(), nFree + 1);
+	boost::shared_ptr<TestPooled> q = pooledPtr(new (poolAllocate<TestPooled>()) TestPooled(10));
+	BOOST_CHECK_EQUAL((void*)q.get(), mem);
+}
+
+void test_pool03(void) {
+	// object pool: the objects are recycled with their buffers, and deleted if the pool is gone
+	boost::shared_ptr<ObjectPool<TestPooled> > pool(new ObjectPool<TestPooled>(&newTestPooled));
+	boost::shared_ptr<TestPooled> a = pool->acquire();
+	boost::shared_ptr<TestPooled> b = pool->acquire();
+	BOOST_CHECK_EQUAL(TestPooled::nAlive, 2);
+	TestPooled * pa = a.get();
+	int * buf = &a->buffer[0];
+	a.reset();
+	BOOST_CHECK_EQUAL(TestPooled::nAlive, 2);
+	BOOST_CHECK_EQUAL(pool->nFree(), 1u);
+	a = pool->acquire();
+	BOOST_CHECK_EQUAL(a.get(), pa);
+	BOOST_CHECK_EQUAL(&a->buffer[0], buf);
+	BOOST_CHECK_EQUAL(pool->nFree(), 0u);
+	pool.reset();
+	a.reset();
+	b.reset();
+	BOOST_CHECK_EQUAL(TestPooled::nAlive, 0);
+}
+
+BOOST_AUTO_TEST_CASE( test_pool )
+{
+	test_pool01();
+	test_pool02();
+	test_pool03();
+}
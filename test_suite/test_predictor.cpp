@@ -0,0 +1,91 @@
+/**
+ * test_predictor.cpp
+ *
+ * \date 17/10/2026
+ * \author croussil
+ *
+ *  \file test_predictor.cpp
+ *
+ *  Test the prediction of the robot pose with the readings of the hardware estimator.
+ *
+ * \ingroup rtslam
+ */
+
+// boost unit test includes
+#include <boost/test/auto_unit_test.hpp>
+
+// jafar debug include
+#include "kernel/jafarDebug.hpp"
+
+#include <iostream>
+#include <boost/shared_ptr.hpp>
+
+#include "jmath/jblas.hpp"
+#include "jmath/ublasExtra.hpp"
+#include "jmath/indirectArray.hpp"
+
+#include "rtslam/rtSlam.hpp"
+#include "rtslam/quatTools.hpp"
+#include "rtslam/robotConstantVelocity.hpp"
+#include "rtslam/posePredictor.hpp"
+
+using namespace jblas;
+using namespace jafar;
+using namespace jafar::rtslam;
+using namespace std;
+
+/// readings pushed by hand, that only have the time
+class HardwareEstimatorTest: public hardware::HardwareEstimatorAbstract
+{
+	public:
+		jblas::mat buffer;
+		HardwareEstimatorTest(): buffer(1,1) { buffer.clear(); }
+		jblas::mat_indirect acquireReadings(double t1, double t2)
+		{
+			return ublas::project(buffer, jmath::ublasExtra::ia_set(0,1), jmath::ublasExtra::ia_set(0,1));
+		}
+		void releaseReadings() {}
+		jblas::ind_array instantValues() { return jmath::ublasExtra::ia_set(1,1); }
+		jblas::ind_array incrementValues() { return jmath::ublasExtra::ia_set(1,1); }
+		void push(double t) { jblas::vec reading(1); reading(0) = t; newReading(reading); }
+};
+
+void test_predictor01(void) {
+	// the predicted pose moves with the readings, and snaps to the filtered state
+	map_ptr_t mapPtr(new MapAbstract(100));
+	robconstvel_ptr_t robPtr(new RobotConstantVelocity(mapPtr));
+	robPtr->linkToParentMap(mapPtr);
+	robPtr->pose.x(quaternion::originFrame());
+	robPtr->state.x(7) = 1.; // vx
+	robPtr->state.P() = 0.01 * jblas::identity_mat(robPtr->state.size());
+	robPtr->self_time = 0.;
+	boost::shared_ptr<HardwareEstimatorTest> estimator(new HardwareEstimatorTest());
+	robPtr->setHardwareEstimator(estimator);
+
+	PosePredictor predictor(robPtr);
+	double t; vec x; sym_mat P;
+	estimator->push(0.01);
+	BOOST_CHECK(!predictor.getPose(t, x, P));
+
+	predictor.correct();
+	for (int i = 2; i <= 10; ++i) estimator->push(0.01 * i);
+	BOOST_CHECK(predictor.getPose(t, x, P));
+	cout << "predicted at " << t << ": " << x << endl;
+	BOOST_CHECK_CLOSE(t, 0.1, 1e-6);
+	BOOST_CHECK_CLOSE(x(0), 0.1, 1e-6);
+	BOOST_CHECK(P(0,0) > 0.01);
+
+	// correction at 0.05, the readings after it are replayed
+	robPtr->state.x(0) = 0.06;
+	robPtr->state.x(7) = 2.;
+	robPtr->self_time = 0.05;
+	predictor.correct();
+	predictor.getPose(t, x, P);
+	BOOST_CHECK_CLOSE(t, 0.1, 1e-6);
+	BOOST_CHECK_CLOSE(x(0), 0.16, 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE( test_predictor )
+{
+	test_predictor01();
+}
@@ -17,10 +17,14 @@
 #include "kernel/jafarDebug.hpp"
 
 #include <iostream>
+#include <algorithm>
 #include "jmath/jblas.hpp"
 #include "rtslam/quatTools.hpp"
+#include "rtslam/quatKernels.hpp"
+#include "rtslam/ahpTools.hpp"
 #include "jmath/matlab.hpp"
 #include "jmath/random.hpp"
+#include "kernel/timingTools.hpp"
 
 
 
@@ -266,9 +270,225 @@ void test_quaternion01(void) { // TESTS FOR QUATTOOLS.HPP IN RTSLAM
 
 
 
+/// max absolute difference between a row-major array and a ublas vector or matrix
+template<class V>
+static double vecDiff(const double * a, const V & v) {
+	double d = 0;
+	for (size_t i = 0; i < v.size(); ++i) d = std::max(d, std::abs(a[i] - v(i)));
+	return d;
+}
+template<class M>
+static double matDiff(const double * a, const M & m) {
+	double d = 0;
+	for (size_t i = 0; i < m.size1(); ++i)
+		for (size_t j = 0; j < m.size2(); ++j) d = std::max(d, std::abs(a[i * m.size2() + j] - m(i, j)));
+	return d;
+}
+
+void test_quaternion02(void) { // FIXED-SIZE KERNELS VS QUATTOOLS
+
+	using namespace std;
+	using namespace jblas;
+	using namespace jafar::jmath;
+	using namespace jafar::rtslam::quaternion;
+	namespace qf = jafar::rtslam::quaternion::fixed;
+	const double tol = 1e-12;
+
+	for (size_t trial = 0; trial < 100; ++trial)
+	{
+		vec q_(4), q2_(4), v_(3), e_(3), t_(3), t2_(3);
+		randVector(q_); randVector(q2_); randVector(v_); randVector(e_); randVector(t_); randVector(t2_);
+		q_ -= scalar_vec(4, 0.5); q2_ -= scalar_vec(4, 0.5); v_ -= scalar_vec(3, 0.5); t_ -= scalar_vec(3, 0.5);
+		ublasExtra::normalize(q_); ublasExtra::normalize(q2_);
+		if (trial == 0) v_ *= 1e-7; // small rotation vector branch
+		vec4 q(q_), q2(q2_);
+		vec3 v(v_), e(e_ * 3.), t(t_), t2(t2_);
+		vec7 F, G;
+		subrange(F, 0, 3) = t; subrange(F, 3, 7) = q;
+		subrange(G, 0, 3) = t2; subrange(G, 3, 7) = q2;
+
+		double aq[4], aq2[4], av[3], ae[3], aF[7], aG[7];
+		qf::load(q, 0, 4, aq); qf::load(q2, 0, 4, aq2); qf::load(v, 0, 3, av);
+		qf::load(e, 0, 3, ae); qf::load(F, 0, 7, aF); qf::load(G, 0, 7, aG);
+
+		double r4[4], r3[3], r7[7], J9[9], J12[12], J16[16], J16b[16], J21[21], J49[49], J49b[49];
+
+		// conjugate and rotation matrix
+		qf::q2qc(aq, r4);
+		BOOST_CHECK_SMALL(vecDiff(r4, q2qc(q)), tol);
+		qf::q2R(aq, J9);
+		BOOST_CHECK_SMALL(matDiff(J9, q2R(q)), tol);
+
+		// rotations
+		vec3 vo; mat VO_q(3, 4), VO_v(3, 3);
+		rotate(q, v, vo, VO_q, VO_v);
+		qf::rotate(aq, av, r3);
+		BOOST_CHECK_SMALL(vecDiff(r3, vo), tol);
+		qf::rotate(aq, av, r3, J12, J9);
+		BOOST_CHECK_SMALL(vecDiff(r3, vo), tol);
+		BOOST_CHECK_SMALL(matDiff(J12, VO_q), tol);
+		BOOST_CHECK_SMALL(matDiff(J9, VO_v), tol);
+		rotateInv(q, v, vo, VO_q, VO_v);
+		qf::rotateInv(aq, av, r3);
+		BOOST_CHECK_SMALL(vecDiff(r3, vo), tol);
+		qf::rotateInv(aq, av, r3, J12, J9);
+		BOOST_CHECK_SMALL(vecDiff(r3, vo), tol);
+		BOOST_CHECK_SMALL(matDiff(J12, VO_q), tol);
+		BOOST_CHECK_SMALL(matDiff(J9, VO_v), tol);
+
+		// quaternion product
+		vec4 qp; mat Q_q1(4, 4), Q_q2(4, 4);
+		qProd(q, q2, qp, Q_q1, Q_q2);
+		qf::qProd(aq, aq2, r4, J16, J16b);
+		BOOST_CHECK_SMALL(vecDiff(r4, qp), tol);
+		BOOST_CHECK_SMALL(matDiff(J16, Q_q1), tol);
+		BOOST_CHECK_SMALL(matDiff(J16b, Q_q2), tol);
+
+		// rotation vector and Euler angles
+		vec4 qv; mat Q_v(4, 3), Q_e(4, 3);
+		v2q(v, qv, Q_v);
+		qf::v2q(av, r4);
+		qf::v2q_by_dv(av, J12);
+		BOOST_CHECK_SMALL(vecDiff(r4, qv), tol);
+		BOOST_CHECK_SMALL(matDiff(J12, Q_v), 1e-9);
+		e2q(e, qv, Q_e);
+		qf::e2q(ae, r4, J12);
+		BOOST_CHECK_SMALL(vecDiff(r4, qv), tol);
+		BOOST_CHECK_SMALL(matDiff(J12, Q_e), tol);
+
+		// frame transformations
+		vec3 p; mat P_f(3, 7), P_p(3, 3);
+		eucFromFrame(F, v, p, P_f, P_p);
+		qf::eucFromFrame(aF, av, r3, J21, J9);
+		BOOST_CHECK_SMALL(vecDiff(r3, p), tol);
+		BOOST_CHECK_SMALL(matDiff(J21, P_f), tol);
+		BOOST_CHECK_SMALL(matDiff(J9, P_p), tol);
+		eucToFrame(F, v, p, P_f, P_p);
+		qf::eucToFrame(aF, av, r3, J21, J9);
+		BOOST_CHECK_SMALL(vecDiff(r3, p), tol);
+		BOOST_CHECK_SMALL(matDiff(J21, P_f), tol);
+		BOOST_CHECK_SMALL(matDiff(J9, P_p), tol);
+		vecFromFrame(F, v, p, P_f, P_p);
+		qf::vecFromFrame(aF, av, r3, J21, J9);
+		BOOST_CHECK_SMALL(vecDiff(r3, p), tol);
+		BOOST_CHECK_SMALL(matDiff(J21, P_f), tol);
+		BOOST_CHECK_SMALL(matDiff(J9, P_p), tol);
+		vecToFrame(F, v, p, P_f, P_p);
+		qf::vecToFrame(aF, av, r3, J21, J9);
+		BOOST_CHECK_SMALL(vecDiff(r3, p), tol);
+		BOOST_CHECK_SMALL(matDiff(J21, P_f), tol);
+		BOOST_CHECK_SMALL(matDiff(J9, P_p), tol);
+
+		// frame composition and inversion
+		vec7 C; mat C_g(7, 7), C_l(7, 7), C_g2(7, 7);
+		composeFrames(G, F, C, C_g, C_l);
+		composeFrames_by_dglobal(G, F, C_g2);
+		qf::composeFrames(aG, aF, r7, J49, J49b);
+		BOOST_CHECK_SMALL(vecDiff(r7, C), tol);
+		BOOST_CHECK_SMALL(vecDiff(r7, composeFrames(G, F)), tol);
+		BOOST_CHECK_SMALL(matDiff(J49, C_g), tol);
+		BOOST_CHECK_SMALL(matDiff(J49, C_g2), tol);
+		BOOST_CHECK_SMALL(matDiff(J49b, C_l), tol);
+		mat I_f(7, 7);
+		invertFrame(F, C, I_f);
+		qf::invertFrame(aF, r7, J49);
+		BOOST_CHECK_SMALL(vecDiff(r7, invertFrame(F)), tol);
+		BOOST_CHECK_SMALL(matDiff(J49, I_f), tol);
+
+		// AHP tools
+		vec7 ahp = jafar::rtslam::lmkAHP::fromBearingOnlyFrame(F, v, 0.5);
+		vec7 ahp2; mat AHP_s(7, 7), AHP_v(7, 3), AHP_rho(7, 1), AHP_s2(7, 7), AHP_v2(7, 3), AHP_rho2(7, 1);
+		jafar::rtslam::lmkAHP::fromBearingOnlyFrame(F, v, 0.5, ahp2, AHP_s, AHP_v, AHP_rho);
+		BOOST_CHECK_SMALL(ublas::norm_inf(ahp2 - ahp), tol);
+		vec3 vb; double dist; mat V_s(3, 7), V_ahp(3, 7);
+		jafar::rtslam::lmkAHP::toBearingOnlyFrame(F, ahp, vb, dist, V_s, V_ahp);
+		BOOST_CHECK_SMALL(ublas::norm_inf(vb - jafar::rtslam::lmkAHP::toBearingOnlyFrame(F, ahp)), tol);
+		BOOST_CHECK_SMALL(ublas::norm_inf(vb / ublas::norm_2(vb) - v / ublas::norm_2(v)), 1e-9);
+		vec3 d = subrange(ahp, 3, 6) - (t - subrange(ahp, 0, 3)) * ahp(6);
+		rotateInv(q, d, vo, VO_q, VO_v);
+		BOOST_CHECK_SMALL(ublas::norm_inf(vb - vo), tol);
+		BOOST_CHECK_SMALL((double)ublas::norm_inf(mat(subrange(V_s, 0, 3, 3, 7) - VO_q)), tol);
+		BOOST_CHECK_SMALL((double)ublas::norm_inf(mat(subrange(V_ahp, 0, 3, 3, 6) - VO_v)), tol);
+		BOOST_CHECK_SMALL((double)ublas::norm_inf(mat(subrange(V_ahp, 0, 3, 0, 3) - VO_v * ahp(6))), tol);
+		vec ahpg(7); mat AHPG_f(7, 7), AHPG_l(7, 7);
+		jafar::rtslam::lmkAHP::fromFrame(G, ahp, ahpg, AHPG_f, AHPG_l);
+		eucFromFrame(G, subrange(ahp, 0, 3), p, P_f, P_p);
+		BOOST_CHECK_SMALL(ublas::norm_inf(subrange(ahpg, 0, 3) - p), tol);
+		BOOST_CHECK_SMALL((double)ublas::norm_inf(mat(subrange(AHPG_f, 0, 3, 0, 7) - P_f)), tol);
+		BOOST_CHECK_SMALL(ublas::norm_inf(ahpg - jafar::rtslam::lmkAHP::fromFrame(G, ahp)), tol);
+		BOOST_CHECK_SMALL(ublas::norm_inf(jafar::rtslam::lmkAHP::toFrame(G, ahpg) - ahp), 1e-9);
+	}
+}
+
+void test_quaternion03(void) { // BENCHMARK OF FIXED-SIZE KERNELS VS QUATTOOLS
+
+	using namespace std;
+	using namespace jblas;
+	using namespace jafar::jmath;
+	using namespace jafar::rtslam::quaternion;
+	namespace qf = jafar::rtslam::quaternion::fixed;
+
+	const size_t n = 200000;
+	vec q_(4), v_(3);
+	randVector(q_); randVector(v_);
+	ublasExtra::normalize(q_);
+	vec7 F, G;
+	subrange(F, 0, 3) = v_; subrange(F, 3, 7) = q_;
+	subrange(G, 0, 3) = -v_; subrange(G, 3, 7) = q2qc(q_);
+	double aF[7], aG[7], r7[7], r4[4], r3[3], J49[49], J49b[49], J16[16], J16b[16], J12[12], J9[9];
+	qf::load(F, 0, 7, aF); qf::load(G, 0, 7, aG);
+	double sink = 0;
+	// each output is fed back as the next input, so that nothing is hoisted out of the loops
+
+	cout << "% kernel  quatTools_ns  fixed_ns" << endl;
+	double t, t_ublas, t_fixed;
+
+	vec4 q4; mat Q_q1(4, 4), Q_q2(4, 4);
+	vec4 qa = subrange(F, 3, 7), qb = subrange(G, 3, 7);
+	t = jafar::kernel::Clock::getTime();
+	for (size_t i = 0; i < n; ++i) { qProd(qa, qb, q4, Q_q1, Q_q2); qb = q4; sink += Q_q1(0, 0); }
+	t_ublas = jafar::kernel::Clock::getTime() - t;
+	t = jafar::kernel::Clock::getTime();
+	for (size_t i = 0; i < n; ++i) { qf::qProd(aF + 3, aG + 3, r4, J16, J16b); std::copy(r4, r4 + 4, aG + 3); sink += J16[0]; }
+	t_fixed = jafar::kernel::Clock::getTime() - t;
+	cout << "qProd+jac  " << t_ublas * 1e9 / n << "  " << t_fixed * 1e9 / n << endl;
+
+	vec3 vo, vv = subrange(G, 0, 3); mat VO_q(3, 4), VO_v(3, 3);
+	t = jafar::kernel::Clock::getTime();
+	for (size_t i = 0; i < n; ++i) { rotate(qa, vv, vo, VO_q, VO_v); vv = vo; sink += VO_q(0, 0); }
+	t_ublas = jafar::kernel::Clock::getTime() - t;
+	t = jafar::kernel::Clock::getTime();
+	for (size_t i = 0; i < n; ++i) { qf::rotate(aF + 3, aG, r3, J12, J9); std::copy(r3, r3 + 3, aG); sink += J12[0]; }
+	t_fixed = jafar::kernel::Clock::getTime() - t;
+	cout << "rotate+jac  " << t_ublas * 1e9 / n << "  " << t_fixed * 1e9 / n << endl;
+
+	vec7 C, G0 = G; mat C_g(7, 7), C_l(7, 7);
+	qf::load(G0, 0, 7, aG);
+	t = jafar::kernel::Clock::getTime();
+	for (size_t i = 0; i < n; ++i) { composeFrames(F, G, C, C_g, C_l); G = C; sink += C_g(0, 3); }
+	t_ublas = jafar::kernel::Clock::getTime() - t;
+	t = jafar::kernel::Clock::getTime();
+	for (size_t i = 0; i < n; ++i) { qf::composeFrames(aF, aG, r7, J49, J49b); std::copy(r7, r7 + 7, aG); sink += J49[3]; }
+	t_fixed = jafar::kernel::Clock::getTime() - t;
+	cout << "composeFrames+jac  " << t_ublas * 1e9 / n << "  " << t_fixed * 1e9 / n << endl;
+
+	G = G0; qf::load(G0, 0, 7, aG);
+	t = jafar::kernel::Clock::getTime();
+	for (size_t i = 0; i < n; ++i) { C = composeFrames(F, G); G = C; sink += C(3); }
+	t_ublas = jafar::kernel::Clock::getTime() - t;
+	t = jafar::kernel::Clock::getTime();
+	for (size_t i = 0; i < n; ++i) { qf::composeFrames(aF, aG, r7); std::copy(r7, r7 + 7, aG); sink += r7[3]; }
+	t_fixed = jafar::kernel::Clock::getTime() - t;
+	cout << "composeFrames  " << t_ublas * 1e9 / n << "  " << t_fixed * 1e9 / n << endl;
+
+	cout << "% (" << sink << ")" << endl;
+}
+
 
 BOOST_AUTO_TEST_CASE( test_quaternion )
 {
 	test_quaternion01();
+	test_quaternion02();
+	test_quaternion03();
 }
 
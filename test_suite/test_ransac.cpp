@@ -0,0 +1,196 @@
+/**
+ * test_ransac.cpp
+ *
+ * \date 17/10/2026
+ * \author jsola
+ *
+ *  \file test_ransac.cpp
+ *
+ *  Test the mean updates of the RANSAC hypotheses, restricted to the states of the visible observations.
+ *
+ * \ingroup rtslam
+ */
+
+// boost unit test includes
+#include <boost/test/auto_unit_test.hpp>
+
+// jafar debug include
+#include "kernel/jafarDebug.hpp"
+
+#include <iostream>
+#include <cstdlib>
+#include <boost/shared_ptr.hpp>
+
+#include "jmath/jblas.hpp"
+#include "jmath/ublasExtra.hpp"
+
+#include "rtslam/rtSlam.hpp"
+#include "rtslam/quatTools.hpp"
+#include "rtslam/robotConstantVelocity.hpp"
+#include "rtslam/sensorPinhole.hpp"
+#include "rtslam/landmarkAnchoredHomogeneousPoint.hpp"
+#include "rtslam/landmarkEuclideanPoint.hpp"
+#include "rtslam/observationPinHoleAnchoredHomogeneous.hpp"
+#include "rtslam/observationFactory.hpp"
+#include "rtslam/observationMakers.hpp"
+#include "rtslam/activeSearch.hpp"
+#include "rtslam/simuRawProcessors.hpp"
+#include "rtslam/dataManagerOnePointRansac.hpp"
+
+using namespace jblas;
+using namespace jafar;
+using namespace jafar::rtslam;
+using namespace std;
+
+typedef DataManagerOnePointRansac<simu::RawSimu, SensorPinhole, simu::FeatureSimu, image::ConvexRoi, ActiveSearchGrid,
+	simu::DetectorSimu<image::ConvexRoi>, simu::MatcherSimu<image::ConvexRoi> > DataManagerSimu;
+
+/// gives access to the mean updates of the hypotheses
+class DataManagerRansacTest: public DataManagerSimu
+{
+	public:
+		DataManagerRansacTest(const boost::shared_ptr<simu::DetectorSimu<image::ConvexRoi> > & _detector,
+			const boost::shared_ptr<simu::MatcherSimu<image::ConvexRoi> > & _matcher, const boost::shared_ptr<ActiveSearchGrid> _featMan):
+			DataManagerSimu(_detector, _matcher, _featMan, 10, 5, 3, 5, 3) {}
+		using DataManagerSimu::updateMean;
+		/// the states of these observations are the ones updated, as in projectAndCollectVisibleObs
+		void setVisible(const ObsList & obsList)
+		{
+			ia_visible = jblas::ind_array(0);
+			for (size_t i = 0; i < obsList.size(); ++i)
+				ia_visible = jmath::ublasExtra::ia_union(ia_visible, obsList[i]->ia_rsl);
+		}
+		const jblas::ind_array & visibleStates() const { return ia_visible; }
+};
+
+static bool isIn(size_t i, const jblas::ind_array & ia)
+{
+	for (size_t k = 0; k < ia.size(); ++k) if (ia(k) == i) return true;
+	return false;
+}
+
+void test_ransac01(void) {
+	// three points seen by a camera, the hypothesis is made of the first two
+	map_ptr_t mapPtr(new MapAbstract(100));
+	robconstvel_ptr_t robPtr(new RobotConstantVelocity(mapPtr));
+	robPtr->id(robPtr->robotIds.getId());
+	robPtr->linkToParentMap(mapPtr);
+	robPtr->pose.x(quaternion::originFrame());
+
+	pinhole_ptr_t senPtr(new SensorPinhole(robPtr, MapObject::UNFILTERED));
+	senPtr->id(senPtr->sensorIds.getId());
+	senPtr->linkToParentRobot(robPtr);
+	vec4 k; k(0) = 320; k(1) = 240; k(2) = 320; k(3) = 320;
+	vec d(0);
+	senPtr->params.setImgSize(640, 480);
+	senPtr->params.setIntrinsicCalibration(k, d, d.size());
+	senPtr->pose.x(quaternion::originFrame());
+
+	landmark_factory_ptr_t lmkFactory(new LandmarkFactory<LandmarkAnchoredHomogeneousPoint, LandmarkEuclideanPoint>());
+	map_manager_ptr_t mmPoint(new MapManager(lmkFactory));
+	mmPoint->linkToParentMap(mapPtr);
+	boost::shared_ptr<ObservationFactory> obsFactory(new ObservationFactory());
+	obsFactory->addMaker(boost::shared_ptr<ObservationMakerAbstract>(new ImagePointObservationMaker<
+		ObservationPinHoleAnchoredHomogeneousPoint, SensorPinhole, LandmarkAnchoredHomogeneousPoint,
+		AppearanceImagePoint, SensorAbstract::PINHOLE, LandmarkAbstract::PNT_AH>(0.5, 11)));
+
+	boost::shared_ptr<simu::DetectorSimu<image::ConvexRoi> > detector(new simu::DetectorSimu<image::ConvexRoi>(LandmarkAbstract::POINT, 2, 11, 1.0, 1.0));
+	boost::shared_ptr<simu::MatcherSimu<image::ConvexRoi> > matcher(new simu::MatcherSimu<image::ConvexRoi>(LandmarkAbstract::POINT, 2, 11, 1000000, 2.0, 0.8, 3.0, 2.0, 1.0, 1.0));
+	boost::shared_ptr<ActiveSearchGrid> asGrid(new ActiveSearchGrid(640, 480, 4, 4, 10, 5));
+	boost::shared_ptr<DataManagerRansacTest> dmPtr(new DataManagerRansacTest(detector, matcher, asGrid));
+	dmPtr->linkToParentSensorSpec(senPtr);
+	dmPtr->linkToParentMapManager(mmPoint);
+	dmPtr->setObservationFactory(obsFactory);
+
+	const double pix[3][2] = { { 200, 150 }, { 450, 300 }, { 320, 400 } };
+	ObsList obsList;
+	for (int i = 0; i < 3; ++i)
+	{
+		observation_ptr_t obsPtr = mmPoint->createNewLandmark(dmPtr);
+		vec u(2), r(1), ahp(7);
+		u(0) = pix[i][0]; u(1) = pix[i][1];
+		r(0) = 0.2 + 0.1 * i;
+		obsPtr->model->backProject_func(senPtr->globalPose(), u, r, ahp);
+		obsPtr->landmarkPtr()->state.x(ahp);
+		obsList.push_back(obsPtr);
+	}
+
+	// a covariance with correlations between all the states
+	jblas::ind_array ia_all = mapPtr->ia_used_states();
+	size_t n = ia_all.size();
+	std::srand(1);
+	mat A(n, n);
+	for (size_t i = 0; i < n; ++i)
+		for (size_t j = 0; j < n; ++j)
+			A(i,j) = 0.01 * ((double)std::rand() / RAND_MAX - 0.5);
+	sym_mat P_all = ublas::prod(A, ublas::trans(A)) + 1e-4 * identity_mat(n);
+	ublas::project(mapPtr->P(), ia_all, ia_all) = P_all;
+
+	// measurements a few pixels away from the expectations
+	for (int i = 0; i < 3; ++i)
+	{
+		observation_ptr_t obsPtr = obsList[i];
+		obsPtr->project();
+		vec meas = obsPtr->expectation.x();
+		meas(0) += 2. - i; meas(1) += 1. + i;
+		obsPtr->measurement.x(meas);
+		obsPtr->measurement.std(1.0);
+		obsPtr->computeInnovation();
+	}
+
+	ObsList obsBaseSet(obsList.begin(), obsList.begin() + 2);
+	dmPtr->setVisible(obsBaseSet);
+	const jblas::ind_array & ia_visible = dmPtr->visibleStates();
+	vec x = mapPtr->x();
+	vec x_restricted = dmPtr->updateMean(obsBaseSet);
+
+	// the full update of all the states: x + P H' inv(H P H' + R) z, H being the Jacobian of the expectations
+	size_t m = 4;
+	mat H(m, n); H.clear();
+	vec z(m);
+	sym_mat R = identity_mat(m);
+	for (size_t o = 0; o < 2; ++o)
+	{
+		const observation_ptr_t & obsPtr = obsBaseSet[o];
+		ublas::subrange(z, 2*o, 2*o+2) = obsPtr->innovation.x();
+		for (size_t c = 0; c < obsPtr->ia_rsl.size(); ++c)
+			for (size_t j = 0; j < n; ++j)
+				if (ia_all(j) == obsPtr->ia_rsl(c))
+					for (size_t l = 0; l < 2; ++l) H(2*o+l, j) = -obsPtr->INN_rsl(l, c);
+	}
+	mat PHt = ublas::prod(P_all, ublas::trans(H));
+	mat S = ublas::prod(H, PHt) + R;
+	mat iS(m, m);
+	jmath::ublasExtra::lu_inv(S, iS);
+	vec x_full = x;
+	ublas::project(x_full, ia_all) += ublas::prod(PHt, ublas::prod(iS, z));
+
+	// same update of the states of the visible observations, the others are not changed
+	double maxFullChange = 0.;
+	for (size_t j = 0; j < n; ++j)
+	{
+		size_t i = ia_all(j);
+		if (isIn(i, ia_visible))
+			BOOST_CHECK_SMALL(x_restricted(i) - x_full(i), 1e-9);
+		else
+		{
+			BOOST_CHECK_EQUAL(x_restricted(i), x(i));
+			maxFullChange = std::max(maxFullChange, std::abs(x_full(i) - x(i)));
+		}
+	}
+	cout << ia_visible.size() << " of " << n << " states updated, max change of the others by the full update " << maxFullChange << endl;
+	BOOST_CHECK(ia_visible.size() < n);
+	BOOST_CHECK(maxFullChange > 1e-6);
+
+	// one observation: same as the single observation update
+	ObsList obsOne(obsList.begin(), obsList.begin() + 1);
+	vec x_one = dmPtr->updateMean(obsOne.front());
+	vec x_list = dmPtr->updateMean(obsOne);
+	for (size_t j = 0; j < n; ++j)
+		BOOST_CHECK_SMALL(x_one(ia_all(j)) - x_list(ia_all(j)), 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE( test_ransac )
+{
+	test_ransac01();
+}
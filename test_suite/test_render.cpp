@@ -0,0 +1,121 @@
+/**
+ * test_render.cpp
+ *
+ * \date 17/10/2026
+ * \author jsola@laas.fr
+ *
+ *  \file test_render.cpp
+ *
+ *  Render images of simulated landmarks, and check that the Harris detector finds
+ *  them at their ground truth projection, from two different poses.
+ *
+ * \ingroup rtslam
+ */
+
+// boost unit test includes
+#include <boost/test/auto_unit_test.hpp>
+
+// jafar debug include
+#include "kernel/jafarDebug.hpp"
+#include "kernel/timingTools.hpp"
+
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include "jmath/jblas.hpp"
+#include "jmath/ublasExtra.hpp"
+
+#include "image/Image.hpp"
+#include "image/roi.hpp"
+#include "rtslam/quatTools.hpp"
+#include "rtslam/simuImageRenderer.hpp"
+#include "rtslam/quickHarrisDetector.hpp"
+#include "rtslam/featurePoint.hpp"
+
+using namespace jafar;
+using namespace jafar::rtslam;
+using namespace jblas;
+using namespace std;
+
+const unsigned IMG_WIDTH = 640;
+const unsigned IMG_HEIGHT = 480;
+const double INTRINSIC[4] = { 301.27013,   266.86136,   497.28243,   496.81116 };
+const double DISTORTION[2] = { -0.23193,   0.11306 };
+
+/**
+ * Detect a corner around the ground truth of each visible landmark.
+ * \return the ratio of landmarks detected within \a tol pixels of their ground truth
+ */
+static double detectionRatio(const simu::ImageRenderer & renderer, const image::Image & img, double tol)
+{
+	// a small box is needed to locate the corners within the tolerance, a 5x5 box has a flat maximum
+	QuickHarrisDetector detector(3, 15., 2.);
+	feat_img_pnt_ptr_t featPtr(new FeatureImagePoint(11, 11, CV_8U));
+	sym_mat P = 2.25 * identity_mat(2);
+	size_t n = 0, n_ok = 0;
+	const simu::ImageRenderer::GroundTruth & truth = renderer.groundTruth();
+	for (simu::ImageRenderer::GroundTruth::const_iterator it = truth.begin(); it != truth.end(); ++it)
+	{
+		vec x = it->second;
+		if (x(0) < 20 || x(1) < 20 || x(0) > IMG_WIDTH - 20 || x(1) > IMG_HEIGHT - 20) continue;
+		++n;
+		image::ConvexRoi roi(x, P, 2.);
+		if (detector.detectIn(img, featPtr, &roi) && ublas::norm_2(featPtr->measurement.x() - x) < tol) ++n_ok;
+	}
+	return (n ? (double)n_ok / n : 0.);
+}
+
+void test_render01(void) {
+
+	vec4 k;
+	for (size_t i = 0; i < 4; ++i) k(i) = INTRINSIC[i];
+	vec d(2);
+	for (size_t i = 0; i < 2; ++i) d(i) = DISTORTION[i];
+	simu::ImageRenderer renderer(IMG_WIDTH, IMG_HEIGHT, k, d);
+
+	// landmarks in front of the camera, z forward
+	std::srand(1);
+	simu::ImageRenderer::PointList points;
+	for (size_t i = 0; i < 60; ++i)
+	{
+		vec3 p;
+		p(2) = 4.5 + 3. * (std::rand() / (double)RAND_MAX - 0.5);
+		p(0) = 1.1 * p(2) * (std::rand() / (double)RAND_MAX - 0.5);
+		p(1) = 0.8 * p(2) * (std::rand() / (double)RAND_MAX - 0.5);
+		points[i] = p;
+	}
+
+	vec7 pose; pose.clear(); pose(3) = 1.;
+	image::Image img(IMG_WIDTH, IMG_HEIGHT, CV_8U, JfrImage_CS_GRAY);
+	double t0 = kernel::Clock::getTime();
+	renderer.render(pose, points, 0, img);
+	cout << "rendering " << IMG_WIDTH << "x" << IMG_HEIGHT << ": " << (kernel::Clock::getTime() - t0) * 1000. << " ms, "
+	     << renderer.groundTruth().size() << " visible landmarks" << endl;
+	BOOST_CHECK(renderer.groundTruth().size() > 30);
+	double ratio = detectionRatio(renderer, img, 1.5);
+	cout << "detected at the ground truth, first pose: " << ratio * 100. << " %" << endl;
+	BOOST_CHECK(ratio > 0.8);
+
+	// same seeds, same image
+	image::Image img2(IMG_WIDTH, IMG_HEIGHT, CV_8U, JfrImage_CS_GRAY);
+	renderer.render(pose, points, 0, img2);
+	bool same = true;
+	for (int y = 0; y < img.height(); ++y)
+		if (memcmp(img.data() + y * img.step(), img2.data() + y * img2.step(), img.width())) same = false;
+	BOOST_CHECK(same);
+
+	// another pose: the squares are seen in perspective
+	pose(0) = 0.5; pose(1) = -0.2;
+	vec3 e; e(0) = 0.05; e(1) = 0.1; e(2) = -0.05;
+	ublas::subrange(pose, 3, 7) = quaternion::e2q(e);
+	renderer.render(pose, points, 1, img);
+	ratio = detectionRatio(renderer, img, 1.5);
+	cout << "detected at the ground truth, second pose: " << ratio * 100. << " %" << endl;
+	BOOST_CHECK(ratio > 0.8);
+}
+
+
+BOOST_AUTO_TEST_CASE( test_render )
+{
+	test_render01();
+}
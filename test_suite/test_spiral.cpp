@@ -0,0 +1,92 @@
+/**
+ * test_spiral.cpp
+ *
+ * \date 17/10/2026
+ * \author jsola@laas.fr
+ *
+ *  \file test_spiral.cpp
+ *
+ *  Test the ZNCC search from the expectation to the border of the search region.
+ *
+ * \ingroup rtslam
+ */
+
+// boost unit test includes
+#include <boost/test/auto_unit_test.hpp>
+
+// jafar debug include
+#include "kernel/jafarDebug.hpp"
+
+#include <iostream>
+#include <cmath>
+
+#include "jmath/jblas.hpp"
+#include "image/Image.hpp"
+#include "image/roi.hpp"
+#include "correl/explorer.hpp"
+#include "rtslam/spiralSearch.hpp"
+
+using namespace jafar;
+using namespace jafar::rtslam;
+using namespace jblas;
+using namespace std;
+
+const int IMG_SIZE = 80;
+const int PATCH_SIZE = 13;
+
+static void fillImage(image::Image & img)
+{
+	for (int i = 0; i < img.height(); ++i)
+		for (int j = 0; j < img.width(); ++j)
+		{
+			double u = j + 0.5, v = i + 0.5;
+			double val = 50. * sin(u / 3.1 + 0.7) * cos(v / 2.3) + 40. * sin((u + 2.*v) / 7.);
+			img.data()[i * img.step() + j] = (unsigned char)(100. + val + 0.5);
+		}
+}
+
+void test_spiral01(void) {
+	// the match is found near the expectation without searching the whole region
+	image::Image img(IMG_SIZE, IMG_SIZE, CV_8U, JfrImage_CS_GRAY);
+	image::Image patch(PATCH_SIZE, PATCH_SIZE, CV_8U, JfrImage_CS_GRAY);
+	fillImage(img);
+	img.extractPatch(patch, 40, 38, PATCH_SIZE, PATCH_SIZE);
+
+	vec2 exp; exp(0) = 41.; exp(1) = 37.;
+	sym_mat P = 25. * identity_mat(2);
+	image::ConvexRoi roi(exp, P, 3.);
+
+	double x, y, sx, sy;
+	correl::FastTranslationMatcherZncc matcher(0.85, 0.25);
+	ZnccSpiralSearch spiral(matcher, 6);
+	double score = spiral.match(patch, img, roi, 0.9, x, y, sx, sy);
+	cout << "spiral: " << x << " " << y << " score " << score << ", " << spiral.stats.nPositions << " positions of " << roi.count() << endl;
+	BOOST_CHECK(score > 0.99);
+	BOOST_CHECK_SMALL(x - 40.5, 0.3);
+	BOOST_CHECK_SMALL(y - 38.5, 0.3);
+	BOOST_CHECK_EQUAL(spiral.stats.nEarly, 1u);
+	BOOST_CHECK(spiral.stats.nPositions < (unsigned long)roi.count() / 3);
+
+	// the whole region, searched by correl, gives the same match
+	ZnccSpiralSearch full(matcher, 1);
+	double xf, yf;
+	full.match(patch, img, roi, 0.9, xf, yf, sx, sy);
+	cout << "full: " << xf << " " << yf << endl;
+	BOOST_CHECK_EQUAL(full.stats.nEarly, 0u);
+	BOOST_CHECK_EQUAL(full.stats.nPositions, (unsigned long)roi.count());
+	BOOST_CHECK_SMALL(xf - x, 0.05);
+	BOOST_CHECK_SMALL(yf - y, 0.05);
+
+	// no good match in the inner rings: the whole region is searched by correl
+	ZnccSpiralSearch notFound(matcher, 6);
+	notFound.match(patch, img, roi, 1.1, xf, yf, sx, sy);
+	BOOST_CHECK_EQUAL(notFound.stats.nEarly, 0u);
+	BOOST_CHECK(notFound.stats.nPositions >= (unsigned long)roi.count());
+	BOOST_CHECK_SMALL(xf - x, 0.05);
+	BOOST_CHECK_SMALL(yf - y, 0.05);
+}
+
+BOOST_AUTO_TEST_CASE( test_spiral )
+{
+	test_spiral01();
+}